@@ -6,6 +6,7 @@ MBED_IGNORE += $(MBED_SRC_ROOT)/Develop/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/frameworks/%
 
 # Directory ignores that are generated by parsing the .mbedignore files in the mbed-os folder.
+MBED_IGNORE += $(MBED_SRC_ROOT)/drivers/test/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/events/equeue/tests/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/FEATURE_COMMON_PAL/mbed-client-randlib/linux/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/FEATURE_COMMON_PAL/mbed-client-randlib/test/%
@@ -24,10 +25,19 @@ MBED_IGNORE += $(MBED_SRC_ROOT)/features/FEATURE_LWIP/lwip-interface/lwip/src/ne
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/FEATURE_LWIP/lwip-interface/lwip/src/netif/lwip_slipif.c
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/FEATURE_LWIP/lwip-interface/lwip/src/include/lwip/apps/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/FEATURE_LWIP/lwip-interface/lwip/src/include/posix/%
+MBED_IGNORE += $(MBED_SRC_ROOT)/features/FEATURE_LWIP/lwip-interface/test/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/FEATURE_LWIP/TESTS/mbedmicro-net/host_tests/%
+MBED_IGNORE += $(MBED_SRC_ROOT)/features/filesystem/test/%
+MBED_IGNORE += $(MBED_SRC_ROOT)/features/mbedtls/test/%
+MBED_IGNORE += $(MBED_SRC_ROOT)/features/netsocket/test/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/nanostack/FEATURE_NANOSTACK/coap-service/test/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/nanostack/FEATURE_NANOSTACK/mbed-mesh-api/test/%
+MBED_IGNORE += $(MBED_SRC_ROOT)/features/storage/FEATURE_STORAGE/cfstore/test/%
+MBED_IGNORE += $(MBED_SRC_ROOT)/features/storage/FEATURE_STORAGE/flash-journal/flash-journal-strategy-sequential/test/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/features/unsupported/%
+MBED_IGNORE += $(MBED_SRC_ROOT)/hal/test/%
+MBED_IGNORE += $(MBED_SRC_ROOT)/platform/test/%
+MBED_IGNORE += $(MBED_SRC_ROOT)/rtos/test/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/targets/TARGET_Silicon_Labs/TARGET_EFM32/TESTS/%
 MBED_IGNORE += $(MBED_SRC_ROOT)/tools/%
 
@@ -231,6 +231,49 @@ void event_inference_test() {
     TEST_ASSERT_EQUAL(counter, 60);
 }
 
+void event_coalesce_test() {
+    counter = 0;
+    EventQueue queue(2048);
+
+    Event<void(int)> e(&queue, count1);
+    e.coalesce(true);
+
+    int id = e.post(1);
+    TEST_ASSERT(id);
+    TEST_ASSERT_EQUAL(e.post(1), id);
+    TEST_ASSERT_EQUAL(e.post(1), id);
+    TEST_ASSERT(queue.time_left(id) >= 0);
+
+    queue.dispatch(0);
+    TEST_ASSERT_EQUAL(counter, 1);
+    TEST_ASSERT(queue.time_left(id) < 0);
+
+    id = e.post(1);
+    queue.dispatch(0);
+    TEST_ASSERT_EQUAL(counter, 2);
+
+    // an unrelated event that is given the id of the dispatched post must
+    // not make the next post look pending
+    bool reused = false;
+    for (int i = 0; i < 1000 && !reused; i++) {
+        reused = queue.call(count0) == id;
+        if (!reused) {
+            queue.dispatch(0);
+        }
+    }
+    TEST_ASSERT(reused);
+    TEST_ASSERT_NOT_EQUAL(e.post(1), id);
+    queue.dispatch(0);
+    TEST_ASSERT_EQUAL(counter, 3);
+
+    // a cancelled post is no longer pending
+    e.post(1);
+    e.cancel();
+    e.post(1);
+    queue.dispatch(0);
+    TEST_ASSERT_EQUAL(counter, 4);
+}
+
 
 // Test setup
 utest::v1::status_t test_setup(const size_t number_of_cases) {
@@ -255,6 +298,7 @@ const Case cases[] = {
     Case("Testing the event class", event_class_test),
     Case("Testing the event class helpers", event_class_helper_test),
     Case("Testing the event inference", event_inference_test),
+    Case("Testing event coalescing", event_coalesce_test),
 };
 
 Specification specification(test_setup, cases);
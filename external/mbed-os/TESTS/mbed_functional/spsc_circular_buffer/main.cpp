@@ -0,0 +1,122 @@
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity.h"
+#include "utest.h"
+#include "platform/SPSCCircularBuffer.h"
+
+using namespace utest::v1;
+
+
+// single context behaviour, for power of two and other sizes
+template <uint32_t N>
+void test_push_pop() {
+    SPSCCircularBuffer<uint32_t, N> buf;
+    uint32_t value;
+
+    TEST_ASSERT_TRUE(buf.empty());
+    TEST_ASSERT_FALSE(buf.pop(value));
+    for (uint32_t i = 0; i < N; i++) {
+        TEST_ASSERT_TRUE(buf.push(i));
+    }
+    TEST_ASSERT_TRUE(buf.full());
+    TEST_ASSERT_FALSE(buf.push(N));
+    TEST_ASSERT_EQUAL_UINT32(N, buf.size());
+    for (uint32_t i = 0; i < N; i++) {
+        TEST_ASSERT_TRUE(buf.pop(value));
+        TEST_ASSERT_EQUAL_UINT32(i, value);
+    }
+    TEST_ASSERT_TRUE(buf.empty());
+}
+
+template <uint32_t N>
+void test_bulk() {
+    SPSCCircularBuffer<uint32_t, N> buf;
+    uint32_t in[N + 3];
+    uint32_t out[N + 3];
+    uint32_t next_in = 0, next_out = 0;
+
+    // odd sized transfers, so that they wrap around the end of the buffer
+    for (uint32_t round = 0; round < 4 * N; round++) {
+        uint32_t n = round % (N + 3);
+        for (uint32_t i = 0; i < n; i++) {
+            in[i] = next_in + i;
+        }
+        uint32_t pushed = buf.push(in, n);
+        TEST_ASSERT_TRUE(pushed <= n);
+        next_in += pushed;
+        TEST_ASSERT_EQUAL_UINT32(next_in - next_out, buf.size());
+
+        uint32_t popped = buf.pop(out, (round * 7) % (N + 3));
+        for (uint32_t i = 0; i < popped; i++) {
+            TEST_ASSERT_EQUAL_UINT32(next_out + i, out[i]);
+        }
+        next_out += popped;
+    }
+    TEST_ASSERT_EQUAL_UINT32(next_out + buf.pop(out, N), next_in);
+    TEST_ASSERT_TRUE(buf.empty());
+}
+
+// samples pushed from a ticker interrupt at 20 kHz and read by the main thread
+static SPSCCircularBuffer<uint32_t, 64> samples;
+static volatile uint32_t next_sample;
+static volatile uint32_t overruns;
+
+static void sample_isr() {
+    if (samples.push(next_sample)) {
+        next_sample = next_sample + 1;
+    } else {
+        overruns = overruns + 1;
+    }
+}
+
+void test_isr_to_thread() {
+    Ticker ticker;
+    Timer timer;
+    uint32_t out[16];
+    uint32_t expected = 0;
+
+    samples.reset();
+    next_sample = 0;
+    overruns = 0;
+    ticker.attach_us(&sample_isr, 50);
+    timer.start();
+    while (true) {
+        bool done = timer.read_ms() >= 1000;
+        if (done) {
+            ticker.detach();
+        }
+        uint32_t n = samples.pop(out, 16);
+        for (uint32_t i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_UINT32(expected, out[i]);
+            expected++;
+        }
+        if (done && samples.empty()) {
+            break;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(next_sample, expected);
+    TEST_ASSERT_TRUE(expected > 10000);
+    printf("%lu samples received, %lu overruns\r\n", (unsigned long)expected, (unsigned long)overruns);
+}
+
+
+// Test setup
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("Testing push and pop with 8 elements", test_push_pop<8>),
+    Case("Testing push and pop with 5 elements", test_push_pop<5>),
+    Case("Testing bulk push and pop with 8 elements", test_bulk<8>),
+    Case("Testing bulk push and pop with 5 elements", test_bulk<5>),
+    Case("Testing samples from an interrupt", test_isr_to_thread),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
@@ -0,0 +1,290 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utest/utest.h"
+#include "unity/unity.h"
+#include "greentea-client/test_env.h"
+
+#include "mbed.h"
+#include "ticker_api.h"
+#include "us_ticker_api.h"
+
+using namespace utest::v1;
+
+/* The event queue is driven by a fake ticker whose time only moves when
+ * the test advances it. */
+
+#define MAX_EVENTS 256
+
+static us_timestamp_t fake_time;
+static timestamp_t fake_interrupt;
+static bool fake_interrupt_set;
+
+static void fake_init(void) {}
+static uint32_t fake_read(void) { return (uint32_t)fake_time; }
+static void fake_disable_interrupt(void) { fake_interrupt_set = false; }
+static void fake_clear_interrupt(void) {}
+static void fake_set_interrupt(timestamp_t timestamp)
+{
+    fake_interrupt = timestamp;
+    fake_interrupt_set = true;
+}
+
+static const ticker_interface_t fake_interface = {
+    fake_init,
+    fake_read,
+    fake_disable_interrupt,
+    fake_clear_interrupt,
+    fake_set_interrupt,
+};
+
+static ticker_event_queue_t fake_queue;
+static const ticker_data_t fake_data = { &fake_interface, &fake_queue };
+
+static ticker_event_t events[MAX_EVENTS];
+static bool removed[MAX_EVENTS];
+static uint32_t fired[MAX_EVENTS];
+static us_timestamp_t fired_time[MAX_EVENTS];
+static uint32_t fired_count;
+static uint32_t rand_state = 1;
+
+static uint32_t next_rand(void)
+{
+    rand_state = rand_state * 1103515245 + 12345;
+    return rand_state >> 8;
+}
+
+static void fake_handler(uint32_t id)
+{
+    fired[fired_count] = id;
+    fired_time[fired_count] = fake_time;
+    fired_count++;
+}
+
+static void fake_reset(us_timestamp_t start)
+{
+    memset(&fake_queue, 0, sizeof(fake_queue));
+    memset(events, 0, sizeof(events));
+    memset(removed, 0, sizeof(removed));
+    fired_count = 0;
+    fake_time = start;
+    fake_interrupt_set = false;
+    ticker_set_handler(&fake_data, fake_handler);
+}
+
+/* Move the fake time forward, taking each interrupt on the way */
+static void fake_advance_to(us_timestamp_t target)
+{
+    while (fake_interrupt_set) {
+        uint32_t delta = fake_interrupt - (uint32_t)fake_time;
+        if ((int32_t)delta < 0) {
+            delta = 0;
+        }
+        if (fake_time + delta > target) {
+            break;
+        }
+        fake_time += delta;
+        fake_interrupt_set = false;
+        ticker_irq_handler(&fake_data);
+    }
+    fake_time = target;
+}
+
+static void test_order(uint32_t count, us_timestamp_t start)
+{
+    fake_reset(start);
+    for (uint32_t i = 0; i < count; i++) {
+        ticker_insert_event(&fake_data, &events[i], (timestamp_t)start + next_rand() % 1000000, i);
+    }
+    fake_advance_to(start + 2000000);
+
+    TEST_ASSERT_EQUAL_UINT32(count, fired_count);
+    for (uint32_t i = 0; i < fired_count; i++) {
+        TEST_ASSERT_TRUE(fired_time[i] >= events[fired[i]].timestamp);
+        if (i > 0) {
+            TEST_ASSERT_TRUE(events[fired[i - 1]].timestamp <= events[fired[i]].timestamp);
+        }
+    }
+}
+
+void ticker_order_test(void)
+{
+    test_order(1, 0);
+    test_order(7, 1000);
+    test_order(MAX_EVENTS, 12345);
+}
+
+/* Events with the same timestamp fire in the order they were inserted, also
+ * when the insertion sequence number wraps */
+void ticker_equal_timestamp_test(void)
+{
+    fake_reset(1000);
+    fake_queue.sequence = 0xFFFFFFFFUL - MAX_EVENTS / 2;
+    for (uint32_t i = 0; i < MAX_EVENTS; i++) {
+        ticker_insert_event(&fake_data, &events[i], 2000 + (next_rand() % 4) * 1000, i);
+    }
+    fake_advance_to(10000);
+
+    TEST_ASSERT_EQUAL_UINT32(MAX_EVENTS, fired_count);
+    for (uint32_t i = 1; i < fired_count; i++) {
+        ticker_event_t *prev = &events[fired[i - 1]];
+        ticker_event_t *next = &events[fired[i]];
+        TEST_ASSERT_TRUE(prev->timestamp < next->timestamp ||
+                         (prev->timestamp == next->timestamp && fired[i - 1] < fired[i]));
+    }
+}
+
+/* Events inserted either side of the 32-bit counter wrapping fire in order */
+void ticker_wrap_test(void)
+{
+    test_order(MAX_EVENTS, 0xFFFFFFFFULL - 500000);
+
+    /* the 64-bit time carries on counting across several wraps */
+    fake_reset(0xFFFF0000UL);
+    us_timestamp_t start = ticker_read_us(&fake_data);
+    fake_advance_to(fake_time + 5 * 0x100000000ULL);
+    TEST_ASSERT_TRUE(ticker_read_us(&fake_data) == start + 5 * 0x100000000ULL);
+}
+
+/* An event more than 2^32 us ahead fires on time */
+void ticker_far_event_test(void)
+{
+    fake_reset(100);
+    us_timestamp_t when = ticker_read_us(&fake_data) + 3 * 0x100000000ULL + 77;
+    ticker_insert_event_us(&fake_data, &events[0], when, 0);
+    fake_advance_to(when - 1);
+    TEST_ASSERT_EQUAL_UINT32(0, fired_count);
+    fake_advance_to(when + 1000);
+    TEST_ASSERT_EQUAL_UINT32(1, fired_count);
+    TEST_ASSERT_TRUE(fired_time[0] == when);
+}
+
+void ticker_remove_test(void)
+{
+    uint32_t i, expected = 0;
+
+    fake_reset(5000);
+    for (i = 0; i < MAX_EVENTS; i++) {
+        ticker_insert_event(&fake_data, &events[i], 5000 + next_rand() % 1000000, i);
+    }
+    /* an event which is not queued can be removed */
+    ticker_event_t not_queued = ticker_event_t();
+    ticker_remove_event(&fake_data, &not_queued);
+    for (i = 0; i < MAX_EVENTS; i++) {
+        if (next_rand() % 3 == 0) {
+            ticker_remove_event(&fake_data, &events[i]);
+            removed[i] = true;
+        } else {
+            expected++;
+        }
+    }
+    fake_advance_to(5000 + 2000000);
+
+    TEST_ASSERT_EQUAL_UINT32(expected, fired_count);
+    for (i = 0; i < fired_count; i++) {
+        TEST_ASSERT_FALSE(removed[fired[i]]);
+        if (i > 0) {
+            TEST_ASSERT_TRUE(events[fired[i - 1]].timestamp <= events[fired[i]].timestamp);
+        }
+    }
+}
+
+#if defined(TICKER_COUNT_HEAP_STEPS)
+/* counted by mbed_ticker_api.c in the host build of hal/test */
+extern "C" uint32_t ticker_heap_steps;
+#endif
+
+/* Worst case work with interrupts disabled to insert and remove an event,
+ * against the number of events queued: the time, and on the host the levels
+ * walked and swaps made in the heap */
+static void critical_section_worst(uint32_t count, uint32_t *us, uint32_t *steps)
+{
+    *us = 0;
+    *steps = 0;
+
+    fake_reset(0);
+    for (uint32_t i = 0; i < count; i++) {
+        ticker_insert_event(&fake_data, &events[i], 1000 + next_rand() % 1000000, i);
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        /* the event is removed from wherever it landed, or the first one
+         * queued is removed and inserted again */
+        ticker_event_t *obj = (i & 1) ? &events[i % count] : &events[count];
+#if defined(TICKER_COUNT_HEAP_STEPS)
+        ticker_heap_steps = 0;
+#endif
+        uint32_t start = us_ticker_read();
+        ticker_remove_event(&fake_data, obj);
+        ticker_insert_event(&fake_data, obj, 1000 + next_rand() % 1000000, obj - events);
+        uint32_t elapsed = us_ticker_read() - start;
+        if (elapsed > *us) {
+            *us = elapsed;
+        }
+#if defined(TICKER_COUNT_HEAP_STEPS)
+        if (ticker_heap_steps > *steps) {
+            *steps = ticker_heap_steps;
+        }
+#endif
+    }
+}
+
+void ticker_critical_section_test(void)
+{
+    static const uint32_t counts[] = { 1, 8, 64, MAX_EVENTS - 1 };
+
+    for (uint32_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        uint32_t us, steps;
+        critical_section_worst(counts[i], &us, &steps);
+        printf("insert+remove worst case with %lu events: %lu us, %lu heap steps\r\n",
+               (unsigned long)counts[i], (unsigned long)us, (unsigned long)steps);
+
+#if defined(TICKER_COUNT_HEAP_STEPS)
+        /* finding the last position and sifting take at most one step per
+         * level, for the removal and for the insertion, where a sorted list
+         * walks half of the events on average */
+        uint32_t levels = 0;
+        while ((counts[i] + 1) >> (levels + 1)) {
+            levels++;
+        }
+        TEST_ASSERT_TRUE(steps <= 4 * levels);
+#endif
+    }
+}
+
+utest::v1::status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("Events fire in timestamp order", ticker_order_test, greentea_failure_handler),
+    Case("Equal timestamps fire in insertion order", ticker_equal_timestamp_test, greentea_failure_handler),
+    Case("Events fire across the 32-bit wrap", ticker_wrap_test, greentea_failure_handler),
+    Case("Events more than 2^32 us ahead", ticker_far_event_test, greentea_failure_handler),
+    Case("Removed events do not fire", ticker_remove_test, greentea_failure_handler),
+    Case("Critical section grows logarithmically", ticker_critical_section_test, greentea_failure_handler),
+};
+
+utest::v1::status_t greentea_test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+int main() {
+    Harness::run(specification);
+}
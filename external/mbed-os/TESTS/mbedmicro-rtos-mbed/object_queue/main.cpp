@@ -0,0 +1,129 @@
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity.h"
+#include "utest.h"
+#include "rtos.h"
+
+#if defined(MBED_RTOS_SINGLE_THREAD)
+  #error [NOT_SUPPORTED] test not supported
+#endif
+
+#define QUEUE_SIZE 8
+
+using namespace utest::v1;
+
+typedef struct {
+    uint32_t counter;
+    uint32_t check;
+} message_t;
+
+
+void test_pool_alloc_free() {
+    MemoryPool<message_t, QUEUE_SIZE> pool;
+    message_t *blocks[QUEUE_SIZE];
+    message_t other;
+
+    for (int i = 0; i < QUEUE_SIZE; i++) {
+        blocks[i] = pool.calloc();
+        TEST_ASSERT_NOT_NULL(blocks[i]);
+        TEST_ASSERT_EQUAL_UINT32(0, blocks[i]->counter);
+        blocks[i]->counter = i;
+    }
+    TEST_ASSERT_NULL(pool.alloc());
+    for (int i = 0; i < QUEUE_SIZE; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i, blocks[i]->counter);
+    }
+
+    TEST_ASSERT_EQUAL(osErrorValue, pool.free(&other));
+    for (int i = 0; i < QUEUE_SIZE; i++) {
+        TEST_ASSERT_EQUAL(osOK, pool.free(blocks[i]));
+    }
+    for (int i = 0; i < QUEUE_SIZE; i++) {
+        TEST_ASSERT_NOT_NULL(pool.alloc());
+    }
+    TEST_ASSERT_NULL(pool.alloc());
+}
+
+void test_queue_put_get() {
+    ObjectQueue<message_t, QUEUE_SIZE> queue;
+    message_t message;
+
+    TEST_ASSERT_EQUAL(osOK, queue.get(message, 0));
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++) {
+        message.counter = i;
+        message.check = ~i;
+        TEST_ASSERT_EQUAL(osOK, queue.put(message));
+    }
+    TEST_ASSERT_EQUAL(osErrorResource, queue.put(message));
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(queue.try_get(message));
+        TEST_ASSERT_EQUAL_UINT32(i, message.counter);
+        TEST_ASSERT_EQUAL_UINT32(~i, message.check);
+    }
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_EQUAL(osEventTimeout, queue.get(message, 10));
+}
+
+// messages sent from a ticker interrupt to a thread blocked in get()
+static ObjectQueue<message_t, QUEUE_SIZE> isr_queue;
+static MemoryPool<message_t, QUEUE_SIZE> isr_pool;
+static volatile uint32_t isr_sent;
+static volatile uint32_t isr_failed;
+
+static void send_isr() {
+    // exercise the pool from the interrupt too
+    message_t *block = isr_pool.alloc();
+    if (block == NULL) {
+        isr_failed = isr_failed + 1;
+        return;
+    }
+    block->counter = isr_sent;
+    block->check = ~isr_sent;
+    if (isr_queue.put(*block) == osOK) {
+        isr_sent = isr_sent + 1;
+    }
+    isr_pool.free(block);
+}
+
+void test_isr_to_thread() {
+    Ticker ticker;
+    message_t message;
+    uint32_t expected = 0;
+
+    isr_sent = 0;
+    isr_failed = 0;
+    ticker.attach_us(&send_isr, 1000);
+    while (expected < 500) {
+        TEST_ASSERT_EQUAL(osEventMessage, isr_queue.get(message, 100));
+        TEST_ASSERT_EQUAL_UINT32(expected, message.counter);
+        TEST_ASSERT_EQUAL_UINT32(~expected, message.check);
+        expected++;
+    }
+    ticker.detach();
+
+    while (isr_queue.try_get(message)) {
+        TEST_ASSERT_EQUAL_UINT32(expected, message.counter);
+        expected++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(isr_sent, expected);
+    TEST_ASSERT_EQUAL_UINT32(0, isr_failed);
+}
+
+
+// Test setup
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("Testing memory pool alloc and free", test_pool_alloc_free),
+    Case("Testing object queue put and get", test_queue_put_get),
+    Case("Testing object queue from an interrupt", test_isr_to_thread),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
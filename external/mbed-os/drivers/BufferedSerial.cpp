@@ -0,0 +1,304 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "drivers/BufferedSerial.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_sleep.h"
+
+#include <errno.h>
+#include <string.h>
+
+#if DEVICE_SERIAL
+
+#define TXBUF_SIZE MBED_CONF_PLATFORM_BUFFERED_SERIAL_TXBUF_SIZE
+#define RXBUF_SIZE MBED_CONF_PLATFORM_BUFFERED_SERIAL_RXBUF_SIZE
+
+namespace mbed {
+
+static inline uint32_t min_u32(uint32_t a, uint32_t b) {
+    return a < b ? a : b;
+}
+
+BufferedSerial::BufferedSerial(PinName tx, PinName rx, const char *name, int baud) :
+        SerialBase(tx, rx, baud), FileLike(name),
+        _tx_head(0), _tx_tail(0), _tx_count(0),
+        _rx_head(0), _rx_tail(0), _rx_count(0),
+        _tx_sending(false), _blocking(true)
+#ifdef MBED_CONF_RTOS_PRESENT
+        , _waiters(0), _event_sem(0)
+#endif
+{
+    // No lock needed in the constructor
+    if (rx != NC) {
+        SerialBase::attach(callback(this, &BufferedSerial::rx_irq), RxIrq);
+    }
+}
+
+BufferedSerial::~BufferedSerial() {
+    SerialBase::attach(NULL, RxIrq);
+    SerialBase::attach(NULL, TxIrq);
+}
+
+ssize_t BufferedSerial::write(const void *buffer, size_t length) {
+    const char *ptr = (const char *)buffer;
+    size_t written = 0;
+
+    api_lock();
+    while (written < length) {
+        uint32_t space = TXBUF_SIZE - _tx_count;
+        if (space == 0) {
+            if (!_blocking) {
+                break;
+            }
+            wait_until(TxSpace);
+            continue;
+        }
+
+        // Copy as much as fits before the end of the buffer; only this
+        // thread moves _tx_head, so the copy needs no critical section
+        uint32_t n = min_u32(min_u32(space, length - written), TXBUF_SIZE - _tx_head);
+        memcpy(&_txbuf[_tx_head], ptr + written, n);
+        _tx_head = (_tx_head + n) % TXBUF_SIZE;
+        written += n;
+
+        core_util_critical_section_enter();
+        _tx_count += n;
+        start_tx();
+        core_util_critical_section_exit();
+    }
+    api_unlock();
+
+    if (written == 0 && length > 0) {
+        return -EAGAIN;
+    }
+    return written;
+}
+
+ssize_t BufferedSerial::read(void *buffer, size_t length) {
+    char *ptr = (char *)buffer;
+    size_t count = 0;
+
+    if (length == 0) {
+        return 0;
+    }
+
+    api_lock();
+    if (_rx_count == 0) {
+        if (!_blocking) {
+            api_unlock();
+            return -EAGAIN;
+        }
+        wait_until(RxData);
+    }
+
+    while (count < length && _rx_count > 0) {
+        uint32_t n = min_u32(min_u32(_rx_count, length - count), RXBUF_SIZE - _rx_tail);
+        memcpy(ptr + count, &_rxbuf[_rx_tail], n);
+        _rx_tail = (_rx_tail + n) % RXBUF_SIZE;
+        count += n;
+
+        core_util_critical_section_enter();
+        _rx_count -= n;
+        core_util_critical_section_exit();
+    }
+    api_unlock();
+
+    return count;
+}
+
+int BufferedSerial::close() {
+    return 0;
+}
+
+int BufferedSerial::sync() {
+    api_lock();
+    wait_until(TxEmpty);
+    api_unlock();
+
+    return 0;
+}
+
+int BufferedSerial::isatty() {
+    return 1;
+}
+
+off_t BufferedSerial::seek(off_t offset, int whence) {
+    return -ESPIPE;
+}
+
+off_t BufferedSerial::tell() {
+    return -ESPIPE;
+}
+
+void BufferedSerial::rewind() {
+}
+
+size_t BufferedSerial::size() {
+    return 0;
+}
+
+void BufferedSerial::set_blocking(bool blocking) {
+    api_lock();
+    _blocking = blocking;
+    api_unlock();
+}
+
+short BufferedSerial::poll(short events) const {
+    short revents = 0;
+
+    if ((events & PollIn) && _rx_count > 0) {
+        revents |= PollIn;
+    }
+    if ((events & PollOut) && _tx_count < TXBUF_SIZE) {
+        revents |= PollOut;
+    }
+    return revents;
+}
+
+void BufferedSerial::sigio(Callback<void()> func) {
+    core_util_critical_section_enter();
+    _sigio_cb = func;
+    core_util_critical_section_exit();
+}
+
+int BufferedSerial::readable() {
+    return _rx_count > 0;
+}
+
+int BufferedSerial::writeable() {
+    return _tx_count < TXBUF_SIZE;
+}
+
+void BufferedSerial::api_lock() {
+    _mutex.lock();
+}
+
+void BufferedSerial::api_unlock() {
+    _mutex.unlock();
+}
+
+bool BufferedSerial::ready(Condition cond) const {
+    switch (cond) {
+        case RxData:
+            return _rx_count > 0;
+        case TxSpace:
+            return _tx_count < TXBUF_SIZE;
+        case TxEmpty:
+        default:
+            return _tx_count == 0;
+    }
+}
+
+/* Called with the API lock held. Sleeps until the interrupts have made the
+   condition true; the lock is released meanwhile, so other threads can use
+   the port. */
+void BufferedSerial::wait_until(Condition cond) {
+#ifdef MBED_CONF_RTOS_PRESENT
+    while (true) {
+        // Checking and registering as a waiter in one critical section
+        // means that any later event releases the semaphore
+        core_util_critical_section_enter();
+        bool done = ready(cond);
+        if (!done) {
+            _waiters++;
+        }
+        core_util_critical_section_exit();
+        if (done) {
+            return;
+        }
+
+        api_unlock();
+        _event_sem.wait();
+        api_lock();
+    }
+#else
+    // An interrupt taken between the check and the sleep would not wake
+    // the core, so sleep with interrupts masked; a pending one still wakes it
+    core_util_critical_section_enter();
+    while (!ready(cond)) {
+        sleep();
+        core_util_critical_section_exit();
+        core_util_critical_section_enter();
+    }
+    core_util_critical_section_exit();
+#endif
+}
+
+/* Called from the interrupts when data has been received or sent */
+void BufferedSerial::wake() {
+#ifdef MBED_CONF_RTOS_PRESENT
+    while (_waiters > 0) {
+        _waiters--;
+        _event_sem.release();
+    }
+#endif
+    if (_sigio_cb) {
+        _sigio_cb();
+    }
+}
+
+void BufferedSerial::rx_irq() {
+    bool received = false;
+
+    // Drain the receiver; characters are dropped if the buffer is full
+    while (SerialBase::readable()) {
+        char c = _base_getc();
+        if (_rx_count < RXBUF_SIZE) {
+            _rxbuf[_rx_head] = c;
+            _rx_head = (_rx_head + 1) % RXBUF_SIZE;
+            _rx_count++;
+            received = true;
+        }
+    }
+
+    if (received) {
+        wake();
+    }
+}
+
+/* Called with interrupts disabled. Enables the transmit interrupt, which
+   then sends characters until the buffer is empty. */
+void BufferedSerial::start_tx() {
+    if (_tx_sending || _tx_count == 0) {
+        return;
+    }
+
+    _tx_sending = true;
+    SerialBase::attach(callback(this, &BufferedSerial::tx_irq), TxIrq);
+}
+
+void BufferedSerial::tx_irq() {
+    bool sent = false;
+
+    while (_tx_count > 0 && SerialBase::writeable()) {
+        _base_putc(_txbuf[_tx_tail]);
+        _tx_tail = (_tx_tail + 1) % TXBUF_SIZE;
+        _tx_count--;
+        sent = true;
+    }
+
+    if (_tx_count == 0) {
+        _tx_sending = false;
+        SerialBase::attach(NULL, TxIrq);
+    }
+
+    if (sent) {
+        wake();
+    }
+}
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,246 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_BUFFEREDSERIAL_H
+#define MBED_BUFFEREDSERIAL_H
+
+#include "platform/platform.h"
+
+#if DEVICE_SERIAL
+
+#include "drivers/FileLike.h"
+#include "drivers/SerialBase.h"
+#include "platform/PlatformMutex.h"
+#include "platform/Callback.h"
+#include "hal/serial_api.h"
+
+#ifdef MBED_CONF_RTOS_PRESENT
+#include "rtos/Semaphore.h"
+#endif
+
+#ifndef MBED_CONF_PLATFORM_BUFFERED_SERIAL_TXBUF_SIZE
+#define MBED_CONF_PLATFORM_BUFFERED_SERIAL_TXBUF_SIZE 256
+#endif
+
+#ifndef MBED_CONF_PLATFORM_BUFFERED_SERIAL_RXBUF_SIZE
+#define MBED_CONF_PLATFORM_BUFFERED_SERIAL_RXBUF_SIZE 256
+#endif
+
+namespace mbed {
+/** \addtogroup drivers */
+/** @{*/
+
+/** A serial port (UART) with transmit and receive buffers
+ *
+ * Writes are copied to the transmit buffer and sent from the transmit
+ * interrupt, so the caller does not wait for the characters to go out on the
+ * wire. DMA is not used: the asynchronous SerialBase::write() shares the UART
+ * interrupt with the receive interrupt on several targets. Received characters are stored in the receive buffer by the receive
+ * interrupt until they are read. Blocked calls sleep until an interrupt
+ * moves data, rather than polling.
+ *
+ * The port is a FileLike, so it can be opened with fopen("/name") when it
+ * has a name. In non-blocking mode read() and write() return at once with
+ * whatever count could be transferred, or -EAGAIN if none.
+ *
+ * @Note Synchronization level: Thread safe
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * BufferedSerial pc(USBTX, USBRX, "pc", 115200);
+ *
+ * int main() {
+ *     FILE *f = fopen("/pc", "w");
+ *     fprintf(f, "Hello World\n");
+ *     fflush(f);
+ * }
+ * @endcode
+ */
+class BufferedSerial : public SerialBase, public FileLike {
+
+public:
+    /** Events reported by poll()
+     */
+    enum PollEvent {
+        PollIn = 0x0001,    /**< There is data to read */
+        PollOut = 0x0004    /**< There is space to write */
+    };
+
+    /** Create a buffered serial port, connected to the specified transmit and receive pins
+     *
+     *  @param tx Transmit pin
+     *  @param rx Receive pin
+     *  @param name The name used to open the port with fopen (optional)
+     *  @param baud The baud rate of the serial port (optional, defaults to MBED_CONF_PLATFORM_DEFAULT_SERIAL_BAUD_RATE)
+     *
+     *  @note
+     *    Either tx or rx may be specified as NC if unused
+     */
+    BufferedSerial(PinName tx, PinName rx, const char *name = NULL, int baud = MBED_CONF_PLATFORM_DEFAULT_SERIAL_BAUD_RATE);
+
+    virtual ~BufferedSerial();
+
+    /** Write the contents of a buffer to the transmit buffer
+     *
+     *  In blocking mode this waits for space until all of the data has been
+     *  buffered. It does not wait for the data to be sent, see sync().
+     *
+     *  @param buffer   The buffer to write from
+     *  @param length   The number of bytes to write
+     *  @return         The number of bytes written, -EAGAIN if none could be in non-blocking mode
+     */
+    virtual ssize_t write(const void *buffer, size_t length);
+
+    /** Read received data into a buffer
+     *
+     *  In blocking mode this waits until at least one byte has been received.
+     *
+     *  @param buffer   The buffer to read in to
+     *  @param length   The maximum number of bytes to read
+     *  @return         The number of bytes read, -EAGAIN if none were available in non-blocking mode
+     */
+    virtual ssize_t read(void *buffer, size_t length);
+
+    /** Close the port
+     *
+     *  @return         0
+     */
+    virtual int close();
+
+    /** Wait until all of the buffered data has been sent
+     *
+     *  @return         0
+     */
+    virtual int sync();
+
+    /** A serial port is a terminal
+     *
+     *  @return         1
+     */
+    virtual int isatty();
+
+    /** Seeking is not supported
+     *
+     *  @return         -ESPIPE
+     */
+    virtual off_t seek(off_t offset, int whence = SEEK_SET);
+
+    /** Seeking is not supported
+     *
+     *  @return         -ESPIPE
+     */
+    virtual off_t tell();
+
+    /** Seeking is not supported
+     */
+    virtual void rewind();
+
+    /** A serial port has no size
+     *
+     *  @return         0
+     */
+    virtual size_t size();
+
+    /** Set blocking or non-blocking mode. The default is blocking.
+     *
+     *  @param blocking true for blocking mode, false for non-blocking mode
+     */
+    void set_blocking(bool blocking);
+
+    /** Check which of the requested events are ready without blocking
+     *
+     *  @param events   The logical OR of the PollEvent values of interest
+     *  @return         The logical OR of the requested events which are ready
+     */
+    short poll(short events) const;
+
+    /** Attach a function to call when data arrives or transmit buffer space is freed
+     *
+     *  The function is called in interrupt context. Use poll() to find out
+     *  which event happened.
+     *
+     *  @param func A function to call, or 0 to set as none
+     */
+    void sigio(Callback<void()> func);
+
+    /** Determine if there is received data to read
+     *
+     *  @returns
+     *    1 if there is data in the receive buffer,
+     *    0 otherwise
+     */
+    int readable();
+
+    /** Determine if there is space in the transmit buffer
+     *
+     *  @returns
+     *    1 if there is space to write,
+     *    0 otherwise
+     */
+    int writeable();
+
+private:
+    enum Condition {
+        RxData,
+        TxSpace,
+        TxEmpty
+    };
+
+    void api_lock();
+    void api_unlock();
+    bool ready(Condition cond) const;
+    void wait_until(Condition cond);
+    void start_tx();
+    void rx_irq();
+    void tx_irq();
+    void wake();
+
+    char _txbuf[MBED_CONF_PLATFORM_BUFFERED_SERIAL_TXBUF_SIZE];
+    char _rxbuf[MBED_CONF_PLATFORM_BUFFERED_SERIAL_RXBUF_SIZE];
+
+    /* The head index of each buffer is moved by its writer and the tail
+     * index by its reader. The counts are shared with the interrupts, so
+     * threads only change them inside critical sections. */
+    uint32_t _tx_head;
+    uint32_t _tx_tail;
+    volatile uint32_t _tx_count;
+    uint32_t _rx_head;
+    uint32_t _rx_tail;
+    volatile uint32_t _rx_count;
+
+    /* Set while the transmit interrupt is attached */
+    volatile bool _tx_sending;
+
+    bool _blocking;
+    Callback<void()> _sigio_cb;
+    PlatformMutex _mutex;
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    /* Threads blocked in wait_until(). The interrupts release the semaphore
+     * once for each of them, so a waiter can not miss an event. */
+    volatile uint32_t _waiters;
+    rtos::Semaphore _event_sem;
+#endif
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
+
+/** @}*/
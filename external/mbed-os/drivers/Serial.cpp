@@ -36,6 +36,11 @@ int Serial::_putc(int c) {
     return _base_putc(c);
 }
 
+ssize_t Serial::_write(const void* buffer, size_t length) {
+    // Mutex is already held
+    return _base_write(buffer, length);
+}
+
 void Serial::lock() {
     _mutex.lock();
 }
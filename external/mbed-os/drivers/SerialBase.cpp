@@ -99,6 +99,15 @@ int SerialBase::_base_putc(int c) {
     return c;
 }
 
+ssize_t SerialBase::_base_write(const void *buffer, size_t length) {
+    // Mutex is already held
+    const unsigned char *data = (const unsigned char *)buffer;
+    for (size_t i = 0; i < length; i++) {
+        serial_putc(&_serial, data[i]);
+    }
+    return length;
+}
+
 void SerialBase::send_break() {
     lock();
   // Wait for 1.5 frames before clearing the break condition
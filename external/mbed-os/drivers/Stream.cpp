@@ -65,16 +65,22 @@ int Stream::close() {
 }
 
 ssize_t Stream::write(const void* buffer, size_t length) {
+    lock();
+    ssize_t ret = _write(buffer, length);
+    unlock();
+    return ret;
+}
+
+ssize_t Stream::_write(const void* buffer, size_t length) {
     const char* ptr = (const char*)buffer;
     const char* end = ptr + length;
 
-    lock();
+    // Mutex is already held
     while (ptr != end) {
         if (_putc(*ptr++) == EOF) {
             break;
         }
     }
-    unlock();
 
     return ptr - (const char*)buffer;
 }
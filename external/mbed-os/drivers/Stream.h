@@ -64,6 +64,10 @@ protected:
     virtual int _putc(int c) = 0;
     virtual int _getc() = 0;
 
+    /* Write a buffer with the mutex held, by default one _putc at a time.
+     * Override to send the whole buffer at once. */
+    virtual ssize_t _write(const void* buffer, size_t length);
+
     std::FILE *_file;
 
     /* disallow copy constructor and assignment operators */
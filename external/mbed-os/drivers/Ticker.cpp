@@ -33,12 +33,12 @@ void Ticker::setup(timestamp_t t) {
     core_util_critical_section_enter();
     remove();
     _delay = t;
-    insert(_delay + ticker_read(_ticker_data));
+    insert_absolute(_delay + ticker_read_us(_ticker_data));
     core_util_critical_section_exit();
 }
 
 void Ticker::handler() {
-    insert(event.timestamp + _delay);
+    insert_absolute(event.timestamp + _delay);
     _function();
 }
 
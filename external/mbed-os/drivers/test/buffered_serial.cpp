@@ -0,0 +1,355 @@
+/*
+ * Host test of BufferedSerial against a simulated UART
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Time is simulated, and moves while the caller is blocked: in a semaphore
+ * wait with an RTOS, or in sleep() without one. Interrupts are taken when a
+ * critical section is left. Releasing the mutex can switch to another
+ * thread, which runs until the next interrupt. A blocked call that is not
+ * woken by an interrupt stalls the simulation, and fails.
+ */
+#include "drivers/BufferedSerial.h"
+#include "host_test.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace mbed;
+
+
+#define BAUD            115200
+#define CHAR_NS         (10 * 1000000000ULL / BAUD)
+
+// Simulated UART
+int sim_critical_depth;
+static uint64_t now;
+static bool in_irq;
+static bool other_threads;
+static Callback<void()> irqs[SerialBase::IrqCnt];
+
+static uint64_t tx_busy_until;
+static char wire[200000];
+static size_t wire_len;
+
+static const char *rx_data;
+static size_t rx_len;
+static size_t rx_pos;
+static uint64_t rx_start;
+
+static unsigned interrupts;
+static unsigned waits;
+
+static uint64_t rx_arrival(size_t i)
+{
+    return rx_start + (i + 1) * CHAR_NS;
+}
+
+SerialBase::SerialBase(PinName tx, PinName rx, int baud)
+{
+}
+
+SerialBase::~SerialBase()
+{
+}
+
+int SerialBase::readable()
+{
+    return rx_pos < rx_len && rx_arrival(rx_pos) <= now;
+}
+
+int SerialBase::writeable()
+{
+    return now >= tx_busy_until;
+}
+
+void SerialBase::attach(Callback<void()> func, IrqType type)
+{
+    irqs[type] = func;
+}
+
+int SerialBase::_base_getc()
+{
+    return rx_data[rx_pos++];
+}
+
+int SerialBase::_base_putc(int c)
+{
+    while (!writeable()) {
+        now = tx_busy_until;
+    }
+    tx_busy_until = now + CHAR_NS;
+    wire[wire_len++] = c;
+    return c;
+}
+
+static void receive(const char *data, size_t len)
+{
+    rx_data = data;
+    rx_len = len;
+    rx_pos = 0;
+    rx_start = now;
+}
+
+static void take_interrupts()
+{
+    if (sim_critical_depth > 0 || in_irq) {
+        return;
+    }
+
+    in_irq = true;
+    while (true) {
+        if (irqs[SerialBase::RxIrq] && rx_pos < rx_len && rx_arrival(rx_pos) <= now) {
+            irqs[SerialBase::RxIrq]();
+        } else if (irqs[SerialBase::TxIrq] && now >= tx_busy_until) {
+            irqs[SerialBase::TxIrq]();
+        } else {
+            break;
+        }
+        interrupts++;
+    }
+    in_irq = false;
+}
+
+static uint64_t next_event()
+{
+    uint64_t next = ~0ULL;
+    if (irqs[SerialBase::TxIrq] && tx_busy_until > now) {
+        next = tx_busy_until;
+    }
+    if (rx_pos < rx_len && rx_arrival(rx_pos) < next) {
+        next = rx_arrival(rx_pos);
+    }
+    return next;
+}
+
+static void run_for(uint64_t ns)
+{
+    uint64_t end = now + ns;
+    take_interrupts();
+    while (next_event() <= end) {
+        now = next_event();
+        take_interrupts();
+    }
+    now = end;
+}
+
+
+// Test
+// Blocks until the next interrupt is due, or fails if there is none
+static void wait_for_interrupt()
+{
+    waits++;
+    uint64_t next = next_event();
+    if (next == ~0ULL) {
+        check(!"blocked without a pending interrupt");
+        exit(host_test_done());
+    }
+    now = next;
+}
+
+void sim_preempt()
+{
+    take_interrupts();
+}
+
+void sim_thread_switch()
+{
+    if (other_threads && next_event() != ~0ULL) {
+        now = next_event();
+    }
+    take_interrupts();
+}
+
+void sleep()
+{
+    // Sleeping with interrupts enabled could miss the wakeup
+    check(sim_critical_depth > 0);
+    wait_for_interrupt();
+}
+
+#ifdef MBED_CONF_RTOS_PRESENT
+int32_t rtos::Semaphore::wait()
+{
+    while (_count == 0) {
+        wait_for_interrupt();
+        take_interrupts();
+    }
+    return _count--;
+}
+#endif
+
+
+// A Serial write, polling for each character
+class PolledSerial : public SerialBase {
+public:
+    PolledSerial() : SerialBase(NC, NC, BAUD) {
+    }
+
+    void write(const char *buffer, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            while (!writeable()) {
+                now = tx_busy_until;
+            }
+            _base_putc(buffer[i]);
+        }
+    }
+};
+
+static void test_line_latency()
+{
+    char line[100];
+    memset(line, 'x', sizeof(line));
+
+    PolledSerial polled;
+    uint64_t polled_ns = 0;
+    for (int i = 0; i < 100; i++) {
+        uint64_t start = now;
+        polled.write(line, sizeof(line));
+        polled_ns += now - start;
+        run_for(20000000);
+    }
+
+    BufferedSerial serial(NC, NC, NULL, BAUD);
+    uint64_t blocked_ns = 0;
+    for (int i = 0; i < 100; i++) {
+        uint64_t start = now;
+        check(serial.write(line, sizeof(line)) == sizeof(line));
+        blocked_ns += now - start;
+        run_for(20000000);
+    }
+    check(serial.sync() == 0);
+
+    printf("caller blocked per 100-byte line: %llu us polled, %llu us buffered\n",
+            (unsigned long long)polled_ns / 100000, (unsigned long long)blocked_ns / 100000);
+    // The polled write returns once the last character is in the transmitter
+    check(polled_ns == 100*(sizeof(line) - 1)*CHAR_NS);
+    check(blocked_ns == 0);
+}
+
+static void test_bulk_write()
+{
+    static char data[100000];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = 'a' + i % 26;
+    }
+
+    BufferedSerial serial(NC, NC, NULL, BAUD);
+    wire_len = 0;
+    waits = 0;
+    interrupts = 0;
+    uint64_t start = now;
+    for (size_t i = 0; i < sizeof(data); i += 100) {
+        check(serial.write(&data[i], 100) == 100);
+    }
+    check(serial.sync() == 0);
+    run_for(CHAR_NS);
+
+    double rate = wire_len / ((now - start) / 1e9);
+    printf("bulk write: %.0f B/s (wire limit %d B/s), %u waits, %u interrupts\n",
+            rate, BAUD / 10, waits, interrupts);
+    check(wire_len == sizeof(data));
+    check(memcmp(wire, data, sizeof(data)) == 0);
+    check(rate > 0.99 * BAUD / 10);
+    // A blocked writer only wakes on interrupts
+    check(waits <= interrupts);
+}
+
+static void test_non_blocking()
+{
+    static char data[1000];
+    memset(data, 'y', sizeof(data));
+    char buffer[8];
+
+    BufferedSerial serial(NC, NC, NULL, BAUD);
+    serial.set_blocking(false);
+    // The buffer, and the character the transmitter took on the way
+    check(serial.write(data, sizeof(data)) == MBED_CONF_PLATFORM_BUFFERED_SERIAL_TXBUF_SIZE + 1);
+    check(serial.write(data, sizeof(data)) == -EAGAIN);
+    check(serial.poll(BufferedSerial::PollOut) == 0);
+    check(serial.read(buffer, sizeof(buffer)) == -EAGAIN);
+    check(serial.poll(BufferedSerial::PollIn) == 0);
+
+    // Space frees up as characters go out
+    run_for(10*CHAR_NS);
+    check(serial.poll(BufferedSerial::PollOut) == BufferedSerial::PollOut);
+    check(serial.write(data, sizeof(data)) > 0);
+
+    serial.set_blocking(true);
+    check(serial.sync() == 0);
+}
+
+// The transmitter finishes while sync() has released the lock
+static void test_sync_thread_switch()
+{
+    char line[100];
+    memset(line, 'z', sizeof(line));
+
+    BufferedSerial serial(NC, NC, NULL, BAUD);
+    other_threads = true;
+    for (int i = 0; i < 10; i++) {
+        check(serial.write(line, sizeof(line)) == sizeof(line));
+        check(serial.sync() == 0);
+        check(serial.poll(BufferedSerial::PollOut) == BufferedSerial::PollOut);
+    }
+    other_threads = false;
+}
+
+static int sigios;
+
+static void count_sigio()
+{
+    sigios++;
+}
+
+static void test_blocking_read()
+{
+    static const char data[] = "hello world";
+    char buffer[16];
+
+    BufferedSerial serial(NC, 1, NULL, BAUD);
+    serial.sigio(count_sigio);
+    sigios = 0;
+    receive(data, strlen(data));
+
+    // Returns with the first character
+    check(serial.read(buffer, sizeof(buffer)) == 1);
+    check(buffer[0] == 'h');
+    check(now == rx_arrival(0));
+    check(sigios == 1);
+
+    run_for(strlen(data) * CHAR_NS);
+    check(serial.poll(BufferedSerial::PollIn) == BufferedSerial::PollIn);
+    check(serial.read(buffer, sizeof(buffer)) == (ssize_t)strlen(data) - 1);
+    check(memcmp(buffer, data + 1, strlen(data) - 1) == 0);
+    check(sigios == (int)strlen(data));
+}
+
+int main()
+{
+#ifdef MBED_CONF_RTOS_PRESENT
+    printf("waiting on a semaphore\n");
+#else
+    printf("waiting in sleep()\n");
+#endif
+
+    test_line_latency();
+    test_bulk_write();
+    test_non_blocking();
+    test_sync_thread_switch();
+    test_blocking_read();
+    check(sim_critical_depth == 0);
+
+    return host_test_done();
+}
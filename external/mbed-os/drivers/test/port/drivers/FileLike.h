@@ -0,0 +1,30 @@
+/* Host stand-in for FileLike, the interface without the file system */
+#ifndef MBED_FILELIKE_H
+#define MBED_FILELIKE_H
+
+#include "platform/platform.h"
+
+namespace mbed {
+
+class FileLike {
+public:
+    FileLike(const char *name = NULL) {
+    }
+
+    virtual ~FileLike() {
+    }
+
+    virtual ssize_t read(void *buffer, size_t length) = 0;
+    virtual ssize_t write(const void *buffer, size_t length) = 0;
+    virtual int close() = 0;
+    virtual int sync() = 0;
+    virtual int isatty() = 0;
+    virtual off_t seek(off_t offset, int whence = SEEK_SET) = 0;
+    virtual off_t tell() = 0;
+    virtual void rewind() = 0;
+    virtual size_t size() = 0;
+};
+
+} // namespace mbed
+
+#endif
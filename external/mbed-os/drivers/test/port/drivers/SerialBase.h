@@ -0,0 +1,36 @@
+/* Host stand-in for SerialBase, a simulated UART. A character takes ten bit
+ * times on the wire. The transmit interrupt is raised while it is attached
+ * and the transmitter is free, the receive interrupt while a received
+ * character is waiting. */
+#ifndef MBED_SERIALBASE_H
+#define MBED_SERIALBASE_H
+
+#include "platform/platform.h"
+#include "platform/Callback.h"
+
+namespace mbed {
+
+class SerialBase {
+public:
+    enum IrqType {
+        RxIrq = 0,
+        TxIrq,
+
+        IrqCnt
+    };
+
+    SerialBase(PinName tx, PinName rx, int baud);
+    virtual ~SerialBase();
+
+    int readable();
+    int writeable();
+    void attach(Callback<void()> func, IrqType type = RxIrq);
+
+protected:
+    int _base_getc();
+    int _base_putc(int c);
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,5 @@
+/* Host stand-in for serial_api.h, the simulated UART is in SerialBase.h */
+#ifndef MBED_SERIAL_API_H
+#define MBED_SERIAL_API_H
+
+#endif
@@ -0,0 +1,18 @@
+/* Host stand-in for PlatformMutex. Unlocking may switch to another thread,
+ * which lets the simulation run. */
+#ifndef PLATFORM_MUTEX_H
+#define PLATFORM_MUTEX_H
+
+void sim_thread_switch(void);
+
+class PlatformMutex {
+public:
+    void lock() {
+    }
+
+    void unlock() {
+        sim_thread_switch();
+    }
+};
+
+#endif
@@ -0,0 +1,21 @@
+/* Host stand-in for the critical section API. Interrupts raised while in a
+ * critical section are taken when it is left. */
+#ifndef __MBED_UTIL_CRITICAL_H__
+#define __MBED_UTIL_CRITICAL_H__
+
+extern int sim_critical_depth;
+void sim_preempt(void);
+
+static inline void core_util_critical_section_enter(void)
+{
+    sim_critical_depth++;
+}
+
+static inline void core_util_critical_section_exit(void)
+{
+    if (--sim_critical_depth == 0) {
+        sim_preempt();
+    }
+}
+
+#endif
@@ -0,0 +1,8 @@
+/* Host stand-in for mbed_sleep.h, sleep() runs the simulation until the
+ * next interrupt */
+#ifndef MBED_SLEEP_H
+#define MBED_SLEEP_H
+
+void sleep(void);
+
+#endif
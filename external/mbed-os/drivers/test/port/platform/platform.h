@@ -0,0 +1,17 @@
+/* Host stand-in for platform.h, for a target with a serial port */
+#ifndef MBED_PLATFORM_H
+#define MBED_PLATFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#define DEVICE_SERIAL 1
+
+typedef int PinName;
+#define NC (-1)
+
+#define MBED_CONF_PLATFORM_DEFAULT_SERIAL_BAUD_RATE 115200
+
+#endif
@@ -0,0 +1,27 @@
+/* Host stand-in for rtos::Semaphore. wait() runs the simulation until the
+ * semaphore is released. */
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include <stdint.h>
+
+namespace rtos {
+
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0) : _count(count) {
+    }
+
+    int32_t wait();
+
+    void release() {
+        _count++;
+    }
+
+private:
+    int32_t _count;
+};
+
+} // namespace rtos
+
+#endif
@@ -60,6 +60,9 @@ public:
             _event->id = 0;
             _event->delay = 0;
             _event->period = -1;
+            _event->coalesce = false;
+            _event->pending = 0;
+            _event->users = 1;
 
             _event->post = &Event::event_post<F>;
             _event->dtor = &Event::event_dtor<F>;
@@ -97,8 +100,7 @@ public:
         if (_event) {
             _event->ref -= 1;
             if (_event->ref == 0) {
-                _event->dtor(_event);
-                equeue_dealloc(_event->equeue, _event);
+                event_release(_event);
             }
         }
     }
@@ -123,6 +125,22 @@ public:
         }
     }
 
+    /** Configure whether repeated posts of an event are coalesced
+     *
+     *  When enabled, posting the event while a previous post is still
+     *  waiting to be dispatched does not queue another copy. The pending
+     *  event executes once and its id is returned. Any arguments passed to
+     *  a coalesced post are discarded. A periodic event stays pending until
+     *  it is cancelled, so posting it again does not queue a second copy.
+     *
+     *  @param coalesce True to coalesce repeated posts of the event
+     */
+    void coalesce(bool coalesce) {
+        if (_event) {
+            _event->coalesce = coalesce;
+        }
+    }
+
     /** Posts an event onto the underlying event queue
      *
      *  The event is posted to the underlying queue and is executed in the
@@ -141,6 +159,14 @@ public:
             return 0;
         }
 
+        if (_event->coalesce) {
+            // a pending post holds its id, which this post folds into
+            unsigned pending = *(volatile unsigned *)&_event->pending;
+            if (pending) {
+                return pending;
+            }
+        }
+
         _event->id = _event->post(_event);
         return _event->id;
     }
@@ -196,6 +222,9 @@ private:
 
         int delay;
         int period;
+        bool coalesce;
+        unsigned pending;
+        unsigned users;
 
         int (*post)(struct event *);
         void (*dtor)(struct event *);
@@ -207,6 +236,10 @@ private:
     template <typename F>
     static int event_post(struct event *e) {
         typedef EventQueue::context00<F> C;
+        if (e->coalesce) {
+            return event_post_coalesced(e, C(*(F*)(e + 1)));
+        }
+
         void *p = equeue_alloc(e->equeue, sizeof(C));
         if (!p) {
             return 0;
@@ -224,6 +257,83 @@ private:
         ((F*)(e + 1))->~F();
     }
 
+    // Coalesced posts
+    //
+    // A coalescing event has at most one post waiting to be dispatched, whose
+    // id is kept in pending. The posted context clears pending once it starts
+    // executing, or for a periodic event once it is cancelled, and holds a use
+    // of the event so the event outlives it.
+    template <typename C>
+    struct coalesced {
+        C c;
+        struct event *e;
+        unsigned id;
+        bool periodic;
+
+        coalesced(const C &c, struct event *e, unsigned id, bool periodic)
+            : c(c), e(e), id(id), periodic(periodic) {}
+
+        ~coalesced() {
+            equeue_atomic_cas(&e->pending, id, 0);
+            event_release(e);
+        }
+
+        void operator()() {
+            if (!periodic) {
+                equeue_atomic_cas(&e->pending, id, 0);
+            }
+            c();
+        }
+    };
+
+    template <typename C>
+    static int event_post_coalesced(struct event *e, const C &c) {
+        typedef coalesced<C> W;
+        void *p = equeue_alloc(e->equeue, sizeof(W));
+        if (!p) {
+            return 0;
+        }
+
+        // the id equeue_post will return, fixed when the context is allocated
+        struct equeue_event *qe = (struct equeue_event *)p - 1;
+        unsigned id = (qe->id << e->equeue->npw2) |
+                ((unsigned char *)qe - e->equeue->buffer);
+        while (!equeue_atomic_cas(&e->pending, 0, id)) {
+            // lost a race with another post, fold into it if still pending
+            unsigned pending = *(volatile unsigned *)&e->pending;
+            if (pending) {
+                equeue_dealloc(e->equeue, p);
+                return pending;
+            }
+        }
+
+        event_acquire(e);
+        new (p) W(c, e, id, e->period >= 0);
+        equeue_event_delay(p, e->delay);
+        equeue_event_period(p, e->period);
+        equeue_event_dtor(p, &EventQueue::function_dtor<W>);
+        return equeue_post(e->equeue, &EventQueue::function_call<W>, p);
+    }
+
+    static void event_acquire(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users + 1));
+    }
+
+    static void event_release(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users - 1));
+
+        if (users == 1) {
+            e->dtor(e);
+            equeue_dealloc(e->equeue, e);
+        }
+    }
+
 public:
     /** Create an event
      *  @see Event::Event
@@ -456,6 +566,9 @@ public:
             _event->id = 0;
             _event->delay = 0;
             _event->period = -1;
+            _event->coalesce = false;
+            _event->pending = 0;
+            _event->users = 1;
 
             _event->post = &Event::event_post<F>;
             _event->dtor = &Event::event_dtor<F>;
@@ -493,8 +606,7 @@ public:
         if (_event) {
             _event->ref -= 1;
             if (_event->ref == 0) {
-                _event->dtor(_event);
-                equeue_dealloc(_event->equeue, _event);
+                event_release(_event);
             }
         }
     }
@@ -519,6 +631,22 @@ public:
         }
     }
 
+    /** Configure whether repeated posts of an event are coalesced
+     *
+     *  When enabled, posting the event while a previous post is still
+     *  waiting to be dispatched does not queue another copy. The pending
+     *  event executes once and its id is returned. Any arguments passed to
+     *  a coalesced post are discarded. A periodic event stays pending until
+     *  it is cancelled, so posting it again does not queue a second copy.
+     *
+     *  @param coalesce True to coalesce repeated posts of the event
+     */
+    void coalesce(bool coalesce) {
+        if (_event) {
+            _event->coalesce = coalesce;
+        }
+    }
+
     /** Posts an event onto the underlying event queue
      *
      *  The event is posted to the underlying queue and is executed in the
@@ -537,6 +665,14 @@ public:
             return 0;
         }
 
+        if (_event->coalesce) {
+            // a pending post holds its id, which this post folds into
+            unsigned pending = *(volatile unsigned *)&_event->pending;
+            if (pending) {
+                return pending;
+            }
+        }
+
         _event->id = _event->post(_event, a0);
         return _event->id;
     }
@@ -592,6 +728,9 @@ private:
 
         int delay;
         int period;
+        bool coalesce;
+        unsigned pending;
+        unsigned users;
 
         int (*post)(struct event *, A0 a0);
         void (*dtor)(struct event *);
@@ -603,6 +742,10 @@ private:
     template <typename F>
     static int event_post(struct event *e, A0 a0) {
         typedef EventQueue::context10<F, A0> C;
+        if (e->coalesce) {
+            return event_post_coalesced(e, C(*(F*)(e + 1), a0));
+        }
+
         void *p = equeue_alloc(e->equeue, sizeof(C));
         if (!p) {
             return 0;
@@ -620,6 +763,83 @@ private:
         ((F*)(e + 1))->~F();
     }
 
+    // Coalesced posts
+    //
+    // A coalescing event has at most one post waiting to be dispatched, whose
+    // id is kept in pending. The posted context clears pending once it starts
+    // executing, or for a periodic event once it is cancelled, and holds a use
+    // of the event so the event outlives it.
+    template <typename C>
+    struct coalesced {
+        C c;
+        struct event *e;
+        unsigned id;
+        bool periodic;
+
+        coalesced(const C &c, struct event *e, unsigned id, bool periodic)
+            : c(c), e(e), id(id), periodic(periodic) {}
+
+        ~coalesced() {
+            equeue_atomic_cas(&e->pending, id, 0);
+            event_release(e);
+        }
+
+        void operator()() {
+            if (!periodic) {
+                equeue_atomic_cas(&e->pending, id, 0);
+            }
+            c();
+        }
+    };
+
+    template <typename C>
+    static int event_post_coalesced(struct event *e, const C &c) {
+        typedef coalesced<C> W;
+        void *p = equeue_alloc(e->equeue, sizeof(W));
+        if (!p) {
+            return 0;
+        }
+
+        // the id equeue_post will return, fixed when the context is allocated
+        struct equeue_event *qe = (struct equeue_event *)p - 1;
+        unsigned id = (qe->id << e->equeue->npw2) |
+                ((unsigned char *)qe - e->equeue->buffer);
+        while (!equeue_atomic_cas(&e->pending, 0, id)) {
+            // lost a race with another post, fold into it if still pending
+            unsigned pending = *(volatile unsigned *)&e->pending;
+            if (pending) {
+                equeue_dealloc(e->equeue, p);
+                return pending;
+            }
+        }
+
+        event_acquire(e);
+        new (p) W(c, e, id, e->period >= 0);
+        equeue_event_delay(p, e->delay);
+        equeue_event_period(p, e->period);
+        equeue_event_dtor(p, &EventQueue::function_dtor<W>);
+        return equeue_post(e->equeue, &EventQueue::function_call<W>, p);
+    }
+
+    static void event_acquire(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users + 1));
+    }
+
+    static void event_release(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users - 1));
+
+        if (users == 1) {
+            e->dtor(e);
+            equeue_dealloc(e->equeue, e);
+        }
+    }
+
 public:
     /** Create an event
      *  @see Event::Event
@@ -852,6 +1072,9 @@ public:
             _event->id = 0;
             _event->delay = 0;
             _event->period = -1;
+            _event->coalesce = false;
+            _event->pending = 0;
+            _event->users = 1;
 
             _event->post = &Event::event_post<F>;
             _event->dtor = &Event::event_dtor<F>;
@@ -889,8 +1112,7 @@ public:
         if (_event) {
             _event->ref -= 1;
             if (_event->ref == 0) {
-                _event->dtor(_event);
-                equeue_dealloc(_event->equeue, _event);
+                event_release(_event);
             }
         }
     }
@@ -915,6 +1137,22 @@ public:
         }
     }
 
+    /** Configure whether repeated posts of an event are coalesced
+     *
+     *  When enabled, posting the event while a previous post is still
+     *  waiting to be dispatched does not queue another copy. The pending
+     *  event executes once and its id is returned. Any arguments passed to
+     *  a coalesced post are discarded. A periodic event stays pending until
+     *  it is cancelled, so posting it again does not queue a second copy.
+     *
+     *  @param coalesce True to coalesce repeated posts of the event
+     */
+    void coalesce(bool coalesce) {
+        if (_event) {
+            _event->coalesce = coalesce;
+        }
+    }
+
     /** Posts an event onto the underlying event queue
      *
      *  The event is posted to the underlying queue and is executed in the
@@ -933,6 +1171,14 @@ public:
             return 0;
         }
 
+        if (_event->coalesce) {
+            // a pending post holds its id, which this post folds into
+            unsigned pending = *(volatile unsigned *)&_event->pending;
+            if (pending) {
+                return pending;
+            }
+        }
+
         _event->id = _event->post(_event, a0, a1);
         return _event->id;
     }
@@ -988,6 +1234,9 @@ private:
 
         int delay;
         int period;
+        bool coalesce;
+        unsigned pending;
+        unsigned users;
 
         int (*post)(struct event *, A0 a0, A1 a1);
         void (*dtor)(struct event *);
@@ -999,6 +1248,10 @@ private:
     template <typename F>
     static int event_post(struct event *e, A0 a0, A1 a1) {
         typedef EventQueue::context20<F, A0, A1> C;
+        if (e->coalesce) {
+            return event_post_coalesced(e, C(*(F*)(e + 1), a0, a1));
+        }
+
         void *p = equeue_alloc(e->equeue, sizeof(C));
         if (!p) {
             return 0;
@@ -1016,6 +1269,83 @@ private:
         ((F*)(e + 1))->~F();
     }
 
+    // Coalesced posts
+    //
+    // A coalescing event has at most one post waiting to be dispatched, whose
+    // id is kept in pending. The posted context clears pending once it starts
+    // executing, or for a periodic event once it is cancelled, and holds a use
+    // of the event so the event outlives it.
+    template <typename C>
+    struct coalesced {
+        C c;
+        struct event *e;
+        unsigned id;
+        bool periodic;
+
+        coalesced(const C &c, struct event *e, unsigned id, bool periodic)
+            : c(c), e(e), id(id), periodic(periodic) {}
+
+        ~coalesced() {
+            equeue_atomic_cas(&e->pending, id, 0);
+            event_release(e);
+        }
+
+        void operator()() {
+            if (!periodic) {
+                equeue_atomic_cas(&e->pending, id, 0);
+            }
+            c();
+        }
+    };
+
+    template <typename C>
+    static int event_post_coalesced(struct event *e, const C &c) {
+        typedef coalesced<C> W;
+        void *p = equeue_alloc(e->equeue, sizeof(W));
+        if (!p) {
+            return 0;
+        }
+
+        // the id equeue_post will return, fixed when the context is allocated
+        struct equeue_event *qe = (struct equeue_event *)p - 1;
+        unsigned id = (qe->id << e->equeue->npw2) |
+                ((unsigned char *)qe - e->equeue->buffer);
+        while (!equeue_atomic_cas(&e->pending, 0, id)) {
+            // lost a race with another post, fold into it if still pending
+            unsigned pending = *(volatile unsigned *)&e->pending;
+            if (pending) {
+                equeue_dealloc(e->equeue, p);
+                return pending;
+            }
+        }
+
+        event_acquire(e);
+        new (p) W(c, e, id, e->period >= 0);
+        equeue_event_delay(p, e->delay);
+        equeue_event_period(p, e->period);
+        equeue_event_dtor(p, &EventQueue::function_dtor<W>);
+        return equeue_post(e->equeue, &EventQueue::function_call<W>, p);
+    }
+
+    static void event_acquire(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users + 1));
+    }
+
+    static void event_release(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users - 1));
+
+        if (users == 1) {
+            e->dtor(e);
+            equeue_dealloc(e->equeue, e);
+        }
+    }
+
 public:
     /** Create an event
      *  @see Event::Event
@@ -1248,6 +1578,9 @@ public:
             _event->id = 0;
             _event->delay = 0;
             _event->period = -1;
+            _event->coalesce = false;
+            _event->pending = 0;
+            _event->users = 1;
 
             _event->post = &Event::event_post<F>;
             _event->dtor = &Event::event_dtor<F>;
@@ -1285,8 +1618,7 @@ public:
         if (_event) {
             _event->ref -= 1;
             if (_event->ref == 0) {
-                _event->dtor(_event);
-                equeue_dealloc(_event->equeue, _event);
+                event_release(_event);
             }
         }
     }
@@ -1311,6 +1643,22 @@ public:
         }
     }
 
+    /** Configure whether repeated posts of an event are coalesced
+     *
+     *  When enabled, posting the event while a previous post is still
+     *  waiting to be dispatched does not queue another copy. The pending
+     *  event executes once and its id is returned. Any arguments passed to
+     *  a coalesced post are discarded. A periodic event stays pending until
+     *  it is cancelled, so posting it again does not queue a second copy.
+     *
+     *  @param coalesce True to coalesce repeated posts of the event
+     */
+    void coalesce(bool coalesce) {
+        if (_event) {
+            _event->coalesce = coalesce;
+        }
+    }
+
     /** Posts an event onto the underlying event queue
      *
      *  The event is posted to the underlying queue and is executed in the
@@ -1329,6 +1677,14 @@ public:
             return 0;
         }
 
+        if (_event->coalesce) {
+            // a pending post holds its id, which this post folds into
+            unsigned pending = *(volatile unsigned *)&_event->pending;
+            if (pending) {
+                return pending;
+            }
+        }
+
         _event->id = _event->post(_event, a0, a1, a2);
         return _event->id;
     }
@@ -1384,6 +1740,9 @@ private:
 
         int delay;
         int period;
+        bool coalesce;
+        unsigned pending;
+        unsigned users;
 
         int (*post)(struct event *, A0 a0, A1 a1, A2 a2);
         void (*dtor)(struct event *);
@@ -1395,6 +1754,10 @@ private:
     template <typename F>
     static int event_post(struct event *e, A0 a0, A1 a1, A2 a2) {
         typedef EventQueue::context30<F, A0, A1, A2> C;
+        if (e->coalesce) {
+            return event_post_coalesced(e, C(*(F*)(e + 1), a0, a1, a2));
+        }
+
         void *p = equeue_alloc(e->equeue, sizeof(C));
         if (!p) {
             return 0;
@@ -1412,6 +1775,83 @@ private:
         ((F*)(e + 1))->~F();
     }
 
+    // Coalesced posts
+    //
+    // A coalescing event has at most one post waiting to be dispatched, whose
+    // id is kept in pending. The posted context clears pending once it starts
+    // executing, or for a periodic event once it is cancelled, and holds a use
+    // of the event so the event outlives it.
+    template <typename C>
+    struct coalesced {
+        C c;
+        struct event *e;
+        unsigned id;
+        bool periodic;
+
+        coalesced(const C &c, struct event *e, unsigned id, bool periodic)
+            : c(c), e(e), id(id), periodic(periodic) {}
+
+        ~coalesced() {
+            equeue_atomic_cas(&e->pending, id, 0);
+            event_release(e);
+        }
+
+        void operator()() {
+            if (!periodic) {
+                equeue_atomic_cas(&e->pending, id, 0);
+            }
+            c();
+        }
+    };
+
+    template <typename C>
+    static int event_post_coalesced(struct event *e, const C &c) {
+        typedef coalesced<C> W;
+        void *p = equeue_alloc(e->equeue, sizeof(W));
+        if (!p) {
+            return 0;
+        }
+
+        // the id equeue_post will return, fixed when the context is allocated
+        struct equeue_event *qe = (struct equeue_event *)p - 1;
+        unsigned id = (qe->id << e->equeue->npw2) |
+                ((unsigned char *)qe - e->equeue->buffer);
+        while (!equeue_atomic_cas(&e->pending, 0, id)) {
+            // lost a race with another post, fold into it if still pending
+            unsigned pending = *(volatile unsigned *)&e->pending;
+            if (pending) {
+                equeue_dealloc(e->equeue, p);
+                return pending;
+            }
+        }
+
+        event_acquire(e);
+        new (p) W(c, e, id, e->period >= 0);
+        equeue_event_delay(p, e->delay);
+        equeue_event_period(p, e->period);
+        equeue_event_dtor(p, &EventQueue::function_dtor<W>);
+        return equeue_post(e->equeue, &EventQueue::function_call<W>, p);
+    }
+
+    static void event_acquire(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users + 1));
+    }
+
+    static void event_release(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users - 1));
+
+        if (users == 1) {
+            e->dtor(e);
+            equeue_dealloc(e->equeue, e);
+        }
+    }
+
 public:
     /** Create an event
      *  @see Event::Event
@@ -1644,6 +2084,9 @@ public:
             _event->id = 0;
             _event->delay = 0;
             _event->period = -1;
+            _event->coalesce = false;
+            _event->pending = 0;
+            _event->users = 1;
 
             _event->post = &Event::event_post<F>;
             _event->dtor = &Event::event_dtor<F>;
@@ -1681,8 +2124,7 @@ public:
         if (_event) {
             _event->ref -= 1;
             if (_event->ref == 0) {
-                _event->dtor(_event);
-                equeue_dealloc(_event->equeue, _event);
+                event_release(_event);
             }
         }
     }
@@ -1707,6 +2149,22 @@ public:
         }
     }
 
+    /** Configure whether repeated posts of an event are coalesced
+     *
+     *  When enabled, posting the event while a previous post is still
+     *  waiting to be dispatched does not queue another copy. The pending
+     *  event executes once and its id is returned. Any arguments passed to
+     *  a coalesced post are discarded. A periodic event stays pending until
+     *  it is cancelled, so posting it again does not queue a second copy.
+     *
+     *  @param coalesce True to coalesce repeated posts of the event
+     */
+    void coalesce(bool coalesce) {
+        if (_event) {
+            _event->coalesce = coalesce;
+        }
+    }
+
     /** Posts an event onto the underlying event queue
      *
      *  The event is posted to the underlying queue and is executed in the
@@ -1725,6 +2183,14 @@ public:
             return 0;
         }
 
+        if (_event->coalesce) {
+            // a pending post holds its id, which this post folds into
+            unsigned pending = *(volatile unsigned *)&_event->pending;
+            if (pending) {
+                return pending;
+            }
+        }
+
         _event->id = _event->post(_event, a0, a1, a2, a3);
         return _event->id;
     }
@@ -1780,6 +2246,9 @@ private:
 
         int delay;
         int period;
+        bool coalesce;
+        unsigned pending;
+        unsigned users;
 
         int (*post)(struct event *, A0 a0, A1 a1, A2 a2, A3 a3);
         void (*dtor)(struct event *);
@@ -1791,6 +2260,10 @@ private:
     template <typename F>
     static int event_post(struct event *e, A0 a0, A1 a1, A2 a2, A3 a3) {
         typedef EventQueue::context40<F, A0, A1, A2, A3> C;
+        if (e->coalesce) {
+            return event_post_coalesced(e, C(*(F*)(e + 1), a0, a1, a2, a3));
+        }
+
         void *p = equeue_alloc(e->equeue, sizeof(C));
         if (!p) {
             return 0;
@@ -1808,6 +2281,83 @@ private:
         ((F*)(e + 1))->~F();
     }
 
+    // Coalesced posts
+    //
+    // A coalescing event has at most one post waiting to be dispatched, whose
+    // id is kept in pending. The posted context clears pending once it starts
+    // executing, or for a periodic event once it is cancelled, and holds a use
+    // of the event so the event outlives it.
+    template <typename C>
+    struct coalesced {
+        C c;
+        struct event *e;
+        unsigned id;
+        bool periodic;
+
+        coalesced(const C &c, struct event *e, unsigned id, bool periodic)
+            : c(c), e(e), id(id), periodic(periodic) {}
+
+        ~coalesced() {
+            equeue_atomic_cas(&e->pending, id, 0);
+            event_release(e);
+        }
+
+        void operator()() {
+            if (!periodic) {
+                equeue_atomic_cas(&e->pending, id, 0);
+            }
+            c();
+        }
+    };
+
+    template <typename C>
+    static int event_post_coalesced(struct event *e, const C &c) {
+        typedef coalesced<C> W;
+        void *p = equeue_alloc(e->equeue, sizeof(W));
+        if (!p) {
+            return 0;
+        }
+
+        // the id equeue_post will return, fixed when the context is allocated
+        struct equeue_event *qe = (struct equeue_event *)p - 1;
+        unsigned id = (qe->id << e->equeue->npw2) |
+                ((unsigned char *)qe - e->equeue->buffer);
+        while (!equeue_atomic_cas(&e->pending, 0, id)) {
+            // lost a race with another post, fold into it if still pending
+            unsigned pending = *(volatile unsigned *)&e->pending;
+            if (pending) {
+                equeue_dealloc(e->equeue, p);
+                return pending;
+            }
+        }
+
+        event_acquire(e);
+        new (p) W(c, e, id, e->period >= 0);
+        equeue_event_delay(p, e->delay);
+        equeue_event_period(p, e->period);
+        equeue_event_dtor(p, &EventQueue::function_dtor<W>);
+        return equeue_post(e->equeue, &EventQueue::function_call<W>, p);
+    }
+
+    static void event_acquire(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users + 1));
+    }
+
+    static void event_release(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users - 1));
+
+        if (users == 1) {
+            e->dtor(e);
+            equeue_dealloc(e->equeue, e);
+        }
+    }
+
 public:
     /** Create an event
      *  @see Event::Event
@@ -2040,6 +2590,9 @@ public:
             _event->id = 0;
             _event->delay = 0;
             _event->period = -1;
+            _event->coalesce = false;
+            _event->pending = 0;
+            _event->users = 1;
 
             _event->post = &Event::event_post<F>;
             _event->dtor = &Event::event_dtor<F>;
@@ -2077,8 +2630,7 @@ public:
         if (_event) {
             _event->ref -= 1;
             if (_event->ref == 0) {
-                _event->dtor(_event);
-                equeue_dealloc(_event->equeue, _event);
+                event_release(_event);
             }
         }
     }
@@ -2103,6 +2655,22 @@ public:
         }
     }
 
+    /** Configure whether repeated posts of an event are coalesced
+     *
+     *  When enabled, posting the event while a previous post is still
+     *  waiting to be dispatched does not queue another copy. The pending
+     *  event executes once and its id is returned. Any arguments passed to
+     *  a coalesced post are discarded. A periodic event stays pending until
+     *  it is cancelled, so posting it again does not queue a second copy.
+     *
+     *  @param coalesce True to coalesce repeated posts of the event
+     */
+    void coalesce(bool coalesce) {
+        if (_event) {
+            _event->coalesce = coalesce;
+        }
+    }
+
     /** Posts an event onto the underlying event queue
      *
      *  The event is posted to the underlying queue and is executed in the
@@ -2121,6 +2689,14 @@ public:
             return 0;
         }
 
+        if (_event->coalesce) {
+            // a pending post holds its id, which this post folds into
+            unsigned pending = *(volatile unsigned *)&_event->pending;
+            if (pending) {
+                return pending;
+            }
+        }
+
         _event->id = _event->post(_event, a0, a1, a2, a3, a4);
         return _event->id;
     }
@@ -2176,6 +2752,9 @@ private:
 
         int delay;
         int period;
+        bool coalesce;
+        unsigned pending;
+        unsigned users;
 
         int (*post)(struct event *, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4);
         void (*dtor)(struct event *);
@@ -2187,6 +2766,10 @@ private:
     template <typename F>
     static int event_post(struct event *e, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4) {
         typedef EventQueue::context50<F, A0, A1, A2, A3, A4> C;
+        if (e->coalesce) {
+            return event_post_coalesced(e, C(*(F*)(e + 1), a0, a1, a2, a3, a4));
+        }
+
         void *p = equeue_alloc(e->equeue, sizeof(C));
         if (!p) {
             return 0;
@@ -2204,6 +2787,83 @@ private:
         ((F*)(e + 1))->~F();
     }
 
+    // Coalesced posts
+    //
+    // A coalescing event has at most one post waiting to be dispatched, whose
+    // id is kept in pending. The posted context clears pending once it starts
+    // executing, or for a periodic event once it is cancelled, and holds a use
+    // of the event so the event outlives it.
+    template <typename C>
+    struct coalesced {
+        C c;
+        struct event *e;
+        unsigned id;
+        bool periodic;
+
+        coalesced(const C &c, struct event *e, unsigned id, bool periodic)
+            : c(c), e(e), id(id), periodic(periodic) {}
+
+        ~coalesced() {
+            equeue_atomic_cas(&e->pending, id, 0);
+            event_release(e);
+        }
+
+        void operator()() {
+            if (!periodic) {
+                equeue_atomic_cas(&e->pending, id, 0);
+            }
+            c();
+        }
+    };
+
+    template <typename C>
+    static int event_post_coalesced(struct event *e, const C &c) {
+        typedef coalesced<C> W;
+        void *p = equeue_alloc(e->equeue, sizeof(W));
+        if (!p) {
+            return 0;
+        }
+
+        // the id equeue_post will return, fixed when the context is allocated
+        struct equeue_event *qe = (struct equeue_event *)p - 1;
+        unsigned id = (qe->id << e->equeue->npw2) |
+                ((unsigned char *)qe - e->equeue->buffer);
+        while (!equeue_atomic_cas(&e->pending, 0, id)) {
+            // lost a race with another post, fold into it if still pending
+            unsigned pending = *(volatile unsigned *)&e->pending;
+            if (pending) {
+                equeue_dealloc(e->equeue, p);
+                return pending;
+            }
+        }
+
+        event_acquire(e);
+        new (p) W(c, e, id, e->period >= 0);
+        equeue_event_delay(p, e->delay);
+        equeue_event_period(p, e->period);
+        equeue_event_dtor(p, &EventQueue::function_dtor<W>);
+        return equeue_post(e->equeue, &EventQueue::function_call<W>, p);
+    }
+
+    static void event_acquire(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users + 1));
+    }
+
+    static void event_release(struct event *e) {
+        unsigned users;
+        do {
+            users = *(volatile unsigned *)&e->users;
+        } while (!equeue_atomic_cas(&e->users, users, users - 1));
+
+        if (users == 1) {
+            e->dtor(e);
+            equeue_dealloc(e->equeue, e);
+        }
+    }
+
 public:
     /** Create an event
      *  @see Event::Event
@@ -123,6 +123,20 @@ public:
      */
     void cancel(int id);
 
+    /** Query how much time is left for a queued event
+     *
+     *  Returns the number of milliseconds until the event referenced by the
+     *  unique id is dispatched, or a negative value if the event has already
+     *  begun executing, or has already been dispatched or cancelled.
+     *
+     *  The time_left function is irq safe.
+     *
+     *  @param id       Unique id of the event
+     *  @return         Milliseconds until the event is dispatched, or a
+     *                  negative value if the event is no longer queued
+     */
+    int time_left(int id);
+
     /** Background an event queue onto a single-shot timer-interrupt
      *
      *  When updated, the event queue will call the provided update function
@@ -42,6 +42,93 @@ static inline void equeue_incid(equeue_t *q, struct equeue_event *e) {
     }
 }
 
+// Lock-free stacks of chunks
+//
+// A stack is stored in a single word as the buffer offset of its top chunk
+// plus one in the low npw2 bits, and a counter in the remaining bits that
+// changes on every update to protect against ABA races. Chunks are linked
+// through their next pointers.
+static inline struct equeue_event *equeue_stack_top(equeue_t *q, unsigned s) {
+    unsigned off = s & ((1 << q->npw2)-1);
+    return off ? (struct equeue_event *)&q->buffer[off-1] : 0;
+}
+
+static inline unsigned equeue_stack_word(equeue_t *q, unsigned s,
+        struct equeue_event *e) {
+    unsigned off = e ? (unsigned)((unsigned char *)e - q->buffer) + 1 : 0;
+    return (((s >> q->npw2) + 1) << q->npw2) | off;
+}
+
+static void equeue_stack_push(equeue_t *q, unsigned *stack,
+        struct equeue_event *e) {
+    unsigned s;
+    do {
+        s = *(volatile unsigned *)stack;
+        e->next = equeue_stack_top(q, s);
+    } while (!equeue_atomic_cas(stack, s, equeue_stack_word(q, s, e)));
+}
+
+static struct equeue_event *equeue_stack_pop(equeue_t *q, unsigned *stack) {
+    unsigned s;
+    struct equeue_event *e;
+    do {
+        s = *(volatile unsigned *)stack;
+        e = equeue_stack_top(q, s);
+        if (!e) {
+            return 0;
+        }
+    } while (!equeue_atomic_cas(stack, s, equeue_stack_word(q, s, e->next)));
+
+    return e;
+}
+
+static struct equeue_event *equeue_stack_popall(equeue_t *q, unsigned *stack) {
+    unsigned s;
+    do {
+        s = *(volatile unsigned *)stack;
+    } while (!equeue_atomic_cas(stack, s, equeue_stack_word(q, s, 0)));
+
+    return equeue_stack_top(q, s);
+}
+
+#if !defined(EQUEUE_HEAP) || defined(EQUEUE_COALESCE)
+// stable merge sort of a list of events linked through their next pointers
+static struct equeue_event *equeue_sort(struct equeue_event *es,
+        bool (*before)(struct equeue_event *, struct equeue_event *)) {
+    if (!es || !es->next) {
+        return es;
+    }
+
+    // split the list in half
+    struct equeue_event *slow = es;
+    for (struct equeue_event *fast = es->next; fast && fast->next;
+            fast = fast->next->next) {
+        slow = slow->next;
+    }
+
+    struct equeue_event *b = equeue_sort(slow->next, before);
+    slow->next = 0;
+    struct equeue_event *a = equeue_sort(es, before);
+
+    // and merge the sorted halves
+    struct equeue_event *head = 0;
+    struct equeue_event **tail = &head;
+    while (a && b) {
+        if (before(b, a)) {
+            *tail = b;
+            b = b->next;
+        } else {
+            *tail = a;
+            a = a->next;
+        }
+        tail = &(*tail)->next;
+    }
+
+    *tail = a ? a : b;
+    return head;
+}
+#endif
+
 
 // equeue lifetime management
 int equeue_create(equeue_t *q, size_t size) {
@@ -66,13 +153,31 @@ int equeue_create_inplace(equeue_t *q, size_t size, void *buffer) {
         q->npw2++;
     }
 
-    q->chunks = 0;
+    q->incoming = 0;
+    for (int i = 0; i < EQUEUE_CLASSES; i++) {
+        q->classes[i] = 0;
+    }
+
+    for (int i = 0; i < EQUEUE_BINS; i++) {
+        q->bins[i] = 0;
+    }
+
     q->slab.size = size;
     q->slab.data = buffer;
+#ifdef EQUEUE_COALESCE
+    q->slab.id = 1;
+#endif
+
+    q->usage.used = 0;
+    q->usage.max_used = 0;
+    q->usage.failures = 0;
 
     q->queue = 0;
     q->tick = equeue_tick();
     q->generation = 0;
+#ifdef EQUEUE_HEAP
+    q->seq = 0;
+#endif
     q->breaks = 0;
 
     q->background.active = false;
@@ -101,6 +206,7 @@ int equeue_create_inplace(equeue_t *q, size_t size, void *buffer) {
 
 void equeue_destroy(equeue_t *q) {
     // call destructors on pending events
+#ifndef EQUEUE_HEAP
     for (struct equeue_event *es = q->queue; es; es = es->next) {
         for (struct equeue_event *e = q->queue; e; e = e->sibling) {
             if (e->dtor) {
@@ -108,6 +214,35 @@ void equeue_destroy(equeue_t *q) {
             }
         }
     }
+#else
+    struct equeue_event *es = q->queue;
+    while (es) {
+        struct equeue_event *e = es;
+        es = e->sibling;
+
+        // splice children in front of the remaining siblings
+        if (e->next) {
+            struct equeue_event *c = e->next;
+            while (c->sibling) {
+                c = c->sibling;
+            }
+
+            c->sibling = es;
+            es = e->next;
+        }
+
+        if (e->dtor) {
+            e->dtor(e + 1);
+        }
+    }
+#endif
+
+    for (struct equeue_event *e = equeue_stack_top(q, q->incoming);
+            e; e = e->next) {
+        if (e->dtor) {
+            e->dtor(e + 1);
+        }
+    }
 
     // notify background timer
     if (q->background.update) {
@@ -123,25 +258,137 @@ void equeue_destroy(equeue_t *q) {
 
 
 // equeue chunk allocation functions
-static struct equeue_event *equeue_mem_alloc(equeue_t *q, size_t size) {
-    // add event overhead
-    size += sizeof(struct equeue_event);
-    size = (size + sizeof(void*)-1) & ~(sizeof(void*)-1);
+static inline unsigned equeue_atomic_add(unsigned *p, unsigned delta) {
+    unsigned v;
+    do {
+        v = *(volatile unsigned *)p;
+    } while (!equeue_atomic_cas(p, v, v + delta));
 
-    equeue_mutex_lock(&q->memlock);
+    return v + delta;
+}
+
+static void equeue_mem_account(equeue_t *q, struct equeue_event *e) {
+    unsigned used = equeue_atomic_add(&q->usage.used, e->size);
+
+    // raise the high-water mark
+    unsigned max;
+    do {
+        max = *(volatile unsigned *)&q->usage.max_used;
+        if (used <= max) {
+            break;
+        }
+    } while (!equeue_atomic_cas(&q->usage.max_used, max, used));
+}
+
+static inline unsigned equeue_mem_bin(unsigned size) {
+    unsigned bin = 0;
+    while (size >>= 1) {
+        bin++;
+    }
+
+    return bin < EQUEUE_BINS ? bin : EQUEUE_BINS-1;
+}
+
+// release a chunk to its freelist or bin, large chunks need the memlock
+static void equeue_mem_release(equeue_t *q, struct equeue_event *e) {
+    unsigned i = (e->size - sizeof(struct equeue_event)) / sizeof(void*);
+    if (i < EQUEUE_CLASSES) {
+        equeue_stack_push(q, &q->classes[i], e);
+        return;
+    }
+
+    unsigned bin = equeue_mem_bin(e->size);
+    e->next = q->bins[bin];
+    q->bins[bin] = e;
+}
+
+#ifdef EQUEUE_COALESCE
+static bool equeue_addr_before(struct equeue_event *a, struct equeue_event *b) {
+    return a < b;
+}
+
+// merge adjacent free chunks and return free memory at the top of the
+// buffer to the slab, called with the memlock held
+static void equeue_mem_coalesce(equeue_t *q) {
+    // collect every free chunk
+    struct equeue_event *es = 0;
+    for (int i = 0; i < EQUEUE_CLASSES; i++) {
+        struct equeue_event *e = equeue_stack_popall(q, &q->classes[i]);
+        while (e) {
+            struct equeue_event *next = e->next;
+            e->next = es;
+            es = e;
+            e = next;
+        }
+    }
+
+    for (int i = 0; i < EQUEUE_BINS; i++) {
+        struct equeue_event *e = q->bins[i];
+        while (e) {
+            struct equeue_event *next = e->next;
+            e->next = es;
+            es = e;
+            e = next;
+        }
+        q->bins[i] = 0;
+    }
+
+    // merge chunks that touch, a free chunk's id is the next one its offset
+    // would hand out, so chunks later carved from the slab start past every
+    // id that may still be held for memory given back to it
+    es = equeue_sort(es, equeue_addr_before);
+    for (struct equeue_event *e = es; e; e = e->next) {
+        if (e->id > q->slab.id) {
+            q->slab.id = e->id;
+        }
+
+        while (e->next &&
+               (unsigned char *)e + e->size == (unsigned char *)e->next) {
+            if (e->next->id > q->slab.id) {
+                q->slab.id = e->next->id;
+            }
+            e->size += e->next->size;
+            e->next = e->next->next;
+        }
+    }
+
+    // give the top-most chunk back to the slab and release the rest
+    while (es) {
+        struct equeue_event *e = es;
+        es = e->next;
 
-    // check if a good chunk is available
-    for (struct equeue_event **p = &q->chunks; *p; p = &(*p)->next) {
+        if ((unsigned char *)e + e->size == q->slab.data) {
+            q->slab.data -= e->size;
+            q->slab.size += e->size;
+        } else {
+            equeue_mem_release(q, e);
+        }
+    }
+}
+#endif
+
+// take a chunk from the bins or the slab, called with the memlock held
+static struct equeue_event *equeue_mem_take(equeue_t *q, size_t size) {
+    // check if a good chunk is available, the head of the chunk's own bin
+    // may fit, any chunk in a larger bin is guaranteed to fit
+    unsigned bin = equeue_mem_bin(size);
+    for (struct equeue_event **p = &q->bins[bin]; *p; p = &(*p)->next) {
         if ((*p)->size >= size) {
             struct equeue_event *e = *p;
-            if (e->sibling) {
-                *p = e->sibling;
-                (*p)->next = e->next;
-            } else {
-                *p = e->next;
-            }
+            *p = e->next;
+            return e;
+        }
 
-            equeue_mutex_unlock(&q->memlock);
+        // only the last bin is unbounded and worth searching
+        if (bin != EQUEUE_BINS-1) {
+            break;
+        }
+    }
+
+    for (unsigned i = bin+1; i < EQUEUE_BINS; i++) {
+        if (q->bins[i]) {
+            struct equeue_event *e = q->bins[i];
+            q->bins[i] = e->next;
             return e;
         }
     }
@@ -152,35 +399,79 @@ static struct equeue_event *equeue_mem_alloc(equeue_t *q, size_t size) {
         q->slab.data += size;
         q->slab.size -= size;
         e->size = size;
+#ifdef EQUEUE_COALESCE
+        e->id = q->slab.id;
+#else
         e->id = 1;
-
-        equeue_mutex_unlock(&q->memlock);
+#endif
         return e;
     }
 
-    equeue_mutex_unlock(&q->memlock);
     return 0;
 }
 
-static void equeue_mem_dealloc(equeue_t *q, struct equeue_event *e) {
+static struct equeue_event *equeue_mem_alloc(equeue_t *q, size_t size) {
+    // add event overhead
+    size += sizeof(struct equeue_event);
+    size = (size + sizeof(void*)-1) & ~(sizeof(void*)-1);
+
+    // check the lock-free freelists for a small chunk
+    for (unsigned i = (size - sizeof(struct equeue_event)) / sizeof(void*);
+            i < EQUEUE_CLASSES; i++) {
+        struct equeue_event *e = equeue_stack_pop(q, &q->classes[i]);
+        if (e) {
+            equeue_mem_account(q, e);
+            return e;
+        }
+    }
+
     equeue_mutex_lock(&q->memlock);
 
-    // stick chunk into list of chunks
-    struct equeue_event **p = &q->chunks;
-    while (*p && (*p)->size < e->size) {
-        p = &(*p)->next;
+    struct equeue_event *e = equeue_mem_take(q, size);
+#ifdef EQUEUE_COALESCE
+    if (!e) {
+        equeue_mem_coalesce(q);
+        e = equeue_mem_take(q, size);
     }
+#endif
 
-    if (*p && (*p)->size == e->size) {
-        e->sibling = *p;
-        e->next = (*p)->next;
-    } else {
-        e->sibling = 0;
-        e->next = *p;
+    if (!e) {
+        q->usage.failures += 1;
     }
-    *p = e;
 
     equeue_mutex_unlock(&q->memlock);
+
+    if (e) {
+        equeue_mem_account(q, e);
+    }
+
+    return e;
+}
+
+static void equeue_mem_dealloc(equeue_t *q, struct equeue_event *e) {
+    equeue_atomic_add(&q->usage.used, -e->size);
+
+    // small chunks go back to their lock-free freelist
+    unsigned i = (e->size - sizeof(struct equeue_event)) / sizeof(void*);
+    if (i < EQUEUE_CLASSES) {
+        equeue_mem_release(q, e);
+        return;
+    }
+
+    equeue_mutex_lock(&q->memlock);
+    equeue_mem_release(q, e);
+    equeue_mutex_unlock(&q->memlock);
+}
+
+void equeue_stats(equeue_t *q, struct equeue_stats *stats) {
+    equeue_mutex_lock(&q->memlock);
+    stats->size = q->slab.data + q->slab.size - q->buffer;
+    stats->used = q->usage.used;
+    stats->max_used = q->usage.max_used;
+    stats->fragmented = (q->slab.data - q->buffer) - q->usage.used;
+    stats->slab = q->slab.size;
+    stats->failures = q->usage.failures;
+    equeue_mutex_unlock(&q->memlock);
 }
 
 void *equeue_alloc(equeue_t *q, size_t size) {
@@ -208,20 +499,23 @@ void equeue_dealloc(equeue_t *q, void *p) {
 
 
 // equeue scheduling functions
-static int equeue_enqueue(equeue_t *q, struct equeue_event *e, unsigned tick) {
-    // setup event and hash local id with buffer offset for unique id
-    int id = (e->id << q->npw2) | ((unsigned char *)e - q->buffer);
-    e->target = tick + equeue_clampdiff(e->target, tick);
-    e->generation = q->generation;
-
-    equeue_mutex_lock(&q->queuelock);
-
-    // find the event slot
-    struct equeue_event **p = &q->queue;
-    while (*p && equeue_tickdiff((*p)->target, e->target) < 0) {
+#ifndef EQUEUE_HEAP
+// The queue is a list of slots sorted by target, with events that share a
+// target chained through their sibling pointers in reverse insertion order.
+// Only the head of each slot keeps a valid next pointer.
+
+// find the slot for a target, starting from an earlier slot
+static struct equeue_event **equeue_queue_slot(struct equeue_event **p,
+        unsigned target) {
+    while (*p && equeue_tickdiff((*p)->target, target) < 0) {
         p = &(*p)->next;
     }
 
+    return p;
+}
+
+static void equeue_queue_link(struct equeue_event **p,
+        struct equeue_event *e) {
     // insert at head in slot
     if (*p && (*p)->target == e->target) {
         e->next = (*p)->next;
@@ -230,6 +524,7 @@ static int equeue_enqueue(equeue_t *q, struct equeue_event *e, unsigned tick) {
         }
 
         e->sibling = *p;
+        e->sibling->next = 0;
         e->sibling->ref = &e->sibling;
     } else {
         e->next = *p;
@@ -242,40 +537,33 @@ static int equeue_enqueue(equeue_t *q, struct equeue_event *e, unsigned tick) {
 
     *p = e;
     e->ref = p;
+}
 
-    // notify background timer
-    if ((q->background.update && q->background.active) &&
-        (q->queue == e && !e->sibling)) {
-        q->background.update(q->background.timer,
-                equeue_clampdiff(e->target, tick));
-    }
-
-    equeue_mutex_unlock(&q->queuelock);
-
-    return id;
+static void equeue_queue_insert(equeue_t *q, struct equeue_event *e) {
+    equeue_queue_link(equeue_queue_slot(&q->queue, e->target), e);
 }
 
-static struct equeue_event *equeue_unqueue(equeue_t *q, int id) {
-    // decode event from unique id and check that the local id matches
-    struct equeue_event *e = (struct equeue_event *)
-            &q->buffer[id & ((1 << q->npw2)-1)];
+static bool equeue_target_before(
+        struct equeue_event *a, struct equeue_event *b) {
+    return equeue_tickdiff(a->target, b->target) < 0;
+}
 
-    equeue_mutex_lock(&q->queuelock);
-    if (e->id != id >> q->npw2) {
-        equeue_mutex_unlock(&q->queuelock);
-        return 0;
-    }
+// insert a list of events, sorting them first so the queue is only
+// walked once
+static void equeue_queue_insert_batch(equeue_t *q, struct equeue_event *es) {
+    es = equeue_sort(es, equeue_target_before);
 
-    // clear the event and check if already in-flight
-    e->cb = 0;
-    e->period = -1;
+    struct equeue_event **p = &q->queue;
+    while (es) {
+        struct equeue_event *e = es;
+        es = e->next;
 
-    int diff = equeue_tickdiff(e->target, q->tick);
-    if (diff < 0 || (diff == 0 && e->generation != q->generation)) {
-        equeue_mutex_unlock(&q->queuelock);
-        return 0;
+        p = equeue_queue_slot(p, e->target);
+        equeue_queue_link(p, e);
     }
+}
 
+static void equeue_queue_remove(equeue_t *q, struct equeue_event *e) {
     // disentangle from queue
     if (e->sibling) {
         e->sibling->next = e->next;
@@ -291,22 +579,10 @@ static struct equeue_event *equeue_unqueue(equeue_t *q, int id) {
             e->next->ref = e->ref;
         }
     }
-
-    equeue_incid(q, e);
-    equeue_mutex_unlock(&q->queuelock);
-
-    return e;
 }
 
-static struct equeue_event *equeue_dequeue(equeue_t *q, unsigned target) {
-    equeue_mutex_lock(&q->queuelock);
-
-    // find all expired events and mark a new generation
-    q->generation += 1;
-    if (equeue_tickdiff(q->tick, target) <= 0) {
-        q->tick = target;
-    }
-
+static struct equeue_event *equeue_queue_expire(equeue_t *q,
+        unsigned target) {
     struct equeue_event *head = q->queue;
     struct equeue_event **p = &head;
     while (*p && equeue_tickdiff((*p)->target, target) <= 0) {
@@ -319,9 +595,10 @@ static struct equeue_event *equeue_dequeue(equeue_t *q, unsigned target) {
     }
 
     *p = 0;
+    return head;
+}
 
-    equeue_mutex_unlock(&q->queuelock);
-
+static struct equeue_event *equeue_queue_flatten(struct equeue_event *head) {
     // reverse and flatten each slot to match insertion order
     struct equeue_event **tail = &head;
     struct equeue_event *ess = head;
@@ -341,11 +618,311 @@ static struct equeue_event *equeue_dequeue(equeue_t *q, unsigned target) {
 
     return head;
 }
+#else
+// The queue is a pairing heap ordered by target and then insertion order.
+// Each event's next pointer references its first child, its sibling pointer
+// the next child of its parent, and its ref pointer whichever pointer
+// currently references the event.
+static inline bool equeue_heap_before(
+        struct equeue_event *a, struct equeue_event *b) {
+    int diff = equeue_tickdiff(a->target, b->target);
+    if (diff) {
+        return diff < 0;
+    }
+
+    // the sequence wraps, but only after 2^31 inserts while both are queued
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+// meld two detached heaps, leaving the root's ref for the caller
+static struct equeue_event *equeue_heap_meld(
+        struct equeue_event *a, struct equeue_event *b) {
+    if (equeue_heap_before(b, a)) {
+        struct equeue_event *t = a;
+        a = b;
+        b = t;
+    }
+
+    b->sibling = a->next;
+    if (b->sibling) {
+        b->sibling->ref = &b->sibling;
+    }
+
+    a->next = b;
+    b->ref = &a->next;
+    return a;
+}
+
+// combine a list of children into a single heap with the two-pass
+// pairing strategy that gives the heap its logarithmic bounds
+static struct equeue_event *equeue_heap_merge(struct equeue_event *es) {
+    if (!es) {
+        return 0;
+    }
+
+    // meld pairs left to right, building a reversed list of the results
+    struct equeue_event *pairs = 0;
+    while (es) {
+        struct equeue_event *a = es;
+        struct equeue_event *b = a->sibling;
+        a->sibling = 0;
+        if (!b) {
+            a->sibling = pairs;
+            pairs = a;
+            break;
+        }
+
+        es = b->sibling;
+        b->sibling = 0;
+
+        struct equeue_event *m = equeue_heap_meld(a, b);
+        m->sibling = pairs;
+        pairs = m;
+    }
+
+    // meld the results right to left
+    struct equeue_event *root = pairs;
+    pairs = root->sibling;
+    root->sibling = 0;
+    while (pairs) {
+        struct equeue_event *e = pairs;
+        pairs = e->sibling;
+        e->sibling = 0;
+        root = equeue_heap_meld(root, e);
+    }
+
+    return root;
+}
+
+static void equeue_queue_insert(equeue_t *q, struct equeue_event *e) {
+    e->seq = q->seq++;
+    e->next = 0;
+    e->sibling = 0;
+
+    if (q->queue) {
+        q->queue = equeue_heap_meld(q->queue, e);
+    } else {
+        q->queue = e;
+    }
+    q->queue->ref = &q->queue;
+}
+
+static void equeue_queue_insert_batch(equeue_t *q, struct equeue_event *es) {
+    while (es) {
+        struct equeue_event *e = es;
+        es = e->next;
+        equeue_queue_insert(q, e);
+    }
+}
+
+static void equeue_queue_remove(equeue_t *q, struct equeue_event *e) {
+    struct equeue_event *children = equeue_heap_merge(e->next);
+
+    if (q->queue == e) {
+        q->queue = children;
+    } else {
+        // cut the subtree out of its parent and meld the children back in
+        *e->ref = e->sibling;
+        if (e->sibling) {
+            e->sibling->ref = e->ref;
+        }
+
+        if (children) {
+            q->queue = equeue_heap_meld(q->queue, children);
+        }
+    }
+
+    if (q->queue) {
+        q->queue->ref = &q->queue;
+    }
+}
+
+static struct equeue_event *equeue_queue_expire(equeue_t *q,
+        unsigned target) {
+    // pop expired events in order
+    struct equeue_event *head = 0;
+    struct equeue_event **tail = &head;
+    while (q->queue && equeue_tickdiff(q->queue->target, target) <= 0) {
+        struct equeue_event *e = q->queue;
+        equeue_queue_remove(q, e);
+
+        *tail = e;
+        tail = &e->next;
+    }
+
+    *tail = 0;
+    return head;
+}
+
+static inline struct equeue_event *equeue_queue_flatten(
+        struct equeue_event *head) {
+    return head;
+}
+#endif
+
+// move events posted without locking into the queue, oldest first, making
+// sure they are due by the target tick
+static void equeue_incoming_drain(equeue_t *q, unsigned target) {
+    struct equeue_event *incoming = 0;
+    for (struct equeue_event *es = equeue_stack_popall(q, &q->incoming); es;) {
+        struct equeue_event *e = es;
+        es = e->next;
+        e->next = incoming;
+        incoming = e;
+    }
+
+    while (incoming) {
+        struct equeue_event *e = incoming;
+        incoming = e->next;
+
+        if (equeue_tickdiff(e->target, target) > 0) {
+            e->target = target;
+        }
+        e->generation = q->generation;
+        equeue_queue_insert(q, e);
+    }
+}
+
+static int equeue_enqueue(equeue_t *q, struct equeue_event *e, unsigned tick) {
+    // setup event and hash local id with buffer offset for unique id
+    int id = (e->id << q->npw2) | ((unsigned char *)e - q->buffer);
+    e->target = tick + equeue_clampdiff(e->target, tick);
+    e->generation = q->generation;
+
+    equeue_mutex_lock(&q->queuelock);
+
+    equeue_queue_insert(q, e);
+
+    // notify background timer
+    if ((q->background.update && q->background.active) &&
+        (q->queue == e && !e->sibling)) {
+        q->background.update(q->background.timer,
+                equeue_clampdiff(e->target, tick));
+    }
+
+    equeue_mutex_unlock(&q->queuelock);
+
+    return id;
+}
+
+// reenqueue a list of dispatched periodic events with a single lock
+static void equeue_requeue(equeue_t *q, struct equeue_event *es,
+        unsigned tick) {
+    struct equeue_event *cancelled = 0;
+    struct equeue_event *batch = 0;
+    struct equeue_event **tail = &batch;
+
+    equeue_mutex_lock(&q->queuelock);
+
+    // events may have been cancelled while in-flight
+    while (es) {
+        struct equeue_event *e = es;
+        es = e->next;
+
+        if (e->period >= 0) {
+            e->target += e->period;
+            e->target = tick + equeue_clampdiff(e->target, tick);
+            e->generation = q->generation;
+            *tail = e;
+            tail = &e->next;
+        } else {
+            e->next = cancelled;
+            cancelled = e;
+        }
+    }
+
+    *tail = 0;
+
+    struct equeue_event *head = q->queue;
+    unsigned target = head ? head->target : 0;
+    equeue_queue_insert_batch(q, batch);
+
+    // notify background timer
+    if ((q->background.update && q->background.active) && q->queue &&
+        (!head || equeue_tickdiff(q->queue->target, target) < 0)) {
+        q->background.update(q->background.timer,
+                equeue_clampdiff(q->queue->target, tick));
+    }
+
+    equeue_mutex_unlock(&q->queuelock);
+
+    while (cancelled) {
+        struct equeue_event *e = cancelled;
+        cancelled = e->next;
+        equeue_incid(q, e);
+        equeue_dealloc(q, e+1);
+    }
+}
+
+static struct equeue_event *equeue_unqueue(equeue_t *q, int id) {
+    // decode event from unique id and check that the local id matches
+    struct equeue_event *e = (struct equeue_event *)
+            &q->buffer[id & ((1 << q->npw2)-1)];
+
+    equeue_mutex_lock(&q->queuelock);
+    if (e->id != id >> q->npw2) {
+        equeue_mutex_unlock(&q->queuelock);
+        return 0;
+    }
+
+    // events still on the incoming list need to be sorted in first
+    if (!e->ref) {
+        equeue_incoming_drain(q, q->tick);
+    }
+
+    // clear the event and check if already in-flight
+    e->cb = 0;
+    e->period = -1;
+
+    int diff = equeue_tickdiff(e->target, q->tick);
+    if (diff < 0 || (diff == 0 && e->generation != q->generation)) {
+        equeue_mutex_unlock(&q->queuelock);
+        return 0;
+    }
+
+    equeue_queue_remove(q, e);
+
+    equeue_incid(q, e);
+    equeue_mutex_unlock(&q->queuelock);
+
+    return e;
+}
+
+static struct equeue_event *equeue_dequeue(equeue_t *q, unsigned target) {
+    equeue_mutex_lock(&q->queuelock);
+
+    equeue_incoming_drain(q, target);
+
+    // find all expired events and mark a new generation
+    q->generation += 1;
+    if (equeue_tickdiff(q->tick, target) <= 0) {
+        q->tick = target;
+    }
+
+    struct equeue_event *head = equeue_queue_expire(q, target);
+
+    equeue_mutex_unlock(&q->queuelock);
+
+    return equeue_queue_flatten(head);
+}
 
 int equeue_post(equeue_t *q, void (*cb)(void*), void *p) {
     struct equeue_event *e = (struct equeue_event*)p - 1;
     unsigned tick = equeue_tick();
     e->cb = cb;
+
+    // events without a delay skip the queue lock unless a background timer
+    // needs to be notified, the dispatch loop sorts them in later
+    if ((int)e->target <= 0 && !q->background.update) {
+        int id = (e->id << q->npw2) | ((unsigned char *)e - q->buffer);
+        e->target = tick;
+        e->ref = 0;
+
+        equeue_stack_push(q, &q->incoming, e);
+        equeue_sema_signal(&q->eventsema);
+        return id;
+    }
+
     e->target = tick + e->target;
 
     int id = equeue_enqueue(q, e, tick);
@@ -364,6 +941,33 @@ void equeue_cancel(equeue_t *q, int id) {
     }
 }
 
+int equeue_timeleft(equeue_t *q, int id) {
+    if (!id) {
+        return -1;
+    }
+
+    // decode event from unique id and check that the local id matches
+    struct equeue_event *e = (struct equeue_event *)
+            &q->buffer[id & ((1 << q->npw2)-1)];
+
+    int ret = -1;
+    equeue_mutex_lock(&q->queuelock);
+    if (e->id == id >> q->npw2) {
+        if (!e->ref) {
+            // still on the incoming list
+            ret = 0;
+        } else {
+            int diff = equeue_tickdiff(e->target, q->tick);
+            if (!(diff < 0 || (diff == 0 && e->generation != q->generation))) {
+                ret = equeue_clampdiff(e->target, equeue_tick());
+            }
+        }
+    }
+    equeue_mutex_unlock(&q->queuelock);
+
+    return ret;
+}
+
 void equeue_break(equeue_t *q) {
     equeue_mutex_lock(&q->queuelock);
     q->breaks++;
@@ -379,6 +983,8 @@ void equeue_dispatch(equeue_t *q, int ms) {
     while (1) {
         // collect all the available events and next deadline
         struct equeue_event *es = equeue_dequeue(q, tick);
+        struct equeue_event *periodic = 0;
+        struct equeue_event **periodic_tail = &periodic;
 
         // dispatch events
         while (es) {
@@ -391,16 +997,21 @@ void equeue_dispatch(equeue_t *q, int ms) {
                 cb(e + 1);
             }
 
-            // reenqueue periodic events or deallocate
+            // collect periodic events to reenqueue as a batch or deallocate
             if (e->period >= 0) {
-                e->target += e->period;
-                equeue_enqueue(q, e, equeue_tick());
+                *periodic_tail = e;
+                periodic_tail = &e->next;
             } else {
                 equeue_incid(q, e);
                 equeue_dealloc(q, e+1);
             }
         }
 
+        *periodic_tail = 0;
+        if (periodic) {
+            equeue_requeue(q, periodic, equeue_tick());
+        }
+
         int deadline = -1;
         tick = equeue_tick();
 
@@ -528,7 +1139,9 @@ void equeue_background(equeue_t *q,
     q->background.update = update;
     q->background.timer = timer;
 
-    if (q->background.update && q->queue) {
+    if (q->background.update && equeue_stack_top(q, q->incoming)) {
+        q->background.update(q->background.timer, 0);
+    } else if (q->background.update && q->queue) {
         q->background.update(q->background.timer,
                 equeue_clampdiff(q->queue->target, equeue_tick()));
     }
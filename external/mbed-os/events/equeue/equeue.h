@@ -36,11 +36,54 @@ extern "C" {
 // This size is guaranteed to fit events created by event_call
 #define EQUEUE_EVENT_SIZE (sizeof(struct equeue_event) + 2*sizeof(void*))
 
+// Queue backend
+//
+// By default pending events are kept in a sorted list of time slots. This is
+// compact and dispatches in constant time, however equeue_post and
+// equeue_cancel grow linearly with the number of pending events.
+//
+// Defining EQUEUE_HEAP stores pending events in a pairing heap instead,
+// giving constant-time post and logarithmic-time cancel and dispatch. This
+// is preferable for queues with hundreds of pending timed events. Each event
+// also carries a 32-bit insertion sequence that orders events due at the
+// same tick.
+//#define EQUEUE_HEAP
+
+// Number of small chunk sizes with lock-free freelists
+//
+// Chunks with up to EQUEUE_CLASSES-1 words of event data are recycled through
+// per-size lock-free freelists, so allocating and posting small events never
+// takes a lock once the queue has warmed up. Larger chunks are kept in
+// power-of-two size bins protected by the memlock.
+#ifndef EQUEUE_CLASSES
+#define EQUEUE_CLASSES 8
+#endif
+
+// Number of power-of-two size bins for larger chunks
+//
+// Bin n holds free chunks of 2^n up to 2^(n+1)-1 bytes, and the last bin
+// holds any chunks larger than that.
+#ifndef EQUEUE_BINS
+#define EQUEUE_BINS 16
+#endif
+
+// Chunk coalescing
+//
+// Freed chunks are normally only reused by events of a similar size. Defining
+// EQUEUE_COALESCE makes an allocation that would otherwise fail merge
+// adjacent free chunks and return the top-most free memory to the slab
+// before giving up. This takes time linear in the number of free chunks
+// while holding the memlock, but only on the allocation failure path.
+//#define EQUEUE_COALESCE
+
 // Internal event structure
 struct equeue_event {
     unsigned size;
     uint8_t id;
     uint8_t generation;
+#ifdef EQUEUE_HEAP
+    uint32_t seq;
+#endif
 
     struct equeue_event *next;
     struct equeue_event *sibling;
@@ -60,17 +103,31 @@ typedef struct equeue {
     unsigned tick;
     unsigned breaks;
     uint8_t generation;
+#ifdef EQUEUE_HEAP
+    uint32_t seq;
+#endif
 
     unsigned char *buffer;
     unsigned npw2;
     void *allocated;
 
-    struct equeue_event *chunks;
+    unsigned incoming;
+    unsigned classes[EQUEUE_CLASSES];
+    struct equeue_event *bins[EQUEUE_BINS];
     struct equeue_slab {
         size_t size;
         unsigned char *data;
+#ifdef EQUEUE_COALESCE
+        unsigned id;
+#endif
     } slab;
 
+    struct equeue_usage {
+        unsigned used;
+        unsigned max_used;
+        unsigned failures;
+    } usage;
+
     struct equeue_background {
         bool active;
         void (*update)(void *timer, int ms);
@@ -142,8 +199,9 @@ int equeue_call_every(equeue_t *queue, int ms, void (*cb)(void *), void *data);
 //
 // The equeue allocator is designed to minimize jitter in interrupt contexts as
 // well as avoid memory fragmentation on small devices. The allocator achieves
-// both constant-runtime and zero-fragmentation for fixed-size events, however
-// grows linearly as the quantity of different sized allocations increases.
+// constant-runtime for all event sizes and zero-fragmentation for fixed-size
+// events. Small events are recycled without locking, see EQUEUE_CLASSES, and
+// larger events are recycled through power-of-two bins, see EQUEUE_BINS.
 //
 // The equeue_alloc function returns a pointer to the event's allocated memory
 // and acts as a handle to the underlying event. If there is not enough memory
@@ -151,6 +209,30 @@ int equeue_call_every(equeue_t *queue, int ms, void (*cb)(void *), void *data);
 void *equeue_alloc(equeue_t *queue, size_t size);
 void equeue_dealloc(equeue_t *queue, void *event);
 
+// Memory usage statistics
+//
+// The equeue_stats function reports how the event queue's buffer is being
+// used, which can be used to size the buffer from measurements:
+//
+// size       - Size of the event queue's buffer in bytes
+// used       - Bytes currently allocated to events, including overhead
+// max_used   - High-water mark of used bytes
+// fragmented - Bytes sitting in freed chunks that have not been reused
+// slab       - Bytes that have never been allocated
+// failures   - Number of allocations that failed due to lack of memory
+//
+// The equeue_stats function is irq safe.
+struct equeue_stats {
+    size_t size;
+    size_t used;
+    size_t max_used;
+    size_t fragmented;
+    size_t slab;
+    unsigned failures;
+};
+
+void equeue_stats(equeue_t *queue, struct equeue_stats *stats);
+
 // Configure an allocated event
 //
 // equeue_event_delay  - Millisecond delay before dispatching an event
@@ -168,7 +250,10 @@ void equeue_event_dtor(void *event, void (*dtor)(void *));
 // as its argument.
 //
 // The equeue_post function is irq safe and can act as a mechanism for
-// moving events out of irq contexts.
+// moving events out of irq contexts. Events without a delay posted to a
+// queue that is not backgrounded are pushed onto a lock-free incoming list
+// that the dispatch loop drains, so posting from an irq does not need to
+// hold off interrupts while the queue is sorted.
 //
 // The return value is a unique id that represents the posted event and can
 // be passed to equeue_cancel.
@@ -187,6 +272,16 @@ int equeue_post(equeue_t *queue, void (*cb)(void *), void *event);
 // the event may have already begun executing.
 void equeue_cancel(equeue_t *queue, int id);
 
+// Query how long until an event is dispatched
+//
+// Returns the number of milliseconds until the event referenced by the unique
+// id is dispatched. Returns a negative value if the event has already begun
+// executing, or the event has already been dispatched or cancelled.
+//
+// The equeue_timeleft function is irq safe, and can be used to coalesce
+// repeated posts of an event that has not yet executed.
+int equeue_timeleft(equeue_t *queue, int id);
+
 // Background an event queue onto a single-shot timer
 //
 // The provided update function will be called to indicate when the queue
@@ -82,6 +82,16 @@ void equeue_mutex_unlock(equeue_mutex_t *m) {
 }
 
 
+// Atomic operations
+bool equeue_atomic_cas(unsigned *ptr, unsigned expected, unsigned desired) {
+    MBED_STATIC_ASSERT(sizeof(unsigned) == sizeof(uint32_t),
+            "The equeue_atomic_cas relies on unsigned being 32-bits");
+    uint32_t current = expected;
+    return core_util_atomic_cas_u32(
+            reinterpret_cast<uint32_t*>(ptr), &current, desired);
+}
+
+
 // Semaphore operations
 #ifdef MBED_CONF_RTOS_PRESENT
 
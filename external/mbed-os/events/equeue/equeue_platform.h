@@ -94,6 +94,18 @@ void equeue_mutex_lock(equeue_mutex_t *mutex);
 void equeue_mutex_unlock(equeue_mutex_t *mutex);
 
 
+// Platform atomic operations
+//
+// The equeue_atomic_cas function atomically compares the value at ptr with
+// the expected value, and if they are equal, replaces it with the desired
+// value. Returns true if the value was replaced.
+//
+// The equeue_atomic_cas function must be safe in interrupt contexts and acts
+// as a full memory barrier. On cores without exclusive access instructions
+// it may simply be implemented with a short critical section.
+bool equeue_atomic_cas(unsigned *ptr, unsigned expected, unsigned desired);
+
+
 // Platform semaphore type
 //
 // The equeue library requires a binary semaphore type that can be safely
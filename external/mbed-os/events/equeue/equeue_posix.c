@@ -50,6 +50,12 @@ void equeue_mutex_unlock(equeue_mutex_t *m) {
 }
 
 
+// Atomic operations
+bool equeue_atomic_cas(unsigned *ptr, unsigned expected, unsigned desired) {
+    return __sync_bool_compare_and_swap(ptr, expected, desired);
+}
+
+
 // Semaphore operations
 int equeue_sema_create(equeue_sema_t *s) {
     int err = pthread_mutex_init(&s->mutex, 0);
@@ -0,0 +1,247 @@
+/*
+ * Host test of coalesced Event posts, over the posix equeue port
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * A post that folds into a pending one returns the pending post's id, also
+ * while the pending post is still being queued by another thread, and when
+ * several threads post at once. A periodic coalesced event stays
+ * pending while it repeats, so posting it again neither queues a second
+ * copy nor changes its id, until it is cancelled.
+ */
+#include "events/mbed_events.h"
+#include "host_test.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+
+#define POSTERS         4
+#define ROUNDS          20000
+#define PERIOD          10
+
+static volatile int counter;
+
+static void count()
+{
+    counter++;
+}
+
+
+// One thread
+static void test_fold()
+{
+    EventQueue queue(2048);
+    Event<void()> e(&queue, count);
+    e.coalesce(true);
+    counter = 0;
+
+    int id = e.post();
+    check(id);
+    check(e.post() == id);
+    check(e.post() == id);
+    queue.dispatch(0);
+    check(counter == 1);
+
+    // the next post is a new one, whose id later posts return
+    int next = e.post();
+    check(next && next != id);
+    check(e.post() == next);
+    queue.dispatch(0);
+    check(counter == 2);
+
+    // a cancelled post is no longer pending
+    id = e.post();
+    e.cancel();
+    next = e.post();
+    check(next && next != id);
+    queue.dispatch(0);
+    check(counter == 3);
+}
+
+static void test_periodic()
+{
+    EventQueue queue(2048);
+    Event<void()> e(&queue, count);
+    e.period(PERIOD);
+    e.coalesce(true);
+    counter = 0;
+
+    int id = e.post();
+    check(id);
+    queue.dispatch(5*PERIOD + PERIOD/2);
+    check(counter >= 3 && counter <= 6);
+
+    // still pending after it has run, so posts fold into it
+    check(queue.time_left(id) >= 0);
+    for (int i = 0; i < 4; i++) {
+        check(e.post() == id);
+    }
+    counter = 0;
+    queue.dispatch(5*PERIOD + PERIOD/2);
+    check(counter >= 3 && counter <= 7);
+
+    // cancelling it ends it, and the next post starts a new one
+    e.cancel();
+    counter = 0;
+    queue.dispatch(3*PERIOD);
+    check(counter == 0);
+
+    int next = e.post();
+    check(next && next != id);
+    check(e.post() == next);
+    queue.dispatch(2*PERIOD + PERIOD/2);
+    check(counter >= 1 && counter <= 3);
+    e.cancel();
+}
+
+
+// Several threads
+class LockableQueue : public EventQueue {
+public:
+    LockableQueue() : EventQueue(2048) {
+    }
+
+    size_t used() {
+        struct equeue_stats stats;
+        equeue_stats(&_equeue, &stats);
+        return stats.used;
+    }
+
+    // Holds up delayed posts once they have claimed their event
+    void lock() {
+        equeue_mutex_lock(&_equeue.queuelock);
+    }
+
+    void unlock() {
+        equeue_mutex_unlock(&_equeue.queuelock);
+    }
+};
+
+static void *post_one(void *arg)
+{
+    Event<void()> *e = (Event<void()> *)arg;
+    return (void *)(intptr_t)e->post();
+}
+
+static void test_post_window()
+{
+    LockableQueue queue;
+    Event<void()> e(&queue, count);
+    e.delay(1);
+    e.coalesce(true);
+    counter = 0;
+
+    int first = e.post();
+    queue.dispatch(10);
+    check(counter == 1);
+
+    // another thread's post is pending but not yet queued, so it has not
+    // returned its id to the event
+    size_t used = queue.used();
+    queue.lock();
+    pthread_t thread;
+    pthread_create(&thread, NULL, post_one, &e);
+    while (queue.used() == used) {
+        sched_yield();
+    }
+    usleep(10000);
+    int id = e.post();
+    queue.unlock();
+
+    void *posted;
+    pthread_join(thread, &posted);
+    check(id && id != first);
+    check(id == (int)(intptr_t)posted);
+    queue.dispatch(10);
+    check(counter == 2);
+}
+
+struct Posters {
+    Event<void()> *e;
+    pthread_barrier_t start;
+    pthread_barrier_t done;
+    int ids[POSTERS];
+};
+
+static Posters posters;
+
+static void *poster(void *arg)
+{
+    int i = (int)(intptr_t)arg;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        pthread_barrier_wait(&posters.start);
+        posters.ids[i] = posters.e->post();
+        if (i % 2) {
+            sched_yield();
+        }
+        pthread_barrier_wait(&posters.done);
+    }
+    return NULL;
+}
+
+// Every thread that posts in a round gets the id of the one post queued
+static void test_threads()
+{
+    EventQueue queue(2048);
+    Event<void()> e(&queue, count);
+    e.coalesce(true);
+    counter = 0;
+
+    posters.e = &e;
+    pthread_barrier_init(&posters.start, NULL, POSTERS + 1);
+    pthread_barrier_init(&posters.done, NULL, POSTERS + 1);
+
+    pthread_t threads[POSTERS];
+    for (int i = 0; i < POSTERS; i++) {
+        pthread_create(&threads[i], NULL, poster, (void *)(intptr_t)i);
+    }
+
+    int mismatched = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        pthread_barrier_wait(&posters.start);
+        pthread_barrier_wait(&posters.done);
+
+        for (int i = 1; i < POSTERS; i++) {
+            if (!posters.ids[i] || posters.ids[i] != posters.ids[0]) {
+                mismatched++;
+            }
+        }
+        queue.dispatch(0);
+        if (counter != round + 1) {
+            mismatched++;
+            counter = round + 1;
+        }
+    }
+
+    for (int i = 0; i < POSTERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_barrier_destroy(&posters.start);
+    pthread_barrier_destroy(&posters.done);
+
+    printf("%d rounds of %d threads posting at once\n", ROUNDS, POSTERS);
+    check(mismatched == 0);
+}
+
+int main()
+{
+    test_fold();
+    test_periodic();
+    test_post_window();
+    test_threads();
+
+    return host_test_done();
+}
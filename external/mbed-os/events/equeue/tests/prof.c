@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <inttypes.h>
 #include <sys/time.h>
+#include <pthread.h>
 
 
 // Performance measurement utils
@@ -67,7 +68,11 @@ static const char *prof_units;
 })
 
 #define prof_measure(func, ...) ({                                          \
-    printf("%s: ...", #func);                                               \
+    char prof_name[64];                                                     \
+    snprintf(prof_name, sizeof(prof_name), "%s%s%s%s", #func,              \
+            *#__VA_ARGS__ ? "(" : "", #__VA_ARGS__,                         \
+            *#__VA_ARGS__ ? ")" : "");                                      \
+    printf("%s: ...", prof_name);                                           \
     fflush(stdout);                                                         \
                                                                             \
     prof_units = "cycles";                                                  \
@@ -86,11 +91,11 @@ static const char *prof_units;
         }                                                                   \
     }                                                                       \
     res -= prof_baseline_cycle;                                             \
-    printf("\r%s: %"PRIu64" %s", #func, res, prof_units);                   \
+    printf("\r%s: %"PRIu64" %s", prof_name, res, prof_units);               \
                                                                             \
     if (!isatty(0)) {                                                       \
         prof_cycle_t prev;                                                  \
-        while (scanf("%*[^0-9]%"PRIu64, &prev) == 0);                       \
+        while (scanf("%*[^:]:%"PRIu64, &prev) == 0);                        \
         int64_t perc = 100*((int64_t)prev - (int64_t)res) / (int64_t)prev;  \
                                                                             \
         if (perc > 10) {                                                    \
@@ -175,6 +180,31 @@ void equeue_alloc_many_prof(int count) {
     equeue_destroy(&q);
 }
 
+void equeue_alloc_sizes_prof(int count) {
+    struct equeue q;
+    equeue_create(&q, count*(EQUEUE_EVENT_SIZE + count*sizeof(int)));
+
+    void *es[count];
+
+    for (int i = 0; i < count; i++) {
+        es[i] = equeue_alloc(&q, (8+i) * sizeof(int));
+    }
+
+    for (int i = 0; i < count; i++) {
+        equeue_dealloc(&q, es[i]);
+    }
+
+    prof_loop() {
+        prof_start();
+        void *e = equeue_alloc(&q, (8+count-1) * sizeof(int));
+        prof_stop();
+
+        equeue_dealloc(&q, e);
+    }
+
+    equeue_destroy(&q);
+}
+
 void equeue_post_prof(void) {
     struct equeue q;
     equeue_create(&q, EQUEUE_EVENT_SIZE);
@@ -253,6 +283,33 @@ void equeue_post_future_many_prof(int count) {
     equeue_destroy(&q);
 }
 
+void equeue_post_scattered_prof(int count) {
+    struct equeue q;
+    equeue_create(&q, count*EQUEUE_EVENT_SIZE);
+
+    unsigned seed = 1;
+    for (int i = 0; i < count-1; i++) {
+        seed = seed*1103515245 + 12345;
+        void *e = equeue_alloc(&q, 0);
+        equeue_event_delay(e, 1000 + (seed >> 16) % count);
+        equeue_post(&q, no_func, e);
+    }
+
+    prof_loop() {
+        seed = seed*1103515245 + 12345;
+        void *e = equeue_alloc(&q, 0);
+        equeue_event_delay(e, 1000 + (seed >> 16) % count);
+
+        prof_start();
+        int id = equeue_post(&q, no_func, e);
+        prof_stop();
+
+        equeue_cancel(&q, id);
+    }
+
+    equeue_destroy(&q);
+}
+
 void equeue_dispatch_prof(void) {
     struct equeue q;
     equeue_create(&q, EQUEUE_EVENT_SIZE);
@@ -285,6 +342,60 @@ void equeue_dispatch_many_prof(int count) {
     equeue_destroy(&q);
 }
 
+void equeue_dispatch_periodic_prof(int count) {
+    struct equeue q;
+    equeue_create(&q, count*EQUEUE_EVENT_SIZE);
+
+    for (int i = 0; i < count; i++) {
+        equeue_call_every(&q, 0, no_func, 0);
+    }
+
+    prof_loop() {
+        prof_start();
+        equeue_dispatch(&q, 0);
+        prof_stop();
+    }
+
+    equeue_destroy(&q);
+}
+
+void equeue_burst_prof(int count) {
+    struct equeue q;
+    equeue_create(&q, count*EQUEUE_EVENT_SIZE);
+
+    prof_loop() {
+        prof_start();
+        for (int i = 0; i < count; i++) {
+            equeue_call(&q, no_func, 0);
+        }
+
+        equeue_dispatch(&q, 0);
+        prof_stop();
+    }
+
+    equeue_destroy(&q);
+}
+
+void equeue_burst_coalesced_prof(int count) {
+    struct equeue q;
+    equeue_create(&q, count*EQUEUE_EVENT_SIZE);
+
+    int id = 0;
+    prof_loop() {
+        prof_start();
+        for (int i = 0; i < count; i++) {
+            if (equeue_timeleft(&q, id) < 0) {
+                id = equeue_call(&q, no_func, 0);
+            }
+        }
+
+        equeue_dispatch(&q, 0);
+        prof_stop();
+    }
+
+    equeue_destroy(&q);
+}
+
 void equeue_cancel_prof(void) {
     struct equeue q;
     equeue_create(&q, EQUEUE_EVENT_SIZE);
@@ -319,6 +430,88 @@ void equeue_cancel_many_prof(int count) {
     equeue_destroy(&q);
 }
 
+void equeue_cancel_scattered_prof(int count) {
+    struct equeue q;
+    equeue_create(&q, count*EQUEUE_EVENT_SIZE);
+
+    unsigned seed = 1;
+    for (int i = 0; i < count-1; i++) {
+        seed = seed*1103515245 + 12345;
+        void *e = equeue_alloc(&q, 0);
+        equeue_event_delay(e, 1000 + (seed >> 16) % count);
+        equeue_post(&q, no_func, e);
+    }
+
+    prof_loop() {
+        seed = seed*1103515245 + 12345;
+        void *e = equeue_alloc(&q, 0);
+        equeue_event_delay(e, 1000 + (seed >> 16) % count);
+        int id = equeue_post(&q, no_func, e);
+
+        prof_start();
+        equeue_cancel(&q, id);
+        prof_stop();
+    }
+
+    equeue_destroy(&q);
+}
+
+struct prof_producer {
+    pthread_t thread;
+    struct equeue *q;
+    prof_cycle_t cycles;
+    int count;
+};
+
+static void *prof_producer_thread(void *p) {
+    struct prof_producer *t = (struct prof_producer *)p;
+    t->cycles = 0;
+    for (int i = 0; i < t->count;) {
+        prof_cycle_t start = prof_cycle();
+        int id = equeue_call(t->q, no_func, 0);
+        t->cycles += prof_cycle() - start;
+
+        if (id) {
+            i++;
+        }
+    }
+    return 0;
+}
+
+static void *prof_dispatch_thread(void *p) {
+    equeue_dispatch((struct equeue *)p, -1);
+    return 0;
+}
+
+void equeue_post_multithread_prof(int threads) {
+    struct equeue q;
+    equeue_create(&q, 1000*EQUEUE_EVENT_SIZE);
+
+    pthread_t dispatcher;
+    pthread_create(&dispatcher, 0, prof_dispatch_thread, &q);
+
+    struct prof_producer producers[threads];
+    for (int i = 0; i < threads; i++) {
+        producers[i].q = &q;
+        producers[i].count = 100000;
+        pthread_create(&producers[i].thread, 0,
+                prof_producer_thread, &producers[i]);
+    }
+
+    prof_cycle_t cycles = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(producers[i].thread, 0);
+        cycles += producers[i].cycles;
+    }
+
+    equeue_break(&q);
+    pthread_join(dispatcher, 0);
+
+    prof_result(cycles / (threads*100000), "cycles");
+
+    equeue_destroy(&q);
+}
+
 void equeue_alloc_size_prof(void) {
     size_t size = 32*EQUEUE_EVENT_SIZE;
 
@@ -394,11 +587,27 @@ int main() {
     prof_measure(equeue_cancel_prof);
 
     prof_measure(equeue_alloc_many_prof, 1000);
+    prof_measure(equeue_alloc_sizes_prof, 100);
     prof_measure(equeue_post_many_prof, 1000);
     prof_measure(equeue_post_future_many_prof, 1000);
     prof_measure(equeue_dispatch_many_prof, 100);
+    prof_measure(equeue_dispatch_periodic_prof, 100);
+    prof_measure(equeue_burst_prof, 100);
+    prof_measure(equeue_burst_coalesced_prof, 100);
     prof_measure(equeue_cancel_many_prof, 100);
 
+    prof_measure(equeue_post_scattered_prof, 10);
+    prof_measure(equeue_post_scattered_prof, 100);
+    prof_measure(equeue_post_scattered_prof, 1000);
+    prof_measure(equeue_post_scattered_prof, 10000);
+    prof_measure(equeue_cancel_scattered_prof, 10);
+    prof_measure(equeue_cancel_scattered_prof, 100);
+    prof_measure(equeue_cancel_scattered_prof, 1000);
+    prof_measure(equeue_cancel_scattered_prof, 10000);
+
+    prof_measure(equeue_post_multithread_prof, 1);
+    prof_measure(equeue_post_multithread_prof, 4);
+
     prof_measure(equeue_alloc_size_prof);
     prof_measure(equeue_alloc_many_size_prof, 1000);
     prof_measure(equeue_alloc_fragmented_size_prof, 1000);
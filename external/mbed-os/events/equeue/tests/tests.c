@@ -132,6 +132,21 @@ void nest_func(void *p) {
     usleep(10000);
 }
 
+struct order {
+    unsigned *targets;
+    int *indices;
+    int *count;
+    int index;
+};
+
+void order_func(void *p) {
+    struct order *order = (struct order *)p;
+    struct equeue_event *e = (struct equeue_event *)p - 1;
+    order->targets[*order->count] = e->target;
+    order->indices[*order->count] = order->index;
+    (*order->count)++;
+}
+
 
 // Simple call tests
 void simple_call_test(void) {
@@ -269,6 +284,109 @@ void allocation_failure_test(void) {
     equeue_destroy(&q);
 }
 
+void stats_test(void) {
+    equeue_t q;
+    int err = equeue_create(&q, 2048);
+    test_assert(!err);
+
+    struct equeue_stats stats;
+    equeue_stats(&q, &stats);
+    test_assert(stats.size == 2048);
+    test_assert(stats.used == 0 && stats.max_used == 0);
+    test_assert(stats.fragmented == 0 && stats.slab == 2048);
+    test_assert(stats.failures == 0);
+
+    void *e1 = equeue_alloc(&q, 8);
+    void *e2 = equeue_alloc(&q, 128);
+    test_assert(e1 && e2);
+
+    equeue_stats(&q, &stats);
+    size_t used = stats.used;
+    test_assert(used >= 8 + 128 + 2*sizeof(struct equeue_event));
+    test_assert(stats.max_used == used);
+    test_assert(stats.fragmented == 0 && stats.slab == 2048 - used);
+
+    equeue_dealloc(&q, e1);
+    equeue_stats(&q, &stats);
+    test_assert(stats.used < used && stats.max_used == used);
+    test_assert(stats.fragmented == used - stats.used);
+
+    void *e3 = equeue_alloc(&q, 4096);
+    test_assert(!e3);
+    equeue_stats(&q, &stats);
+    test_assert(stats.failures == 1);
+
+    equeue_dealloc(&q, e2);
+    equeue_stats(&q, &stats);
+    test_assert(stats.used == 0 && stats.max_used == used);
+
+    equeue_destroy(&q);
+}
+
+void coalesce_test(int N) {
+    equeue_t q;
+    int err = equeue_create(&q, N*EQUEUE_EVENT_SIZE);
+    test_assert(!err);
+
+    void **es = malloc(N*sizeof(void*));
+    for (int i = 0; i < N; i++) {
+        es[i] = equeue_alloc(&q, (i % 4) * sizeof(int));
+        test_assert(es[i]);
+    }
+
+    for (int i = 0; i < N; i += 2) {
+        equeue_dealloc(&q, es[i]);
+    }
+
+    for (int i = 1; i < N; i += 2) {
+        equeue_dealloc(&q, es[i]);
+    }
+
+    free(es);
+
+    void *e = equeue_alloc(&q, (N/2)*EQUEUE_EVENT_SIZE);
+    test_assert(e);
+
+    struct equeue_stats stats;
+    equeue_stats(&q, &stats);
+    test_assert(stats.failures == 0);
+
+    equeue_dealloc(&q, e);
+    e = equeue_alloc(&q, N*EQUEUE_EVENT_SIZE - sizeof(struct equeue_event));
+    test_assert(e);
+
+    equeue_destroy(&q);
+}
+
+void coalesce_cancel_test(void) {
+    equeue_t q;
+    int err = equeue_create(&q, 2048);
+    test_assert(!err);
+
+    // dispatch an event, so its chunk is freed with a stale id
+    int old_count = 0;
+    int old_id = equeue_call(&q, simple_func, &old_count);
+    test_assert(old_id);
+    equeue_dispatch(&q, 0);
+    test_assert(old_count == 1);
+
+    // an allocation that only fits after the chunk is returned to the slab
+    // reuses its memory
+    int new_count = 0;
+    struct indirect *i = equeue_alloc(&q, 2048 - sizeof(struct equeue_event));
+    test_assert(i);
+    i->touched = &new_count;
+    int new_id = equeue_post(&q, indirect_func, i);
+    test_assert(new_id != old_id);
+
+    // cancelling the stale id must not cancel the new event
+    equeue_cancel(&q, old_id);
+    equeue_dispatch(&q, 0);
+    test_assert(new_count == 1);
+
+    equeue_destroy(&q);
+}
+
 void cancel_test(int N) {
     equeue_t q;
     int err = equeue_create(&q, 2048);
@@ -293,6 +411,135 @@ void cancel_test(int N) {
     equeue_destroy(&q);
 }
 
+void order_test(int N) {
+    equeue_t q;
+    int err = equeue_create(&q, N*(EQUEUE_EVENT_SIZE+sizeof(struct order)));
+    test_assert(!err);
+
+    unsigned *targets = malloc(N*sizeof(unsigned));
+    int *indices = malloc(N*sizeof(int));
+    int *ids = malloc(N*sizeof(int));
+    int count = 0;
+
+    for (int i = 0; i < N; i++) {
+        struct order *order = equeue_alloc(&q, sizeof(struct order));
+        test_assert(order);
+
+        order->targets = targets;
+        order->indices = indices;
+        order->count = &count;
+        order->index = i;
+        equeue_event_delay(order, (i*7) % 5);
+
+        ids[i] = equeue_post(&q, order_func, order);
+        test_assert(ids[i]);
+    }
+
+    for (int i = 0; i < N; i += 3) {
+        equeue_cancel(&q, ids[i]);
+    }
+
+    equeue_dispatch(&q, 10);
+    test_assert(count == N - (N+2)/3);
+
+    for (int i = 1; i < count; i++) {
+        test_assert(targets[i-1] <= targets[i]);
+        test_assert(targets[i-1] != targets[i] || indices[i-1] < indices[i]);
+    }
+
+    free(targets);
+    free(indices);
+    free(ids);
+
+    equeue_destroy(&q);
+}
+
+void order_wrap_test(int N) {
+    equeue_t q;
+    int err = equeue_create(&q, 2048);
+    test_assert(!err);
+
+    unsigned targets[2];
+    int indices[2];
+    int count = 0;
+    unsigned target = 0;
+
+    for (int i = 0; i < 2; i++) {
+        if (i == 1) {
+            // insert and remove more events than a 16-bit sequence holds
+            for (int j = 0; j < N; j++) {
+                int id = equeue_call_in(&q, 1000, pass_func, 0);
+                test_assert(id);
+                equeue_cancel(&q, id);
+            }
+        }
+
+        // both events are due at the same tick, so post again if the tick
+        // moved on during the post
+        int id = 0;
+        while (!id) {
+            struct order *order = equeue_alloc(&q, sizeof(struct order));
+            test_assert(order);
+
+            order->targets = targets;
+            order->indices = indices;
+            order->count = &count;
+            order->index = i;
+
+            unsigned tick = equeue_tick();
+            if (i == 0) {
+                target = tick + 100;
+            }
+            equeue_event_delay(order, target - tick);
+
+            id = equeue_post(&q, order_func, order);
+            test_assert(id);
+            if (equeue_tick() != tick) {
+                equeue_cancel(&q, id);
+                id = 0;
+            }
+        }
+    }
+
+    equeue_dispatch(&q, 200);
+    test_assert(count == 2);
+    test_assert(targets[0] == targets[1]);
+    test_assert(indices[0] == 0 && indices[1] == 1);
+
+    equeue_destroy(&q);
+}
+
+void timeleft_test(void) {
+    equeue_t q;
+    int err = equeue_create(&q, 2048);
+    test_assert(!err);
+
+    int touched = 0;
+    int id1 = equeue_call(&q, simple_func, &touched);
+    int id2 = equeue_call_in(&q, 100, simple_func, &touched);
+    int id3 = equeue_call_every(&q, 100, simple_func, &touched);
+    test_assert(id1 && id2 && id3);
+
+    test_assert(equeue_timeleft(&q, 0) < 0);
+    test_assert(equeue_timeleft(&q, id1) == 0);
+    int ms = equeue_timeleft(&q, id2);
+    test_assert(ms > 90 && ms <= 100);
+
+    equeue_dispatch(&q, 0);
+    test_assert(touched == 1);
+    test_assert(equeue_timeleft(&q, id1) < 0);
+    test_assert(equeue_timeleft(&q, id2) > 0);
+
+    equeue_cancel(&q, id2);
+    test_assert(equeue_timeleft(&q, id2) < 0);
+
+    equeue_dispatch(&q, 110);
+    test_assert(touched == 2);
+    test_assert(equeue_timeleft(&q, id3) > 0);
+
+    equeue_destroy(&q);
+}
+
 void cancel_inflight_test(void) {
     equeue_t q;
     int err = equeue_create(&q, 2048);
@@ -595,6 +842,65 @@ void unchain_test(void) {
     equeue_destroy(&q2);
 }
 
+struct producer {
+    pthread_t thread;
+    equeue_t *q;
+    int *touched;
+    int N;
+};
+
+static void *producer_thread(void *p) {
+    struct producer *t = (struct producer *)p;
+    for (int i = 0; i < t->N; i++) {
+        while (!equeue_call(t->q, simple_func, t->touched)) {
+            usleep(100);
+        }
+    }
+    return 0;
+}
+
+static void break_func(void *p) {
+    equeue_break((equeue_t *)p);
+}
+
+void multiproducer_test(int N) {
+    equeue_t q;
+    int err = equeue_create(&q, 64*EQUEUE_EVENT_SIZE);
+    test_assert(!err);
+
+    int touched = 0;
+    pthread_t thread;
+    err = pthread_create(&thread, 0, multithread_thread, &q);
+    test_assert(!err);
+
+    struct producer producers[4];
+    for (int i = 0; i < 4; i++) {
+        producers[i].q = &q;
+        producers[i].touched = &touched;
+        producers[i].N = N;
+        err = pthread_create(&producers[i].thread, 0,
+                producer_thread, &producers[i]);
+        test_assert(!err);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        err = pthread_join(producers[i].thread, 0);
+        test_assert(!err);
+    }
+
+    int id = 0;
+    while (!id) {
+        id = equeue_call(&q, break_func, &q);
+    }
+
+    err = pthread_join(thread, 0);
+    test_assert(!err);
+
+    test_assert(touched == 4*N);
+
+    equeue_destroy(&q);
+}
+
 // Barrage tests
 void simple_barrage_test(int N) {
     equeue_t q;
@@ -697,8 +1003,16 @@ int main() {
     test_run(simple_post_test);
     test_run(destructor_test);
     test_run(allocation_failure_test);
+    test_run(stats_test);
+#ifdef EQUEUE_COALESCE
+    test_run(coalesce_test, 20);
+    test_run(coalesce_cancel_test);
+#endif
     test_run(cancel_test, 20);
+    test_run(order_test, 200);
+    test_run(order_wrap_test, 40000);
     test_run(cancel_inflight_test);
+    test_run(timeleft_test);
     test_run(cancel_unnecessarily_test);
     test_run(loop_protect_test);
     test_run(break_test);
@@ -709,6 +1023,7 @@ int main() {
     test_run(chain_test);
     test_run(unchain_test);
     test_run(multithread_test);
+    test_run(multiproducer_test, 10000);
     test_run(simple_barrage_test, 20);
     test_run(fragmenting_barrage_test, 20);
     test_run(multithreaded_barrage_test, 20);
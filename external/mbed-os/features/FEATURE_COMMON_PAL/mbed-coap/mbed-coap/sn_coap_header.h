@@ -304,6 +304,41 @@ typedef struct sn_nsdl_addr_ {
  */
 extern sn_coap_hdr_s *sn_coap_parser(struct coap_s *handle, uint16_t packet_data_len, uint8_t *packet_data_ptr, coap_version_e *coap_version_ptr);
 
+/**
+ * \brief Arena size that is always enough for sn_coap_parser_zero_copy() to parse a packet of given length
+ */
+#define SN_COAP_PARSER_ARENA_SIZE(packet_data_len) \
+    (sizeof(sn_coap_hdr_s) + sizeof(sn_coap_options_list_s) + 2 * sizeof(void *) + (packet_data_len))
+
+/**
+ * \fn sn_coap_hdr_s *sn_coap_parser_zero_copy(uint16_t packet_data_len, uint8_t *packet_data_ptr, coap_version_e *coap_version_ptr, uint8_t *arena_ptr, uint16_t arena_len)
+ *
+ * \brief Parses CoAP message from given Packet data without heap allocations
+ *
+ *        The message structure, its options and any repeated option that has to be
+ *        joined from several parts are placed in the given arena. Token, payload and
+ *        all other options point to the Packet data, which must outlive the message.
+ *
+ *        Note!!! The message must not be released with sn_coap_parser_release_allocated_coap_msg_mem(),
+ *        the arena can be reused once the message is no longer needed.
+ *
+ * \param packet_data_len is length of given Packet data to be parsed to CoAP message
+ *
+ * \param *packet_data_ptr is source for Packet data to be parsed to CoAP message
+ *
+ * \param *coap_version_ptr is destination for parsed CoAP specification version
+ *
+ * \param *arena_ptr is memory for the parsed message
+ *
+ * \param arena_len is length of the arena, SN_COAP_PARSER_ARENA_SIZE(packet_data_len) is always enough
+ *
+ * \return Return value is pointer to parsed CoAP message.\n
+ *         In following failure cases NULL is returned:\n
+ *          -Failure in given pointer (= NULL)\n
+ *          -Arena too small for the message structure
+ */
+extern sn_coap_hdr_s *sn_coap_parser_zero_copy(uint16_t packet_data_len, uint8_t *packet_data_ptr, coap_version_e *coap_version_ptr, uint8_t *arena_ptr, uint16_t arena_len);
+
 /**
  * \fn void sn_coap_parser_release_allocated_coap_msg_mem(struct coap_s *handle, sn_coap_hdr_s *freed_coap_msg_ptr)
  *
@@ -362,6 +397,29 @@ extern uint16_t sn_coap_builder_calc_needed_packet_data_size(sn_coap_hdr_s *src_
  */
 extern int16_t sn_coap_builder_2(uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, uint16_t blockwise_payload_size);
 
+/**
+ * \fn int16_t sn_coap_builder_3(uint8_t *dst_packet_data_ptr, uint16_t dst_packet_data_len, sn_coap_hdr_s *src_coap_msg_ptr, uint16_t blockwise_payload_size)
+ *
+ * \brief Builds an outgoing message into a buffer of given size.
+ *
+ *        Unlike sn_coap_builder_2() the buffer does not need to be sized with
+ *        sn_coap_builder_calc_needed_packet_data_size_2() first.
+ *
+ * \param *dst_packet_data_ptr is pointer to destination buffer for built CoAP packet
+ *
+ * \param dst_packet_data_len is size of the destination buffer
+ *
+ * \param *src_coap_msg_ptr is pointer to source structure for building Packet data
+ *
+ * \param blockwise_payload_size Blockwise message maximum payload size
+ *
+ * \return Return value is byte count of built Packet data. In failure cases:\n
+ *          -1 = Failure in given CoAP header structure\n
+ *          -2 = Failure in given pointer (= NULL)\n
+ *          -3 = Destination buffer too small
+ */
+extern int16_t sn_coap_builder_3(uint8_t *dst_packet_data_ptr, uint16_t dst_packet_data_len, sn_coap_hdr_s *src_coap_msg_ptr, uint16_t blockwise_payload_size);
+
 /**
  * \fn uint16_t sn_coap_builder_calc_needed_packet_data_size_2(sn_coap_hdr_s *src_coap_msg_ptr, uint16_t blockwise_payload_size)
  *
@@ -391,6 +449,22 @@ extern uint16_t sn_coap_builder_calc_needed_packet_data_size_2(sn_coap_hdr_s *sr
  */
 extern sn_coap_hdr_s *sn_coap_build_response(struct coap_s *handle, sn_coap_hdr_s *coap_packet_ptr, uint8_t msg_code);
 
+/**
+ * \fn int8_t sn_coap_build_response_zero_copy(sn_coap_hdr_s *coap_res_ptr, sn_coap_hdr_s *coap_packet_ptr, uint8_t msg_code)
+ *
+ * \brief Prepares generic response packet from a request packet in a caller provided sn_coap_hdr_s
+ *
+ *        The response token points to the token of the request, so the request must
+ *        outlive the response. Nothing is allocated.
+ *
+ * \param *coap_res_ptr The response packet to fill in
+ * \param *coap_packet_ptr The request packet pointer
+ * \param msg_code response messages code
+ *
+ * \return 0 on success, -1 on error in the request
+ */
+extern int8_t sn_coap_build_response_zero_copy(sn_coap_hdr_s *coap_res_ptr, sn_coap_hdr_s *coap_packet_ptr, uint8_t msg_code);
+
 /**
  * \brief Initialise a message structure to empty
  *
@@ -37,6 +37,7 @@
 
 #define TRACE_GROUP "coap"
 /* * * * LOCAL FUNCTION PROTOTYPES * * * */
+static int16_t  sn_coap_builder_build(uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, uint16_t dst_byte_count_to_be_built);
 static int8_t   sn_coap_builder_header_build(uint8_t **dst_packet_data_pptr, sn_coap_hdr_s *src_coap_msg_ptr);
 static int8_t   sn_coap_builder_options_build(uint8_t **dst_packet_data_pptr, sn_coap_hdr_s *src_coap_msg_ptr);
 static uint16_t sn_coap_builder_options_calc_option_size(uint16_t query_len, uint8_t *query_ptr, sn_coap_option_numbers_e option);
@@ -57,11 +58,35 @@ sn_coap_hdr_s *sn_coap_build_response(struct coap_s *handle, sn_coap_hdr_s *coap
         return NULL;
     }
 
-    coap_res_ptr = sn_coap_parser_alloc_message(handle);
+    coap_res_ptr = handle->sn_coap_protocol_malloc(sizeof(sn_coap_hdr_s));
     if (!coap_res_ptr) {
         return NULL;
     }
 
+    if (sn_coap_build_response_zero_copy(coap_res_ptr, coap_packet_ptr, msg_code) != 0) {
+        handle->sn_coap_protocol_free( coap_res_ptr );
+        return NULL;
+    }
+
+    if (coap_packet_ptr->token_ptr) {
+        coap_res_ptr->token_ptr = handle->sn_coap_protocol_malloc(coap_res_ptr->token_len);
+        if (!coap_res_ptr->token_ptr) {
+            handle->sn_coap_protocol_free(coap_res_ptr);
+            return NULL;
+        }
+        memcpy(coap_res_ptr->token_ptr, coap_packet_ptr->token_ptr, coap_res_ptr->token_len);
+    }
+    return coap_res_ptr;
+}
+
+int8_t sn_coap_build_response_zero_copy(sn_coap_hdr_s *coap_res_ptr, sn_coap_hdr_s *coap_packet_ptr, uint8_t msg_code)
+{
+    if (!coap_res_ptr || !coap_packet_ptr) {
+        return -1;
+    }
+
+    sn_coap_parser_init_message(coap_res_ptr);
+
     if (coap_packet_ptr->msg_type == COAP_MSG_TYPE_CONFIRMABLE) {
         coap_res_ptr->msg_type = COAP_MSG_TYPE_ACKNOWLEDGEMENT;
         coap_res_ptr->msg_code = (sn_coap_msg_code_e)msg_code;
@@ -75,20 +100,15 @@ sn_coap_hdr_s *sn_coap_build_response(struct coap_s *handle, sn_coap_hdr_s *coap
     }
 
     else {
-        handle->sn_coap_protocol_free( coap_res_ptr );
-        return NULL;
+        return -1;
     }
 
+    /* The response shares the token of the request */
     if (coap_packet_ptr->token_ptr) {
         coap_res_ptr->token_len = coap_packet_ptr->token_len;
-        coap_res_ptr->token_ptr = handle->sn_coap_protocol_malloc(coap_res_ptr->token_len);
-        if (!coap_res_ptr->token_ptr) {
-            handle->sn_coap_protocol_free(coap_res_ptr);
-            return NULL;
-        }
-        memcpy(coap_res_ptr->token_ptr, coap_packet_ptr->token_ptr, coap_res_ptr->token_len);
+        coap_res_ptr->token_ptr = coap_packet_ptr->token_ptr;
     }
-    return coap_res_ptr;
+    return 0;
 }
 
 int16_t sn_coap_builder(uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr)
@@ -99,20 +119,52 @@ int16_t sn_coap_builder(uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_ms
 int16_t sn_coap_builder_2(uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, uint16_t blockwise_payload_size)
 {
     tr_debug("sn_coap_builder_2");
-    uint8_t *base_packet_data_ptr = NULL;
 
     /* * * * Check given pointers  * * * */
     if (dst_packet_data_ptr == NULL || src_coap_msg_ptr == NULL) {
         return -2;
     }
 
-    /* Initialize given Packet data memory area with zero values */
     uint16_t dst_byte_count_to_be_built = sn_coap_builder_calc_needed_packet_data_size_2(src_coap_msg_ptr, blockwise_payload_size);
     tr_debug("sn_coap_builder_2 - message len: [%d]", dst_byte_count_to_be_built);
     if (!dst_byte_count_to_be_built) {
         return -1;
     }
 
+    return sn_coap_builder_build(dst_packet_data_ptr, src_coap_msg_ptr, dst_byte_count_to_be_built);
+}
+
+int16_t sn_coap_builder_3(uint8_t *dst_packet_data_ptr, uint16_t dst_packet_data_len, sn_coap_hdr_s *src_coap_msg_ptr, uint16_t blockwise_payload_size)
+{
+    /* * * * Check given pointers  * * * */
+    if (dst_packet_data_ptr == NULL || src_coap_msg_ptr == NULL) {
+        return -2;
+    }
+
+    uint16_t dst_byte_count_to_be_built = sn_coap_builder_calc_needed_packet_data_size_2(src_coap_msg_ptr, blockwise_payload_size);
+    if (!dst_byte_count_to_be_built) {
+        return -1;
+    }
+
+    if (dst_byte_count_to_be_built > dst_packet_data_len) {
+        return -3;
+    }
+
+    return sn_coap_builder_build(dst_packet_data_ptr, src_coap_msg_ptr, dst_byte_count_to_be_built);
+}
+
+/**
+ * \fn static int16_t sn_coap_builder_build(uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, uint16_t dst_byte_count_to_be_built)
+ *
+ * \brief Builds Packet data of a size already calculated with sn_coap_builder_calc_needed_packet_data_size_2()
+ *
+ * \return Return value is byte count of built Packet data, -1 if header building failed
+ */
+static int16_t sn_coap_builder_build(uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, uint16_t dst_byte_count_to_be_built)
+{
+    uint8_t *base_packet_data_ptr = NULL;
+
+    /* Initialize given Packet data memory area with zero values */
     memset(dst_packet_data_ptr, 0, dst_byte_count_to_be_built);
 
     /* * * * Store base (= original) destination Packet data pointer for later usage * * * */
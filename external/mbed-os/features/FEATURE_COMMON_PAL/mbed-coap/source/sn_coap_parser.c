@@ -35,13 +35,26 @@
 #include "mbed-coap/sn_coap_protocol.h"
 #include "sn_coap_header_internal.h"
 #include "sn_coap_protocol_internal.h"
+/* * * * * * * * * * * * * * * * * * * * */
+/* * * * LOCAL TYPES * * * * * * * * * * */
+/* * * * * * * * * * * * * * * * * * * * */
+
+/* Caller memory used instead of the heap by sn_coap_parser_zero_copy() */
+typedef struct sn_coap_parser_arena_ {
+    uint8_t *ptr;
+    uint16_t len;
+} sn_coap_parser_arena_s;
+
 /* * * * * * * * * * * * * * * * * * * * */
 /* * * * LOCAL FUNCTION PROTOTYPES * * * */
 /* * * * * * * * * * * * * * * * * * * * */
 
+static void    *sn_coap_parser_malloc(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint16_t size, bool aligned);
+static sn_coap_hdr_s *sn_coap_parser_parse(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint16_t packet_data_len, uint8_t *packet_data_ptr, coap_version_e *coap_version_ptr);
+static sn_coap_options_list_s *sn_coap_parser_options_alloc(struct coap_s *handle, sn_coap_parser_arena_s *arena, sn_coap_hdr_s *coap_msg_ptr);
 static void     sn_coap_parser_header_parse(uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, coap_version_e *coap_version_ptr);
-static int8_t   sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, uint8_t *packet_data_start_ptr, uint16_t packet_len);
-static int8_t   sn_coap_parser_options_parse_multiple_options(struct coap_s *handle, uint8_t **packet_data_pptr, uint16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint16_t option_number_len);
+static int8_t   sn_coap_parser_options_parse(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, uint8_t *packet_data_start_ptr, uint16_t packet_len);
+static int8_t   sn_coap_parser_options_parse_multiple_options(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint8_t **packet_data_pptr, uint16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint16_t option_number_len);
 static int16_t  sn_coap_parser_options_count_needed_memory_multiple_option(uint8_t *packet_data_ptr, uint16_t packet_left_len, sn_coap_option_numbers_e option, uint16_t option_number_len);
 static int8_t   sn_coap_parser_payload_parse(uint16_t packet_data_len, uint8_t *packet_data_start_ptr, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr);
 
@@ -82,13 +95,76 @@ sn_coap_options_list_s *sn_coap_parser_alloc_options(struct coap_s *handle, sn_c
         return NULL;
     }
 
+    return sn_coap_parser_options_alloc(handle, NULL, coap_msg_ptr);
+}
+
+sn_coap_hdr_s *sn_coap_parser(struct coap_s *handle, uint16_t packet_data_len, uint8_t *packet_data_ptr, coap_version_e *coap_version_ptr)
+{
+    /* * * * Check given pointer * * * */
+    if (handle == NULL) {
+        return NULL;
+    }
+
+    return sn_coap_parser_parse(handle, NULL, packet_data_len, packet_data_ptr, coap_version_ptr);
+}
+
+sn_coap_hdr_s *sn_coap_parser_zero_copy(uint16_t packet_data_len, uint8_t *packet_data_ptr, coap_version_e *coap_version_ptr, uint8_t *arena_ptr, uint16_t arena_len)
+{
+    sn_coap_parser_arena_s arena;
+
+    /* * * * Check given pointer * * * */
+    if (arena_ptr == NULL) {
+        return NULL;
+    }
+
+    arena.ptr = arena_ptr;
+    arena.len = arena_len;
+
+    return sn_coap_parser_parse(NULL, &arena, packet_data_len, packet_data_ptr, coap_version_ptr);
+}
+
+/**
+ * \fn static void *sn_coap_parser_malloc(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint16_t size, bool aligned)
+ *
+ * \brief Allocates memory for a parsed message from the arena, or from the heap if there is no arena
+ *
+ * \param aligned is true for structures, byte strings are packed without padding
+ *
+ * \return Return value is pointer to the memory, NULL if there is not enough of it
+ */
+static void *sn_coap_parser_malloc(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint16_t size, bool aligned)
+{
+    uint16_t padding = 0;
+    void *ptr;
+
+    if (arena == NULL) {
+        return handle->sn_coap_protocol_malloc(size);
+    }
+
+    if (aligned) {
+        padding = (sizeof(void *) - ((uintptr_t)arena->ptr % sizeof(void *))) % sizeof(void *);
+    }
+
+    if (padding + size > arena->len) {
+        return NULL;
+    }
+
+    ptr = arena->ptr + padding;
+    arena->ptr += padding + size;
+    arena->len -= padding + size;
+
+    return ptr;
+}
+
+static sn_coap_options_list_s *sn_coap_parser_options_alloc(struct coap_s *handle, sn_coap_parser_arena_s *arena, sn_coap_hdr_s *coap_msg_ptr)
+{
     /* * * * If the message already has options, return them * * * */
     if (coap_msg_ptr->options_list_ptr) {
         return coap_msg_ptr->options_list_ptr;
     }
 
     /* * * * Allocate memory for options and initialize allocated memory with with default values  * * * */
-    coap_msg_ptr->options_list_ptr = handle->sn_coap_protocol_malloc(sizeof(sn_coap_options_list_s));
+    coap_msg_ptr->options_list_ptr = sn_coap_parser_malloc(handle, arena, sizeof(sn_coap_options_list_s), true);
 
     if (coap_msg_ptr->options_list_ptr == NULL) {
         return NULL;
@@ -107,18 +183,18 @@ sn_coap_options_list_s *sn_coap_parser_alloc_options(struct coap_s *handle, sn_c
     return coap_msg_ptr->options_list_ptr;
 }
 
-sn_coap_hdr_s *sn_coap_parser(struct coap_s *handle, uint16_t packet_data_len, uint8_t *packet_data_ptr, coap_version_e *coap_version_ptr)
+static sn_coap_hdr_s *sn_coap_parser_parse(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint16_t packet_data_len, uint8_t *packet_data_ptr, coap_version_e *coap_version_ptr)
 {
     uint8_t       *data_temp_ptr                    = packet_data_ptr;
     sn_coap_hdr_s *parsed_and_returned_coap_msg_ptr = NULL;
 
     /* * * * Check given pointer * * * */
-    if (packet_data_ptr == NULL || packet_data_len < 4 || handle == NULL) {
+    if (packet_data_ptr == NULL || packet_data_len < 4) {
         return NULL;
     }
 
     /* * * * Allocate and initialize CoAP message  * * * */
-    parsed_and_returned_coap_msg_ptr = sn_coap_parser_alloc_message(handle);
+    parsed_and_returned_coap_msg_ptr = sn_coap_parser_init_message(sn_coap_parser_malloc(handle, arena, sizeof(sn_coap_hdr_s), true));
 
     if (parsed_and_returned_coap_msg_ptr == NULL) {
         return NULL;
@@ -128,7 +204,7 @@ sn_coap_hdr_s *sn_coap_parser(struct coap_s *handle, uint16_t packet_data_len, u
     sn_coap_parser_header_parse(&data_temp_ptr, parsed_and_returned_coap_msg_ptr, coap_version_ptr);
 
     /* * * * Options parsing, move pointer over the options... * * * */
-    if (sn_coap_parser_options_parse(handle, &data_temp_ptr, parsed_and_returned_coap_msg_ptr, packet_data_ptr, packet_data_len) != 0) {
+    if (sn_coap_parser_options_parse(handle, arena, &data_temp_ptr, parsed_and_returned_coap_msg_ptr, packet_data_ptr, packet_data_len) != 0) {
         parsed_and_returned_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_ERROR_IN_HEADER;
         return parsed_and_returned_coap_msg_ptr;
     }
@@ -242,12 +318,13 @@ static uint32_t sn_coap_parser_options_parse_uint(uint8_t **packet_data_pptr, ui
  *
  * \brief Parses CoAP message's Options part from given Packet data
  *
+ * \param *arena is memory for zero-copy parsing, NULL to allocate from the heap
  * \param **packet_data_pptr is source of Packet data to be parsed to CoAP message
  * \param *dst_coap_msg_ptr is destination for parsed CoAP message
  *
  * \return Return value is 0 in ok case and -1 in failure case
  */
-static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, uint8_t *packet_data_start_ptr, uint16_t packet_len)
+static int8_t sn_coap_parser_options_parse(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr, uint8_t *packet_data_start_ptr, uint16_t packet_len)
 {
     uint8_t previous_option_number = 0;
     uint8_t i                      = 0;
@@ -258,17 +335,22 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
     dst_coap_msg_ptr->token_len = *packet_data_start_ptr & COAP_HEADER_TOKEN_LENGTH_MASK;
 
     if (dst_coap_msg_ptr->token_len) {
-        if ((dst_coap_msg_ptr->token_len > 8) || dst_coap_msg_ptr->token_ptr) {
+        if ((dst_coap_msg_ptr->token_len > 8) || dst_coap_msg_ptr->token_ptr ||
+                (*packet_data_pptr - packet_data_start_ptr) + dst_coap_msg_ptr->token_len > packet_len) {
             return -1;
         }
 
-        dst_coap_msg_ptr->token_ptr = handle->sn_coap_protocol_malloc(dst_coap_msg_ptr->token_len);
+        if (arena) {
+            dst_coap_msg_ptr->token_ptr = *packet_data_pptr;
+        } else {
+            dst_coap_msg_ptr->token_ptr = handle->sn_coap_protocol_malloc(dst_coap_msg_ptr->token_len);
 
-        if (dst_coap_msg_ptr->token_ptr == NULL) {
-            return -1;
-        }
+            if (dst_coap_msg_ptr->token_ptr == NULL) {
+                return -1;
+            }
 
-        memcpy(dst_coap_msg_ptr->token_ptr, *packet_data_pptr, dst_coap_msg_ptr->token_len);
+            memcpy(dst_coap_msg_ptr->token_ptr, *packet_data_pptr, dst_coap_msg_ptr->token_len);
+        }
         (*packet_data_pptr) += dst_coap_msg_ptr->token_len;
     }
 
@@ -288,6 +370,11 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
         /* Resolve option delta */
         uint16_t  option_number = (**packet_data_pptr >> COAP_OPTIONS_OPTION_NUMBER_SHIFT);
 
+        /* Extended option delta and length must be within the Packet data */
+        if ((option_number >= 13 ? option_number - 12 : 0) + (option_len >= 13 ? option_len - 12 : 0) >= message_left) {
+            return -1;
+        }
+
         if (option_number == 13) {
             option_number = *(*packet_data_pptr + 1) + 13;
             (*packet_data_pptr)++;
@@ -314,6 +401,11 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
             (*packet_data_pptr) += 2;
         }
 
+        /* Option value must be within the Packet data, it may be used without copying */
+        if ((*packet_data_pptr - packet_data_start_ptr) + 1 + option_len > packet_len) {
+            return -1;
+        }
+
         message_left = packet_len - (*packet_data_pptr - packet_data_start_ptr);
 
         /* * * Parse option itself * * */
@@ -335,7 +427,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
             case COAP_OPTION_ACCEPT:
             case COAP_OPTION_SIZE1:
             case COAP_OPTION_SIZE2:
-                if (sn_coap_parser_alloc_options(handle, dst_coap_msg_ptr) == NULL) {
+                if (sn_coap_parser_options_alloc(handle, arena, dst_coap_msg_ptr) == NULL) {
                     return -1;
                 }
                 break;
@@ -366,12 +458,16 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 dst_coap_msg_ptr->options_list_ptr->proxy_uri_len = option_len;
                 (*packet_data_pptr)++;
 
-                dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr = handle->sn_coap_protocol_malloc(option_len);
+                if (arena) {
+                    dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr = *packet_data_pptr;
+                } else {
+                    dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr = handle->sn_coap_protocol_malloc(option_len);
 
-                if (dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr == NULL) {
-                    return -1;
+                    if (dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr == NULL) {
+                        return -1;
+                    }
+                    memcpy(dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr, *packet_data_pptr, option_len);
                 }
-                memcpy(dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr, *packet_data_pptr, option_len);
                 (*packet_data_pptr) += option_len;
 
                 break;
@@ -379,7 +475,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
             case COAP_OPTION_ETAG:
                 /* This is managed independently because User gives this option in one character table */
 
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, arena, packet_data_pptr,
                              message_left,
                              &dst_coap_msg_ptr->options_list_ptr->etag_ptr,
                              (uint16_t *)&dst_coap_msg_ptr->options_list_ptr->etag_len,
@@ -398,12 +494,16 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 dst_coap_msg_ptr->options_list_ptr->uri_host_len = option_len;
                 (*packet_data_pptr)++;
 
-                dst_coap_msg_ptr->options_list_ptr->uri_host_ptr = handle->sn_coap_protocol_malloc(option_len);
+                if (arena) {
+                    dst_coap_msg_ptr->options_list_ptr->uri_host_ptr = *packet_data_pptr;
+                } else {
+                    dst_coap_msg_ptr->options_list_ptr->uri_host_ptr = handle->sn_coap_protocol_malloc(option_len);
 
-                if (dst_coap_msg_ptr->options_list_ptr->uri_host_ptr == NULL) {
-                    return -1;
+                    if (dst_coap_msg_ptr->options_list_ptr->uri_host_ptr == NULL) {
+                        return -1;
+                    }
+                    memcpy(dst_coap_msg_ptr->options_list_ptr->uri_host_ptr, *packet_data_pptr, option_len);
                 }
-                memcpy(dst_coap_msg_ptr->options_list_ptr->uri_host_ptr, *packet_data_pptr, option_len);
                 (*packet_data_pptr) += option_len;
 
                 break;
@@ -413,7 +513,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                     return -1;
                 }
                 /* This is managed independently because User gives this option in one character table */
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr, message_left,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, arena, packet_data_pptr, message_left,
                              &dst_coap_msg_ptr->options_list_ptr->location_path_ptr, &dst_coap_msg_ptr->options_list_ptr->location_path_len,
                              COAP_OPTION_LOCATION_PATH, option_len);
                 if (ret_status >= 0) {
@@ -435,7 +535,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 break;
 
             case COAP_OPTION_LOCATION_QUERY:
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr, message_left,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, arena, packet_data_pptr, message_left,
                              &dst_coap_msg_ptr->options_list_ptr->location_query_ptr, &dst_coap_msg_ptr->options_list_ptr->location_query_len,
                              COAP_OPTION_LOCATION_QUERY, option_len);
                 if (ret_status >= 0) {
@@ -447,7 +547,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 break;
 
             case COAP_OPTION_URI_PATH:
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr, message_left,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, arena, packet_data_pptr, message_left,
                              &dst_coap_msg_ptr->uri_path_ptr, &dst_coap_msg_ptr->uri_path_len,
                              COAP_OPTION_URI_PATH, option_len);
                 if (ret_status >= 0) {
@@ -470,7 +570,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
                 break;
 
             case COAP_OPTION_URI_QUERY:
-                ret_status = sn_coap_parser_options_parse_multiple_options(handle, packet_data_pptr, message_left,
+                ret_status = sn_coap_parser_options_parse_multiple_options(handle, arena, packet_data_pptr, message_left,
                              &dst_coap_msg_ptr->options_list_ptr->uri_query_ptr, &dst_coap_msg_ptr->options_list_ptr->uri_query_len,
                              COAP_OPTION_URI_QUERY, option_len);
                 if (ret_status >= 0) {
@@ -553,6 +653,9 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
  *
  * \brief Parses CoAP message's Uri-query options
  *
+ *        In zero-copy parsing an option with a single part points to the Packet data,
+ *        several parts are joined in the arena
+ *
  * \param **packet_data_pptr is source for Packet data to be parsed to CoAP message
  *
  * \param *dst_coap_msg_ptr is destination for parsed CoAP message
@@ -563,7 +666,7 @@ static int8_t sn_coap_parser_options_parse(struct coap_s *handle, uint8_t **pack
  *
  * \return Return value is count of Uri-query optios parsed. In failure case -1 is returned.
 */
-static int8_t sn_coap_parser_options_parse_multiple_options(struct coap_s *handle, uint8_t **packet_data_pptr, uint16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint16_t option_number_len)
+static int8_t sn_coap_parser_options_parse_multiple_options(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint8_t **packet_data_pptr, uint16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint16_t option_number_len)
 {
     int16_t     uri_query_needed_heap       = sn_coap_parser_options_count_needed_memory_multiple_option(*packet_data_pptr, packet_left_len, option, option_number_len);
     uint8_t    *temp_parsed_uri_query_ptr   = NULL;
@@ -573,8 +676,17 @@ static int8_t sn_coap_parser_options_parse_multiple_options(struct coap_s *handl
         return -1;
     }
 
+    /* Nothing to join, use the option as it is in the Packet data */
+    if (arena && uri_query_needed_heap && uri_query_needed_heap == option_number_len) {
+        (*packet_data_pptr)++;
+        *dst_pptr = *packet_data_pptr;
+        *dst_len_ptr = option_number_len;
+        (*packet_data_pptr) += option_number_len;
+        return 1;
+    }
+
     if (uri_query_needed_heap) {
-        *dst_pptr = (uint8_t *) handle->sn_coap_protocol_malloc(uri_query_needed_heap);
+        *dst_pptr = (uint8_t *) sn_coap_parser_malloc(handle, arena, uri_query_needed_heap, false);
 
         if (*dst_pptr == NULL) {
             return -1;
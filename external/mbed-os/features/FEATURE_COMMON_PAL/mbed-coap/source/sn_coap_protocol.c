@@ -1082,6 +1082,9 @@ static void sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct
             removed_duplication_info_ptr->addr_ptr = 0;
             handle->sn_coap_protocol_free(removed_duplication_info_ptr);
             removed_duplication_info_ptr = 0;
+        } else {
+            /* Infos are stored in time order, the rest are newer */
+            break;
         }
     }
 }
@@ -1311,6 +1314,9 @@ static void sn_coap_protocol_linked_list_blockwise_remove_old_data(struct coap_s
                 removed_blocwise_msg_ptr->coap_msg_ptr = 0;
             }
             sn_coap_protocol_linked_list_blockwise_msg_remove(handle, removed_blocwise_msg_ptr);
+        } else {
+            /* Messages are stored in time order, the rest are newer */
+            break;
         }
     }
 
@@ -1319,6 +1325,9 @@ static void sn_coap_protocol_linked_list_blockwise_remove_old_data(struct coap_s
         if ((handle->system_time - removed_blocwise_payload_ptr->timestamp)  > SN_COAP_BLOCKWISE_MAX_TIME_DATA_STORED) {
             /* * * * Old Blockise payload found, remove it from Linked list * * * */
             sn_coap_protocol_linked_list_blockwise_payload_remove(handle, removed_blocwise_payload_ptr);
+        } else {
+            /* Payloads are stored in time order, the rest are newer */
+            break;
         }
     }
 }
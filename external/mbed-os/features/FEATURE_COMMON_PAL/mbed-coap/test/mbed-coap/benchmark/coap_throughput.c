@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2017 ARM Limited. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Parses a CON GET with a token, three uri-path parts, a query, observe
+ * and a payload, and answers it with a built response. Once with the heap
+ * parser, sn_coap_build_response and sn_coap_builder_2 into a packet sized
+ * and allocated for it, and once with sn_coap_parser_zero_copy,
+ * sn_coap_build_response_zero_copy and sn_coap_builder_3 into buffers on
+ * the stack. Counts heap allocations and messages per second.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ns_types.h"
+#include "sn_coap_header.h"
+#include "coap_test_messages.h"
+#include "host_test.h"
+
+#define MESSAGES 2000000
+
+
+static uint8_t request[256];
+static uint16_t request_len;
+static volatile unsigned sink;
+
+static void heap(void)
+{
+    coap_version_e version;
+    sn_coap_hdr_s *msg = sn_coap_parser(&coap_test_handle, request_len, request, &version);
+    sn_coap_hdr_s *response = sn_coap_build_response(&coap_test_handle, msg, COAP_MSG_CODE_RESPONSE_CONTENT);
+    response->payload_ptr = msg->payload_ptr;
+    response->payload_len = msg->payload_len;
+
+    uint16_t len = sn_coap_builder_calc_needed_packet_data_size_2(response, 0);
+    uint8_t *packet = coap_test_handle.sn_coap_protocol_malloc(len);
+    sink += sn_coap_builder_2(packet, response, 0);
+    coap_test_handle.sn_coap_protocol_free(packet);
+
+    response->payload_ptr = NULL;
+    sn_coap_parser_release_allocated_coap_msg_mem(&coap_test_handle, response);
+    sn_coap_parser_release_allocated_coap_msg_mem(&coap_test_handle, msg);
+}
+
+static void zero_copy(void)
+{
+    uint8_t arena[SN_COAP_PARSER_ARENA_SIZE(sizeof(request))];
+    uint8_t packet[256];
+    coap_version_e version;
+    sn_coap_hdr_s response;
+
+    sn_coap_hdr_s *msg = sn_coap_parser_zero_copy(request_len, request, &version, arena, sizeof(arena));
+    sn_coap_build_response_zero_copy(&response, msg, COAP_MSG_CODE_RESPONSE_CONTENT);
+    response.payload_ptr = msg->payload_ptr;
+    response.payload_len = msg->payload_len;
+    sink += sn_coap_builder_3(packet, sizeof(packet), &response, 0);
+}
+
+static double run(const char *name, void (*handle)(void), double *allocs)
+{
+    int before = coap_test_allocs;
+    uint64_t start = now_ns();
+    for (int i = 0; i < MESSAGES; i++) {
+        handle();
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    double rate = MESSAGES * 1e9 / elapsed;
+    *allocs = (double)(coap_test_allocs - before) / MESSAGES;
+    printf("%-48s %5.1fM msg/s, %.0f allocs/msg\n", name, rate / 1e6, *allocs);
+    return rate;
+}
+
+int main()
+{
+    sn_coap_hdr_s msg;
+    sn_coap_options_list_s options;
+    coap_test_message(0, &msg, &options);
+    request_len = sn_coap_builder_3(request, sizeof(request), &msg, 0);
+    check(request_len > 0);
+
+    double heap_allocs, zero_copy_allocs;
+    double heap_rate = run("heap parser + build_response + builder_2", heap, &heap_allocs);
+    double zero_copy_rate = run("zero-copy parser + in-place response + builder_3", zero_copy, &zero_copy_allocs);
+
+    check(zero_copy_allocs == 0);
+    check(heap_allocs > 0);
+    check(zero_copy_rate > heap_rate);
+    check(coap_test_held == 0);
+
+    return host_test_done();
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2017 ARM Limited. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "coap_test_messages.h"
+#include "sn_coap_header_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+int coap_test_allocs = 0;
+int coap_test_held = 0;
+
+static void *own_alloc(uint16_t size)
+{
+    coap_test_allocs++;
+    coap_test_held++;
+    return malloc(size);
+}
+
+static void own_free(void *ptr)
+{
+    if (ptr) {
+        coap_test_held--;
+        free(ptr);
+    }
+}
+
+struct coap_s coap_test_handle = {
+    .sn_coap_protocol_malloc = own_alloc,
+    .sn_coap_protocol_free = own_free,
+};
+
+static uint8_t token[] = {0x12, 0x34, 0x56, 0x78};
+static uint8_t etag[] = {0xe1, 0xe2, 0xe3, 0xe4};
+static uint8_t payload[600];
+static char proxy_uri[300];
+
+void coap_test_message(int index, sn_coap_hdr_s *msg, sn_coap_options_list_s *options)
+{
+    sn_coap_parser_init_message(msg);
+    memset(options, 0, sizeof(*options));
+    options->max_age = COAP_OPTION_MAX_AGE_DEFAULT;
+    options->uri_port = COAP_OPTION_URI_PORT_NONE;
+    options->observe = COAP_OBSERVE_NONE;
+    options->accept = COAP_CT_NONE;
+    options->block2 = COAP_OPTION_BLOCK_NONE;
+    options->block1 = COAP_OPTION_BLOCK_NONE;
+
+    for (unsigned i = 0; i < sizeof(payload); i++) {
+        payload[i] = i * 7;
+    }
+    memset(proxy_uri, 'p', sizeof(proxy_uri));
+
+    switch (index) {
+        /* Observation request with a repeated path and query */
+        case 0:
+            msg->msg_type = COAP_MSG_TYPE_CONFIRMABLE;
+            msg->msg_code = COAP_MSG_CODE_REQUEST_GET;
+            msg->msg_id = 0x1234;
+            msg->token_ptr = token;
+            msg->token_len = sizeof(token);
+            msg->uri_path_ptr = (uint8_t *)"sensors/temp/0";
+            msg->uri_path_len = strlen("sensors/temp/0");
+            msg->content_format = COAP_CT_TEXT_PLAIN;
+            msg->payload_ptr = (uint8_t *)"21.5";
+            msg->payload_len = 4;
+            options->uri_query_ptr = (uint8_t *)"unit=c&avg=1";
+            options->uri_query_len = strlen("unit=c&avg=1");
+            options->observe = 0;
+            msg->options_list_ptr = options;
+            break;
+
+        /* Proxied request with long options and a large payload */
+        case 1:
+            msg->msg_type = COAP_MSG_TYPE_NON_CONFIRMABLE;
+            msg->msg_code = COAP_MSG_CODE_REQUEST_POST;
+            msg->msg_id = 0xfffe;
+            msg->token_ptr = token;
+            msg->token_len = 1;
+            msg->uri_path_ptr = (uint8_t *)"up";
+            msg->uri_path_len = 2;
+            msg->payload_ptr = payload;
+            msg->payload_len = sizeof(payload);
+            options->uri_host_ptr = (uint8_t *)"example.com";
+            options->uri_host_len = strlen("example.com");
+            options->proxy_uri_ptr = (uint8_t *)proxy_uri;
+            options->proxy_uri_len = sizeof(proxy_uri);
+            options->etag_ptr = etag;
+            options->etag_len = sizeof(etag);
+            options->uri_port = 5683;
+            options->accept = COAP_CT_JSON;
+            msg->options_list_ptr = options;
+            break;
+
+        /* Response with location and block options */
+        case 2:
+            msg->msg_type = COAP_MSG_TYPE_ACKNOWLEDGEMENT;
+            msg->msg_code = COAP_MSG_CODE_RESPONSE_CREATED;
+            msg->msg_id = 7;
+            msg->token_ptr = token;
+            msg->token_len = 2;
+            msg->payload_ptr = payload;
+            msg->payload_len = 64;
+            options->location_path_ptr = (uint8_t *)"a/bb/ccc";
+            options->location_path_len = strlen("a/bb/ccc");
+            options->location_query_ptr = (uint8_t *)"x=1&y=2";
+            options->location_query_len = strlen("x=1&y=2");
+            options->max_age = 30;
+            options->size2 = 4096;
+            options->use_size2 = true;
+            options->block2 = 0x26;
+            msg->options_list_ptr = options;
+            break;
+
+        /* Empty reset */
+        default:
+            msg->msg_type = COAP_MSG_TYPE_RESET;
+            msg->msg_code = COAP_MSG_CODE_EMPTY;
+            msg->msg_id = 1;
+            break;
+    }
+}
+
+static bool bytes_equal(const uint8_t *a, uint16_t a_len, const uint8_t *b, uint16_t b_len)
+{
+    if (!a || !b) {
+        return !a && !b && a_len == b_len;
+    }
+
+    return a_len == b_len && !memcmp(a, b, a_len);
+}
+
+static bool options_equal(const sn_coap_options_list_s *a, const sn_coap_options_list_s *b)
+{
+    if (!a || !b) {
+        return !a && !b;
+    }
+
+    return a->use_size1 == b->use_size1 &&
+           a->use_size2 == b->use_size2 &&
+           a->accept == b->accept &&
+           a->max_age == b->max_age &&
+           a->size1 == b->size1 &&
+           a->size2 == b->size2 &&
+           a->uri_port == b->uri_port &&
+           a->observe == b->observe &&
+           a->block1 == b->block1 &&
+           a->block2 == b->block2 &&
+           bytes_equal(a->proxy_uri_ptr, a->proxy_uri_len, b->proxy_uri_ptr, b->proxy_uri_len) &&
+           bytes_equal(a->etag_ptr, a->etag_len, b->etag_ptr, b->etag_len) &&
+           bytes_equal(a->uri_host_ptr, a->uri_host_len, b->uri_host_ptr, b->uri_host_len) &&
+           bytes_equal(a->location_path_ptr, a->location_path_len, b->location_path_ptr, b->location_path_len) &&
+           bytes_equal(a->location_query_ptr, a->location_query_len, b->location_query_ptr, b->location_query_len) &&
+           bytes_equal(a->uri_query_ptr, a->uri_query_len, b->uri_query_ptr, b->uri_query_len);
+}
+
+bool coap_test_equal(const sn_coap_hdr_s *a, const sn_coap_hdr_s *b)
+{
+    return a->coap_status == b->coap_status &&
+           a->msg_code == b->msg_code &&
+           a->msg_type == b->msg_type &&
+           a->content_format == b->content_format &&
+           a->msg_id == b->msg_id &&
+           bytes_equal(a->token_ptr, a->token_len, b->token_ptr, b->token_len) &&
+           bytes_equal(a->uri_path_ptr, a->uri_path_len, b->uri_path_ptr, b->uri_path_len) &&
+           bytes_equal(a->payload_ptr, a->payload_len, b->payload_ptr, b->payload_len) &&
+           options_equal(a->options_list_ptr, b->options_list_ptr);
+}
+
+uint32_t coap_test_random(void)
+{
+    static uint32_t state = 1;
+    state = state * 1103515245 + 12345;
+    return state >> 8;
+}
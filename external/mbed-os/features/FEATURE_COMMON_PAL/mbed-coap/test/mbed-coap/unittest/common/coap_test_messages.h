@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2017 ARM Limited. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef COAP_TEST_MESSAGES_H
+#define COAP_TEST_MESSAGES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include "ns_types.h"
+#include "sn_coap_header.h"
+#include "sn_coap_protocol_internal.h"
+
+/* Number of sample messages */
+#define COAP_TEST_MESSAGES 4
+
+/* Heap of the test handle, counting what is allocated and still held */
+extern struct coap_s coap_test_handle;
+extern int coap_test_allocs;
+extern int coap_test_held;
+
+/* Fills in a sample message, pointing to static strings */
+void coap_test_message(int index, sn_coap_hdr_s *msg, sn_coap_options_list_s *options);
+
+/* Compares every field of two messages, and the byte strings they point to */
+bool coap_test_equal(const sn_coap_hdr_s *a, const sn_coap_hdr_s *b);
+
+/* Deterministic pseudo random numbers for mutating packets */
+uint32_t coap_test_random(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COAP_TEST_MESSAGES_H
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2017 ARM. All rights reserved.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_sn_coap_builder.h"
+
+TEST_GROUP(sn_coap_builder)
+{
+    void setup()
+    {
+    }
+
+    void teardown()
+    {
+    }
+};
+
+TEST(sn_coap_builder, test_sn_coap_builder_3)
+{
+    CHECK(test_sn_coap_builder_3());
+}
+
+TEST(sn_coap_builder, test_sn_coap_builder_3_truncated_buffer)
+{
+    CHECK(test_sn_coap_builder_3_truncated_buffer());
+}
+
+TEST(sn_coap_builder, test_sn_coap_build_response_zero_copy)
+{
+    CHECK(test_sn_coap_build_response_zero_copy());
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2017 ARM Limited. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "test_sn_coap_builder.h"
+#include <stdlib.h>
+#include <string.h>
+#include "ns_types.h"
+#include "sn_coap_header.h"
+#include "coap_test_messages.h"
+
+#define GUARD_LEN 16
+
+bool test_sn_coap_builder_3()
+{
+    uint8_t buffer[1024];
+    uint8_t expected[1024];
+    sn_coap_hdr_s msg;
+    sn_coap_options_list_s options;
+
+    coap_test_message(0, &msg, &options);
+    if (sn_coap_builder_3(NULL, sizeof(buffer), &msg, 0) != -2) {
+        return false;
+    }
+    if (sn_coap_builder_3(buffer, sizeof(buffer), NULL, 0) != -2) {
+        return false;
+    }
+
+    /* Invalid message */
+    msg.token_len = 9;
+    if (sn_coap_builder_3(buffer, sizeof(buffer), &msg, 0) != -1) {
+        return false;
+    }
+
+    /* Builds the same packet as sn_coap_builder_2 into a larger buffer */
+    for (int i = 0; i < COAP_TEST_MESSAGES; i++) {
+        coap_test_message(i, &msg, &options);
+        uint16_t len = sn_coap_builder_calc_needed_packet_data_size_2(&msg, 0);
+        if (sn_coap_builder_2(expected, &msg, 0) != len) {
+            return false;
+        }
+
+        memset(buffer, 0xa5, sizeof(buffer));
+        if (sn_coap_builder_3(buffer, sizeof(buffer), &msg, 0) != len) {
+            return false;
+        }
+        if (memcmp(buffer, expected, len)) {
+            return false;
+        }
+        for (uint16_t j = len; j < sizeof(buffer); j++) {
+            if (buffer[j] != 0xa5) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool test_sn_coap_builder_3_truncated_buffer()
+{
+    for (int i = 0; i < COAP_TEST_MESSAGES; i++) {
+        sn_coap_hdr_s msg;
+        sn_coap_options_list_s options;
+        coap_test_message(i, &msg, &options);
+        uint16_t len = sn_coap_builder_calc_needed_packet_data_size_2(&msg, 0);
+        uint8_t *buffer = malloc(len + GUARD_LEN);
+
+        /* Every buffer too small is refused without being written */
+        for (uint16_t size = 0; size < len; size++) {
+            memset(buffer, 0xa5, len + GUARD_LEN);
+            if (sn_coap_builder_3(buffer, size, &msg, 0) != -3) {
+                return false;
+            }
+            for (uint16_t j = 0; j < len + GUARD_LEN; j++) {
+                if (buffer[j] != 0xa5) {
+                    return false;
+                }
+            }
+        }
+
+        /* An exact fit is enough */
+        memset(buffer, 0xa5, len + GUARD_LEN);
+        if (sn_coap_builder_3(buffer, len, &msg, 0) != len) {
+            return false;
+        }
+        for (uint16_t j = len; j < len + GUARD_LEN; j++) {
+            if (buffer[j] != 0xa5) {
+                return false;
+            }
+        }
+
+        free(buffer);
+    }
+
+    return true;
+}
+
+bool test_sn_coap_build_response_zero_copy()
+{
+    sn_coap_hdr_s request;
+    sn_coap_hdr_s response;
+    sn_coap_options_list_s options;
+    uint8_t buffer[64];
+    uint8_t expected[64];
+
+    coap_test_message(0, &request, &options);
+    if (sn_coap_build_response_zero_copy(NULL, &request, COAP_MSG_CODE_RESPONSE_CONTENT) != -1) {
+        return false;
+    }
+    if (sn_coap_build_response_zero_copy(&response, NULL, COAP_MSG_CODE_RESPONSE_CONTENT) != -1) {
+        return false;
+    }
+
+    /* Only requests are answered */
+    coap_test_message(2, &request, &options);
+    if (sn_coap_build_response_zero_copy(&response, &request, COAP_MSG_CODE_RESPONSE_CONTENT) != -1) {
+        return false;
+    }
+    coap_test_message(3, &request, &options);
+    if (sn_coap_build_response_zero_copy(&response, &request, COAP_MSG_CODE_RESPONSE_CONTENT) != -1) {
+        return false;
+    }
+
+    /* Confirmable requests are acknowledged with the same message id */
+    coap_test_message(0, &request, &options);
+    if (sn_coap_build_response_zero_copy(&response, &request, COAP_MSG_CODE_RESPONSE_CONTENT) != 0) {
+        return false;
+    }
+    if (response.msg_type != COAP_MSG_TYPE_ACKNOWLEDGEMENT ||
+            response.msg_code != COAP_MSG_CODE_RESPONSE_CONTENT ||
+            response.msg_id != request.msg_id ||
+            response.options_list_ptr || response.uri_path_ptr || response.payload_ptr) {
+        return false;
+    }
+
+    /* The token is shared with the request, nothing is allocated */
+    if (response.token_ptr != request.token_ptr || response.token_len != request.token_len) {
+        return false;
+    }
+
+    /* Builds the same packet as the heap response */
+    int allocs = coap_test_allocs;
+    sn_coap_hdr_s *heap_response = sn_coap_build_response(&coap_test_handle, &request, COAP_MSG_CODE_RESPONSE_CONTENT);
+    if (!heap_response || coap_test_allocs == allocs || heap_response->token_ptr == request.token_ptr) {
+        return false;
+    }
+    int16_t len = sn_coap_builder_2(expected, heap_response, 0);
+    if (len <= 0 || sn_coap_builder_3(buffer, sizeof(buffer), &response, 0) != len || memcmp(buffer, expected, len)) {
+        return false;
+    }
+    sn_coap_parser_release_allocated_coap_msg_mem(&coap_test_handle, heap_response);
+
+    /* Non-confirmable requests get a non-confirmable response */
+    coap_test_message(1, &request, &options);
+    if (sn_coap_build_response_zero_copy(&response, &request, COAP_MSG_CODE_RESPONSE_CHANGED) != 0) {
+        return false;
+    }
+    if (response.msg_type != COAP_MSG_TYPE_NON_CONFIRMABLE ||
+            response.msg_code != COAP_MSG_CODE_RESPONSE_CHANGED ||
+            response.token_ptr != request.token_ptr) {
+        return false;
+    }
+
+    return coap_test_held == 0;
+}
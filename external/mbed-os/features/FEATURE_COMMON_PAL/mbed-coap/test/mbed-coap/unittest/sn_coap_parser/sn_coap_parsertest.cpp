@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2017 ARM. All rights reserved.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_sn_coap_parser.h"
+
+TEST_GROUP(sn_coap_parser)
+{
+    void setup()
+    {
+    }
+
+    void teardown()
+    {
+    }
+};
+
+TEST(sn_coap_parser, test_sn_coap_parser_zero_copy_parameters)
+{
+    CHECK(test_sn_coap_parser_zero_copy_parameters());
+}
+
+TEST(sn_coap_parser, test_sn_coap_parser_zero_copy_views)
+{
+    CHECK(test_sn_coap_parser_zero_copy_views());
+}
+
+TEST(sn_coap_parser, test_sn_coap_parser_zero_copy_truncated)
+{
+    CHECK(test_sn_coap_parser_zero_copy_truncated());
+}
+
+TEST(sn_coap_parser, test_sn_coap_parser_zero_copy_mutated)
+{
+    CHECK(test_sn_coap_parser_zero_copy_mutated());
+}
+
+TEST(sn_coap_parser, test_sn_coap_parser_zero_copy_arena_exhausted)
+{
+    CHECK(test_sn_coap_parser_zero_copy_arena_exhausted());
+}
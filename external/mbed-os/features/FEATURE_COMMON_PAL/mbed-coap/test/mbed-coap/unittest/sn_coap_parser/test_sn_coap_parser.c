@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2017 ARM Limited. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "test_sn_coap_parser.h"
+#include <stdlib.h>
+#include <string.h>
+#include "ns_types.h"
+#include "sn_coap_header.h"
+#include "coap_test_messages.h"
+
+#define GUARD_LEN 16
+
+static uint8_t packet[1024];
+
+static uint16_t build(int index)
+{
+    sn_coap_hdr_s msg;
+    sn_coap_options_list_s options;
+    coap_test_message(index, &msg, &options);
+    return sn_coap_builder_3(packet, sizeof(packet), &msg, 0);
+}
+
+static bool inside(const uint8_t *ptr, const uint8_t *start, size_t len)
+{
+    return ptr >= start && ptr < start + len;
+}
+
+/* Parses the packet with both parsers, from an exactly sized copy */
+static bool same_result(const uint8_t *data, uint16_t len)
+{
+    uint8_t *copy = malloc(len);
+    uint8_t *arena = malloc(SN_COAP_PARSER_ARENA_SIZE(len));
+    coap_version_e heap_version;
+    coap_version_e version;
+    bool result;
+
+    memcpy(copy, data, len);
+    sn_coap_hdr_s *heap_msg = sn_coap_parser(&coap_test_handle, len, copy, &heap_version);
+    sn_coap_hdr_s *msg = sn_coap_parser_zero_copy(len, copy, &version, arena, SN_COAP_PARSER_ARENA_SIZE(len));
+
+    if (len < 4) {
+        result = !heap_msg && !msg;
+    } else {
+        result = heap_msg && msg && heap_version == version && coap_test_equal(heap_msg, msg);
+    }
+
+    sn_coap_parser_release_allocated_coap_msg_mem(&coap_test_handle, heap_msg);
+    free(arena);
+    free(copy);
+    return result && coap_test_held == 0;
+}
+
+bool test_sn_coap_parser_zero_copy_parameters()
+{
+    uint8_t arena[SN_COAP_PARSER_ARENA_SIZE(4)];
+    coap_version_e version;
+    uint16_t len = build(3);
+
+    if (sn_coap_parser_zero_copy(len, packet, &version, NULL, sizeof(arena)) != NULL) {
+        return false;
+    }
+    if (sn_coap_parser_zero_copy(len, NULL, &version, arena, sizeof(arena)) != NULL) {
+        return false;
+    }
+    if (sn_coap_parser_zero_copy(3, packet, &version, arena, sizeof(arena)) != NULL) {
+        return false;
+    }
+    if (sn_coap_parser_zero_copy(len, packet, &version, arena, 0) != NULL) {
+        return false;
+    }
+
+    sn_coap_hdr_s *msg = sn_coap_parser_zero_copy(len, packet, &version, arena, sizeof(arena));
+    if (!msg || msg->coap_status != COAP_STATUS_OK || msg->msg_type != COAP_MSG_TYPE_RESET || msg->msg_id != 1) {
+        return false;
+    }
+
+    return version == COAP_VERSION_1;
+}
+
+bool test_sn_coap_parser_zero_copy_views()
+{
+    static uint8_t arena[SN_COAP_PARSER_ARENA_SIZE(sizeof(packet))];
+    coap_version_e version;
+
+    for (int i = 0; i < COAP_TEST_MESSAGES; i++) {
+        uint16_t len = build(i);
+        sn_coap_hdr_s expected;
+        sn_coap_options_list_s options;
+        coap_test_message(i, &expected, &options);
+
+        int allocs = coap_test_allocs;
+        sn_coap_hdr_s *msg = sn_coap_parser_zero_copy(len, packet, &version, arena, SN_COAP_PARSER_ARENA_SIZE(len));
+        if (!msg || msg->coap_status != COAP_STATUS_OK || coap_test_allocs != allocs) {
+            return false;
+        }
+
+        /* Parses to the message it was built from */
+        if (!coap_test_equal(msg, &expected) || !same_result(packet, len)) {
+            return false;
+        }
+
+        /* The message lives in the arena */
+        if (!inside((uint8_t *)msg, arena, sizeof(arena)) ||
+                (msg->options_list_ptr && !inside((uint8_t *)msg->options_list_ptr, arena, sizeof(arena)))) {
+            return false;
+        }
+
+        /* Token and payload point into the packet */
+        if ((msg->token_ptr && !inside(msg->token_ptr, packet, len)) ||
+                (msg->payload_ptr && !inside(msg->payload_ptr, packet, len))) {
+            return false;
+        }
+    }
+
+    /* Repeated options are joined in the arena, single ones point into the packet */
+    uint16_t len = build(0);
+    sn_coap_hdr_s *msg = sn_coap_parser_zero_copy(len, packet, &version, arena, SN_COAP_PARSER_ARENA_SIZE(len));
+    if (!inside(msg->uri_path_ptr, arena, sizeof(arena)) ||
+            !inside(msg->options_list_ptr->uri_query_ptr, arena, sizeof(arena))) {
+        return false;
+    }
+
+    len = build(1);
+    msg = sn_coap_parser_zero_copy(len, packet, &version, arena, SN_COAP_PARSER_ARENA_SIZE(len));
+    if (!inside(msg->uri_path_ptr, packet, len) ||
+            !inside(msg->options_list_ptr->uri_host_ptr, packet, len) ||
+            !inside(msg->options_list_ptr->proxy_uri_ptr, packet, len)) {
+        return false;
+    }
+
+    /* The heap parser allocates for the same message */
+    int allocs = coap_test_allocs;
+    sn_coap_hdr_s *heap_msg = sn_coap_parser(&coap_test_handle, len, packet, &version);
+    if (!heap_msg || coap_test_allocs == allocs) {
+        return false;
+    }
+    sn_coap_parser_release_allocated_coap_msg_mem(&coap_test_handle, heap_msg);
+
+    return coap_test_held == 0;
+}
+
+bool test_sn_coap_parser_zero_copy_truncated()
+{
+    for (int i = 0; i < COAP_TEST_MESSAGES; i++) {
+        uint16_t len = build(i);
+        for (uint16_t truncated = 0; truncated <= len; truncated++) {
+            if (!same_result(packet, truncated)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool test_sn_coap_parser_zero_copy_mutated()
+{
+    uint8_t mutated[sizeof(packet)];
+
+    for (int i = 0; i < COAP_TEST_MESSAGES; i++) {
+        uint16_t len = build(i);
+        for (int n = 0; n < 5000; n++) {
+            memcpy(mutated, packet, len);
+
+            /* A few random bytes, biased to the header and options */
+            int changes = 1 + coap_test_random() % 3;
+            while (changes--) {
+                uint16_t at = coap_test_random() % (coap_test_random() % 2 ? 24 : len);
+                if (at < len) {
+                    mutated[at] = coap_test_random();
+                }
+            }
+
+            uint16_t mutated_len = len;
+            if (coap_test_random() % 4 == 0) {
+                mutated_len = 4 + coap_test_random() % (len - 3);
+            }
+
+            if (!same_result(mutated, mutated_len)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool test_sn_coap_parser_zero_copy_arena_exhausted()
+{
+    for (int i = 0; i < COAP_TEST_MESSAGES; i++) {
+        uint16_t len = build(i);
+        uint16_t arena_len = SN_COAP_PARSER_ARENA_SIZE(len);
+        uint8_t *arena = malloc(arena_len + GUARD_LEN);
+        coap_version_e version;
+        bool exhausted = false;
+
+        sn_coap_hdr_s *expected = sn_coap_parser(&coap_test_handle, len, packet, &version);
+
+        for (uint16_t size = 0; size <= arena_len; size++) {
+            memset(arena, 0xa5, arena_len + GUARD_LEN);
+            sn_coap_hdr_s *msg = sn_coap_parser_zero_copy(len, packet, &version, arena, size);
+
+            /* Nothing is written past the arena */
+            for (uint16_t j = size; j < arena_len + GUARD_LEN; j++) {
+                if (arena[j] != 0xa5) {
+                    return false;
+                }
+            }
+
+            /* Too small for the message, for its options, or large enough */
+            if (size < sizeof(sn_coap_hdr_s)) {
+                if (msg) {
+                    return false;
+                }
+            } else if (!msg) {
+                return false;
+            } else if (msg->coap_status == COAP_STATUS_PARSER_ERROR_IN_HEADER) {
+                exhausted = true;
+            } else if (!coap_test_equal(msg, expected)) {
+                return false;
+            }
+
+            if (size == arena_len && (!msg || msg->coap_status != COAP_STATUS_OK)) {
+                return false;
+            }
+        }
+
+        /* Messages with options run out of arena after the header */
+        if (exhausted != (expected->options_list_ptr != NULL || expected->uri_path_ptr != NULL)) {
+            return false;
+        }
+
+        sn_coap_parser_release_allocated_coap_msg_mem(&coap_test_handle, expected);
+        free(arena);
+    }
+
+    return coap_test_held == 0;
+}
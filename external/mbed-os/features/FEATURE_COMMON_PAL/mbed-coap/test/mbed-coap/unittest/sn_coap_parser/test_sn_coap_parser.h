@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2017 ARM Limited. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_SN_COAP_PARSER_H
+#define TEST_SN_COAP_PARSER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+bool test_sn_coap_parser_zero_copy_parameters();
+bool test_sn_coap_parser_zero_copy_views();
+bool test_sn_coap_parser_zero_copy_truncated();
+bool test_sn_coap_parser_zero_copy_mutated();
+bool test_sn_coap_parser_zero_copy_arena_exhausted();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_SN_COAP_PARSER_H
@@ -11,11 +11,11 @@
 
 nsdynmemlib_stub_data_t nsdynmemlib_stub;
 
-void ns_dyn_mem_init(uint8_t *heap, uint16_t h_size, void (*passed_fptr)(heap_fail_t), mem_stat_t *info_ptr)
+void ns_dyn_mem_init(uint8_t *heap, ns_mem_heap_size_t h_size, void (*passed_fptr)(heap_fail_t), mem_stat_t *info_ptr)
 {
 }
 
-void *ns_dyn_mem_alloc(int16_t alloc_size)
+void *ns_dyn_mem_alloc(ns_mem_block_size_t alloc_size)
 {
     if (nsdynmemlib_stub.returnCounter > 0)
     {
@@ -28,7 +28,7 @@ void *ns_dyn_mem_alloc(int16_t alloc_size)
     }
 }
 
-void *ns_dyn_mem_temporary_alloc(int16_t alloc_size)
+void *ns_dyn_mem_temporary_alloc(ns_mem_block_size_t alloc_size)
 {
     if (nsdynmemlib_stub.returnCounter > 0)
     {
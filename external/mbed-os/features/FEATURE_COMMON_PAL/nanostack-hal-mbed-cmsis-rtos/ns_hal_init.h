@@ -19,9 +19,7 @@ extern "C" {
  * they call this first with a "large" heap size, before anyone
  * requests a smaller one.
  *
- * Parameters are as for ns_dyn_mem_init (but note that nsdynmemlib
- * currently limits heap size to 16-bit, so be wary of passing large
- * sizes.
+ * Parameters are as for ns_dyn_mem_init.
  *
  * If heap is NULL, h_size will be allocated from the malloc() heap,
  * else the passed-in pointer will be used.
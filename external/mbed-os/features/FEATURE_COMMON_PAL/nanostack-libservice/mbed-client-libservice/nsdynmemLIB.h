@@ -28,6 +28,9 @@ extern "C" {
 
 #include "ns_types.h"
 
+typedef size_t ns_mem_block_size_t; //external interface unsigned heap block size type
+typedef size_t ns_mem_heap_size_t; //total heap size type.
+
 /*!
  * \enum heap_fail_t
  * \brief Dynamically heap system failure call back event types.
@@ -47,22 +50,39 @@ typedef enum {
  */
 typedef struct mem_stat_t {
     /*Heap stats*/
-    int16_t heap_sector_size;                   /**< Heap total Sector len. */
-    int16_t heap_sector_alloc_cnt;              /**< Reserved Heap sector cnt. */
-    int16_t heap_sector_allocated_bytes;        /**< Reserved Heap data in bytes. */
-    int16_t heap_sector_allocated_bytes_max;    /**< Reserved Heap data in bytes max value. */
+    ns_mem_heap_size_t heap_sector_size;                   /**< Heap total Sector len. */
+    ns_mem_heap_size_t heap_sector_alloc_cnt;              /**< Reserved Heap sector cnt. */
+    ns_mem_heap_size_t heap_sector_allocated_bytes;        /**< Reserved Heap data in bytes. */
+    ns_mem_heap_size_t heap_sector_allocated_bytes_max;    /**< Reserved Heap data in bytes max value. */
     uint32_t heap_alloc_total_bytes;            /**< Total Heap allocated bytes. */
     uint32_t heap_alloc_fail_cnt;               /**< Counter for Heap allocation fail. */
+    /*Small block pool stats*/
+    ns_mem_heap_size_t heap_slab_size;          /**< Heap bytes held by small block pool pages. */
+    uint32_t heap_slab_alloc_cnt;               /**< Counter for allocations served from the small block pools. */
+    /*Fragmentation stats*/
+    uint32_t heap_hole_cnt;                     /**< Current number of free sectors between allocations. */
+    uint32_t heap_hole_cnt_max;                 /**< Free sector count max value. */
+    /*Latency stats, in free sectors visited while searching inside the critical section*/
+    uint32_t heap_alloc_search_cnt;             /**< Counter for free sector searches. */
+    uint32_t heap_alloc_search_total;           /**< Total free sectors visited by searches. */
+    uint32_t heap_alloc_search_max;             /**< Free sectors visited by the longest search. */
 } mem_stat_t;
 
 /**
   * \brief Init and set Dynamical heap pointer and length.
   *
+  * Allocations of up to 64 bytes are served from per-size pools of fixed
+  * size blocks, carved from the heap a page at a time, in front of the
+  * first-fit search of the free sectors. Pools are only used for sizes
+  * whose page fits in an eighth of the heap, so very small heaps behave
+  * as before. Define NS_DYN_MEM_SLAB_OBJECTS to set the number of blocks
+  * in a page, or to 0 to disable the pools.
+  *
   * \param heap_ptr Pointer to dynamically heap buffer
   * \param heap_size size of the heap buffer
   * \return None
   */
-extern void ns_dyn_mem_init(uint8_t *heap, uint16_t h_size, void (*passed_fptr)(heap_fail_t), mem_stat_t *info_ptr);
+extern void ns_dyn_mem_init(uint8_t *heap, ns_mem_heap_size_t h_size, void (*passed_fptr)(heap_fail_t), mem_stat_t *info_ptr);
 
 
 /**
@@ -84,7 +104,7 @@ extern void ns_dyn_mem_free(void *heap_ptr);
   * \return 0, Allocate Fail
   * \return >0, Pointer to allocated data sector.
   */
-extern void *ns_dyn_mem_temporary_alloc(int16_t alloc_size);
+extern void *ns_dyn_mem_temporary_alloc(ns_mem_block_size_t alloc_size);
 /**
   * \brief Allocate long period data.
   *
@@ -95,7 +115,7 @@ extern void *ns_dyn_mem_temporary_alloc(int16_t alloc_size);
   * \return 0, Allocate Fail
   * \return >0, Pointer to allocated data sector.
   */
-extern void *ns_dyn_mem_alloc(int16_t alloc_size);
+extern void *ns_dyn_mem_alloc(ns_mem_block_size_t alloc_size);
 
 /**
   * \brief Get pointer to the current mem_stat_t set via ns_dyn_mem_init.
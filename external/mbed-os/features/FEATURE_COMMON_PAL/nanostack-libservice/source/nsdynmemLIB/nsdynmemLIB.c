@@ -15,6 +15,7 @@
  */
 #include <stdint.h>
 #include <string.h>
+#include <limits.h>
 #include "nsdynmemLIB.h"
 #include "platform/arm_hal_interrupt.h"
 #include <stdlib.h>
@@ -25,12 +26,18 @@ void (*heap_failure_callback)(heap_fail_t);
 #ifndef STANDARD_MALLOC
 static int *heap_main = 0;
 static int *heap_main_end = 0;
-static uint16_t heap_size = 0;
+static ns_mem_heap_size_t heap_size = 0;
 
 typedef enum mem_stat_update_t {
     DEV_HEAP_ALLOC_OK,
     DEV_HEAP_ALLOC_FAIL,
     DEV_HEAP_FREE,
+    DEV_HEAP_SLAB_ALLOC_OK,
+    DEV_HEAP_SLAB_PAGE_ALLOC,
+    DEV_HEAP_SLAB_PAGE_FREE,
+    DEV_HEAP_HOLE_ADD,
+    DEV_HEAP_HOLE_REMOVE,
+    DEV_HEAP_SEARCH,
 } mem_stat_update_t;
 
 
@@ -45,6 +52,9 @@ static NS_LIST_DEFINE(holes_list, hole_t, link);
 // size of a hole_t in our word units
 #define HOLE_T_SIZE ((sizeof(hole_t) + sizeof(int) - 1) / sizeof(int))
 
+// Block sizes are stored in int words, with headroom for the slab tags below
+#define HEAP_WORDS_MAX (INT_MAX / 4)
+
 static NS_INLINE hole_t *hole_from_block_start(int *start)
 {
     return (hole_t *)(start + 1);
@@ -55,6 +65,65 @@ static NS_INLINE int *block_start_from_hole(hole_t *start)
     return ((int *)start) - 1;
 }
 
+/* Small allocations come from per-size-class slab pages, so they neither
+ * walk nor fragment the hole list. A slab page is an ordinary allocated
+ * block holding a slab_page_t followed by fixed size objects, each behind
+ * a one word header. Object headers are tagged well below -HEAP_WORDS_MAX,
+ * so they can't be confused with block sizes, and encode the object's word
+ * offset from the start of its page and whether it is free.
+ */
+#ifndef NS_DYN_MEM_SLAB_OBJECTS
+#define NS_DYN_MEM_SLAB_OBJECTS 8
+#endif
+#if NS_DYN_MEM_SLAB_OBJECTS > 255
+#error "NS_DYN_MEM_SLAB_OBJECTS must be at most 255"
+#endif
+
+typedef struct slab_page {
+    ns_list_link_t link;
+    uint16_t free_head;         // offset of first free object, 0 if none
+    uint8_t free_cnt;
+    uint8_t class_idx;
+    int check;                  // ~page block size, last so overruns into the header are caught
+} slab_page_t;
+
+typedef struct slab_class {
+    NS_LIST_HEAD(slab_page_t, link) pages; // pages with free objects, any empty page last
+    uint8_t obj_words;
+    uint8_t obj_cnt;
+    uint8_t empty_cnt;
+    uint16_t page_words;
+} slab_class_t;
+
+// size of a slab_page_t in our word units
+#define SLAB_PAGE_T_SIZE ((sizeof(slab_page_t) + sizeof(int) - 1) / sizeof(int))
+#define SLAB_CLASS_CNT 6
+#define SLAB_OBJ_WORDS_MAX 16
+
+static const uint8_t slab_obj_words[SLAB_CLASS_CNT] = {2, 4, 6, 8, 12, 16};
+static slab_class_t slab_classes[SLAB_CLASS_CNT];
+// slab class index + 1 for each data size in words, 0 if not served by a slab
+static uint8_t slab_class_lut[SLAB_OBJ_WORDS_MAX + 1];
+
+static NS_INLINE int slab_hdr(int offset, bool free)
+{
+    return INT_MIN + 2 * offset + free;
+}
+
+static NS_INLINE bool slab_hdr_is_tagged(int hdr)
+{
+    return hdr < -HEAP_WORDS_MAX;
+}
+
+static NS_INLINE slab_page_t *slab_page_from_block(int *block)
+{
+    return (slab_page_t *)(block + 1);
+}
+
+static NS_INLINE int *block_from_slab_page(slab_page_t *page)
+{
+    return ((int *)page) - 1;
+}
 
 static void heap_failure(heap_fail_t reason)
 {
@@ -63,9 +132,11 @@ static void heap_failure(heap_fail_t reason)
     }
 }
 
+void dev_stat_update(mem_stat_update_t type, ns_mem_block_size_t size);
+static void slab_init(void);
 #endif
 
-void ns_dyn_mem_init(uint8_t *heap, uint16_t h_size, void (*passed_fptr)(heap_fail_t), mem_stat_t *info_ptr)
+void ns_dyn_mem_init(uint8_t *heap, ns_mem_heap_size_t h_size, void (*passed_fptr)(heap_fail_t), mem_stat_t *info_ptr)
 {
 #ifndef STANDARD_MALLOC
     int *ptr;
@@ -82,6 +153,9 @@ void ns_dyn_mem_init(uint8_t *heap, uint16_t h_size, void (*passed_fptr)(heap_fa
     if (temp_int) {
         h_size -= (sizeof(int) - temp_int);
     }
+    if (h_size > HEAP_WORDS_MAX * sizeof(int)) {
+        h_size = HEAP_WORDS_MAX * sizeof(int);
+    }
     heap_main = (int *)heap; // SET Heap Pointer
     heap_size = h_size; //Set Heap Size
     temp_int = (h_size / sizeof(int));
@@ -96,11 +170,14 @@ void ns_dyn_mem_init(uint8_t *heap, uint16_t h_size, void (*passed_fptr)(heap_fa
     ns_list_add_to_start(&holes_list, hole_from_block_start(heap_main));
 
     //RESET Memory by Hea Len
+    mem_stat_info_ptr = info_ptr;
     if (info_ptr) {
-        mem_stat_info_ptr = info_ptr;
         memset(mem_stat_info_ptr, 0, sizeof(mem_stat_t));
         mem_stat_info_ptr->heap_sector_size = heap_size;
     }
+    dev_stat_update(DEV_HEAP_HOLE_ADD, 0);
+
+    slab_init();
 #endif
     heap_failure_callback = passed_fptr;
 }
@@ -115,10 +192,13 @@ const mem_stat_t *ns_dyn_mem_get_mem_stat(void)
 }
 
 #ifndef STANDARD_MALLOC
-void dev_stat_update(mem_stat_update_t type, int16_t size)
+void dev_stat_update(mem_stat_update_t type, ns_mem_block_size_t size)
 {
     if (mem_stat_info_ptr) {
         switch (type) {
+            case DEV_HEAP_SLAB_ALLOC_OK:
+                mem_stat_info_ptr->heap_slab_alloc_cnt++;
+                /* fall through */
             case DEV_HEAP_ALLOC_OK:
                 mem_stat_info_ptr->heap_sector_alloc_cnt++;
                 mem_stat_info_ptr->heap_sector_allocated_bytes += size;
@@ -134,11 +214,33 @@ void dev_stat_update(mem_stat_update_t type, int16_t size)
                 mem_stat_info_ptr->heap_sector_alloc_cnt--;
                 mem_stat_info_ptr->heap_sector_allocated_bytes -= size;
                 break;
+            case DEV_HEAP_SLAB_PAGE_ALLOC:
+                mem_stat_info_ptr->heap_slab_size += size;
+                break;
+            case DEV_HEAP_SLAB_PAGE_FREE:
+                mem_stat_info_ptr->heap_slab_size -= size;
+                break;
+            case DEV_HEAP_HOLE_ADD:
+                mem_stat_info_ptr->heap_hole_cnt++;
+                if (mem_stat_info_ptr->heap_hole_cnt_max < mem_stat_info_ptr->heap_hole_cnt) {
+                    mem_stat_info_ptr->heap_hole_cnt_max = mem_stat_info_ptr->heap_hole_cnt;
+                }
+                break;
+            case DEV_HEAP_HOLE_REMOVE:
+                mem_stat_info_ptr->heap_hole_cnt--;
+                break;
+            case DEV_HEAP_SEARCH:
+                mem_stat_info_ptr->heap_alloc_search_cnt++;
+                mem_stat_info_ptr->heap_alloc_search_total += size;
+                if (mem_stat_info_ptr->heap_alloc_search_max < size) {
+                    mem_stat_info_ptr->heap_alloc_search_max = size;
+                }
+                break;
         }
     }
 }
 
-static int convert_allocation_size(int16_t requested_bytes)
+static int convert_allocation_size(ns_mem_block_size_t requested_bytes)
 {
     if (heap_main == 0) {
         heap_failure(NS_DYN_MEM_HEAP_SECTOR_UNITIALIZED);
@@ -146,8 +248,10 @@ static int convert_allocation_size(int16_t requested_bytes)
         heap_failure(NS_DYN_MEM_ALLOCATE_SIZE_NOT_VALID);
     } else if (requested_bytes > (heap_size - 2 * sizeof(int)) ) {
         heap_failure(NS_DYN_MEM_ALLOCATE_SIZE_NOT_VALID);
+    } else {
+        return (requested_bytes + sizeof(int) - 1) / sizeof(int);
     }
-    return (requested_bytes + sizeof(int) - 1) / sizeof(int);
+    return 0;
 }
 
 // Checks that block length indicators are valid
@@ -165,20 +269,15 @@ static int8_t ns_block_validate(int *block_start, int direction)
     }
     return ret_val;
 }
-#endif
 
-// For direction, use 1 for direction up and -1 for down
-static void *ns_dyn_mem_internal_alloc(const int16_t alloc_size, int direction)
+// Takes the first big enough hole, searching up (1) or down (-1) the heap.
+// Returns the block start and sets data_size to the size actually used,
+// or returns NULL if no hole is big enough.
+static int *ns_dyn_mem_hole_alloc(int *data_size_ptr, int direction)
 {
-#ifndef STANDARD_MALLOC
+    int data_size = *data_size_ptr;
     int *block_ptr = NULL;
-
-    platform_enter_critical();
-
-    int data_size = convert_allocation_size(alloc_size);
-    if (!data_size) {
-        goto done;
-    }
+    ns_mem_block_size_t visited = 0;
 
     // ns_list_foreach, either forwards or backwards, result to ptr
     for (hole_t *cur_hole = direction > 0 ? ns_list_get_first(&holes_list)
@@ -188,6 +287,7 @@ static void *ns_dyn_mem_internal_alloc(const int16_t alloc_size, int direction)
                                   : ns_list_get_previous(&holes_list, cur_hole)
         ) {
         int *p = block_start_from_hole(cur_hole);
+        visited++;
         if (ns_block_validate(p, direction) != 0 || *p >= 0) {
             //Validation failed, or this supposed hole has positive (allocated) size
             heap_failure(NS_DYN_MEM_HEAP_SECTOR_CORRUPTED);
@@ -199,9 +299,10 @@ static void *ns_dyn_mem_internal_alloc(const int16_t alloc_size, int direction)
             break;
         }
     }
+    dev_stat_update(DEV_HEAP_SEARCH, visited);
 
     if (!block_ptr) {
-        goto done;
+        return NULL;
     }
 
     int block_data_size = -*block_ptr;
@@ -234,46 +335,15 @@ static void *ns_dyn_mem_internal_alloc(const int16_t alloc_size, int direction)
         // Not enough room for a left-over hole, so use the whole block
         data_size = block_data_size;
         ns_list_remove(&holes_list, hole_from_block_start(block_ptr));
+        dev_stat_update(DEV_HEAP_HOLE_REMOVE, 0);
     }
     block_ptr[0] = data_size;
     block_ptr[1 + data_size] = data_size;
 
- done:
-    if (mem_stat_info_ptr) {
-        if (block_ptr) {
-            //Update Allocate OK
-            dev_stat_update(DEV_HEAP_ALLOC_OK, (data_size + 2) * sizeof(int));
-
-        } else {
-            //Update Allocate Fail, second parameter is not used for stats
-            dev_stat_update(DEV_HEAP_ALLOC_FAIL, 0);
-        }
-    }
-    platform_exit_critical();
-
-    return block_ptr ? block_ptr + 1 : NULL;
-#else
-    void *retval = NULL;
-    if (alloc_size) {
-        platform_enter_critical();
-        retval = malloc(alloc_size);
-        platform_exit_critical();
-    }
-    return retval;
-#endif
-}
-
-void *ns_dyn_mem_alloc(int16_t alloc_size)
-{
-    return ns_dyn_mem_internal_alloc(alloc_size, -1);
-}
-
-void *ns_dyn_mem_temporary_alloc(int16_t alloc_size)
-{
-    return ns_dyn_mem_internal_alloc(alloc_size, 1);
+    *data_size_ptr = data_size;
+    return block_ptr;
 }
 
-#ifndef STANDARD_MALLOC
 static void ns_free_and_merge_with_adjacent_blocks(int *cur_block, int data_size)
 {
     // Theory of operation: Block is always in form | Len | Data | Len |
@@ -324,6 +394,7 @@ static void ns_free_and_merge_with_adjacent_blocks(int *cur_block, int data_size
         // Optimisation - note our position for insertion below.
         before = ns_list_get_next(&holes_list, existing_end);
         ns_list_remove(&holes_list, existing_end);
+        dev_stat_update(DEV_HEAP_HOLE_REMOVE, 0);
     }
     if (existing_start) {
         // Extending hole described by "existing_start" upwards.
@@ -348,14 +419,229 @@ static void ns_free_and_merge_with_adjacent_blocks(int *cur_block, int data_size
             } else {
                 ns_list_add_to_end(&holes_list, to_add);
             }
+            dev_stat_update(DEV_HEAP_HOLE_ADD, 0);
 
         }
     }
     *start = -merged_data_size;
     *end = -merged_data_size;
 }
+
+static void slab_init(void)
+{
+    memset(slab_class_lut, 0, sizeof(slab_class_lut));
+    for (int i = 0; i < SLAB_CLASS_CNT; i++) {
+        slab_class_t *cls = &slab_classes[i];
+        ns_list_init(&cls->pages);
+        cls->obj_words = slab_obj_words[i];
+        cls->obj_cnt = NS_DYN_MEM_SLAB_OBJECTS;
+        cls->empty_cnt = 0;
+        cls->page_words = SLAB_PAGE_T_SIZE + cls->obj_cnt * (cls->obj_words + 1);
+
+        // Leave small heaps to the holes, a page must fit in an eighth of the heap
+        if (cls->obj_cnt < 2 || (cls->page_words + 2) * sizeof(int) * 8 > heap_size) {
+            continue;
+        }
+        for (int words = i ? slab_obj_words[i - 1] + 1 : 1; words <= cls->obj_words; words++) {
+            slab_class_lut[words] = i + 1;
+        }
+    }
+}
+
+static void ns_dyn_mem_slab_page_free(int *block)
+{
+    int size = *block;
+    dev_stat_update(DEV_HEAP_SLAB_PAGE_FREE, (size + 2) * sizeof(int));
+    ns_free_and_merge_with_adjacent_blocks(block, size);
+}
+
+static int *ns_dyn_mem_slab_alloc(slab_class_t *cls)
+{
+    slab_page_t *page = ns_list_get_first(&cls->pages);
+    int first = 1 + SLAB_PAGE_T_SIZE;
+    int *block;
+
+    if (page) {
+        block = block_from_slab_page(page);
+        if (ns_block_validate(block, 1) != 0 || page->check != ~*block) {
+            heap_failure(NS_DYN_MEM_HEAP_SECTOR_CORRUPTED);
+            return NULL;
+        }
+    } else {
+        // Pages are long lived, so take them from the end of the heap
+        int data_size = cls->page_words;
+        block = ns_dyn_mem_hole_alloc(&data_size, -1);
+        if (!block) {
+            return NULL;
+        }
+        dev_stat_update(DEV_HEAP_SLAB_PAGE_ALLOC, (data_size + 2) * sizeof(int));
+
+        page = slab_page_from_block(block);
+        page->free_head = first;
+        page->free_cnt = cls->obj_cnt;
+        page->class_idx = cls - slab_classes;
+        page->check = ~*block;
+        for (int i = 0, offset = first; i < cls->obj_cnt; i++, offset += cls->obj_words + 1) {
+            block[offset] = slab_hdr(offset, true);
+            block[offset + 1] = i + 1 < cls->obj_cnt ? offset + cls->obj_words + 1 : 0;
+        }
+        ns_list_add_to_start(&cls->pages, page);
+        cls->empty_cnt++;
+    }
+
+    int offset = page->free_head;
+    int *obj = block + offset;
+    if (offset < first || offset > cls->page_words || *obj != slab_hdr(offset, true)) {
+        // Free list was written to after free
+        heap_failure(NS_DYN_MEM_HEAP_SECTOR_CORRUPTED);
+        return NULL;
+    }
+    page->free_head = obj[1];
+    if (page->free_cnt-- == cls->obj_cnt) {
+        cls->empty_cnt--;
+    }
+    if (page->free_cnt == 0) {
+        ns_list_remove(&cls->pages, page);
+    }
+    *obj = slab_hdr(offset, false);
+    return obj;
+}
+
+static void ns_dyn_mem_slab_free(int *obj)
+{
+    unsigned tag = (unsigned)*obj - (unsigned)INT_MIN;
+    int offset = tag / 2;
+    int first = 1 + SLAB_PAGE_T_SIZE;
+
+    if (tag & 1) {
+        heap_failure(NS_DYN_MEM_DOUBLE_FREE);
+        return;
+    }
+    if (offset > obj - heap_main) {
+        heap_failure(NS_DYN_MEM_POINTER_NOT_VALID);
+        return;
+    }
+
+    int *block = obj - offset;
+    slab_page_t *page = slab_page_from_block(block);
+    if (*block <= 0 || (block + *block) >= heap_main_end ||
+            ns_block_validate(block, 1) != 0 || page->check != ~*block ||
+            page->class_idx >= SLAB_CLASS_CNT) {
+        heap_failure(NS_DYN_MEM_HEAP_SECTOR_CORRUPTED);
+        return;
+    }
+
+    slab_class_t *cls = &slab_classes[page->class_idx];
+    if (offset < first || offset > cls->page_words ||
+            (offset - first) % (cls->obj_words + 1) != 0) {
+        heap_failure(NS_DYN_MEM_POINTER_NOT_VALID);
+        return;
+    }
+
+    obj[0] = slab_hdr(offset, true);
+    obj[1] = page->free_head;
+    page->free_head = offset;
+    if (page->free_cnt++ == 0) {
+        ns_list_add_to_start(&cls->pages, page);
+    }
+    if (page->free_cnt == cls->obj_cnt) {
+        // Keep one empty page per class, so alloc/free churn stays off the
+        // holes, and queue it last so partial pages are filled first
+        ns_list_remove(&cls->pages, page);
+        if (cls->empty_cnt) {
+            ns_dyn_mem_slab_page_free(block);
+        } else {
+            ns_list_add_to_end(&cls->pages, page);
+            cls->empty_cnt++;
+        }
+    }
+    dev_stat_update(DEV_HEAP_FREE, (cls->obj_words + 1) * sizeof(int));
+}
+
+// Gives the cached empty pages back to the holes, returns true if any were
+static bool ns_dyn_mem_slab_release_empty(void)
+{
+    bool released = false;
+    for (int i = 0; i < SLAB_CLASS_CNT; i++) {
+        slab_class_t *cls = &slab_classes[i];
+        if (cls->empty_cnt) {
+            slab_page_t *page = ns_list_get_last(&cls->pages);
+            ns_list_remove(&cls->pages, page);
+            cls->empty_cnt--;
+            ns_dyn_mem_slab_page_free(block_from_slab_page(page));
+            released = true;
+        }
+    }
+    return released;
+}
 #endif
 
+// For direction, use 1 for direction up and -1 for down
+static void *ns_dyn_mem_internal_alloc(const ns_mem_block_size_t alloc_size, int direction)
+{
+#ifndef STANDARD_MALLOC
+    int *block_ptr = NULL;
+    slab_class_t *cls = NULL;
+
+    platform_enter_critical();
+
+    int data_size = convert_allocation_size(alloc_size);
+    if (!data_size) {
+        goto done;
+    }
+
+    if (data_size <= SLAB_OBJ_WORDS_MAX && slab_class_lut[data_size]) {
+        cls = &slab_classes[slab_class_lut[data_size] - 1];
+        block_ptr = ns_dyn_mem_slab_alloc(cls);
+        if (block_ptr) {
+            goto done;
+        }
+        // No room for a new page, try to squeeze it into a hole
+        cls = NULL;
+    }
+
+    block_ptr = ns_dyn_mem_hole_alloc(&data_size, direction);
+    if (!block_ptr && ns_dyn_mem_slab_release_empty()) {
+        block_ptr = ns_dyn_mem_hole_alloc(&data_size, direction);
+    }
+
+ done:
+    if (mem_stat_info_ptr) {
+        if (cls) {
+            dev_stat_update(DEV_HEAP_SLAB_ALLOC_OK, (cls->obj_words + 1) * sizeof(int));
+        } else if (block_ptr) {
+            //Update Allocate OK
+            dev_stat_update(DEV_HEAP_ALLOC_OK, (data_size + 2) * sizeof(int));
+
+        } else {
+            //Update Allocate Fail, second parameter is not used for stats
+            dev_stat_update(DEV_HEAP_ALLOC_FAIL, 0);
+        }
+    }
+    platform_exit_critical();
+
+    return block_ptr ? block_ptr + 1 : NULL;
+#else
+    void *retval = NULL;
+    if (alloc_size) {
+        platform_enter_critical();
+        retval = malloc(alloc_size);
+        platform_exit_critical();
+    }
+    return retval;
+#endif
+}
+
+void *ns_dyn_mem_alloc(ns_mem_block_size_t alloc_size)
+{
+    return ns_dyn_mem_internal_alloc(alloc_size, -1);
+}
+
+void *ns_dyn_mem_temporary_alloc(ns_mem_block_size_t alloc_size)
+{
+    return ns_dyn_mem_internal_alloc(alloc_size, 1);
+}
+
 void ns_dyn_mem_free(void *block)
 {
 #ifndef STANDARD_MALLOC
@@ -373,12 +659,17 @@ void ns_dyn_mem_free(void *block)
 
     platform_enter_critical();
     ptr --;
+    if (ptr < heap_main || ptr >= heap_main_end) {
+        heap_failure(NS_DYN_MEM_POINTER_NOT_VALID);
+        platform_exit_critical();
+        return;
+    }
     //Read Current Size
     size = *ptr;
-    if (size < 0) {
+    if (slab_hdr_is_tagged(size)) {
+        ns_dyn_mem_slab_free(ptr);
+    } else if (size < 0) {
         heap_failure(NS_DYN_MEM_DOUBLE_FREE);
-    } else if (ptr < heap_main || ptr >= heap_main_end) {
-        heap_failure(NS_DYN_MEM_POINTER_NOT_VALID);
     } else if ((ptr + size) >= heap_main_end) {
         heap_failure(NS_DYN_MEM_POINTER_NOT_VALID);
     } else {
@@ -17,6 +17,8 @@
 #include "nsdynmemLIB.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include "error_callback.h"
 
 TEST_GROUP(dynmem)
@@ -429,6 +431,219 @@ TEST(dynmem, test_invalid_pointer_freed) {
     free(heap);
 }
 
+TEST(dynmem, large_heap)
+{
+    uint32_t size = 100000;
+    mem_stat_t info;
+    uint8_t *heap = (uint8_t*)malloc(size);
+    CHECK(NULL != heap);
+    reset_heap_error();
+    ns_dyn_mem_init(heap, size, &heap_fail_callback, &info);
+    CHECK(info.heap_sector_size >= (size-4));
+    CHECK(!heap_have_failed());
+    void *p = ns_dyn_mem_alloc(40000);
+    CHECK(p);
+    void *p2 = ns_dyn_mem_temporary_alloc(40000);
+    CHECK(p2);
+    CHECK(info.heap_sector_allocated_bytes >= 80000);
+    ns_dyn_mem_free(p);
+    ns_dyn_mem_free(p2);
+    CHECK(!heap_have_failed());
+    CHECK(info.heap_sector_allocated_bytes == 0);
+    free(heap);
+}
+
+TEST(dynmem, small_blocks_from_slabs)
+{
+    uint16_t size = 4000;
+    mem_stat_t info;
+    void *p[64];
+    uint8_t *heap = (uint8_t*)malloc(size);
+    CHECK(NULL != heap);
+    reset_heap_error();
+    ns_dyn_mem_init(heap, size, &heap_fail_callback, &info);
+    CHECK(!heap_have_failed());
+    for (int i = 0; i < 64; i++) {
+        p[i] = ns_dyn_mem_alloc(1 + (i % 24));
+        CHECK(p[i]);
+        memset(p[i], 0xff, 1 + (i % 24));
+    }
+    CHECK(!heap_have_failed());
+    CHECK(info.heap_slab_alloc_cnt == 64);
+    CHECK(info.heap_slab_size > 0);
+    CHECK(info.heap_sector_alloc_cnt == 64);
+    CHECK(info.heap_hole_cnt == 1);
+
+    // Churn doesn't touch the holes
+    uint32_t searches = info.heap_alloc_search_cnt;
+    for (int i = 0; i < 1000; i++) {
+        ns_dyn_mem_free(p[i % 64]);
+        p[i % 64] = ns_dyn_mem_temporary_alloc(1 + (i % 64) % 24);
+        CHECK(p[i % 64]);
+    }
+    CHECK(!heap_have_failed());
+    CHECK(info.heap_alloc_search_cnt == searches);
+    CHECK(info.heap_hole_cnt == 1);
+
+    for (int i = 0; i < 64; i++) {
+        ns_dyn_mem_free(p[i]);
+    }
+    CHECK(!heap_have_failed());
+    CHECK(info.heap_sector_alloc_cnt == 0);
+    CHECK(info.heap_sector_allocated_bytes == 0);
+
+    // Only cached empty pages are left, and they make way for a big block
+    void *big = ns_dyn_mem_alloc(size - 16);
+    CHECK(big);
+    CHECK(info.heap_slab_size == 0);
+    ns_dyn_mem_free(big);
+    CHECK(!heap_have_failed());
+    free(heap);
+}
+
+TEST(dynmem, slab_double_free)
+{
+    uint16_t size = 4000;
+    mem_stat_t info;
+    uint8_t *heap = (uint8_t*)malloc(size);
+    CHECK(NULL != heap);
+    reset_heap_error();
+    ns_dyn_mem_init(heap, size, &heap_fail_callback, &info);
+    void *p = ns_dyn_mem_alloc(8);
+    void *p2 = ns_dyn_mem_alloc(8);
+    CHECK(p && p2);
+    CHECK(info.heap_slab_alloc_cnt == 2);
+    ns_dyn_mem_free(p);
+    CHECK(!heap_have_failed());
+    ns_dyn_mem_free(p);
+    CHECK(heap_have_failed());
+    CHECK(NS_DYN_MEM_DOUBLE_FREE == current_heap_error);
+    reset_heap_error();
+    ns_dyn_mem_free((uint8_t *)p2 + sizeof(int));
+    CHECK(heap_have_failed());
+    free(heap);
+}
+
+TEST(dynmem, fragmentation_stats)
+{
+    uint16_t size = 4000;
+    mem_stat_t info;
+    void *p[8];
+    uint8_t *heap = (uint8_t*)malloc(size);
+    CHECK(NULL != heap);
+    reset_heap_error();
+    ns_dyn_mem_init(heap, size, &heap_fail_callback, &info);
+    CHECK(info.heap_hole_cnt == 1);
+    for (int i = 0; i < 8; i++) {
+        p[i] = ns_dyn_mem_temporary_alloc(200);
+        CHECK(p[i]);
+    }
+    CHECK(info.heap_hole_cnt == 1);
+    for (int i = 0; i < 8; i += 2) {
+        ns_dyn_mem_free(p[i]);
+    }
+    CHECK(info.heap_hole_cnt == 5);
+    CHECK(info.heap_hole_cnt_max == 5);
+
+    // A block bigger than the holes walks past all of them
+    uint32_t searches = info.heap_alloc_search_cnt;
+    CHECK(ns_dyn_mem_temporary_alloc(300));
+    CHECK(info.heap_alloc_search_cnt == searches + 1);
+    CHECK(info.heap_alloc_search_max == 5);
+
+    for (int i = 1; i < 8; i += 2) {
+        ns_dyn_mem_free(p[i]);
+    }
+    CHECK(!heap_have_failed());
+    CHECK(info.heap_hole_cnt == 2);
+    free(heap);
+}
+
+// Replays a synthetic border router trace: heavy churn of small buffer
+// headers, timers and list entries, a handful of in-flight packet
+// buffers, and slowly changing routing and neighbour entries
+static uint32_t trace_rand_state;
+
+static uint32_t trace_rand()
+{
+    trace_rand_state = trace_rand_state * 1103515245 + 12345;
+    return trace_rand_state >> 8;
+}
+
+static void trace_toggle(void **p, uint32_t size, bool temporary, int *fails)
+{
+    if (*p) {
+        ns_dyn_mem_free(*p);
+        *p = NULL;
+        return;
+    }
+
+    *p = temporary ? ns_dyn_mem_temporary_alloc(size) : ns_dyn_mem_alloc(size);
+    if (!*p) {
+        (*fails)++;
+    }
+}
+
+static int trace_replay(uint8_t *heap, uint32_t size, int ops, mem_stat_t *info)
+{
+    static const uint16_t small_sizes[] = {12, 16, 20, 24, 32, 36, 48};
+    static const uint16_t entry_sizes[] = {20, 28, 40, 64, 96, 120};
+    void *small[256] = {0};
+    void *packets[8] = {0};
+    void *entries[96] = {0};
+    int fails = 0;
+
+    trace_rand_state = 12345;
+    ns_dyn_mem_init(heap, size, &heap_fail_callback, info);
+    for (int i = 0; i < ops; i++) {
+        uint32_t r = trace_rand() % 100;
+        if (r < 85) {
+            void **p = &small[trace_rand() % 256];
+            trace_toggle(p, small_sizes[trace_rand() % 7], trace_rand() & 1, &fails);
+        } else if (r < 97) {
+            void **p = &packets[trace_rand() % 8];
+            trace_toggle(p, 64 + trace_rand() % 1216, true, &fails);
+        } else {
+            void **p = &entries[trace_rand() % 96];
+            if (!*p || trace_rand() % 10 == 0) {
+                trace_toggle(p, entry_sizes[trace_rand() % 6], false, &fails);
+            }
+        }
+    }
+
+    return fails;
+}
+
+TEST(dynmem, trace_replay)
+{
+    uint32_t size = 28000;
+    mem_stat_t info;
+    uint8_t *heap = (uint8_t*)malloc(size);
+    CHECK(NULL != heap);
+    reset_heap_error();
+
+    clock_t start = clock();
+    int fails = trace_replay(heap, size, 1000000, &info);
+    clock_t end = clock();
+    CHECK(!heap_have_failed());
+
+    uint32_t allocs = info.heap_alloc_search_cnt + info.heap_slab_alloc_cnt;
+    double visited_avg = (double)info.heap_alloc_search_total / allocs;
+    printf("\ntrace replay: %.0f ns/op, %d failures, slab hits %u of %u, "
+           "holes max %u, holes visited per alloc avg %.1f max %u\n",
+           (end - start) * 1e9 / CLOCKS_PER_SEC / 1000000, fails,
+           (unsigned)info.heap_slab_alloc_cnt, (unsigned)allocs,
+           (unsigned)info.heap_hole_cnt_max, visited_avg,
+           (unsigned)info.heap_alloc_search_max);
+
+    // Small blocks are served from the pools, so on average an allocation
+    // visits less than one hole inside the critical section
+    CHECK(fails == 0);
+    CHECK(info.heap_slab_alloc_cnt > info.heap_alloc_search_cnt);
+    CHECK(visited_avg < 1.0);
+    free(heap);
+}
+
 //NOTE! This test must be last!
 TEST(dynmem, uninitialized_test){
     ns_dyn_mem_alloc(4);
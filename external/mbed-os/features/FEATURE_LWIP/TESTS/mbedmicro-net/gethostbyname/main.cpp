@@ -88,6 +88,44 @@ void test_dns_literal_pref() {
     TEST_ASSERT(strcmp(ip_literal, addr.get_ip_address()) == 0);
 }
 
+#if MBED_CONF_NSAPI_DNS_CACHE_SIZE > 0
+void test_dns_query_cached() {
+    SocketAddress first;
+    int err = net.gethostbyname(MBED_DNS_TEST_HOST, &first);
+    TEST_ASSERT_EQUAL(0, err);
+
+    // a repeated query, in any case, is answered from the cache
+    // without a round trip to the servers
+    Timer timer;
+    timer.start();
+    SocketAddress addr;
+    err = net.gethostbyname(MBED_DNS_TEST_HOST, &addr);
+    timer.stop();
+    printf("DNS: cached query \"%s\" => \"%s\" in %dus\n",
+            MBED_DNS_TEST_HOST, addr.get_ip_address(), timer.read_us());
+
+    TEST_ASSERT_EQUAL(0, err);
+    TEST_ASSERT(first == addr);
+    TEST_ASSERT(timer.read_ms() < 10);
+}
+
+void test_dns_query_cached_failure() {
+    SocketAddress addr;
+    int err = net.gethostbyname("nonexistent.invalid", &addr);
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_DNS_FAILURE, err);
+
+    Timer timer;
+    timer.start();
+    err = net.gethostbyname("NONEXISTENT.invalid", &addr);
+    timer.stop();
+    printf("DNS: cached failure \"%s\" in %dus\n",
+            "nonexistent.invalid", timer.read_us());
+
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_DNS_FAILURE, err);
+    TEST_ASSERT(timer.read_ms() < 10);
+}
+#endif
+
 
 // Test setup
 utest::v1::status_t test_setup(const size_t number_of_cases) {
@@ -101,6 +139,10 @@ Case cases[] = {
     Case("Testing DNS preference query",    test_dns_query_pref),
     Case("Testing DNS literal",             test_dns_literal),
     Case("Testing DNS preference literal",  test_dns_literal_pref),
+#if MBED_CONF_NSAPI_DNS_CACHE_SIZE > 0
+    Case("Testing DNS cached query",        test_dns_query_cached),
+    Case("Testing DNS cached failure",      test_dns_query_cached_failure),
+#endif
 };
 
 Specification specification(test_setup, cases);
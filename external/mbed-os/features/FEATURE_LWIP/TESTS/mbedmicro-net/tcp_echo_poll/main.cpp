@@ -0,0 +1,139 @@
+#if !FEATURE_LWIP
+    #error [NOT_SUPPORTED] LWIP not supported for this target
+#endif
+#if DEVICE_EMAC
+    #error [NOT_SUPPORTED] Not supported for WiFi targets
+#endif
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "TCPSocket.h"
+#include "nsapi_poll.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+
+
+#ifndef MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE
+#define MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE 64
+#endif
+
+#ifndef MBED_CFG_TCP_CLIENT_ECHO_SOCKETS
+#define MBED_CFG_TCP_CLIENT_ECHO_SOCKETS 3
+#endif
+
+
+EthernetInterface net;
+SocketAddress tcp_addr;
+
+void prep_buffer(char *tx_buffer, size_t tx_size) {
+    for (size_t i=0; i<tx_size; ++i) {
+        tx_buffer[i] = (rand() % 10) + '0';
+    }
+}
+
+
+// Each echo class is in charge of one transaction, all of them
+// are served from the main thread with nsapi_poll
+class Echo {
+private:
+    char tx_buffer[MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE];
+    char rx_buffer[MBED_CFG_TCP_CLIENT_ECHO_BUFFER_SIZE];
+    size_t rx_size;
+
+public:
+    TCPSocket sock;
+
+    void start() {
+        int err = sock.open(&net);
+        TEST_ASSERT_EQUAL(0, err);
+
+        err = sock.connect(tcp_addr);
+        TEST_ASSERT_EQUAL(0, err);
+
+        printf("HTTP: Connected to %s:%d\r\n",
+                tcp_addr.get_ip_address(), tcp_addr.get_port());
+
+        prep_buffer(tx_buffer, sizeof(tx_buffer));
+        const int ret = sock.send(tx_buffer, sizeof(tx_buffer));
+        TEST_ASSERT_EQUAL(sizeof(tx_buffer), ret);
+
+        rx_size = 0;
+        sock.set_blocking(false);
+    }
+
+    // Returns true once the whole echo has been received
+    bool event() {
+        while (rx_size < sizeof(rx_buffer)) {
+            int ret = sock.recv(&rx_buffer[rx_size], sizeof(rx_buffer) - rx_size);
+            if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+                return false;
+            }
+
+            TEST_ASSERT(ret > 0);
+            rx_size += ret;
+        }
+
+        bool result = !memcmp(tx_buffer, rx_buffer, sizeof(tx_buffer));
+        TEST_ASSERT_EQUAL(true, result);
+
+        int err = sock.close();
+        TEST_ASSERT_EQUAL(0, err);
+        return true;
+    }
+};
+
+Echo echoers[MBED_CFG_TCP_CLIENT_ECHO_SOCKETS];
+nsapi_pollsock_t socks[MBED_CFG_TCP_CLIENT_ECHO_SOCKETS];
+
+
+int main() {
+    GREENTEA_SETUP(60, "tcp_echo");
+
+    int err = net.connect();
+    TEST_ASSERT_EQUAL(0, err);
+
+    printf("MBED: TCPClient IP address is '%s'\n", net.get_ip_address());
+    printf("MBED: TCPClient waiting for server IP and port...\n");
+
+    greentea_send_kv("target_ip", net.get_ip_address());
+
+    char recv_key[] = "host_port";
+    char ipbuf[60] = {0};
+    char portbuf[16] = {0};
+    unsigned int port = 0;
+
+    greentea_send_kv("host_ip", " ");
+    greentea_parse_kv(recv_key, ipbuf, sizeof(recv_key), sizeof(ipbuf));
+
+    greentea_send_kv("host_port", " ");
+    greentea_parse_kv(recv_key, portbuf, sizeof(recv_key), sizeof(ipbuf));
+    sscanf(portbuf, "%u", &port);
+
+    printf("MBED: Server IP address received: %s:%d \n", ipbuf, port);
+    tcp_addr.set_ip_address(ipbuf);
+    tcp_addr.set_port(port);
+
+    for (int i = 0; i < MBED_CFG_TCP_CLIENT_ECHO_SOCKETS; i++) {
+        echoers[i].start();
+        socks[i].socket = &echoers[i].sock;
+        socks[i].events = NSAPI_POLLIN;
+    }
+
+    // Serve all sockets from this thread, each stays readable until
+    // a recv would block so data that arrived early is not missed
+    int done = 0;
+    while (done < MBED_CFG_TCP_CLIENT_ECHO_SOCKETS) {
+        int ready = nsapi_poll(socks, MBED_CFG_TCP_CLIENT_ECHO_SOCKETS, 10000);
+        TEST_ASSERT(ready > 0);
+
+        for (int i = 0; i < MBED_CFG_TCP_CLIENT_ECHO_SOCKETS; i++) {
+            if ((socks[i].revents & NSAPI_POLLIN) && echoers[i].event()) {
+                socks[i].socket = NULL;
+                done += 1;
+            }
+        }
+    }
+
+    net.disconnect();
+    GREENTEA_TESTSUITE_RESULT(true);
+}
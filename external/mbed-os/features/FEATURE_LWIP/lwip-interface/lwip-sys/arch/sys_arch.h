@@ -51,7 +51,7 @@ typedef struct {
 } sys_mutex_t;
 
 // === MAIL BOX ===
-#define MB_SIZE      8
+#define MB_SIZE      MBOX_SIZE
 
 typedef struct {
     osMessageQId    id;
@@ -846,6 +846,184 @@ static nsapi_size_or_error_t mbed_lwip_socket_recvfrom(nsapi_stack_t *stack, nsa
     return recv;
 }
 
+static nsapi_size_or_error_t mbed_lwip_socket_sendv(nsapi_stack_t *stack, nsapi_socket_t handle, const nsapi_iovec_t *iov, unsigned count, int flags)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    nsapi_size_t sent = 0;
+
+    /* The data is always copied, without NETCONN_COPY lwIP would reference
+     * it until it is acked and nothing tells the caller when that is */
+    u8_t apiflags = NETCONN_COPY;
+
+    for (unsigned i = 0; i < count; i++) {
+        if (iov[i].size == 0) {
+            continue;
+        }
+
+        /* Hold off the push flag until the last buffer */
+        u8_t more = (i + 1 < count) ? NETCONN_MORE : 0;
+        size_t bytes_written = 0;
+
+        err_t err = netconn_write_partly(s->conn, iov[i].data, iov[i].size, apiflags | more, &bytes_written);
+        if (err != ERR_OK) {
+            /* Only report the error if nothing has been queued yet */
+            if (sent) {
+                break;
+            }
+
+            return mbed_lwip_err_remap(err);
+        }
+
+        sent += bytes_written;
+        if (bytes_written < iov[i].size) {
+            break;
+        }
+    }
+
+    return (nsapi_size_or_error_t)sent;
+}
+
+static nsapi_size_or_error_t mbed_lwip_socket_recv_buffer(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_buffer_t *buffer)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+
+    if (!s->buf) {
+        err_t err = netconn_recv(s->conn, &s->buf);
+        s->offset = 0;
+
+        if (err != ERR_OK) {
+            return mbed_lwip_err_remap(err);
+        }
+    }
+
+    /* Find the pbuf holding the current offset */
+    struct pbuf *p = s->buf->p;
+    u16_t offset = s->offset;
+    while (offset >= p->len) {
+        offset -= p->len;
+        p = p->next;
+    }
+
+    /* Loan out the rest of the pbuf, the extra reference keeps it
+     * alive after the netbuf is deleted */
+    pbuf_ref(p);
+    buffer->data = (const u8_t *)p->payload + offset;
+    buffer->size = p->len - offset;
+    buffer->handle = p;
+
+    s->offset += buffer->size;
+
+    if (s->offset >= netbuf_len(s->buf)) {
+        netbuf_delete(s->buf);
+        s->buf = 0;
+    }
+
+    return buffer->size;
+}
+
+static nsapi_size_or_error_t mbed_lwip_socket_sendtov(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_addr_t addr, uint16_t port, const nsapi_iovec_t *iov, unsigned count, int flags)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    ip_addr_t ip_addr;
+
+    if (!convert_mbed_addr_to_lwip(&ip_addr, &addr)) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    nsapi_size_t size = 0;
+    for (unsigned i = 0; i < count; i++) {
+        size += iov[i].size;
+    }
+
+    if (size > 0xffff) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    /* Chain references to the caller's buffers instead of gathering them,
+     * UDP is sent before netconn_sendto returns and lwIP copies referenced
+     * data if it needs to queue the packet, so NSAPI_SEND_NOCOPY is implied */
+    struct netbuf *buf = netbuf_new();
+    if (!buf) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        if (iov[i].size == 0 && buf->p) {
+            continue;
+        }
+
+        struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, 0, PBUF_REF);
+        if (!p) {
+            netbuf_delete(buf);
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+
+        p->payload = (void *)iov[i].data;
+        p->len = p->tot_len = (u16_t)iov[i].size;
+
+        if (buf->p) {
+            pbuf_cat(buf->p, p);
+        } else {
+            buf->p = p;
+            buf->ptr = p;
+        }
+    }
+
+    if (!buf->p) {
+        netbuf_delete(buf);
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    err_t err = netconn_sendto(s->conn, buf, &ip_addr, port);
+    netbuf_delete(buf);
+    if (err != ERR_OK) {
+        return mbed_lwip_err_remap(err);
+    }
+
+    return size;
+}
+
+static nsapi_size_or_error_t mbed_lwip_socket_recvfrom_buffer(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_addr_t *addr, uint16_t *port, nsapi_buffer_t *buffer)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    struct netbuf *buf;
+
+    err_t err = netconn_recv(s->conn, &buf);
+    if (err != ERR_OK) {
+        return mbed_lwip_err_remap(err);
+    }
+
+    convert_lwip_addr_to_mbed(addr, netbuf_fromaddr(buf));
+    *port = netbuf_fromport(buf);
+
+    /* Take the packet out of the netbuf */
+    struct pbuf *p = buf->p;
+    buf->p = 0;
+    buf->ptr = 0;
+    netbuf_delete(buf);
+
+    /* Packets are usually a single pbuf, but chained packets must be
+     * flattened to be loaned out as a single buffer */
+    if (p->next) {
+        p = pbuf_coalesce(p, PBUF_RAW);
+        if (p->next) {
+            pbuf_free(p);
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+    }
+
+    buffer->data = p->payload;
+    buffer->size = p->len;
+    buffer->handle = p;
+
+    return buffer->size;
+}
+
+static void mbed_lwip_socket_free_buffer(nsapi_stack_t *stack, nsapi_buffer_t *buffer)
+{
+    pbuf_free((struct pbuf *)buffer->handle);
+}
+
 static nsapi_error_t mbed_lwip_setsockopt(nsapi_stack_t *stack, nsapi_socket_t handle, int level, int optname, const void *optval, unsigned optlen)
 {
     struct lwip_socket *s = (struct lwip_socket *)handle;
@@ -916,6 +1094,11 @@ const nsapi_stack_api_t lwip_stack_api = {
     .socket_recvfrom    = mbed_lwip_socket_recvfrom,
     .setsockopt         = mbed_lwip_setsockopt,
     .socket_attach      = mbed_lwip_socket_attach,
+    .socket_sendv       = mbed_lwip_socket_sendv,
+    .socket_recv_buffer = mbed_lwip_socket_recv_buffer,
+    .socket_sendtov     = mbed_lwip_socket_sendtov,
+    .socket_recvfrom_buffer = mbed_lwip_socket_recvfrom_buffer,
+    .socket_free_buffer = mbed_lwip_socket_free_buffer,
 };
 
 nsapi_stack_t lwip_stack = {
@@ -74,11 +74,21 @@
 
 #define LWIP_RAW                    0
 
-#define TCPIP_MBOX_SIZE             8
-#define DEFAULT_TCP_RECVMBOX_SIZE   8
-#define DEFAULT_UDP_RECVMBOX_SIZE   8
-#define DEFAULT_RAW_RECVMBOX_SIZE   8
-#define DEFAULT_ACCEPTMBOX_SIZE     8
+// Size of the mailboxes, the throughput profile needs room for a full
+// window of segments on each TCP connection
+#if defined(MBED_CONF_LWIP_MBOX_SIZE)
+#define MBOX_SIZE                   MBED_CONF_LWIP_MBOX_SIZE
+#elif MBED_CONF_LWIP_THROUGHPUT_PROFILE
+#define MBOX_SIZE                   16
+#else
+#define MBOX_SIZE                   8
+#endif
+
+#define TCPIP_MBOX_SIZE             MBOX_SIZE
+#define DEFAULT_TCP_RECVMBOX_SIZE   MBOX_SIZE
+#define DEFAULT_UDP_RECVMBOX_SIZE   MBOX_SIZE
+#define DEFAULT_RAW_RECVMBOX_SIZE   MBOX_SIZE
+#define DEFAULT_ACCEPTMBOX_SIZE     MBOX_SIZE
 
 #ifdef LWIP_DEBUG
 #define TCPIP_THREAD_STACKSIZE      1200*2
@@ -106,10 +116,16 @@
 #define LWIP_RAM_HEAP_POINTER       lwip_ram_heap
 
 // Number of pool pbufs.
-// Each requires 684 bytes of RAM.
+// Each requires 684 bytes of RAM, or 1608 bytes with a 1460 byte MSS.
 #ifndef PBUF_POOL_SIZE
+#if defined(MBED_CONF_LWIP_PBUF_POOL_SIZE)
+#define PBUF_POOL_SIZE              MBED_CONF_LWIP_PBUF_POOL_SIZE
+#elif MBED_CONF_LWIP_THROUGHPUT_PROFILE
+#define PBUF_POOL_SIZE              8
+#else
 #define PBUF_POOL_SIZE              5
 #endif
+#endif
 
 // One tcp_pcb_listen is needed for each TCPServer.
 // Each requires 72 bytes of RAM.
@@ -154,8 +170,67 @@
 #define MEMP_NUM_NETCONN            4
 #endif
 
+// TCP segment size, window and send buffer.
+// Transport defaults are below, the configured sizes override them.
+#ifdef MBED_CONF_LWIP_TCP_MSS
+#define TCP_MSS                     MBED_CONF_LWIP_TCP_MSS
+#elif MBED_CONF_LWIP_THROUGHPUT_PROFILE && LWIP_TRANSPORT_ETHERNET
+#define TCP_MSS                     1460
+#endif
+
+#ifdef MBED_CONF_LWIP_TCP_WND
+#define TCP_WND                     MBED_CONF_LWIP_TCP_WND
+#elif MBED_CONF_LWIP_THROUGHPUT_PROFILE
+#define TCP_WND                     (4 * TCP_MSS)
+#endif
+
+#ifdef MBED_CONF_LWIP_TCP_SND_BUF
+#define TCP_SND_BUF                 MBED_CONF_LWIP_TCP_SND_BUF
+#elif MBED_CONF_LWIP_THROUGHPUT_PROFILE
+// Fast retransmit needs three duplicate acks, so four full segments in
+// flight, and a fifth for the application to fill meanwhile. Otherwise
+// Nagle holds back the last partial segment and a loss waits for the
+// retransmission timeout
+#define TCP_SND_BUF                 (5 * TCP_MSS)
+#endif
+
+// Size of the heap. Copied TCP writes are allocated from it, so the
+// throughput profile makes room for a full send buffer of segments and
+// their headers when the target does not set its own heap size.
+#ifdef MBED_CONF_LWIP_MEM_SIZE
+#undef MEM_SIZE
+#define MEM_SIZE                    MBED_CONF_LWIP_MEM_SIZE
+#elif MBED_CONF_LWIP_THROUGHPUT_PROFILE && !defined(MEM_SIZE)
+#define MEM_SIZE                    (TCP_SND_BUF + (TCP_SND_BUF/TCP_MSS + 1) * 128 + 1600)
+#endif
+
+#if MBED_CONF_LWIP_THROUGHPUT_PROFILE
+// Queue out-of-order segments so a single lost segment only costs its
+// own retransmission instead of the rest of the window. The queue is
+// bounded so it can not take all of the pbufs needed for reception.
+#define TCP_QUEUE_OOSEQ             1
+#define TCP_OOSEQ_MAX_PBUFS         MBED_CONF_LWIP_TCP_OOSEQ_MAX_PBUFS
+#define TCP_OOSEQ_MAX_BYTES         TCP_WND
+
+// Let tcp_write fill segments up to the MSS instead of sending each
+// write as its own segment
+#define TCP_OVERSIZE                TCP_MSS
+
+// Accept scaled windows from the peer, and scale our own receive
+// window if it is configured larger than 65535 bytes
+#define LWIP_WND_SCALE              1
+#if defined(MBED_CONF_LWIP_TCP_WND) && MBED_CONF_LWIP_TCP_WND > 0xffff
+#define TCP_RCV_SCALE               4
+#else
+#define TCP_RCV_SCALE               0
+#endif
+
+// Segments are needed for the send queue and the out-of-order queue
+#define MEMP_NUM_TCP_SEG            (TCP_SND_QUEUELEN + TCP_OOSEQ_MAX_PBUFS)
+#else
 #define TCP_QUEUE_OOSEQ             0
 #define TCP_OVERSIZE                0
+#endif
 
 #define LWIP_DHCP                   LWIP_IPV4
 #define LWIP_DNS                    1
@@ -247,8 +322,12 @@
 
 #elif LWIP_TRANSPORT_PPP
 
+#ifndef TCP_SND_BUF
 #define TCP_SND_BUF                     (3 * 536)
+#endif
+#ifndef TCP_WND
 #define TCP_WND                         (2 * 536)
+#endif
 
 #define LWIP_ARP 0
 
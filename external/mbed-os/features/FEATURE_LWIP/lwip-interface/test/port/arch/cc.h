@@ -0,0 +1,41 @@
+/* Host build of the lwIP core with the mbed configuration
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __CC_H__
+#define __CC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LWIP_PROVIDE_ERRNO
+
+#define PACK_STRUCT_BEGIN
+#define PACK_STRUCT_STRUCT __attribute__ ((__packed__))
+#define PACK_STRUCT_END
+#define PACK_STRUCT_FIELD(fld) fld
+
+#define LWIP_CHKSUM_ALGORITHM   1
+
+#define LWIP_PLATFORM_DIAG(msg) do { printf msg; } while (0)
+#define LWIP_PLATFORM_ASSERT(flag) do { \
+        printf("assert %s %s:%d\n", flag, __FILE__, __LINE__); abort(); \
+    } while (0)
+
+#define LWIP_PLATFORM_HTONS(x)      __builtin_bswap16(x)
+#define LWIP_PLATFORM_HTONL(x)      __builtin_bswap32(x)
+
+#endif
@@ -0,0 +1,37 @@
+/* Host build of the lwIP core with the mbed configuration
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __ARCH_SYS_ARCH_H__
+#define __ARCH_SYS_ARCH_H__
+
+#include "lwip/opt.h"
+
+// Single threaded, the raw API is called directly
+typedef int sys_sem_t;
+typedef int sys_mutex_t;
+typedef int sys_mbox_t;
+typedef int sys_thread_t;
+typedef int sys_prot_t;
+
+#define sys_sem_valid(s)            1
+#define sys_sem_set_invalid(s)
+#define sys_mbox_valid(m)           1
+#define sys_mbox_set_invalid(m)
+#define sys_mutex_valid(m)          1
+#define sys_mutex_set_invalid(m)
+
+extern u8_t lwip_ram_heap[];
+
+#endif
@@ -0,0 +1,22 @@
+/* Host build of the lwIP core with the mbed configuration
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LWIPOPTS_CONF_H
+#define LWIPOPTS_CONF_H
+
+// An Ethernet target that leaves the heap size to lwipopts.h
+#define LWIP_TRANSPORT_ETHERNET       1
+
+#endif
@@ -0,0 +1,34 @@
+/* Host build of the lwIP core with the mbed configuration
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_CONFIG_H
+#define MBED_CONFIG_H
+
+// Defaults from mbed_lib.json, the profile is chosen by the Makefile
+#define MBED_CONF_LWIP_IPV4_ENABLED         1
+#define MBED_CONF_LWIP_IPV6_ENABLED         0
+#define MBED_CONF_LWIP_IP_VER_PREF          4
+#define MBED_CONF_LWIP_ADDR_TIMEOUT         5
+#define MBED_CONF_LWIP_SOCKET_MAX           4
+#define MBED_CONF_LWIP_TCP_SERVER_MAX       4
+#define MBED_CONF_LWIP_TCP_SOCKET_MAX       4
+#define MBED_CONF_LWIP_UDP_SOCKET_MAX       4
+#define MBED_CONF_LWIP_TCP_OOSEQ_MAX_PBUFS  4
+
+#ifndef MBED_CONF_LWIP_THROUGHPUT_PROFILE
+#define MBED_CONF_LWIP_THROUGHPUT_PROFILE   1
+#endif
+
+#endif
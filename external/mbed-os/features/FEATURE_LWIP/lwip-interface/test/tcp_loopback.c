@@ -0,0 +1,292 @@
+/*
+ * Loopback benchmark of the lwIP TCP send and receive paths
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Sends messages of a 16 byte header and a 1024 byte body over a loopback
+ * netif with the raw TCP API, the way the lwIP glue's socket_sendv and
+ * socket_recv_buffer use netconn, and counts the bytes moved per cycle in
+ * the send calls and in the receive callback:
+ *
+ *  - copy tx writes both buffers with TCP_WRITE_FLAG_COPY, as sendv does
+ *  - nocopy tx references them until acked, which sendv no longer offers
+ *    since nothing tells the caller when the data may be reused
+ *  - copy rx copies the data out of the pbufs, as recv does
+ *  - loaned rx reads the data in place, as recv_buffer lets callers do
+ *
+ * The netif copies every segment as a driver would, and the host memcpy is
+ * far faster than a Cortex-M's, so the differences on targets are larger.
+ */
+#include "lwip/init.h"
+#include "lwip/sys.h"
+#include "lwip/mem.h"
+#include "lwip/tcp.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/netif.h"
+#include "lwip/ip.h"
+#include "lwip/tcpip.h"
+#include "host_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+// Host port of the parts of sys_arch the core uses
+LWIP_DECLARE_MEMORY_ALIGNED(lwip_ram_heap, LWIP_MEM_ALIGN_SIZE(MEM_SIZE) + 64);
+
+u32_t sys_now(void) { return 0; }
+void sys_init(void) {}
+sys_prot_t sys_arch_protect(void) { return 0; }
+void sys_arch_unprotect(sys_prot_t p) {}
+err_t sys_mutex_new(sys_mutex_t *mutex) { return ERR_OK; }
+void sys_mutex_lock(sys_mutex_t *mutex) {}
+void sys_mutex_unlock(sys_mutex_t *mutex) {}
+void sys_mutex_free(sys_mutex_t *mutex) {}
+
+sys_mutex_t lock_tcpip_core;
+u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout) { abort(); }
+
+err_t tcpip_callback_with_block(tcpip_callback_fn function, void *ctx, u8_t block)
+{
+    function(ctx);
+    return ERR_OK;
+}
+
+// Cycle counter, or nanoseconds where there is none
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+
+// Loopback netif, segments are copied into pool pbufs and delivered
+// from the main loop, as a driver's receive thread would
+#define LOOP_QUEUE 256
+
+static struct pbuf *loop_queue[LOOP_QUEUE];
+static unsigned loop_head, loop_tail;
+static struct netif loop;
+
+static err_t loop_output(struct netif *netif, struct pbuf *p, const ip4_addr_t *addr)
+{
+    struct pbuf *q = pbuf_alloc(PBUF_RAW, p->tot_len, PBUF_POOL);
+    if (!q) {
+        return ERR_MEM;
+    }
+
+    pbuf_copy(q, p);
+    loop_queue[loop_tail++ % LOOP_QUEUE] = q;
+    return ERR_OK;
+}
+
+static err_t loop_init(struct netif *netif)
+{
+    netif->output = loop_output;
+    netif->mtu = 1500;
+    return ERR_OK;
+}
+
+// Delivers the queued segments, or sends delayed acks if there are none
+static void loop_deliver(void)
+{
+    if (loop_head == loop_tail) {
+        tcp_fasttmr();
+    }
+
+    while (loop_head != loop_tail) {
+        struct pbuf *p = loop_queue[loop_head++ % LOOP_QUEUE];
+        if (loop.input(p, &loop) != ERR_OK) {
+            pbuf_free(p);
+        }
+    }
+}
+
+
+// Messages are a header with the message number and a constant body
+#define HEADER_SIZE 16
+#define BODY_SIZE   1024
+#define MESSAGE_SIZE (HEADER_SIZE + BODY_SIZE)
+#define MESSAGES    20000
+
+// Headers stay referenced until acked with nocopy tx
+static u8_t headers[256][HEADER_SIZE];
+static u8_t body[BODY_SIZE];
+
+static int loaned_rx;
+static u32_t received;
+static u32_t rx_sum;
+static uint64_t rx_cycles;
+static u8_t rx_copy[TCP_WND];
+static int connected;
+
+// The receiver checks the stream by its sum
+static u32_t sum(const u8_t *data, size_t len)
+{
+    u32_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static err_t server_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+    if (!p) {
+        return ERR_OK;
+    }
+
+    // Only getting at the data and releasing it is timed, checking it
+    // reads every byte once on both paths
+    uint64_t start = cycles();
+    u16_t len = p->tot_len;
+    if (!loaned_rx) {
+        pbuf_copy_partial(p, rx_copy, len, 0);
+    }
+    rx_cycles += cycles() - start;
+
+    if (loaned_rx) {
+        for (struct pbuf *q = p; q; q = q->next) {
+            rx_sum += sum(q->payload, q->len);
+        }
+    } else {
+        rx_sum += sum(rx_copy, len);
+    }
+
+    start = cycles();
+    pbuf_free(p);
+    rx_cycles += cycles() - start;
+
+    received += len;
+    tcp_recved(pcb, len);
+    return ERR_OK;
+}
+
+static err_t server_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    tcp_recv(pcb, server_recv);
+    return ERR_OK;
+}
+
+static err_t client_connected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    connected = 1;
+    return ERR_OK;
+}
+
+// Sends the messages and returns the receiver's sum of the stream
+static u32_t transfer(u16_t port, int nocopy, int loaned)
+{
+    ip_addr_t addr;
+    IP4_ADDR(&addr, 10, 0, 0, 1);
+
+    struct tcp_pcb *listener = tcp_new();
+    tcp_bind(listener, IP_ADDR_ANY, port);
+    listener = tcp_listen(listener);
+    tcp_accept(listener, server_accept);
+
+    loaned_rx = loaned;
+    received = 0;
+    rx_sum = 0;
+    rx_cycles = 0;
+    connected = 0;
+    struct tcp_pcb *client = tcp_new();
+    tcp_connect(client, &addr, port, client_connected);
+    while (!connected) {
+        loop_deliver();
+    }
+
+    u8_t flags = nocopy ? 0 : TCP_WRITE_FLAG_COPY;
+    uint64_t tx_cycles = 0;
+    u32_t sent = 0;
+    int body_pending = 0;
+    while (received < MESSAGES * MESSAGE_SIZE) {
+        uint64_t start = cycles();
+        while (sent < MESSAGES) {
+            // A body that did not fit goes out before the next header
+            if (!body_pending) {
+                u8_t *header = headers[sent % 256];
+                memset(header, 0, HEADER_SIZE);
+                memcpy(header, &sent, sizeof(sent));
+                if (tcp_write(client, header, HEADER_SIZE, flags | TCP_WRITE_FLAG_MORE) != ERR_OK) {
+                    break;
+                }
+                body_pending = 1;
+            }
+
+            if (tcp_write(client, body, BODY_SIZE, flags) != ERR_OK) {
+                break;
+            }
+            body_pending = 0;
+            sent++;
+        }
+        tcp_output(client);
+        tx_cycles += cycles() - start;
+
+        loop_deliver();
+    }
+
+    tcp_close(client);
+    tcp_close(listener);
+    loop_deliver();
+    tcp_tmr();
+
+    double bytes = (double)MESSAGES * MESSAGE_SIZE;
+    printf("%-6s tx / %-6s rx: tx %5.2f B/cycle, rx %5.2f B/cycle\n",
+            nocopy ? "nocopy" : "copy", loaned ? "loaned" : "copy",
+            bytes / tx_cycles, bytes / rx_cycles);
+    return rx_sum;
+}
+
+
+// Test
+int main(void)
+{
+    lwip_init();
+
+    ip4_addr_t ip, mask, gw;
+    IP4_ADDR(&ip, 10, 0, 0, 1);
+    IP4_ADDR(&mask, 255, 255, 255, 0);
+    IP4_ADDR(&gw, 10, 0, 0, 254);
+    netif_add(&loop, &ip, &mask, &gw, NULL, loop_init, ip_input);
+    netif_set_default(&loop);
+    netif_set_up(&loop);
+    netif_set_link_up(&loop);
+
+    for (int i = 0; i < BODY_SIZE; i++) {
+        body[i] = (u8_t)(i * 7);
+    }
+
+    u32_t expected = 0;
+    for (u32_t i = 0; i < MESSAGES; i++) {
+        expected += sum((const u8_t *)&i, sizeof(i)) + sum(body, BODY_SIZE);
+    }
+
+    // Every path delivers the same stream
+    printf("%d messages of %d + %d bytes\n", MESSAGES, HEADER_SIZE, BODY_SIZE);
+    check(transfer(2000, 0, 0) == expected);
+    check(transfer(2001, 0, 1) == expected);
+    check(transfer(2002, 1, 1) == expected);
+
+    return host_test_done();
+}
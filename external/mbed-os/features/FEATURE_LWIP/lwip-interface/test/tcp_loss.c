@@ -0,0 +1,308 @@
+/*
+ * Loss injection test for the lwIP TCP configuration
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Builds the lwIP core on the host with lwipopts.h and runs an upload
+ * over a simulated WAN link, written in small chunks the way NETCONN_COPY
+ * writes are. Time is simulated, one loop iteration per millisecond.
+ */
+#include "lwip/init.h"
+#include "lwip/sys.h"
+#include "lwip/mem.h"
+#include "lwip/tcp.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/netif.h"
+#include "lwip/ip.h"
+#include "lwip/tcpip.h"
+#include "host_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// Host port of the parts of sys_arch the core uses
+LWIP_DECLARE_MEMORY_ALIGNED(lwip_ram_heap, LWIP_MEM_ALIGN_SIZE(MEM_SIZE) + 64);
+
+static u32_t now;
+
+u32_t sys_now(void) { return now; }
+void sys_init(void) {}
+sys_prot_t sys_arch_protect(void) { return 0; }
+void sys_arch_unprotect(sys_prot_t p) {}
+err_t sys_mutex_new(sys_mutex_t *mutex) { return ERR_OK; }
+void sys_mutex_lock(sys_mutex_t *mutex) {}
+void sys_mutex_unlock(sys_mutex_t *mutex) {}
+void sys_mutex_free(sys_mutex_t *mutex) {}
+
+// Only referenced by the tcpip thread's timeout loop, which is not run
+sys_mutex_t lock_tcpip_core;
+u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout) { abort(); }
+
+// Freeing out-of-order pbufs when the pool runs dry is deferred to the
+// main loop, as the tcpip thread would
+static tcpip_callback_fn deferred;
+static void *deferred_ctx;
+
+err_t tcpip_callback_with_block(tcpip_callback_fn function, void *ctx, u8_t block)
+{
+    deferred = function;
+    deferred_ctx = ctx;
+    return ERR_OK;
+}
+
+
+// Simulated WAN link, a fixed one-way delay and bandwidth with random
+// loss, or a single dropped data segment
+#define LINK_DELAY  40      // ms
+#define LINK_RATE   250     // bytes per ms, 2 Mbit/s
+#define LINK_QUEUE  4096
+
+// Packets in flight are kept outside of lwIP's heap, and are received
+// into pool pbufs like a driver would
+struct packet {
+    u8_t *data;
+    u16_t len;
+    u32_t at;
+};
+
+static struct packet link_queue[LINK_QUEUE];
+static unsigned link_head, link_tail;
+static u32_t link_free;
+static struct netif link;
+
+static double loss;
+static int drop_segment;
+static unsigned data_segments;
+static u32_t first_seq;
+static u32_t dropped_end;
+static u32_t dropped_at;
+
+static struct tcp_pcb *client;
+static u32_t received;
+static u32_t recovered_at;
+static int connected;
+static u32_t max_queued;
+
+// Data segments sent by the client, sequence numbers are relative to the
+// first data byte, returns 0 for anything else
+static u32_t data_segment(struct pbuf *p, u32_t *seq)
+{
+    u8_t hdr[40];
+    if (!client || pbuf_copy_partial(p, hdr, sizeof hdr, 0) != sizeof hdr) {
+        return 0;
+    }
+
+    u16_t src = (hdr[20] << 8) | hdr[21];
+    u32_t tcp_seq = ((u32_t)hdr[24] << 24) | ((u32_t)hdr[25] << 16) |
+            ((u32_t)hdr[26] << 8) | hdr[27];
+    u32_t len = p->tot_len - 20 - 4*(hdr[32] >> 4);
+    if (src != client->local_port || len == 0) {
+        return 0;
+    }
+
+    if (data_segments++ == 0) {
+        first_seq = tcp_seq;
+    }
+
+    *seq = tcp_seq - first_seq;
+    return len;
+}
+
+static err_t link_output(struct netif *netif, struct pbuf *p, const ip4_addr_t *addr)
+{
+    u32_t start = link_free > now ? link_free : now;
+    link_free = start + (p->tot_len + LINK_RATE-1) / LINK_RATE;
+
+    u32_t seq;
+    u32_t len = data_segment(p, &seq);
+    if (len && drop_segment && data_segments == (unsigned)drop_segment) {
+        dropped_end = seq + len;
+        dropped_at = now;
+        return ERR_OK;
+    }
+
+    if ((double)rand() / RAND_MAX < loss) {
+        return ERR_OK;
+    }
+
+    struct packet *packet = &link_queue[link_tail++ % LINK_QUEUE];
+    packet->data = malloc(p->tot_len);
+    packet->len = pbuf_copy_partial(p, packet->data, p->tot_len, 0);
+    packet->at = link_free + LINK_DELAY;
+    return ERR_OK;
+}
+
+static err_t link_init(struct netif *netif)
+{
+    netif->output = link_output;
+    netif->mtu = 1500;
+    return ERR_OK;
+}
+
+
+// Server and client
+static err_t server_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+    if (!p) {
+        return ERR_OK;
+    }
+
+    received += p->tot_len;
+    if (dropped_end && !recovered_at && received >= dropped_end) {
+        recovered_at = now;
+    }
+
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static err_t server_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    tcp_recv(pcb, server_recv);
+    return ERR_OK;
+}
+
+static err_t client_connected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    connected = 1;
+    return ERR_OK;
+}
+
+static void client_fill(void)
+{
+    static u8_t chunk[256];
+    while (tcp_sndbuf(client) >= sizeof chunk) {
+        if (tcp_write(client, chunk, sizeof chunk, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+            break;
+        }
+    }
+
+    u32_t queued = TCP_SND_BUF - tcp_sndbuf(client);
+    if (queued > max_queued) {
+        max_queued = queued;
+    }
+
+    tcp_output(client);
+}
+
+// Uploads for the duration in ms and returns the goodput in bytes per second
+static u32_t upload(u16_t port, u32_t duration)
+{
+    ip_addr_t addr;
+    IP4_ADDR(&addr, 10, 0, 0, 1);
+
+    struct tcp_pcb *listener = tcp_new();
+    tcp_bind(listener, IP_ADDR_ANY, port);
+    listener = tcp_listen(listener);
+    tcp_accept(listener, server_accept);
+
+    received = 0;
+    connected = 0;
+    max_queued = 0;
+    data_segments = 0;
+    dropped_end = 0;
+    recovered_at = 0;
+    client = tcp_new();
+    tcp_connect(client, &addr, port, client_connected);
+
+    u32_t start = now;
+    for (; now - start < duration; now++) {
+        while (link_head != link_tail && link_queue[link_head % LINK_QUEUE].at <= now) {
+            struct packet *packet = &link_queue[link_head++ % LINK_QUEUE];
+            struct pbuf *p = pbuf_alloc(PBUF_RAW, packet->len, PBUF_POOL);
+            if (p) {
+                pbuf_take(p, packet->data, packet->len);
+                if (link.input(p, &link) != ERR_OK) {
+                    pbuf_free(p);
+                }
+            }
+
+            free(packet->data);
+        }
+
+        if (deferred) {
+            tcpip_callback_fn function = deferred;
+            deferred = 0;
+            function(deferred_ctx);
+        }
+
+        if ((now - start) % TCP_TMR_INTERVAL == 0) {
+            tcp_tmr();
+        }
+
+        if (connected) {
+            client_fill();
+        }
+    }
+
+    tcp_abort(client);
+    client = 0;
+    tcp_close(listener);
+    while (link_head != link_tail) {
+        free(link_queue[link_head++ % LINK_QUEUE].data);
+    }
+
+    return received / (duration / 1000);
+}
+
+
+// Test
+int main(void)
+{
+    lwip_init();
+
+    ip4_addr_t ip, mask, gw;
+    IP4_ADDR(&ip, 10, 0, 0, 1);
+    IP4_ADDR(&mask, 255, 255, 255, 0);
+    IP4_ADDR(&gw, 10, 0, 0, 254);
+    netif_add(&link, &ip, &mask, &gw, NULL, link_init, ip_input);
+    netif_set_default(&link);
+    netif_set_up(&link);
+    netif_set_link_up(&link);
+
+    printf("mss %d, wnd %d, snd_buf %d, mem_size %d, ooseq %d\n",
+            TCP_MSS, TCP_WND, TCP_SND_BUF, MEM_SIZE, TCP_QUEUE_OOSEQ);
+
+    // copied writes must be able to fill the whole send buffer
+    u32_t lossless = upload(1000, 20000);
+    printf("loss  0%%: %6u B/s, %u of %u bytes queued\n",
+            lossless, max_queued, TCP_SND_BUF);
+    check(max_queued + TCP_MSS > TCP_SND_BUF);
+
+    // goodput under random loss
+    static const double losses[] = {0.01, 0.03, 0.05};
+    for (unsigned i = 0; i < sizeof losses / sizeof losses[0]; i++) {
+        srand(1);
+        loss = losses[i];
+        u32_t goodput = upload(1001 + i, 60000);
+        printf("loss %2d%%: %6u B/s\n", (int)(loss*100 + 0.5), goodput);
+        check(goodput > 0);
+    }
+
+#if MBED_CONF_LWIP_THROUGHPUT_PROFILE
+    // a single lost segment is recovered by fast retransmit in a few
+    // round trips, instead of waiting for the retransmission timeout
+    loss = 0;
+    drop_segment = 20;
+    upload(1010, 10000);
+    printf("segment %d lost, recovered after %u ms\n",
+            drop_segment, recovered_at - dropped_at);
+    check(recovered_at != 0);
+    check(recovered_at - dropped_at < 8*LINK_DELAY);
+#endif
+
+    return host_test_done();
+}
@@ -0,0 +1,189 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity.h"
+#include "utest.h"
+
+#include "HeapBlockDevice.h"
+#include "BufferedBlockDevice.h"
+#include "FATFileSystem.h"
+#include <stdlib.h>
+#include "mbed_retarget.h"
+
+using namespace utest::v1;
+
+#ifndef MBED_EXTENDED_TESTS
+    #error [NOT_SUPPORTED] Filesystem tests not supported by default
+#endif
+
+#define BLOCK_SIZE 512
+#define BLOCK_COUNT 128
+#define FILE_COUNT 16
+#define CACHE_COUNT 8
+
+
+// Counts the operations that reach the underlying device
+class CountingBlockDevice : public BlockDevice
+{
+public:
+    CountingBlockDevice(BlockDevice *bd)
+        : _bd(bd), reads(0), programs(0), erases(0) {}
+
+    virtual int init() { return _bd->init(); }
+    virtual int deinit() { return _bd->deinit(); }
+    virtual int sync() { return _bd->sync(); }
+
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size) {
+        reads++;
+        return _bd->read(buffer, addr, size);
+    }
+
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size) {
+        programs++;
+        return _bd->program(buffer, addr, size);
+    }
+
+    virtual int erase(bd_addr_t addr, bd_size_t size) {
+        erases++;
+        return _bd->erase(addr, size);
+    }
+
+    virtual bd_size_t get_read_size() const { return _bd->get_read_size(); }
+    virtual bd_size_t get_program_size() const { return _bd->get_program_size(); }
+    virtual bd_size_t get_erase_size() const { return _bd->get_erase_size(); }
+    virtual bd_size_t size() const { return _bd->size(); }
+
+private:
+    BlockDevice *_bd;
+
+public:
+    unsigned reads;
+    unsigned programs;
+    unsigned erases;
+};
+
+
+// Metadata heavy workload: create small files in a directory, list it,
+// read every file back and delete half of them
+static void run_workload(BlockDevice *bd) {
+    char name[32];
+    char data[100];
+
+    int err = FATFileSystem::format(bd);
+    TEST_ASSERT_EQUAL(0, err);
+
+    FATFileSystem fs("fat");
+    err = fs.mount(bd);
+    TEST_ASSERT_EQUAL(0, err);
+
+    err = fs.mkdir("dir", 0777);
+    TEST_ASSERT_EQUAL(0, err);
+
+    File file;
+    for (int i = 0; i < FILE_COUNT; i++) {
+        snprintf(name, sizeof(name), "dir/file%02d.txt", i);
+        err = file.open(&fs, name, O_WRONLY | O_CREAT);
+        TEST_ASSERT_EQUAL(0, err);
+        memset(data, 'a' + i % 26, sizeof(data));
+        TEST_ASSERT_EQUAL(sizeof(data), file.write(data, sizeof(data)));
+        err = file.close();
+        TEST_ASSERT_EQUAL(0, err);
+    }
+
+    for (int k = 0; k < 4; k++) {
+        Dir dir;
+        struct dirent ent;
+        int count = 0;
+        err = dir.open(&fs, "dir");
+        TEST_ASSERT_EQUAL(0, err);
+        while (dir.read(&ent) > 0) {
+            count++;
+        }
+        err = dir.close();
+        TEST_ASSERT_EQUAL(0, err);
+        TEST_ASSERT_EQUAL(FILE_COUNT, count);
+    }
+
+    for (int i = 0; i < FILE_COUNT; i++) {
+        snprintf(name, sizeof(name), "dir/file%02d.txt", i);
+        err = file.open(&fs, name, O_RDONLY);
+        TEST_ASSERT_EQUAL(0, err);
+        TEST_ASSERT_EQUAL(sizeof(data), file.read(data, sizeof(data)));
+        TEST_ASSERT_EQUAL('a' + i % 26, data[0]);
+        err = file.close();
+        TEST_ASSERT_EQUAL(0, err);
+    }
+
+    for (int i = 0; i < FILE_COUNT; i += 2) {
+        snprintf(name, sizeof(name), "dir/file%02d.txt", i);
+        err = fs.remove(name);
+        TEST_ASSERT_EQUAL(0, err);
+    }
+
+    err = fs.unmount();
+    TEST_ASSERT_EQUAL(0, err);
+}
+
+void test_device_operations() {
+    HeapBlockDevice direct_heap(BLOCK_COUNT*BLOCK_SIZE, BLOCK_SIZE);
+    CountingBlockDevice direct(&direct_heap);
+    run_workload(&direct);
+
+    HeapBlockDevice buffered_heap(BLOCK_COUNT*BLOCK_SIZE, BLOCK_SIZE);
+    CountingBlockDevice counted(&buffered_heap);
+    BufferedBlockDevice buffered(&counted, CACHE_COUNT, 1);
+    run_workload(&buffered);
+
+    printf("direct:      %u reads, %u programs\r\n",
+            direct.reads, direct.programs);
+    printf("buffered(%d): %u reads, %u programs (%u hits, %u misses)\r\n",
+            CACHE_COUNT, counted.reads, counted.programs,
+            (unsigned)buffered.get_hits(), (unsigned)buffered.get_misses());
+
+    TEST_ASSERT(counted.reads < direct.reads);
+    TEST_ASSERT(counted.programs <= direct.programs);
+}
+
+void test_uninitialized() {
+    HeapBlockDevice heap(BLOCK_COUNT*BLOCK_SIZE, BLOCK_SIZE);
+    BufferedBlockDevice buffered(&heap, CACHE_COUNT, 1);
+    uint8_t buffer[BLOCK_SIZE] = {0};
+
+    TEST_ASSERT_EQUAL(BD_ERROR_DEVICE_ERROR, buffered.read(buffer, 0, BLOCK_SIZE));
+    TEST_ASSERT_EQUAL(BD_ERROR_DEVICE_ERROR, buffered.program(buffer, 0, BLOCK_SIZE));
+    TEST_ASSERT_EQUAL(BD_ERROR_DEVICE_ERROR, buffered.erase(0, BLOCK_SIZE));
+    TEST_ASSERT_EQUAL(0, buffered.sync());
+    TEST_ASSERT_EQUAL(0, buffered.deinit());
+}
+
+
+// Test setup
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("Testing device operations for a metadata workload", test_device_operations),
+    Case("Testing operations before init", test_uninitialized),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
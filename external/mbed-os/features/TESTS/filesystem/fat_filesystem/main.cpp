@@ -85,6 +85,142 @@ void test_read_write() {
 }
 
 
+// Test for random reads with fast seeking enabled
+void test_fast_seek() {
+    FATFileSystem fs("fat");
+
+    int err = fs.mount(&bd);
+    TEST_ASSERT_EQUAL(0, err);
+
+    const ssize_t TEST_SIZE = 16*BLOCK_SIZE;
+    uint8_t *buffer = (uint8_t *)malloc(TEST_SIZE);
+    TEST_ASSERT(buffer);
+
+    // Fill with random sequence
+    srand(1);
+    for (int i = 0; i < TEST_SIZE; i++) {
+        buffer[i] = 0xff & rand();
+    }
+
+    File file;
+    err = file.open(&fs, "test_fast_seek.dat", O_WRONLY | O_CREAT);
+    TEST_ASSERT_EQUAL(0, err);
+    ssize_t size = file.write(buffer, TEST_SIZE);
+    TEST_ASSERT_EQUAL(TEST_SIZE, size);
+    err = file.close();
+    TEST_ASSERT_EQUAL(0, err);
+
+    err = file.open(&fs, "test_fast_seek.dat", O_RDWR);
+    TEST_ASSERT_EQUAL(0, err);
+    err = file.fastseek(4);
+    TEST_ASSERT_EQUAL(0, err);
+
+    // Seek backwards through the file
+    for (off_t off = TEST_SIZE - 7; off > 0; off -= BLOCK_SIZE + 13) {
+        uint8_t c;
+        TEST_ASSERT_EQUAL(off, file.seek(off, SEEK_SET));
+        TEST_ASSERT_EQUAL(1, file.read(&c, 1));
+        TEST_ASSERT_EQUAL(buffer[off], c);
+    }
+
+    // Grow the file, and check seeking still works
+    uint8_t c = 0x5a;
+    TEST_ASSERT_EQUAL(TEST_SIZE, file.seek(0, SEEK_END));
+    TEST_ASSERT_EQUAL(1, file.write(&c, 1));
+    TEST_ASSERT_EQUAL(TEST_SIZE/2, file.seek(TEST_SIZE/2, SEEK_SET));
+    TEST_ASSERT_EQUAL(1, file.read(&c, 1));
+    TEST_ASSERT_EQUAL(buffer[TEST_SIZE/2], c);
+    TEST_ASSERT_EQUAL(TEST_SIZE, file.seek(-1, SEEK_END));
+    TEST_ASSERT_EQUAL(1, file.read(&c, 1));
+    TEST_ASSERT_EQUAL(0x5a, c);
+
+    err = file.close();
+    TEST_ASSERT_EQUAL(0, err);
+    free(buffer);
+
+    err = fs.unmount();
+    TEST_ASSERT_EQUAL(0, err);
+}
+
+
+// Test for concurrent access to multiple volumes
+HeapBlockDevice bd2(128*BLOCK_SIZE, BLOCK_SIZE);
+
+struct volume_test {
+    FATFileSystem *fs;
+    uint8_t pattern;
+    int err;
+};
+
+void test_volume_thread(volume_test *t) {
+    const ssize_t TEST_SIZE = 8*BLOCK_SIZE;
+    uint8_t buffer[BLOCK_SIZE];
+    File file;
+
+    t->err = file.open(t->fs, "test_volumes.dat", O_WRONLY | O_CREAT | O_TRUNC);
+    for (ssize_t i = 0; !t->err && i < TEST_SIZE; i += BLOCK_SIZE) {
+        memset(buffer, t->pattern, BLOCK_SIZE);
+        if (file.write(buffer, BLOCK_SIZE) != BLOCK_SIZE) {
+            t->err = -EIO;
+        }
+    }
+    file.close();
+
+    if (!t->err) {
+        t->err = file.open(t->fs, "test_volumes.dat", O_RDONLY);
+    }
+    for (ssize_t i = 0; !t->err && i < TEST_SIZE; i += BLOCK_SIZE) {
+        if (file.read(buffer, BLOCK_SIZE) != BLOCK_SIZE) {
+            t->err = -EIO;
+        }
+        for (int j = 0; !t->err && j < BLOCK_SIZE; j++) {
+            if (buffer[j] != t->pattern) {
+                t->err = -EIO;
+            }
+        }
+    }
+    file.close();
+}
+
+void test_multiple_volumes() {
+    int err = FATFileSystem::format(&bd2);
+    TEST_ASSERT_EQUAL(0, err);
+
+    FATFileSystem fs1("fat");
+    FATFileSystem fs2("fat2");
+
+    err = fs1.mount(&bd);
+    TEST_ASSERT_EQUAL(0, err);
+    err = fs2.mount(&bd2);
+    TEST_ASSERT_EQUAL(0, err);
+
+    volume_test t1 = {&fs1, 0x11, -1};
+    volume_test t2 = {&fs2, 0x22, -1};
+    Thread thread1(osPriorityNormal, 4096);
+    Thread thread2(osPriorityNormal, 4096);
+    thread1.start(callback(test_volume_thread, &t1));
+    thread2.start(callback(test_volume_thread, &t2));
+    thread1.join();
+    thread2.join();
+    TEST_ASSERT_EQUAL(0, t1.err);
+    TEST_ASSERT_EQUAL(0, t2.err);
+
+    // Paths must resolve on their own volume
+    err = fs2.mkdir("test_volumes", S_IRWXU | S_IRWXG | S_IRWXO);
+    TEST_ASSERT_EQUAL(0, err);
+    struct stat st;
+    err = fs1.stat("test_volumes", &st);
+    TEST_ASSERT_EQUAL(-ENOENT, err);
+    err = fs2.remove("test_volumes");
+    TEST_ASSERT_EQUAL(0, err);
+
+    err = fs2.unmount();
+    TEST_ASSERT_EQUAL(0, err);
+    err = fs1.unmount();
+    TEST_ASSERT_EQUAL(0, err);
+}
+
+
 // Simple test for iterating dir entries
 void test_read_dir() {
     FATFileSystem fs("fat");
@@ -150,6 +286,9 @@ Case cases[] = {
     Case("Testing formating", test_format),
     Case("Testing read write < block", test_read_write<BLOCK_SIZE/2>),
     Case("Testing read write > block", test_read_write<2*BLOCK_SIZE>),
+    Case("Testing read write streaming", test_read_write<32*BLOCK_SIZE>),
+    Case("Testing fast seek", test_fast_seek),
+    Case("Testing multiple volumes", test_multiple_volumes),
     Case("Testing dir iteration", test_read_dir),
 };
 
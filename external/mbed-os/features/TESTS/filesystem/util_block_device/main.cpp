@@ -21,6 +21,7 @@
 #include "HeapBlockDevice.h"
 #include "SlicingBlockDevice.h"
 #include "ChainingBlockDevice.h"
+#include "BufferedBlockDevice.h"
 #include <stdlib.h>
 
 using namespace utest::v1;
@@ -176,6 +177,70 @@ void test_chaining() {
     TEST_ASSERT_EQUAL(0, err);
 }
 
+// Simple test which read/writes partial blocks through a buffered block device
+void test_buffering() {
+    HeapBlockDevice bd(BLOCK_COUNT*BLOCK_SIZE, 16, 16, BLOCK_SIZE);
+    uint8_t *write_block = new uint8_t[BLOCK_SIZE];
+    uint8_t *read_block = new uint8_t[BLOCK_SIZE];
+
+    // Test with two buffered blocks
+    BufferedBlockDevice buffered(&bd, 2, 1);
+
+    int err = buffered.init();
+    TEST_ASSERT_EQUAL(0, err);
+
+    TEST_ASSERT_EQUAL(16, buffered.get_program_size());
+    TEST_ASSERT_EQUAL(BLOCK_SIZE, buffered.get_erase_size());
+    TEST_ASSERT_EQUAL(BLOCK_COUNT*BLOCK_SIZE, buffered.size());
+
+    // Fill with random sequence
+    srand(1);
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        write_block[i] = 0xff & rand();
+    }
+
+    // Write the block in halves, and read it back from the buffer
+    err = buffered.program(write_block, BLOCK_SIZE, BLOCK_SIZE/2);
+    TEST_ASSERT_EQUAL(0, err);
+
+    err = buffered.program(write_block + BLOCK_SIZE/2, BLOCK_SIZE + BLOCK_SIZE/2, BLOCK_SIZE/2);
+    TEST_ASSERT_EQUAL(0, err);
+
+    err = buffered.read(read_block, BLOCK_SIZE, BLOCK_SIZE);
+    TEST_ASSERT_EQUAL(0, err);
+    TEST_ASSERT(buffered.get_hits() >= 2);
+
+    // Check that the data was unmodified
+    srand(1);
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        TEST_ASSERT_EQUAL(0xff & rand(), read_block[i]);
+    }
+
+    // Evict the block by reading the rest of the device
+    for (int b = 2; b < BLOCK_COUNT; b++) {
+        err = buffered.read(read_block, b*BLOCK_SIZE, 16);
+        TEST_ASSERT_EQUAL(0, err);
+    }
+
+    // Check with original block device
+    err = buffered.sync();
+    TEST_ASSERT_EQUAL(0, err);
+
+    err = bd.read(read_block, BLOCK_SIZE, BLOCK_SIZE);
+    TEST_ASSERT_EQUAL(0, err);
+
+    // Check that the data was unmodified
+    srand(1);
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        TEST_ASSERT_EQUAL(0xff & rand(), read_block[i]);
+    }
+
+    delete[] write_block;
+    delete[] read_block;
+    err = buffered.deinit();
+    TEST_ASSERT_EQUAL(0, err);
+}
+
 
 // Test setup
 utest::v1::status_t test_setup(const size_t number_of_cases) {
@@ -186,6 +251,7 @@ utest::v1::status_t test_setup(const size_t number_of_cases) {
 Case cases[] = {
     Case("Testing slicing of a block device", test_slicing),
     Case("Testing chaining of block devices", test_chaining),
+    Case("Testing buffering of a block device", test_buffering),
 };
 
 Specification specification(test_setup, cases);
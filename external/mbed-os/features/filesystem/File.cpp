@@ -92,6 +92,12 @@ off_t File::seek(off_t offset, int whence)
     return _fs->file_seek(_file, offset, whence);
 }
 
+int File::fastseek(size_t size)
+{
+    MBED_ASSERT(_fs);
+    return _fs->file_fastseek(_file, size);
+}
+
 off_t File::tell()
 {
     MBED_ASSERT(_fs);
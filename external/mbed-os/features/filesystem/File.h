@@ -108,6 +108,18 @@ public:
      */
     virtual off_t seek(off_t offset, int whence = SEEK_SET);
 
+    /** Enable fast seeking on the file
+     *
+     *  The index of the file's location is built on the next seek, and
+     *  can hold up to size fragments. If the file is more fragmented than
+     *  that, seeks fall back to walking the file from its start.
+     *
+     *  @param size     Number of fragments the index can hold, 0 disables
+     *                  fast seeking
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int fastseek(size_t size);
+
     /** Get the file position of the file
      *
      *  @return         The current offset in the file
@@ -35,6 +35,11 @@ int FileSystem::file_isatty(fs_file_t file)
     return false;
 }
 
+int FileSystem::file_fastseek(fs_file_t file, size_t size)
+{
+    return -ENOSYS;
+}
+
 off_t FileSystem::file_tell(fs_file_t file)
 {
     return file_seek(file, 0, SEEK_CUR);
@@ -156,6 +156,18 @@ protected:
      */
     virtual off_t file_seek(fs_file_t file, off_t offset, int whence) = 0;
 
+    /** Enable fast seeking on a file
+     *
+     *  Filesystems that support it keep an index of the file's location on
+     *  the block device so seeks do not need to walk the file from its start
+     *
+     *  @param file     File handle
+     *  @param size     Number of fragments the index can hold, 0 disables
+     *                  fast seeking
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int file_fastseek(fs_file_t file, size_t size);
+
     /** Get the file position of the file
      *
      *  @param file     File handle
@@ -93,6 +93,17 @@ public:
      */
     virtual int erase(bd_addr_t addr, bd_size_t size) = 0;
 
+    /** Ensure data on a block device is committed to the underlying storage
+     *
+     *  Block devices that buffer writes must write them back before returning
+     *
+     *  @return         0 on success or a negative error code on failure
+     */
+    virtual int sync()
+    {
+        return 0;
+    }
+
     /** Get the size of a readable block
      *
      *  @return         Size of a readable block in bytes
@@ -119,6 +130,18 @@ public:
      */
     virtual bd_size_t size() const = 0;
 
+    /** Check if blocks must be erased before they are programmed
+     *
+     *  Devices that manage erasure internally, such as SD cards, can
+     *  return false to let callers skip redundant erase operations
+     *
+     *  @return         True if program must be preceded by erase
+     */
+    virtual bool requires_erase() const
+    {
+        return true;
+    }
+
     /** Convenience function for checking block read validity
      *
      *  @param addr     Address of block to begin reading from
@@ -0,0 +1,377 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BufferedBlockDevice.h"
+
+
+BufferedBlockDevice::BufferedBlockDevice(BlockDevice *bd, size_t count, size_t readahead)
+    : _bd(bd), _count(count), _readahead(readahead)
+    , _line_size(0), _buffer(0), _lines(0), _tick(0)
+    , _next(-1), _hits(0), _misses(0)
+{
+    MBED_ASSERT(_count > 0 && _readahead < _count);
+}
+
+BufferedBlockDevice::~BufferedBlockDevice()
+{
+    delete[] _buffer;
+    delete[] _lines;
+}
+
+int BufferedBlockDevice::init()
+{
+    int err = _bd->init();
+    if (err) {
+        return err;
+    }
+
+    // Block sizes may not be known until the underlying device is initialized
+    bd_size_t line_size = _bd->get_erase_size();
+    if (!_buffer || line_size != _line_size) {
+        delete[] _buffer;
+        _line_size = line_size;
+        _buffer = new uint8_t[_count * _line_size];
+    }
+
+    if (!_lines) {
+        _lines = new struct line[_count];
+    }
+
+    for (size_t i = 0; i < _count; i++) {
+        _lines[i].valid = false;
+        _lines[i].dirty = false;
+        _lines[i].used = 0;
+    }
+
+    _next = -1;
+    return 0;
+}
+
+int BufferedBlockDevice::deinit()
+{
+    int err = sync();
+    if (err) {
+        return err;
+    }
+
+    return _bd->deinit();
+}
+
+int BufferedBlockDevice::read(void *b, bd_addr_t addr, bd_size_t size)
+{
+    MBED_ASSERT(is_valid_read(addr, size));
+    if (!_lines) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    uint8_t *buffer = static_cast<uint8_t*>(b);
+
+    while (size > 0) {
+        bd_addr_t base = addr - addr % _line_size;
+        bd_size_t off = addr - base;
+        bd_size_t len = _line_size - off;
+        if (len > size) {
+            len = size;
+        }
+
+        int i = _find(base);
+        if (i < 0 && off == 0 && size >= 2*_line_size) {
+            // Bulk reads of uncached blocks go directly to the device,
+            // in a single read for as many uncached blocks as possible
+            bd_size_t run = _line_size;
+            while (run + _line_size <= size && _find(base + run) < 0) {
+                run += _line_size;
+            }
+
+            int err = _bd->read(buffer, addr, run);
+            if (err) {
+                return err;
+            }
+
+            _misses += run / _line_size;
+            _next = base + run;
+            buffer += run;
+            addr += run;
+            size -= run;
+            continue;
+        }
+
+        if (i < 0) {
+            i = _fetch(base, true);
+            if (i < 0) {
+                return i;
+            }
+        } else {
+            _hits += 1;
+        }
+
+        memcpy(buffer, &_buffer[i*_line_size + off], len);
+        _lines[i].used = ++_tick;
+
+        buffer += len;
+        addr += len;
+        size -= len;
+    }
+
+    return 0;
+}
+
+int BufferedBlockDevice::program(const void *b, bd_addr_t addr, bd_size_t size)
+{
+    MBED_ASSERT(is_valid_program(addr, size));
+    if (!_lines) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    const uint8_t *buffer = static_cast<const uint8_t*>(b);
+
+    while (size > 0) {
+        bd_addr_t base = addr - addr % _line_size;
+        bd_size_t off = addr - base;
+        bd_size_t len = _line_size - off;
+        if (len > size) {
+            len = size;
+        }
+
+        int i = _find(base);
+        if (i < 0 && off == 0 && size >= 2*_line_size) {
+            // Bulk writes of uncached blocks are written through, in a
+            // single write for as many uncached blocks as possible
+            bd_size_t run = _line_size;
+            while (run + _line_size <= size && _find(base + run) < 0) {
+                run += _line_size;
+            }
+
+            int err = _write(buffer, addr, run);
+            if (err) {
+                return err;
+            }
+
+            _misses += run / _line_size;
+            buffer += run;
+            addr += run;
+            size -= run;
+            continue;
+        }
+
+        if (i < 0 && len == _line_size) {
+            // No need to read a block that is completely overwritten
+            i = _evict(1);
+            if (i < 0) {
+                return i;
+            }
+
+            _lines[i].addr = base;
+            _lines[i].valid = true;
+            _misses += 1;
+        } else if (i < 0) {
+            // Partial programs need the rest of the block, this is
+            // where writes to the same block are combined
+            i = _fetch(base, false);
+            if (i < 0) {
+                return i;
+            }
+        } else {
+            _hits += 1;
+        }
+
+        memcpy(&_buffer[i*_line_size + off], buffer, len);
+        _lines[i].dirty = true;
+        _lines[i].used = ++_tick;
+
+        buffer += len;
+        addr += len;
+        size -= len;
+    }
+
+    return 0;
+}
+
+int BufferedBlockDevice::erase(bd_addr_t addr, bd_size_t size)
+{
+    MBED_ASSERT(is_valid_erase(addr, size));
+    if (!_lines) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    // Drop any cached copies, including unwritten data
+    for (size_t i = 0; i < _count; i++) {
+        if (_lines[i].valid &&
+            _lines[i].addr >= addr && _lines[i].addr < addr + size) {
+            _lines[i].valid = false;
+            _lines[i].dirty = false;
+        }
+    }
+
+    return _bd->erase(addr, size);
+}
+
+int BufferedBlockDevice::sync()
+{
+    // Nothing is buffered before init
+    if (!_lines) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < _count; i++) {
+        int err = _flush(i);
+        if (err) {
+            return err;
+        }
+    }
+
+    return _bd->sync();
+}
+
+bd_size_t BufferedBlockDevice::get_read_size() const
+{
+    return _bd->get_read_size();
+}
+
+bd_size_t BufferedBlockDevice::get_program_size() const
+{
+    return _bd->get_read_size();
+}
+
+bd_size_t BufferedBlockDevice::get_erase_size() const
+{
+    return _bd->get_erase_size();
+}
+
+bd_size_t BufferedBlockDevice::size() const
+{
+    return _bd->size();
+}
+
+bool BufferedBlockDevice::requires_erase() const
+{
+    return false;
+}
+
+uint32_t BufferedBlockDevice::get_hits() const
+{
+    return _hits;
+}
+
+uint32_t BufferedBlockDevice::get_misses() const
+{
+    return _misses;
+}
+
+int BufferedBlockDevice::_find(bd_addr_t addr) const
+{
+    for (size_t i = 0; i < _count; i++) {
+        if (_lines[i].valid && _lines[i].addr == addr) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int BufferedBlockDevice::_evict(size_t n)
+{
+    // Find the least recently used window of n adjacent lines
+    size_t w = 0;
+    uint32_t w_used = -1;
+    for (size_t i = 0; i + n <= _count; i++) {
+        uint32_t used = 0;
+        for (size_t j = i; j < i + n; j++) {
+            uint32_t line_used = _lines[j].valid ? _lines[j].used : 0;
+            if (line_used > used) {
+                used = line_used;
+            }
+        }
+
+        if (used < w_used) {
+            w = i;
+            w_used = used;
+        }
+    }
+
+    for (size_t j = w; j < w + n; j++) {
+        int err = _flush(j);
+        if (err) {
+            return err;
+        }
+        _lines[j].valid = false;
+    }
+
+    return w;
+}
+
+int BufferedBlockDevice::_fetch(bd_addr_t addr, bool sequential)
+{
+    _misses += 1;
+
+    // Read ahead if this miss continues a sequential scan, stopping
+    // at the end of the device or at a block that is already cached
+    size_t n = 1;
+    if (sequential && addr == _next) {
+        while (n < 1 + _readahead &&
+               addr + (n+1)*_line_size <= size() &&
+               _find(addr + n*_line_size) < 0) {
+            n += 1;
+        }
+    }
+
+    int w = _evict(n);
+    if (w < 0) {
+        return w;
+    }
+
+    int err = _bd->read(&_buffer[w*_line_size], addr, n*_line_size);
+    if (err) {
+        return err;
+    }
+
+    for (size_t j = 0; j < n; j++) {
+        _lines[w+j].addr = addr + j*_line_size;
+        _lines[w+j].used = ++_tick;
+        _lines[w+j].valid = true;
+        _lines[w+j].dirty = false;
+    }
+
+    _next = addr + n*_line_size;
+    return w;
+}
+
+int BufferedBlockDevice::_flush(size_t i)
+{
+    if (!_lines[i].valid || !_lines[i].dirty) {
+        return 0;
+    }
+
+    int err = _write(&_buffer[i*_line_size], _lines[i].addr, _line_size);
+    if (err) {
+        return err;
+    }
+
+    _lines[i].dirty = false;
+    return 0;
+}
+
+int BufferedBlockDevice::_write(const uint8_t *buffer, bd_addr_t addr, bd_size_t size)
+{
+    if (_bd->requires_erase()) {
+        int err = _bd->erase(addr, size);
+        if (err) {
+            return err;
+        }
+    }
+
+    return _bd->program(buffer, addr, size);
+}
@@ -0,0 +1,187 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_BUFFERED_BLOCK_DEVICE_H
+#define MBED_BUFFERED_BLOCK_DEVICE_H
+
+#include "BlockDevice.h"
+#include "mbed.h"
+
+
+/** Block device for caching the erase blocks of another block device
+ *
+ *  Keeps a small LRU set of erase blocks in RAM. Reads and partial programs
+ *  are served from the cache, and dirty blocks are written back on eviction
+ *  or on sync. Bulk transfers of uncached blocks bypass the cache, and
+ *  misses in a sequential scan fetch the following blocks in the same
+ *  device read.
+ *
+ *  Since dirty blocks are erased before being written back, the buffered
+ *  block device does not need to be erased before being programmed.
+ *
+ *  @code
+ *  #include "mbed.h"
+ *  #include "HeapBlockDevice.h"
+ *  #include "BufferedBlockDevice.h"
+ *
+ *  // Create a block device with 64 blocks of size 512
+ *  HeapBlockDevice mem(64*512, 512);
+ *
+ *  // Cache up to 8 blocks of mem, reading 2 blocks ahead on sequential reads
+ *  BufferedBlockDevice buffered(&mem, 8, 2);
+ *  @endcode
+ */
+class BufferedBlockDevice : public BlockDevice
+{
+public:
+    /** Lifetime of the buffered block device
+     *
+     *  @param bd        Block device to back the BufferedBlockDevice
+     *  @param count     Number of erase blocks to cache
+     *  @param readahead Number of extra erase blocks to fetch when a miss
+     *                   continues a sequential scan, must be less than count
+     */
+    BufferedBlockDevice(BlockDevice *bd, size_t count = 4, size_t readahead = 1);
+
+    /** Lifetime of a block device
+     */
+    virtual ~BufferedBlockDevice();
+
+    /** Initialize a block device
+     *
+     *  @return         0 on success or a negative error code on failure
+     */
+    virtual int init();
+
+    /** Deinitialize a block device
+     *
+     *  Any buffered writes are written back before the underlying
+     *  block device is deinitialized
+     *
+     *  @return         0 on success or a negative error code on failure
+     */
+    virtual int deinit();
+
+    /** Read blocks from a block device
+     *
+     *  @param buffer   Buffer to read blocks into
+     *  @param addr     Address of block to begin reading from
+     *  @param size     Size to read in bytes, must be a multiple of read block size
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size);
+
+    /** Program blocks to a block device
+     *
+     *  The data may be buffered until the block is evicted or sync is called
+     *
+     *  @param buffer   Buffer of data to write to blocks
+     *  @param addr     Address of block to begin writing to
+     *  @param size     Size to write in bytes, must be a multiple of program block size
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size);
+
+    /** Erase blocks on a block device
+     *
+     *  Buffered writes to the erased blocks are discarded
+     *
+     *  @param addr     Address of block to begin erasing
+     *  @param size     Size to erase in bytes, must be a multiple of erase block size
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int erase(bd_addr_t addr, bd_size_t size);
+
+    /** Write back any buffered writes to the underlying block device
+     *
+     *  @return         0 on success or a negative error code on failure
+     */
+    virtual int sync();
+
+    /** Get the size of a readable block
+     *
+     *  @return         Size of a readable block in bytes
+     */
+    virtual bd_size_t get_read_size() const;
+
+    /** Get the size of a programable block
+     *
+     *  Partial programs are combined in the cache, so this is the
+     *  read size of the underlying block device
+     *
+     *  @return         Size of a programable block in bytes
+     *  @note Must be a multiple of the read size
+     */
+    virtual bd_size_t get_program_size() const;
+
+    /** Get the size of a eraseable block
+     *
+     *  @return         Size of a eraseable block in bytes
+     *  @note Must be a multiple of the program size
+     */
+    virtual bd_size_t get_erase_size() const;
+
+    /** Get the total size of the underlying device
+     *
+     *  @return         Size of the underlying device in bytes
+     */
+    virtual bd_size_t size() const;
+
+    /** Check if blocks must be erased before they are programmed
+     *
+     *  @return         Always false, blocks are erased on write back
+     */
+    virtual bool requires_erase() const;
+
+    /** Get the number of cache hits
+     *
+     *  @return         Number of erase block accesses served from the cache
+     */
+    uint32_t get_hits() const;
+
+    /** Get the number of cache misses
+     *
+     *  @return         Number of erase block accesses that needed the device
+     */
+    uint32_t get_misses() const;
+
+protected:
+    struct line {
+        bd_addr_t addr;
+        uint32_t used;
+        bool valid;
+        bool dirty;
+    };
+
+    int _find(bd_addr_t addr) const;
+    int _evict(size_t n);
+    int _fetch(bd_addr_t addr, bool sequential);
+    int _flush(size_t i);
+    int _write(const uint8_t *buffer, bd_addr_t addr, bd_size_t size);
+
+    BlockDevice *_bd;
+    size_t _count;
+    size_t _readahead;
+    bd_size_t _line_size;
+    uint8_t *_buffer;
+    struct line *_lines;
+    uint32_t _tick;
+    bd_addr_t _next;
+    uint32_t _hits;
+    uint32_t _misses;
+};
+
+
+#endif
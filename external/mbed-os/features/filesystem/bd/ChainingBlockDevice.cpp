@@ -175,6 +175,18 @@ int ChainingBlockDevice::erase(bd_addr_t addr, bd_size_t size)
     return 0;
 }
 
+int ChainingBlockDevice::sync()
+{
+    for (size_t i = 0; i < _bd_count; i++) {
+        int err = _bds[i]->sync();
+        if (err) {
+            return err;
+        }
+    }
+
+    return 0;
+}
+
 bd_size_t ChainingBlockDevice::get_read_size() const
 {
     return _read_size;
@@ -194,3 +206,14 @@ bd_size_t ChainingBlockDevice::size() const
 {
     return _size;
 }
+
+bool ChainingBlockDevice::requires_erase() const
+{
+    for (size_t i = 0; i < _bd_count; i++) {
+        if (_bds[i]->requires_erase()) {
+            return true;
+        }
+    }
+
+    return false;
+}
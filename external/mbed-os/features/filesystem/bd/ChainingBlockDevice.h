@@ -116,6 +116,12 @@ public:
      */
     virtual int erase(bd_addr_t addr, bd_size_t size);
 
+    /** Ensure data on a block device is committed to the underlying storage
+     *
+     *  @return         0 on success or a negative error code on failure
+     */
+    virtual int sync();
+
     /** Get the size of a readable block
      *
      *  @return         Size of a readable block in bytes
@@ -142,6 +148,12 @@ public:
      */
     virtual bd_size_t size() const;
 
+    /** Check if blocks must be erased before they are programmed
+     *
+     *  @return         True if program must be preceded by erase
+     */
+    virtual bool requires_erase() const;
+
 protected:
     BlockDevice **_bds;
     size_t _bd_count;
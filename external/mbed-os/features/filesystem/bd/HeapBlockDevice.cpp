@@ -82,6 +82,11 @@ bd_size_t HeapBlockDevice::size() const
     return _count * _erase_size;
 }
 
+bool HeapBlockDevice::requires_erase() const
+{
+    return false;
+}
+
 int HeapBlockDevice::read(void *b, bd_addr_t addr, bd_size_t size)
 {
     MBED_ASSERT(is_valid_read(addr, size));
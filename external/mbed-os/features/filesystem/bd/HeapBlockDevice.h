@@ -121,6 +121,12 @@ public:
      */
     virtual bd_size_t size() const;
 
+    /** Check if blocks must be erased before they are programmed
+     *
+     *  @return         True if program must be preceded by erase
+     */
+    virtual bool requires_erase() const;
+
 private:
     bd_size_t _read_size;
     bd_size_t _program_size;
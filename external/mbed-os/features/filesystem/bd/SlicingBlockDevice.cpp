@@ -93,6 +93,11 @@ int SlicingBlockDevice::erase(bd_addr_t addr, bd_size_t size)
     return _bd->erase(addr + _start, size);
 }
 
+int SlicingBlockDevice::sync()
+{
+    return _bd->sync();
+}
+
 bd_size_t SlicingBlockDevice::get_read_size() const
 {
     return _bd->get_read_size();
@@ -112,3 +117,8 @@ bd_size_t SlicingBlockDevice::size() const
 {
     return _stop - _start;
 }
+
+bool SlicingBlockDevice::requires_erase() const
+{
+    return _bd->requires_erase();
+}
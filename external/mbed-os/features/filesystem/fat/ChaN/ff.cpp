@@ -2697,6 +2697,9 @@ FRESULT f_write (
 	const BYTE *wbuff = (const BYTE*)buff;
 	BYTE csect;
 	bool need_sync = false;
+#if FLUSH_INTERVAL
+	DWORD fptr;
+#endif
 
 	*bw = 0;	/* Clear write byte counter */
 
@@ -2707,6 +2710,9 @@ FRESULT f_write (
 	if (!(fp->flag & FA_WRITE))				/* Check access mode */
 		LEAVE_FF(fp->fs, FR_DENIED);
 	if (fp->fptr + btw < fp->fptr) btw = 0;	/* File size cannot reach 4GB */
+#if FLUSH_INTERVAL
+	fptr = fp->fptr;						/* Remember where this write started */
+#endif
 
 	for ( ;  btw;							/* Repeat until all data written */
 		wbuff += wcnt, fp->fptr += wcnt, *bw += wcnt, btw -= wcnt) {
@@ -2806,6 +2812,10 @@ FRESULT f_write (
 	if (fp->fptr > fp->fsize) fp->fsize = fp->fptr;	/* Update file size if needed */
 	fp->flag |= FA__WRITTEN;						/* Set file change flag */
 
+#if FLUSH_INTERVAL
+	if (fptr / ((DWORD)FLUSH_INTERVAL * SS(fp->fs)) != fp->fptr / ((DWORD)FLUSH_INTERVAL * SS(fp->fs)))
+		need_sync = true;						/* Crossed a flush interval boundary */
+#endif
 	if (need_sync) {
         f_sync (fp);
     }
@@ -45,7 +45,7 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
-#define	_USE_FASTSEEK	0
+#define	_USE_FASTSEEK	1
 /* This option switches fast seek feature. (0:Disable or 1:Enable) */
 
 
@@ -92,7 +92,7 @@
 */
 
 
-#define	_USE_LFN	1
+#define	_USE_LFN	3
 #define	_MAX_LFN	255
 /* The _USE_LFN option switches the LFN feature.
 /
@@ -140,8 +140,13 @@
 / Drive/Volume Configurations
 /---------------------------------------------------------------------------*/
 
-#define _VOLUMES	1
-/* Number of volumes (logical drives) to be used. */
+#ifdef MBED_CONF_FILESYSTEM_FAT_VOLUMES
+#define _VOLUMES	MBED_CONF_FILESYSTEM_FAT_VOLUMES
+#else
+#define _VOLUMES	4
+#endif
+/* Number of volumes (logical drives) to be used. Each mounted FATFileSystem
+/  takes one volume, and volumes are accessed concurrently. */
 
 
 #define _STR_VOLUME_ID	0
@@ -228,9 +233,9 @@
 /      lock feature is independent of re-entrancy. */
 
 
-#define _FS_REENTRANT	0
+#define _FS_REENTRANT	1
 #define _FS_TIMEOUT		1000
-#define	_SYNC_t			HANDLE
+#define	_SYNC_t			void*
 /* The _FS_REENTRANT option switches the re-entrancy (thread safe) of the FatFs
 /  module itself. Note that regardless of this option, file access to different
 /  volume is always re-entrant and volume control functions, f_mount(), f_mkfs()
@@ -246,7 +251,10 @@
 /  The _FS_TIMEOUT defines timeout period in unit of time tick.
 /  The _SYNC_t defines O/S dependent sync object type. e.g. HANDLE, ID, OS_EVENT*,
 /  SemaphoreHandle_t and etc.. A header file for O/S definitions needs to be
-/  included somewhere in the scope of ff.c. */
+/  included somewhere in the scope of ff.c.
+/
+/  In mbed the sync objects are PlatformMutexes created by FATFileSystem, so
+/  _FS_TIMEOUT has no effect and requests for a volume wait until granted. */
 
 
 #define _WORD_ACCESS	0
@@ -277,9 +285,18 @@
 */
 
 #define FLUSH_ON_NEW_CLUSTER    0   /* Sync the file on every new cluster */
-#define FLUSH_ON_NEW_SECTOR     1   /* Sync the file on every new sector */
+#define FLUSH_ON_NEW_SECTOR     0   /* Sync the file on every new sector */
 /* Only one of these two defines needs to be set to 1. If both are set to 0
    the file is only sync when closed.
    Clusters are group of sectors (eg: 8 sectors). Flushing on new cluster means
    it would be less often than flushing on new sector. Sectors are generally
    512 Bytes long. */
+
+#ifdef MBED_CONF_FILESYSTEM_FAT_FLUSH_INTERVAL
+#define FLUSH_INTERVAL  MBED_CONF_FILESYSTEM_FAT_FLUSH_INTERVAL
+#else
+#define FLUSH_INTERVAL  0
+#endif
+/* Sync the file every time a write crosses a multiple of FLUSH_INTERVAL
+   sectors. When set to 0 the file is only sync on f_sync and f_close,
+   which gives the best streaming write throughput (write-back). */
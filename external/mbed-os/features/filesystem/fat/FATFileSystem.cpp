@@ -127,10 +127,24 @@ void fat_filesystem_set_errno(FRESULT res)
 
 ////// Disk operations //////
 
-// Global access to block device from FAT driver
+// Global access to block device from FAT driver,
+// _ffs_mutex only protects assignment of the drives
 static BlockDevice *_ffs[_VOLUMES] = {0};
 static SingletonPtr<PlatformMutex> _ffs_mutex;
 
+// File object with an optional cluster link map for fast seeking,
+// FIL::cltbl points to clmt only while the map is up to date, and
+// clmt_full is set while the file has more fragments than fit in the map.
+// FatFs only holds the volume lock inside its own calls, so mutex guards
+// the position, size and map across each file operation, leaving
+// different files free to run in parallel
+struct fat_file : FIL {
+    DWORD *clmt;
+    size_t clmt_size;
+    bool clmt_full;
+    PlatformMutex mutex;
+};
+
 
 // FAT driver functions
 DWORD get_fattime(void)
@@ -146,6 +160,50 @@ DWORD get_fattime(void)
            | (DWORD)(ptm->tm_sec/2    );
 }
 
+void *ff_memalloc(UINT size)
+{
+    return malloc(size);
+}
+
+void ff_memfree(void *p)
+{
+    free(p);
+}
+
+// Implementation of FatFs sync functions, each volume gets its own mutex
+// so operations on different volumes can run concurrently
+int ff_cre_syncobj(BYTE vol, _SYNC_t *sobj)
+{
+    *sobj = new PlatformMutex;
+    return 1;
+}
+
+int ff_del_syncobj(_SYNC_t sobj)
+{
+    delete static_cast<PlatformMutex*>(sobj);
+    return 1;
+}
+
+int ff_req_grant(_SYNC_t sobj)
+{
+    static_cast<PlatformMutex*>(sobj)->lock();
+    return 1;
+}
+
+void ff_rel_grant(_SYNC_t sobj)
+{
+    static_cast<PlatformMutex*>(sobj)->unlock();
+}
+
+// Prefix a path with the drive of the filesystem, FatFs otherwise
+// looks the path up on the default drive
+static char *fat_path(const char *fsid, const char *path)
+{
+    char *buffer = new char[strlen(fsid) + strlen(path) + 2];
+    sprintf(buffer, "%s/%s", fsid, path);
+    return buffer;
+}
+
 // Implementation of diskio functions (see ChaN/diskio.h)
 DSTATUS disk_status(BYTE pdrv)
 {
@@ -171,9 +229,12 @@ DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 {
     debug_if(FFS_DBG, "disk_write(sector %d, count %d) on pdrv [%d]\n", sector, count, pdrv);
     bd_size_t ssize = _ffs[pdrv]->get_erase_size();
-    int err = _ffs[pdrv]->erase(sector*ssize, count*ssize);
-    if (err) {
-        return RES_PARERR;
+    int err;
+    if (_ffs[pdrv]->requires_erase()) {
+        err = _ffs[pdrv]->erase(sector*ssize, count*ssize);
+        if (err) {
+            return RES_PARERR;
+        }
     }
 
     err = _ffs[pdrv]->program(buff, sector*ssize, count*ssize);
@@ -191,6 +252,8 @@ DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
         case CTRL_SYNC:
             if (_ffs[pdrv] == NULL) {
                 return RES_NOTRDY;
+            } else if (_ffs[pdrv]->sync()) {
+                return RES_ERROR;
             } else {
                 return RES_OK;
             }
@@ -247,21 +310,29 @@ int FATFileSystem::mount(BlockDevice *bd, bool force) {
         return -EINVAL;
     }
 
+    _ffs_mutex->lock();
     for (int i = 0; i < _VOLUMES; i++) {
         if (!_ffs[i]) {
             _id = i;
             _ffs[_id] = bd;
-            _fsid[0] = '0' + _id;
-            _fsid[1] = '\0';
-            debug_if(FFS_DBG, "Mounting [%s] on ffs drive [%s]\n", getName(), _fsid);
-            FRESULT res = f_mount(&_fs, _fsid, force);
-            unlock();
-            return fat_error_remap(res);
+            break;
         }
     }
+    _ffs_mutex->unlock();
+
+    if (_id == -1) {
+        unlock();
+        return -ENOMEM;
+    }
 
+    // The drive needs a colon, FatFs ignores bare drive numbers
+    _fsid[0] = '0' + _id;
+    _fsid[1] = ':';
+    _fsid[2] = '\0';
+    debug_if(FFS_DBG, "Mounting [%s] on ffs drive [%s]\n", getName(), _fsid);
+    FRESULT res = f_mount(&_fs, _fsid, force);
     unlock();
-    return -ENOMEM;
+    return fat_error_remap(res);
 }
 
 int FATFileSystem::unmount()
@@ -273,7 +344,9 @@ int FATFileSystem::unmount()
     }
 
     FRESULT res = f_mount(NULL, _fsid, 0);
+    _ffs_mutex->lock();
     _ffs[_id] = NULL;
+    _ffs_mutex->unlock();
     _id = -1;
     unlock();
     return fat_error_remap(res);
@@ -305,9 +378,9 @@ int FATFileSystem::format(BlockDevice *bd, int allocation_unit) {
 }
 
 int FATFileSystem::remove(const char *filename) {
-    lock();
-    FRESULT res = f_unlink(filename);
-    unlock();
+    char *path = fat_path(_fsid, filename);
+    FRESULT res = f_unlink(path);
+    delete[] path;
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_unlink() failed: %d\n", res);
@@ -316,9 +389,11 @@ int FATFileSystem::remove(const char *filename) {
 }
 
 int FATFileSystem::rename(const char *oldname, const char *newname) {
-    lock();
-    FRESULT res = f_rename(oldname, newname);
-    unlock();
+    char *oldpath = fat_path(_fsid, oldname);
+    char *newpath = fat_path(_fsid, newname);
+    FRESULT res = f_rename(oldpath, newpath);
+    delete[] oldpath;
+    delete[] newpath;
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_rename() failed: %d\n", res);
@@ -327,9 +402,9 @@ int FATFileSystem::rename(const char *oldname, const char *newname) {
 }
 
 int FATFileSystem::mkdir(const char *name, mode_t mode) {
-    lock();
-    FRESULT res = f_mkdir(name);
-    unlock();
+    char *path = fat_path(_fsid, name);
+    FRESULT res = f_mkdir(path);
+    delete[] path;
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_mkdir() failed: %d\n", res);
@@ -338,13 +413,13 @@ int FATFileSystem::mkdir(const char *name, mode_t mode) {
 }
 
 int FATFileSystem::stat(const char *name, struct stat *st) {
-    lock();
     FILINFO f;
     memset(&f, 0, sizeof(f));
 
-    FRESULT res = f_stat(name, &f);
+    char *path = fat_path(_fsid, name);
+    FRESULT res = f_stat(path, &f);
+    delete[] path;
     if (res != FR_OK) {
-        unlock();
         return fat_error_remap(res);
     }
 
@@ -357,17 +432,16 @@ int FATFileSystem::stat(const char *name, struct stat *st) {
         (S_IRUSR | S_IXUSR | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) :
         (S_IRWXU | S_IRWXG | S_IRWXO);
 #endif /* TOOLCHAIN_GCC */
-    unlock();
 
     return 0;
 }
 
 void FATFileSystem::lock() {
-    _ffs_mutex->lock();
+    _mutex.lock();
 }
 
 void FATFileSystem::unlock() {
-    _ffs_mutex->unlock();
+    _mutex.unlock();
 }
 
 
@@ -375,9 +449,11 @@ void FATFileSystem::unlock() {
 int FATFileSystem::file_open(fs_file_t *file, const char *path, int flags) {
     debug_if(FFS_DBG, "open(%s) on filesystem [%s], drv [%s]\n", path, getName(), _fsid);
 
-    FIL *fh = new FIL;
-    char *buffer = new char[strlen(_fsid) + strlen(path) + 3];
-    sprintf(buffer, "%s:/%s", _fsid, path);
+    fat_file *fh = new fat_file;
+    fh->clmt = NULL;
+    fh->clmt_size = 0;
+    fh->clmt_full = false;
+    char *buffer = fat_path(_fsid, path);
 
     /* POSIX flags -> FatFS open mode */
     BYTE openmode;
@@ -396,11 +472,9 @@ int FATFileSystem::file_open(fs_file_t *file, const char *path, int flags) {
         }
     }
 
-    lock();
     FRESULT res = f_open(fh, buffer, openmode);
 
     if (res != FR_OK) {
-        unlock();
         debug_if(FFS_DBG, "f_open('w') failed: %d\n", res);
         delete[] buffer;
         delete fh;
@@ -410,7 +484,6 @@ int FATFileSystem::file_open(fs_file_t *file, const char *path, int flags) {
     if (flags & O_APPEND) {
         f_lseek(fh, fh->fsize);
     }
-    unlock();
 
     delete[] buffer;
     *file = fh;
@@ -418,23 +491,22 @@ int FATFileSystem::file_open(fs_file_t *file, const char *path, int flags) {
 }
 
 int FATFileSystem::file_close(fs_file_t file) {
-    FIL *fh = static_cast<FIL*>(file);
+    fat_file *fh = static_cast<fat_file*>(file);
 
-    lock();
     FRESULT res = f_close(fh);
-    unlock();
 
+    delete[] fh->clmt;
     delete fh;
     return fat_error_remap(res);
 }
 
 ssize_t FATFileSystem::file_read(fs_file_t file, void *buffer, size_t len) {
-    FIL *fh = static_cast<FIL*>(file);
+    fat_file *fh = static_cast<fat_file*>(file);
 
-    lock();
+    fh->mutex.lock();
     UINT n;
     FRESULT res = f_read(fh, buffer, len, &n);
-    unlock();
+    fh->mutex.unlock();
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_read() failed: %d\n", res);
@@ -445,12 +517,19 @@ ssize_t FATFileSystem::file_read(fs_file_t file, void *buffer, size_t len) {
 }
 
 ssize_t FATFileSystem::file_write(fs_file_t file, const void *buffer, size_t len) {
-    FIL *fh = static_cast<FIL*>(file);
+    fat_file *fh = static_cast<fat_file*>(file);
+
+    fh->mutex.lock();
+    if (fh->fptr + len > fh->fsize) {
+        // The link map can not follow the file as it grows,
+        // and the new clusters may change its fragment count
+        fh->cltbl = NULL;
+        fh->clmt_full = false;
+    }
 
-    lock();
     UINT n;
     FRESULT res = f_write(fh, buffer, len, &n);
-    unlock();
+    fh->mutex.unlock();
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_write() failed: %d", res);
@@ -461,11 +540,11 @@ ssize_t FATFileSystem::file_write(fs_file_t file, const void *buffer, size_t len
 }
 
 int FATFileSystem::file_sync(fs_file_t file) {
-    FIL *fh = static_cast<FIL*>(file);
+    fat_file *fh = static_cast<fat_file*>(file);
 
-    lock();
+    fh->mutex.lock();
     FRESULT res = f_sync(fh);
-    unlock();
+    fh->mutex.unlock();
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_sync() failed: %d\n", res);
@@ -474,43 +553,82 @@ int FATFileSystem::file_sync(fs_file_t file) {
 }
 
 off_t FATFileSystem::file_seek(fs_file_t file, off_t offset, int whence) {
-    FIL *fh = static_cast<FIL*>(file);
+    fat_file *fh = static_cast<fat_file*>(file);
 
-    lock();
+    fh->mutex.lock();
     if (whence == SEEK_END) {
         offset += fh->fsize;
     } else if(whence==SEEK_CUR) {
         offset += fh->fptr;
     }
 
+    if (fh->clmt_size && !fh->cltbl && !fh->clmt_full
+            && (DWORD)offset <= fh->fsize) {
+        // Build the link map, falling back to a normal seek
+        // if the file has too many fragments
+        if (!fh->clmt) {
+            fh->clmt = new DWORD[fh->clmt_size];
+        }
+
+        fh->clmt[0] = fh->clmt_size;
+        fh->cltbl = fh->clmt;
+        if (f_lseek(fh, CREATE_LINKMAP) != FR_OK) {
+            // Walking the chain again would fail the same way, so don't
+            // retry until the file grows or the map is resized
+            fh->cltbl = NULL;
+            fh->clmt_full = true;
+            delete[] fh->clmt;
+            fh->clmt = NULL;
+        }
+    } else if (fh->cltbl && (DWORD)offset > fh->fsize) {
+        // Seeking past the end extends the file
+        fh->cltbl = NULL;
+    }
+
     FRESULT res = f_lseek(fh, offset);
-    off_t noffset = fh->fptr;
-    unlock();
+    offset = fh->fptr;
+    fh->mutex.unlock();
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "lseek failed: %d\n", res);
         return fat_error_remap(res);
     } else {
-        return noffset;
+        return offset;
     }
 }
 
+int FATFileSystem::file_fastseek(fs_file_t file, size_t size) {
+    fat_file *fh = static_cast<fat_file*>(file);
+
+    fh->mutex.lock();
+    fh->cltbl = NULL;
+    delete[] fh->clmt;
+    fh->clmt = NULL;
+    fh->clmt_full = false;
+
+    // Each fragment takes two entries, plus the table size and terminator
+    fh->clmt_size = size ? 2*size + 2 : 0;
+    fh->mutex.unlock();
+
+    return 0;
+}
+
 off_t FATFileSystem::file_tell(fs_file_t file) {
-    FIL *fh = static_cast<FIL*>(file);
+    fat_file *fh = static_cast<fat_file*>(file);
 
-    lock();
+    fh->mutex.lock();
     off_t res = fh->fptr;
-    unlock();
+    fh->mutex.unlock();
 
     return res;
 }
 
 size_t FATFileSystem::file_size(fs_file_t file) {
-    FIL *fh = static_cast<FIL*>(file);
+    fat_file *fh = static_cast<fat_file*>(file);
 
-    lock();
+    fh->mutex.lock();
     size_t res = fh->fsize;
-    unlock();
+    fh->mutex.unlock();
 
     return res;
 }
@@ -520,9 +638,9 @@ size_t FATFileSystem::file_size(fs_file_t file) {
 int FATFileSystem::dir_open(fs_dir_t *dir, const char *path) {
     FATFS_DIR *dh = new FATFS_DIR;
 
-    lock();
-    FRESULT res = f_opendir(dh, path);
-    unlock();
+    char *buffer = fat_path(_fsid, path);
+    FRESULT res = f_opendir(dh, buffer);
+    delete[] buffer;
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_opendir() failed: %d\n", res);
@@ -537,9 +655,7 @@ int FATFileSystem::dir_open(fs_dir_t *dir, const char *path) {
 int FATFileSystem::dir_close(fs_dir_t dir) {
     FATFS_DIR *dh = static_cast<FATFS_DIR*>(dir);
 
-    lock();
     FRESULT res = f_closedir(dh);
-    unlock();
 
     delete dh;
     return fat_error_remap(res);
@@ -554,9 +670,7 @@ ssize_t FATFileSystem::dir_read(fs_dir_t dir, struct dirent *ent) {
     finfo.lfsize = NAME_MAX;
 #endif // _USE_LFN
 
-    lock();
     FRESULT res = f_readdir(dh, &finfo);
-    unlock();
 
     if (res != FR_OK) {
         return fat_error_remap(res);
@@ -581,26 +695,18 @@ ssize_t FATFileSystem::dir_read(fs_dir_t dir, struct dirent *ent) {
 void FATFileSystem::dir_seek(fs_dir_t dir, off_t offset) {
     FATFS_DIR *dh = static_cast<FATFS_DIR*>(dir);
 
-    lock();
     dh->index = offset;
-    unlock();
 }
 
 off_t FATFileSystem::dir_tell(fs_dir_t dir) {
     FATFS_DIR *dh = static_cast<FATFS_DIR*>(dir);
 
-    lock();
-    off_t offset = dh->index;
-    unlock();
-
-    return offset;
+    return dh->index;
 }
 
 void FATFileSystem::dir_rewind(fs_dir_t dir) {
     FATFS_DIR *dh = static_cast<FATFS_DIR*>(dir);
 
-    lock();
     dh->index = 0;
-    unlock();
 }
 
@@ -33,6 +33,11 @@ using namespace mbed;
 
 /**
  * FATFileSystem based on ChaN's Fat Filesystem library v0.8
+ *
+ * Each mounted FATFileSystem is a separate FatFs volume with its own lock,
+ * so operations on different filesystems run concurrently. Operations on
+ * the same filesystem are serialized by FatFs, and a single file or
+ * directory should not be used from multiple threads at the same time.
  */
 class FATFileSystem : public FileSystem {
 public:
@@ -167,6 +172,19 @@ protected:
      */
     virtual off_t file_seek(fs_file_t file, off_t offset, int whence);
 
+    /** Enable fast seeking on a file
+     *
+     *  Seeks use a cluster link map of the file instead of following the
+     *  FAT chain from the start of the file, the map is built lazily on
+     *  the next seek and rebuilt after the file grows
+     *
+     *  @param file     File handle
+     *  @param size     Number of fragments the map can hold, 0 disables
+     *                  fast seeking
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int file_fastseek(fs_file_t file, size_t size);
+
     /** Get the file position of the file
      *
      *  @param file     File handle
@@ -227,8 +245,9 @@ protected:
     
 private:
     FATFS _fs; // Work area (file system object) for logical drive
-    char _fsid[2];
+    char _fsid[3];
     int _id;
+    PlatformMutex _mutex; // Protects mounting and formatting of this volume
 
 protected:
     virtual void lock();
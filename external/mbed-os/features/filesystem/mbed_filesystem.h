@@ -33,6 +33,7 @@
 #include "bd/ChainingBlockDevice.h"
 #include "bd/SlicingBlockDevice.h"
 #include "bd/HeapBlockDevice.h"
+#include "bd/BufferedBlockDevice.h"
 
 
 /** @}*/
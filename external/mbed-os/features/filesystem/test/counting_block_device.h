@@ -0,0 +1,89 @@
+/* Block device adapter for the host tests, counting the operations that
+ * reach the underlying device, and optionally sleeping for each read,
+ * program and erase as a real device would */
+#ifndef COUNTING_BLOCK_DEVICE_H
+#define COUNTING_BLOCK_DEVICE_H
+
+#include "BlockDevice.h"
+#include <unistd.h>
+
+class CountingBlockDevice : public BlockDevice {
+public:
+    CountingBlockDevice(BlockDevice *bd, bool requires_erase, unsigned latency_us = 0)
+        : _bd(bd), _requires_erase(requires_erase), _latency_us(latency_us) {
+        reset();
+    }
+
+    void reset() {
+        reads = programs = erases = syncs = 0;
+    }
+
+    virtual int init() {
+        return _bd->init();
+    }
+
+    virtual int deinit() {
+        return _bd->deinit();
+    }
+
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size) {
+        reads++;
+        delay();
+        return _bd->read(buffer, addr, size);
+    }
+
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size) {
+        programs++;
+        delay();
+        return _bd->program(buffer, addr, size);
+    }
+
+    virtual int erase(bd_addr_t addr, bd_size_t size) {
+        erases++;
+        delay();
+        return _bd->erase(addr, size);
+    }
+
+    virtual int sync() {
+        syncs++;
+        return _bd->sync();
+    }
+
+    virtual bd_size_t get_read_size() const {
+        return _bd->get_read_size();
+    }
+
+    virtual bd_size_t get_program_size() const {
+        return _bd->get_program_size();
+    }
+
+    virtual bd_size_t get_erase_size() const {
+        return _bd->get_erase_size();
+    }
+
+    virtual bd_size_t size() const {
+        return _bd->size();
+    }
+
+    virtual bool requires_erase() const {
+        return _requires_erase;
+    }
+
+    unsigned reads;
+    unsigned programs;
+    unsigned erases;
+    unsigned syncs;
+
+private:
+    void delay() {
+        if (_latency_us) {
+            usleep(_latency_us);
+        }
+    }
+
+    BlockDevice *_bd;
+    bool _requires_erase;
+    unsigned _latency_us;
+};
+
+#endif
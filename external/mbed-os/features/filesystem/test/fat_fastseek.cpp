@@ -0,0 +1,139 @@
+/*
+ * Host test of random reads through FATFileSystem with fastseek
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Reads random sectors of a 1MB file on a FAT volume with 512 byte clusters
+ * and counts the block device reads, with and without a cluster link map.
+ * A fragmented file whose map is too small must cost no more than a plain
+ * seek, rather than walking the cluster chain twice on every seek.
+ */
+#include "FATFileSystem.h"
+#include "File.h"
+#include "HeapBlockDevice.h"
+#include "counting_block_device.h"
+#include "host_test.h"
+#include <errno.h>
+#include <time.h>
+
+
+#define DISK_SIZE       (8*1024*1024)
+#define FILE_SIZE       (1024*1024)
+#define SECTOR          512
+#define SEEKS           1000
+
+pthread_mutex_t singleton_lock = PTHREAD_MUTEX_INITIALIZER;
+
+namespace mbed {
+void remove_filehandle(FileLike *file)
+{
+}
+}
+
+
+// Test
+// Every word holds its own offset in the file
+static void fill(uint32_t *buffer, uint32_t offset)
+{
+    for (unsigned i = 0; i < SECTOR / 4; i++) {
+        buffer[i] = offset + 4*i;
+    }
+}
+
+// Reads SEEKS random sectors of path and returns the block device reads
+static unsigned random_reads(FATFileSystem &fs, CountingBlockDevice &bd,
+        const char *path, size_t fastseek)
+{
+    static uint32_t buffer[SECTOR / 4];
+    File file;
+    check(file.open(&fs, path, O_RDONLY) == 0);
+    if (fastseek) {
+        check(file.fastseek(fastseek) == 0);
+    }
+
+    uint32_t seed = 1;
+    bool same = true;
+    bd.reset();
+    uint64_t start = now_ns();
+    for (int i = 0; i < SEEKS; i++) {
+        seed = seed*1103515245 + 12345;
+        off_t offset = ((seed >> 8) % (FILE_SIZE / SECTOR)) * SECTOR;
+        check(file.seek(offset) == offset);
+        check(file.read(buffer, SECTOR) == SECTOR);
+        same = same && buffer[0] == (uint32_t)offset
+                && buffer[SECTOR/4 - 1] == (uint32_t)offset + SECTOR - 4;
+    }
+    uint64_t elapsed = now_ns() - start;
+    unsigned reads = bd.reads;
+    check(same);
+    check(file.close() == 0);
+
+    printf("%-10s fastseek %4u: %6u reads, %5.2f per seek, %6llu us\n",
+            path, (unsigned)fastseek, reads, (double)reads / SEEKS,
+            (unsigned long long)elapsed / 1000);
+    return reads;
+}
+
+int main()
+{
+    HeapBlockDevice heap(DISK_SIZE, 512);
+    CountingBlockDevice bd(&heap, false);
+    check(FATFileSystem::format(&bd, SECTOR) == 0);
+    FATFileSystem fs("fat", &bd);
+
+    // One contiguous file, and one with a fragment per cluster from
+    // interleaving its writes with another file's
+    static uint32_t buffer[SECTOR / 4];
+    File contiguous, fragmented, filler;
+    check(contiguous.open(&fs, "contig", O_WRONLY | O_CREAT | O_TRUNC) == 0);
+    for (uint32_t offset = 0; offset < FILE_SIZE; offset += SECTOR) {
+        fill(buffer, offset);
+        check(contiguous.write(buffer, SECTOR) == SECTOR);
+    }
+    check(contiguous.close() == 0);
+
+    check(fragmented.open(&fs, "fragment", O_WRONLY | O_CREAT | O_TRUNC) == 0);
+    check(filler.open(&fs, "filler", O_WRONLY | O_CREAT | O_TRUNC) == 0);
+    for (uint32_t offset = 0; offset < FILE_SIZE; offset += SECTOR) {
+        fill(buffer, offset);
+        check(fragmented.write(buffer, SECTOR) == SECTOR);
+        check(fragmented.sync() == 0);
+        check(filler.write(buffer, SECTOR) == SECTOR);
+        check(filler.sync() == 0);
+    }
+    check(fragmented.close() == 0);
+    check(filler.close() == 0);
+
+    const unsigned clusters = FILE_SIZE / SECTOR;
+    unsigned contig_plain = random_reads(fs, bd, "contig", 0);
+    unsigned contig_fast = random_reads(fs, bd, "contig", 4);
+    unsigned frag_plain = random_reads(fs, bd, "fragment", 0);
+    unsigned frag_small = random_reads(fs, bd, "fragment", 4);
+    unsigned frag_fast = random_reads(fs, bd, "fragment", clusters);
+
+    // Walking the whole chain reads each FAT16 sector it spans once, and
+    // the fragmented file spans twice its clusters
+    const unsigned walk = 2*clusters / (SECTOR / 2) + 2;
+
+    // With a map each seek costs the data read, plus building the map once
+    check(contig_fast <= SEEKS + walk);
+    check(frag_fast <= SEEKS + walk);
+    check(contig_fast * 3 < contig_plain);
+    check(frag_fast * 3 < frag_plain);
+
+    // A map that does not fit is given up after the first attempt
+    check(frag_small <= frag_plain + 2*walk);
+
+    return host_test_done();
+}
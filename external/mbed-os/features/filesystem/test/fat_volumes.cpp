@@ -0,0 +1,133 @@
+/*
+ * Host test of throughput scaling across FATFileSystem volumes
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Writes and reads back a file on each of two FAT volumes whose block
+ * devices sleep for every operation, first one volume after the other and
+ * then from a thread per volume. Each volume has its own lock, so the
+ * threads should overlap their device time and nearly double throughput.
+ * Two threads on the same volume are timed for comparison.
+ */
+#include "FATFileSystem.h"
+#include "File.h"
+#include "HeapBlockDevice.h"
+#include "counting_block_device.h"
+#include "host_test.h"
+#include <errno.h>
+#include <time.h>
+
+
+#define DISK_SIZE       (4*1024*1024)
+#define FILE_SIZE       (128*1024)
+#define SECTOR          512
+#define LATENCY_US      50
+
+pthread_mutex_t singleton_lock = PTHREAD_MUTEX_INITIALIZER;
+
+namespace mbed {
+void remove_filehandle(FileLike *file)
+{
+}
+}
+
+
+// Test
+struct stream {
+    FATFileSystem *fs;
+    const char *path;
+    uint8_t pattern;
+};
+
+static void *write_read(void *arg)
+{
+    stream *s = static_cast<stream*>(arg);
+    static __thread uint8_t buffer[SECTOR];
+    File file;
+
+    check(file.open(s->fs, s->path, O_WRONLY | O_CREAT | O_TRUNC) == 0);
+    for (int i = 0; i < FILE_SIZE / SECTOR; i++) {
+        memset(buffer, s->pattern + i, SECTOR);
+        check(file.write(buffer, SECTOR) == SECTOR);
+    }
+    check(file.close() == 0);
+
+    bool same = true;
+    check(file.open(s->fs, s->path, O_RDONLY) == 0);
+    for (int i = 0; i < FILE_SIZE / SECTOR; i++) {
+        check(file.read(buffer, SECTOR) == SECTOR);
+        same = same && buffer[0] == (uint8_t)(s->pattern + i)
+                && buffer[SECTOR - 1] == (uint8_t)(s->pattern + i);
+    }
+    check(same);
+    check(file.close() == 0);
+    return NULL;
+}
+
+// Runs the streams one after the other, or from a thread each,
+// and returns the aggregate throughput in KB/s
+static double run(const char *name, stream *streams, int count, bool threads)
+{
+    pthread_t thread[count];
+    host_mutex_contended = 0;
+    uint64_t start = now_ns();
+    for (int i = 0; i < count; i++) {
+        if (threads) {
+            pthread_create(&thread[i], NULL, write_read, &streams[i]);
+        } else {
+            write_read(&streams[i]);
+        }
+    }
+    if (threads) {
+        for (int i = 0; i < count; i++) {
+            pthread_join(thread[i], NULL);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    double kbps = (2.0 * count * FILE_SIZE / 1024) / (elapsed / 1e9);
+    printf("%-20s %6llu us, %6.0f KB/s, %4u contended locks\n", name,
+            (unsigned long long)elapsed / 1000, kbps, host_mutex_contended);
+    return kbps;
+}
+
+int main()
+{
+    HeapBlockDevice heap1(DISK_SIZE, SECTOR);
+    HeapBlockDevice heap2(DISK_SIZE, SECTOR);
+    CountingBlockDevice bd1(&heap1, false, LATENCY_US);
+    CountingBlockDevice bd2(&heap2, false, LATENCY_US);
+    check(FATFileSystem::format(&bd1) == 0);
+    check(FATFileSystem::format(&bd2) == 0);
+    FATFileSystem fs1("fat1", &bd1);
+    FATFileSystem fs2("fat2", &bd2);
+
+    stream volumes[] = {{&fs1, "a.bin", 0x11}, {&fs2, "b.bin", 0x22}};
+    stream shared[] = {{&fs1, "a.bin", 0x33}, {&fs1, "b.bin", 0x44}};
+
+    double serial = run("serial", volumes, 2, false);
+    double parallel = run("two volumes", volumes, 2, true);
+    run("one volume", shared, 2, true);
+
+    printf("two volumes scale %.2fx\n", parallel / serial);
+    check(parallel >= 1.6 * serial);
+
+    // Each volume holds only its own file
+    struct stat st;
+    check(fs1.stat("a.bin", &st) == 0);
+    check(fs2.stat("b.bin", &st) == 0);
+    check(fs2.stat("a.bin", &st) == -ENOENT);
+
+    return host_test_done();
+}
@@ -0,0 +1,105 @@
+/*
+ * Host test of streaming writes through FATFileSystem
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Writes 2MB in 512 byte File::write calls to a FAT volume on a
+ * HeapBlockDevice, as the SdPerf sample does on an SD card, and counts the
+ * operations that reach the block device.
+ *
+ * Built with MBED_CONF_FILESYSTEM_FAT_FLUSH_INTERVAL=1 and a device that
+ * requires erase, it reproduces the old behaviour of a sync per sector and
+ * an erase before every program.
+ */
+#include "FATFileSystem.h"
+#include "File.h"
+#include "HeapBlockDevice.h"
+#include "counting_block_device.h"
+#include "host_test.h"
+#include <errno.h>
+#include <time.h>
+
+
+#define DISK_SIZE       (8*1024*1024)
+#define FILE_SIZE       (2*1024*1024)
+#define WRITE_SIZE      512
+
+#if MBED_CONF_FILESYSTEM_FAT_FLUSH_INTERVAL
+#define REQUIRES_ERASE  true
+#else
+#define REQUIRES_ERASE  false
+#endif
+
+pthread_mutex_t singleton_lock = PTHREAD_MUTEX_INITIALIZER;
+
+namespace mbed {
+void remove_filehandle(FileLike *file)
+{
+}
+}
+
+
+// Test
+int main()
+{
+    HeapBlockDevice heap(DISK_SIZE, 512);
+    CountingBlockDevice bd(&heap, REQUIRES_ERASE);
+    check(FATFileSystem::format(&bd) == 0);
+    FATFileSystem fs("fat", &bd);
+
+    static uint8_t buffer[WRITE_SIZE];
+    File file;
+    check(file.open(&fs, "stream.bin", O_WRONLY | O_CREAT | O_TRUNC) == 0);
+
+    bd.reset();
+    uint64_t start = now_ns();
+    for (int i = 0; i < FILE_SIZE / WRITE_SIZE; i++) {
+        memset(buffer, i, sizeof(buffer));
+        check(file.write(buffer, sizeof(buffer)) == sizeof(buffer));
+    }
+    check(file.close() == 0);
+    uint64_t elapsed = now_ns() - start;
+
+    const unsigned sectors = FILE_SIZE / 512;
+    printf("%uKB in %dB writes: %u programs, %u erases, %u syncs, %llu us\n",
+            FILE_SIZE / 1024, WRITE_SIZE, bd.programs, bd.erases, bd.syncs,
+            (unsigned long long)elapsed / 1000);
+
+#if MBED_CONF_FILESYSTEM_FAT_FLUSH_INTERVAL
+    check(bd.syncs >= sectors / MBED_CONF_FILESYSTEM_FAT_FLUSH_INTERVAL);
+    check(bd.erases == bd.programs);
+#else
+    // Data sectors plus the FAT and directory entry written on close
+    check(bd.syncs == 1);
+    check(bd.erases == 0);
+    check(bd.programs < sectors + sectors / 64);
+#endif
+
+    // The data reads back after a remount
+    check(fs.unmount() == 0);
+    check(fs.mount(&bd) == 0);
+    check(file.open(&fs, "stream.bin", O_RDONLY) == 0);
+    check(file.size() == FILE_SIZE);
+    bool same = true;
+    for (int i = 0; i < FILE_SIZE / WRITE_SIZE; i++) {
+        check(file.read(buffer, sizeof(buffer)) == sizeof(buffer));
+        for (int j = 0; j < WRITE_SIZE; j++) {
+            same = same && buffer[j] == (uint8_t)i;
+        }
+    }
+    check(same);
+    check(file.close() == 0);
+
+    return host_test_done();
+}
@@ -0,0 +1,16 @@
+/* Host stand-in for mbed.h, for the filesystem and block device sources */
+#ifndef MBED_H
+#define MBED_H
+
+#include <time.h>
+#include "platform/platform.h"
+#include "platform/mbed_assert.h"
+#include "platform/PlatformMutex.h"
+#include "platform/SingletonPtr.h"
+
+namespace mbed {
+}
+
+using namespace mbed;
+
+#endif
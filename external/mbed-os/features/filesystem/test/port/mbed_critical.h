@@ -0,0 +1,5 @@
+/* Host stand-in for mbed_critical.h, unused by the filesystem sources */
+#ifndef MBED_CRITICAL_H
+#define MBED_CRITICAL_H
+
+#endif
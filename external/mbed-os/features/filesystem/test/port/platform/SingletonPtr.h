@@ -0,0 +1,29 @@
+/* Host stand-in for SingletonPtr, constructing the object on first use */
+#ifndef SINGLETONPTR_H
+#define SINGLETONPTR_H
+
+#include <pthread.h>
+
+extern pthread_mutex_t singleton_lock;
+
+template <class T>
+struct SingletonPtr {
+    T *get() {
+        if (!__atomic_load_n(&_ptr, __ATOMIC_ACQUIRE)) {
+            pthread_mutex_lock(&singleton_lock);
+            if (!_ptr) {
+                __atomic_store_n(&_ptr, new T, __ATOMIC_RELEASE);
+            }
+            pthread_mutex_unlock(&singleton_lock);
+        }
+        return _ptr;
+    }
+
+    T *operator->() {
+        return get();
+    }
+
+    T *_ptr;
+};
+
+#endif
@@ -0,0 +1,17 @@
+/* Host stand-in for platform.h, taking the POSIX types from the host */
+#ifndef MBED_PLATFORM_H
+#define MBED_PLATFORM_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "platform/mbed_toolchain.h"
+
+#endif
@@ -478,6 +478,29 @@
  */
 #define MBEDTLS_ECP_NIST_OPTIM
 
+/**
+ * \def MBEDTLS_ECP_CONST_COMB_TABLES
+ *
+ * Keep the precomputed points for multiplication by the secp256r1 generator
+ * in a constant table, so they can be placed in flash, instead of computing
+ * them in RAM for every newly loaded group. This speeds up key generation,
+ * ECDSA signatures and the first half of ECDSA verification, and is used even
+ * when MBEDTLS_ECP_FIXED_POINT_OPTIM is 0.
+ *
+ * Together with MBEDTLS_ECP_NIST_OPTIM and the default window sizes this is
+ * the speed profile for P-256 handshakes on small targets.
+ *
+ * Module:  library/ecp_curves.c
+ * Caller:  library/ecp.c
+ *
+ * Requires: MBEDTLS_ECP_DP_SECP256R1_ENABLED
+ *
+ * Costs about 1.6 Kbytes of ROM.
+ *
+ * Uncomment this macro to place the comb tables in ROM.
+ */
+//#define MBEDTLS_ECP_CONST_COMB_TABLES
+
 /**
  * \def MBEDTLS_ECDSA_DETERMINISTIC
  *
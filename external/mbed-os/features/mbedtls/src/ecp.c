@@ -315,6 +315,14 @@ void mbedtls_ecp_point_free( mbedtls_ecp_point *pt )
     mbedtls_mpi_free( &( pt->Z ) );
 }
 
+/*
+ * Is grp->T a constant table set by mbedtls_ecp_group_load()?
+ */
+static int ecp_group_is_static_comb_table( const mbedtls_ecp_group *grp )
+{
+    return( grp->T != NULL && grp->T_size == 0 );
+}
+
 /*
  * Unallocate (the components of) a group
  */
@@ -334,7 +342,7 @@ void mbedtls_ecp_group_free( mbedtls_ecp_group *grp )
         mbedtls_mpi_free( &grp->N );
     }
 
-    if( grp->T != NULL )
+    if( grp->T != NULL && ! ecp_group_is_static_comb_table( grp ) )
     {
         for( i = 0; i < grp->T_size; i++ )
             mbedtls_ecp_point_free( &grp->T[i] );
@@ -1337,20 +1345,22 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
      * Just adding one avoids upping the cost of the first mul too much,
      * and the memory cost too.
      */
-#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
     p_eq_g = ( mbedtls_mpi_cmp_mpi( &P->Y, &grp->G.Y ) == 0 &&
                mbedtls_mpi_cmp_mpi( &P->X, &grp->G.X ) == 0 );
+#if MBEDTLS_ECP_FIXED_POINT_OPTIM != 1
+    /* A constant table costs no RAM, so it is used anyway */
+    p_eq_g = p_eq_g && ecp_group_is_static_comb_table( grp );
+#endif
     if( p_eq_g )
         w++;
-#else
-    p_eq_g = 0;
-#endif
 
     /*
      * Make sure w is within bounds.
      * (The last test is useful only for very small curves in the test suite.)
+     * A constant table was built with the uncapped w and is used as is.
      */
-    if( w > MBEDTLS_ECP_WINDOW_SIZE )
+    if( w > MBEDTLS_ECP_WINDOW_SIZE &&
+        ! ( p_eq_g && ecp_group_is_static_comb_table( grp ) ) )
         w = MBEDTLS_ECP_WINDOW_SIZE;
     if( w >= grp->nbits )
         w = 2;
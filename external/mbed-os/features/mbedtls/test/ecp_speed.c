@@ -0,0 +1,184 @@
+/*
+ * Host benchmark of P-256 in portable C
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Times key generation, ECDSA signing and verification on a freshly loaded
+ * secp256r1 group, as a handshake does, once with the constant comb table
+ * of MBEDTLS_ECP_CONST_COMB_TABLES and once with the table dropped after
+ * loading, so the generator's points are computed at run time as without
+ * the option. Both must give the same public keys, and signatures made
+ * with either must verify with the other.
+ *
+ * Also times 256-bit multiplications, which run through the portable C
+ * MULADDC of bn_mul.h. The UMAAL variant of it only builds for ARM.
+ */
+#include "mbedtls/ecp.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/bignum.h"
+#include "host_test.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+
+#define KEYS            50
+#define MULTIPLIES      1000000
+
+// Test
+static uint32_t random_state;
+
+static int random_bytes(void *ctx, unsigned char *output, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+        output[i] = random_state >> 24;
+    }
+    return 0;
+}
+
+// Loads secp256r1, without its constant table if runtime
+static void load(mbedtls_ecp_group *grp, bool runtime)
+{
+    mbedtls_ecp_group_init(grp);
+    check(mbedtls_ecp_group_load(grp, MBEDTLS_ECP_DP_SECP256R1) == 0);
+    if (runtime) {
+        check(grp->T != NULL && grp->T_size == 0);
+        grp->T = NULL;
+    }
+}
+
+enum { KEYGEN, SIGN, VERIFY, OPS };
+
+static const char *const op_names[OPS] = {"keygen", "sign", "verify"};
+
+static mbedtls_mpi d[2][KEYS];
+static mbedtls_ecp_point Q[2][KEYS];
+static mbedtls_mpi r[2][KEYS];
+static mbedtls_mpi s[2][KEYS];
+static unsigned char hash[32];
+
+// Generates, signs with and verifies KEYS keys, each on a new group.
+// Returns us per operation
+static void run(bool runtime, double us[OPS])
+{
+    mbedtls_ecp_group grp;
+    uint64_t start;
+
+    random_state = 12345;
+    start = now_ns();
+    for (int i = 0; i < KEYS; i++) {
+        load(&grp, runtime);
+        check(mbedtls_ecp_gen_keypair(&grp, &d[runtime][i], &Q[runtime][i], random_bytes, NULL) == 0);
+        mbedtls_ecp_group_free(&grp);
+    }
+    us[KEYGEN] = (now_ns() - start) / 1000.0 / KEYS;
+
+    start = now_ns();
+    for (int i = 0; i < KEYS; i++) {
+        load(&grp, runtime);
+        check(mbedtls_ecdsa_sign(&grp, &r[runtime][i], &s[runtime][i], &d[runtime][i],
+                hash, sizeof(hash), random_bytes, NULL) == 0);
+        mbedtls_ecp_group_free(&grp);
+    }
+    us[SIGN] = (now_ns() - start) / 1000.0 / KEYS;
+
+    start = now_ns();
+    for (int i = 0; i < KEYS; i++) {
+        load(&grp, runtime);
+        check(mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &Q[runtime][i], &r[runtime][i], &s[runtime][i]) == 0);
+        mbedtls_ecp_group_free(&grp);
+    }
+    us[VERIFY] = (now_ns() - start) / 1000.0 / KEYS;
+}
+
+int main(void)
+{
+    double table[OPS];
+    double runtime[OPS];
+
+    for (int j = 0; j < 2; j++) {
+        for (int i = 0; i < KEYS; i++) {
+            mbedtls_mpi_init(&d[j][i]);
+            mbedtls_ecp_point_init(&Q[j][i]);
+            mbedtls_mpi_init(&r[j][i]);
+            mbedtls_mpi_init(&s[j][i]);
+        }
+    }
+    memset(hash, 0x5a, sizeof(hash));
+
+    run(true, runtime);
+    run(false, table);
+
+    // Same private keys from the same random numbers, so the same public
+    // keys, and signatures made with one table verify with the other
+    for (int i = 0; i < KEYS; i++) {
+        mbedtls_ecp_group grp;
+        check(mbedtls_mpi_cmp_mpi(&d[0][i], &d[1][i]) == 0);
+        check(mbedtls_ecp_point_cmp(&Q[0][i], &Q[1][i]) == 0);
+        for (int j = 0; j < 2; j++) {
+            load(&grp, j);
+            check(mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &Q[j][i], &r[!j][i], &s[!j][i]) == 0);
+            mbedtls_ecp_group_free(&grp);
+        }
+    }
+
+    // A wrong signature does not verify
+    mbedtls_ecp_group grp;
+    load(&grp, false);
+    check(mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &Q[0][0], &r[0][1], &s[0][1]) != 0);
+    mbedtls_ecp_group_free(&grp);
+
+    printf("P-256, window %d, fixed point %d, %d bit limbs\n",
+            MBEDTLS_ECP_WINDOW_SIZE, MBEDTLS_ECP_FIXED_POINT_OPTIM, (int)(8 * sizeof(mbedtls_mpi_uint)));
+    printf("%-8s %12s %12s\n", "us", "runtime", "const table");
+    for (int i = 0; i < OPS; i++) {
+        printf("%-8s %12.0f %12.0f\n", op_names[i], runtime[i], table[i]);
+    }
+
+    // The generator's multiplication dominates key generation and signing
+    check(table[KEYGEN] < runtime[KEYGEN]);
+    check(table[SIGN] < runtime[SIGN]);
+
+    // 256-bit multiplications through MULADDC
+    mbedtls_mpi A, B, X;
+    mbedtls_mpi_init(&A);
+    mbedtls_mpi_init(&B);
+    mbedtls_mpi_init(&X);
+    check(mbedtls_mpi_fill_random(&A, 32, random_bytes, NULL) == 0);
+    check(mbedtls_mpi_fill_random(&B, 32, random_bytes, NULL) == 0);
+    uint64_t start = now_ns();
+    for (int i = 0; i < MULTIPLIES; i++) {
+        mbedtls_mpi_mul_mpi(&X, &A, &B);
+    }
+    double mul_ns = (double)(now_ns() - start) / MULTIPLIES;
+    printf("256x256 bit mpi_mul %.0f ns\n", mul_ns);
+
+    // (A + 1) * B - A * B == B
+    mbedtls_mpi Y;
+    mbedtls_mpi_init(&Y);
+    check(mbedtls_mpi_add_int(&A, &A, 1) == 0);
+    check(mbedtls_mpi_mul_mpi(&Y, &A, &B) == 0);
+    check(mbedtls_mpi_sub_mpi(&Y, &Y, &X) == 0);
+    check(mbedtls_mpi_cmp_mpi(&Y, &B) == 0);
+    mbedtls_mpi_free(&A);
+    mbedtls_mpi_free(&B);
+    mbedtls_mpi_free(&X);
+    mbedtls_mpi_free(&Y);
+
+    return host_test_done();
+}
@@ -187,6 +187,7 @@ static secure_session_t *secure_session_create(internal_socket_t *parent, const
         ns_dyn_mem_free(this);
         return NULL;
     }
+    coap_security_handler_set_peer(this->sec_handler, address_ptr, port);
     this->parent = parent;
 
     this->session_state = SECURE_SESSION_HANDSHAKE_ONGOING;
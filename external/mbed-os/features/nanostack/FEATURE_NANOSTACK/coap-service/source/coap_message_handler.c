@@ -33,26 +33,158 @@ static void own_free(void *ptr)
 
 static NS_LIST_DEFINE(request_list, coap_transaction_t, link);
 
+/* Transactions are in the pointer index, client transactions also in the
+ * token index and server transactions in the message ID index. Each index
+ * starts with TRANSACTION_HASH_SIZE buckets and doubles, up to
+ * TRANSACTION_HASH_SIZE_MAX, when there are more than two transactions per
+ * bucket. */
+static coap_transaction_t *transaction_hash_static[TRANSACTION_INDEX_COUNT][TRANSACTION_HASH_SIZE];
+static coap_transaction_t **transaction_hash[TRANSACTION_INDEX_COUNT] = {
+    transaction_hash_static[TRANSACTION_INDEX_TOKEN],
+    transaction_hash_static[TRANSACTION_INDEX_MSG_ID],
+    transaction_hash_static[TRANSACTION_INDEX_PTR],
+};
+static uint16_t transaction_hash_size = TRANSACTION_HASH_SIZE;
+static uint16_t transaction_count;
+
+static uint32_t transaction_token_key(const uint8_t token[4])
+{
+    return ((uint32_t)token[0] << 24) | ((uint32_t)token[1] << 16) | ((uint32_t)token[2] << 8) | token[3];
+}
+
+static uint16_t transaction_key_bucket(uint32_t key)
+{
+    // Fibonacci hashing, the upper half of the product depends on every key bit
+    return ((uint32_t)(key * 2654435761u) >> 16) & (transaction_hash_size - 1);
+}
+
+static uint16_t transaction_bucket(transaction_index_e index, const coap_transaction_t *this)
+{
+    switch (index) {
+        case TRANSACTION_INDEX_TOKEN:
+            return transaction_key_bucket(transaction_token_key(this->token));
+        case TRANSACTION_INDEX_MSG_ID:
+            return transaction_key_bucket(this->msg_id);
+        default:
+            return transaction_key_bucket((uint32_t)((uintptr_t)this / sizeof(void *)));
+    }
+}
+
+static void transaction_index_add(transaction_index_e index, coap_transaction_t *this)
+{
+    coap_transaction_t **head_ptr = &transaction_hash[index][transaction_bucket(index, this)];
+
+    this->hash_next[index] = *head_ptr;
+    if (*head_ptr) {
+        (*head_ptr)->hash_pprev[index] = &this->hash_next[index];
+    }
+    *head_ptr = this;
+    this->hash_pprev[index] = head_ptr;
+}
+
+static void transaction_index_remove(transaction_index_e index, coap_transaction_t *this)
+{
+    if (!this->hash_pprev[index]) {
+        return;
+    }
+    *this->hash_pprev[index] = this->hash_next[index];
+    if (this->hash_next[index]) {
+        this->hash_next[index]->hash_pprev[index] = this->hash_pprev[index];
+    }
+    this->hash_pprev[index] = NULL;
+}
+
+static void transaction_hash_grow(void)
+{
+    uint16_t size = transaction_hash_size * 2;
+    coap_transaction_t **table = ns_dyn_mem_alloc(TRANSACTION_INDEX_COUNT * size * sizeof(coap_transaction_t *));
+    if (!table) {
+        // Keep chaining in the current buckets
+        return;
+    }
+    memset(table, 0, TRANSACTION_INDEX_COUNT * size * sizeof(coap_transaction_t *));
+
+    if (transaction_hash[0] != transaction_hash_static[0]) {
+        ns_dyn_mem_free(transaction_hash[0]);
+    }
+    for (int i = 0; i < TRANSACTION_INDEX_COUNT; i++) {
+        transaction_hash[i] = table + i * size;
+    }
+    transaction_hash_size = size;
+
+    // Oldest first so each bucket stays newest first, and only into the
+    // indices the transaction was in
+    ns_list_foreach_reverse(coap_transaction_t, cur_ptr, &request_list) {
+        for (int i = 0; i < TRANSACTION_INDEX_COUNT; i++) {
+            if (cur_ptr->hash_pprev[i]) {
+                transaction_index_add((transaction_index_e)i, cur_ptr);
+            }
+        }
+    }
+}
+
+static void transaction_hash_reset(void)
+{
+    if (transaction_hash[0] != transaction_hash_static[0]) {
+        ns_dyn_mem_free(transaction_hash[0]);
+    }
+    memset(transaction_hash_static, 0, sizeof(transaction_hash_static));
+    for (int i = 0; i < TRANSACTION_INDEX_COUNT; i++) {
+        transaction_hash[i] = transaction_hash_static[i];
+    }
+    transaction_hash_size = TRANSACTION_HASH_SIZE;
+    transaction_count = 0;
+}
+
+static void transaction_set_token(coap_transaction_t *this, const uint8_t token[4])
+{
+    transaction_index_remove(TRANSACTION_INDEX_TOKEN, this);
+    memcpy(this->token, token, 4);
+    if (this->client_request) {
+        transaction_index_add(TRANSACTION_INDEX_TOKEN, this);
+    }
+}
+
+static void transaction_set_msg_id(coap_transaction_t *this, uint16_t msg_id)
+{
+    transaction_index_remove(TRANSACTION_INDEX_MSG_ID, this);
+    this->msg_id = msg_id;
+    if (!this->client_request) {
+        transaction_index_add(TRANSACTION_INDEX_MSG_ID, this);
+    }
+}
+
+static void transaction_unlink(coap_transaction_t *this)
+{
+    ns_list_remove(&request_list, this);
+    for (int i = 0; i < TRANSACTION_INDEX_COUNT; i++) {
+        transaction_index_remove((transaction_index_e)i, this);
+    }
+    transaction_count--;
+}
+
 static coap_transaction_t *transaction_find_client_by_token(uint8_t token[4])
 {
-    coap_transaction_t *this = NULL;
-    ns_list_foreach(coap_transaction_t, cur_ptr, &request_list) {
-        if (memcmp(cur_ptr->token,token,4) == 0 && cur_ptr->client_request) {
-           this = cur_ptr;
+    coap_transaction_t *this = transaction_hash[TRANSACTION_INDEX_TOKEN][transaction_key_bucket(transaction_token_key(token))];
+
+    while (this) {
+        if (memcmp(this->token,token,4) == 0) {
             break;
         }
+        this = this->hash_next[TRANSACTION_INDEX_TOKEN];
     }
     return this;
 }
 
 static coap_transaction_t *transaction_find_server(uint16_t msg_id)
 {
-    coap_transaction_t *this = NULL;
-    ns_list_foreach(coap_transaction_t, cur_ptr, &request_list) {
-        if (cur_ptr->msg_id == msg_id && !cur_ptr->client_request) {
-            this = cur_ptr;
+    coap_transaction_t *this = transaction_hash[TRANSACTION_INDEX_MSG_ID][transaction_key_bucket(msg_id)];
+
+    while (this) {
+        if (this->msg_id == msg_id) {
             break;
         }
+        this = this->hash_next[TRANSACTION_INDEX_MSG_ID];
     }
     return this;
 }
@@ -76,7 +208,12 @@ static coap_transaction_t *transaction_create(void)
         memset(this, 0, sizeof(coap_transaction_t));
         this->client_request = true;// default to client initiated method
         this->create_time = coap_service_get_internal_timer_ticks();
+        if (transaction_count >= 2 * transaction_hash_size && transaction_hash_size < TRANSACTION_HASH_SIZE_MAX) {
+            transaction_hash_grow();
+        }
         ns_list_add_to_start(&request_list, this);
+        transaction_index_add(TRANSACTION_INDEX_PTR, this);
+        transaction_count++;
     }
 
     return this;
@@ -97,7 +234,7 @@ static void transaction_free(coap_transaction_t *this)
 void transaction_delete(coap_transaction_t *this)
 {
     if (this) {
-        ns_list_remove(&request_list, this);
+        transaction_unlink(this);
         transaction_free(this);
     }
 
@@ -109,7 +246,7 @@ void transactions_delete_all(uint8_t *address_ptr, uint16_t port)
     coap_transaction_t *transaction = transaction_find_by_address(address_ptr, port);
 
     while (transaction) {
-        ns_list_remove(&request_list, transaction);
+        transaction_unlink(transaction);
         if (transaction->resp_cb) {
             transaction->resp_cb(transaction->service_id, address_ptr, port, NULL);
         }
@@ -135,7 +272,7 @@ static int8_t coap_rx_function(sn_coap_hdr_s *resp_ptr, sn_nsdl_addr_s *address_
         return 0;
     }
 
-    ns_list_remove(&request_list, this);
+    transaction_unlink(this);
     if (this->resp_cb) {
         this->resp_cb(this->service_id, address_ptr->addr_ptr, address_ptr->port, NULL);
     }
@@ -182,10 +319,11 @@ int8_t coap_message_handler_destroy(coap_msg_handler_t *handle){
 
     //Destroy transactions
     ns_list_foreach_safe(coap_transaction_t, cur_ptr, &request_list) {
-        ns_list_remove(&request_list, cur_ptr);
+        transaction_unlink(cur_ptr);
         ns_dyn_mem_free(cur_ptr);
         cur_ptr = NULL;
     }
+    transaction_hash_reset();
 
     handle->sn_coap_service_free(handle);
     return 0;
@@ -193,10 +331,14 @@ int8_t coap_message_handler_destroy(coap_msg_handler_t *handle){
 
 coap_transaction_t *coap_message_handler_transaction_valid(coap_transaction_t *tr_ptr)
 {
-    ns_list_foreach(coap_transaction_t, cur_ptr, &request_list) {
+    // Only compares addresses, tr_ptr may already be freed
+    coap_transaction_t *cur_ptr = transaction_hash[TRANSACTION_INDEX_PTR][transaction_bucket(TRANSACTION_INDEX_PTR, tr_ptr)];
+
+    while (cur_ptr) {
         if (cur_ptr == tr_ptr) {
             return tr_ptr;
         }
+        cur_ptr = cur_ptr->hash_next[TRANSACTION_INDEX_PTR];
     }
     return NULL;
 }
@@ -238,8 +380,8 @@ int16_t coap_message_handler_coap_msg_process(coap_msg_handler_t *handle, int8_t
         coap_transaction_t *transaction_ptr = transaction_create();
         if (transaction_ptr) {
             transaction_ptr->service_id = coap_service_id_find_by_socket(socket_id);
-            transaction_ptr->msg_id = coap_message->msg_id;
             transaction_ptr->client_request = false;// this is server transaction
+            transaction_set_msg_id(transaction_ptr, coap_message->msg_id);
             memcpy(transaction_ptr->local_address, *(dst_addr_ptr) == 0xFF ? ns_in6addr_any : dst_addr_ptr, 16);
             memcpy(transaction_ptr->remote_address, source_addr_ptr, 16);
             transaction_ptr->remote_port = port;
@@ -266,7 +408,7 @@ int16_t coap_message_handler_coap_msg_process(coap_msg_handler_t *handle, int8_t
             return -1;
         }
         tr_debug("Service %d, response received", this->service_id);
-        ns_list_remove(&request_list, this);
+        transaction_unlink(this);
         if (this->resp_cb) {
             this->resp_cb(this->service_id, (uint8_t *)source_addr_ptr, port, coap_message);
         }
@@ -317,7 +459,7 @@ uint16_t coap_message_handler_request_send(coap_msg_handler_t *handle, int8_t se
     do{
         randLIB_get_n_bytes_random(token,4);
     }while(transaction_find_client_by_token(token));
-    memcpy(transaction_ptr->token,token,4);
+    transaction_set_token(transaction_ptr, token);
     request.token_ptr = transaction_ptr->token;
     request.token_len = 4;
 
@@ -330,7 +472,7 @@ uint16_t coap_message_handler_request_send(coap_msg_handler_t *handle, int8_t se
         return 0;
     }
     sn_coap_protocol_build(handle->coap, &dst_addr, data_ptr, &request, transaction_ptr);
-    transaction_ptr->msg_id = request.msg_id;
+    transaction_set_msg_id(transaction_ptr, request.msg_id);
     handle->sn_coap_tx_callback(data_ptr, data_len, &dst_addr, transaction_ptr);
 
     // Free allocated data
@@ -397,11 +539,12 @@ int8_t coap_message_handler_exec(coap_msg_handler_t *handle, uint32_t current_ti
         return -1;
     }
 
-    // Remove outdated transactions from queue
-    ns_list_foreach_safe(coap_transaction_t, transaction, &request_list) {
-        if ((transaction->create_time + TRANSACTION_LIFETIME) < current_time) {
-            transaction_delete(transaction);
-        }
+    // Remove outdated transactions from queue. All have the same lifetime and
+    // new ones are added to the start, so the oldest are at the end.
+    coap_transaction_t *transaction;
+    while ((transaction = ns_list_get_last(&request_list)) != NULL &&
+            (transaction->create_time + TRANSACTION_LIFETIME) < current_time) {
+        transaction_delete(transaction);
     }
 
     return sn_coap_protocol_exec(handle->coap, current_time);
@@ -18,12 +18,28 @@
 #include "mbedtls/entropy_poll.h"
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/ssl_ciphersuites.h"
+#include "mbedtls/ssl_ticket.h"
 
 #include "ns_trace.h"
+#include "ns_list.h"
 #include "nsdynmemLIB.h"
 #include "coap_connection_handler.h"
 #include "randLIB.h"
 
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_SHA256_C) && COAP_SECURITY_SESSION_CACHE_SIZE > 0
+#define COAP_SECURITY_SESSION_CACHE
+#endif
+
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_SESSION_TICKETS) && \
+    defined(MBEDTLS_SSL_TICKET_C) && defined(MBEDTLS_SHA256_C) && COAP_SECURITY_SESSION_TICKET_LIFETIME > 0
+#define COAP_SECURITY_SESSION_TICKETS
+#endif
+
+#if defined(COAP_SECURITY_SESSION_CACHE) || defined(COAP_SECURITY_SESSION_TICKETS)
+#define KEY_ID_LEN 32
+typedef struct ticket_keys ticket_keys_t;
+#endif
+
 struct coap_security_s {
     mbedtls_ssl_config          _conf;
     mbedtls_ssl_context         _ssl;
@@ -45,8 +61,18 @@ struct coap_security_s {
     uint8_t                     _pw_len;
 
     bool                        _is_blocking;
+    bool                        _is_server;
+    bool                        _has_peer;
+    uint8_t                     _peer_address[16];
+    uint16_t                    _peer_port;
     int8_t                      _socket_id;
     int8_t                      _timer_id;
+#ifdef KEY_ID_LEN
+    uint8_t                     _key_id[KEY_ID_LEN];
+#endif
+#ifdef COAP_SECURITY_SESSION_TICKETS
+    ticket_keys_t               *_ticket_keys;
+#endif
     void                        *_handle;
     send_cb                     *_send_cb;
     receive_cb                  *_receive_cb;
@@ -73,6 +99,9 @@ static const int PSK_SUITES[] = {
 static void set_timer( void *sec_obj, uint32_t int_ms, uint32_t fin_ms );
 static int get_timer( void *sec_obj );
 static int coap_security_handler_configure_keys( coap_security_t *sec, coap_security_keys_t keys );
+#ifdef COAP_SECURITY_SESSION_TICKETS
+static void ticket_keys_release(ticket_keys_t *keys);
+#endif
 
 int entropy_poll( void *data, unsigned char *output, size_t len, size_t *olen );
 
@@ -178,11 +207,25 @@ coap_security_t *coap_security_create(int8_t socket_id, int8_t timer_id, void *h
 void coap_security_destroy(coap_security_t *sec){
     if( sec ){
         coap_security_handler_reset(sec);
+#ifdef COAP_SECURITY_SESSION_TICKETS
+        if( sec->_ticket_keys ){
+            ticket_keys_release(sec->_ticket_keys);
+        }
+#endif
         ns_dyn_mem_free(sec);
         sec = NULL;
     }
 }
 
+void coap_security_handler_set_peer(coap_security_t *sec, const uint8_t address[static 16], uint16_t port)
+{
+    if( sec ){
+        memcpy(sec->_peer_address, address, 16);
+        sec->_peer_port = port;
+        sec->_has_peer = true;
+    }
+}
+
 /**** Random number functions ****/
 
 /**
@@ -253,6 +296,200 @@ static int simple_cookie_check(void *ctx,
     return 0;
 }
 
+/**** Session resumption functions ****/
+#ifdef KEY_ID_LEN
+/* Hash of the credential a session is authenticated with. Resumed sessions
+ * skip authentication, so they are only valid under the same credential */
+static void key_id_compute(coap_security_t *sec, const coap_security_keys_t *keys)
+{
+    const unsigned char *part[3] = {keys->_server_cert, keys->_pub_cert_or_identifier, keys->_priv};
+    const uint8_t part_len[3] = {keys->_server_cert_len, keys->_pub_len, keys->_priv_len};
+    const uint8_t mode = sec->_conn_mode;
+    mbedtls_sha256_context ctx;
+
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, &mode, 1);
+    for (int i = 0; i < 3; i++) {
+        mbedtls_sha256_update(&ctx, &part_len[i], 1);
+        if (part_len[i]) {
+            mbedtls_sha256_update(&ctx, part[i], part_len[i]);
+        }
+    }
+    mbedtls_sha256_finish(&ctx, sec->_key_id);
+    mbedtls_sha256_free(&ctx);
+}
+#endif
+
+#ifdef COAP_SECURITY_SESSION_CACHE
+/* Sessions of completed client handshakes, resumed with an abbreviated
+ * handshake when the same peer is connected to again with the same
+ * credential */
+typedef struct session_cache_entry {
+    mbedtls_ssl_session session;
+    uint8_t             key_id[KEY_ID_LEN];
+    uint8_t             address[16];
+    uint16_t            port;
+    int8_t              socket_id;
+    uint32_t            last_used;
+} session_cache_entry_t;
+
+static session_cache_entry_t *session_cache[COAP_SECURITY_SESSION_CACHE_SIZE];
+static uint32_t session_cache_time;
+
+static session_cache_entry_t **session_cache_find(const coap_security_t *sec)
+{
+    for (int i = 0; i < COAP_SECURITY_SESSION_CACHE_SIZE; i++) {
+        session_cache_entry_t *entry = session_cache[i];
+        if (entry && entry->socket_id == sec->_socket_id && entry->port == sec->_peer_port &&
+                memcmp(entry->address, sec->_peer_address, 16) == 0) {
+            return &session_cache[i];
+        }
+    }
+    return NULL;
+}
+
+static void session_cache_remove(session_cache_entry_t **slot)
+{
+    mbedtls_ssl_session_free(&(*slot)->session);
+    ns_dyn_mem_free(*slot);
+    *slot = NULL;
+}
+
+static void session_cache_save(const coap_security_t *sec)
+{
+    session_cache_entry_t **slot = session_cache_find(sec);
+
+    if (!slot) {
+        // Take a free slot, or replace the least recently used session
+        slot = &session_cache[0];
+        for (int i = 1; i < COAP_SECURITY_SESSION_CACHE_SIZE && *slot; i++) {
+            if (!session_cache[i] || session_cache[i]->last_used < (*slot)->last_used) {
+                slot = &session_cache[i];
+            }
+        }
+    }
+    if (*slot) {
+        session_cache_remove(slot);
+    }
+
+    session_cache_entry_t *entry = ns_dyn_mem_alloc(sizeof(session_cache_entry_t));
+    if (!entry) {
+        return;
+    }
+    mbedtls_ssl_session_init(&entry->session);
+    if (mbedtls_ssl_get_session(&sec->_ssl, &entry->session) != 0) {
+        mbedtls_ssl_session_free(&entry->session);
+        ns_dyn_mem_free(entry);
+        return;
+    }
+    memcpy(entry->key_id, sec->_key_id, KEY_ID_LEN);
+    memcpy(entry->address, sec->_peer_address, 16);
+    entry->port = sec->_peer_port;
+    entry->socket_id = sec->_socket_id;
+    entry->last_used = ++session_cache_time;
+    *slot = entry;
+}
+
+static void session_cache_resume(coap_security_t *sec)
+{
+    // Sessions of a credential the socket no longer uses must not be resumed
+    for (int i = 0; i < COAP_SECURITY_SESSION_CACHE_SIZE; i++) {
+        session_cache_entry_t *entry = session_cache[i];
+        if (entry && entry->socket_id == sec->_socket_id &&
+                memcmp(entry->key_id, sec->_key_id, KEY_ID_LEN) != 0) {
+            session_cache_remove(&session_cache[i]);
+        }
+    }
+
+    session_cache_entry_t **slot = session_cache_find(sec);
+
+    if (slot) {
+        // The server falls back to a full handshake if it no longer knows the session
+        if (mbedtls_ssl_set_session(&sec->_ssl, &(*slot)->session) == 0) {
+            (*slot)->last_used = ++session_cache_time;
+        } else {
+            session_cache_remove(slot);
+        }
+    }
+}
+
+static void session_cache_forget(const coap_security_t *sec)
+{
+    session_cache_entry_t **slot = session_cache_find(sec);
+
+    if (slot) {
+        session_cache_remove(slot);
+    }
+}
+#endif
+
+#ifdef COAP_SECURITY_SESSION_TICKETS
+/* Ticket keys of a server socket. A ticket only resumes sessions on the
+ * socket that issued it and under the credential it was issued with. Keys
+ * of a replaced credential are retired and freed once no session uses them */
+struct ticket_keys {
+    mbedtls_ssl_ticket_context  ctx;
+    uint8_t                     key_id[KEY_ID_LEN];
+    int8_t                      socket_id;
+    bool                        retired;
+    uint16_t                    users;
+    ns_list_link_t              link;
+};
+
+static NS_LIST_DEFINE(ticket_keys_list, ticket_keys_t, link);
+
+static void ticket_keys_free(ticket_keys_t *keys)
+{
+    ns_list_remove(&ticket_keys_list, keys);
+    mbedtls_ssl_ticket_free(&keys->ctx);
+    ns_dyn_mem_free(keys);
+}
+
+static ticket_keys_t *ticket_keys_get(const coap_security_t *sec)
+{
+    ns_list_foreach(ticket_keys_t, cur_ptr, &ticket_keys_list) {
+        if (cur_ptr->retired || cur_ptr->socket_id != sec->_socket_id) {
+            continue;
+        }
+        if (memcmp(cur_ptr->key_id, sec->_key_id, KEY_ID_LEN) == 0) {
+            cur_ptr->users++;
+            return cur_ptr;
+        }
+        cur_ptr->retired = true;
+        if (!cur_ptr->users) {
+            ticket_keys_free(cur_ptr);
+        }
+        break;
+    }
+
+    ticket_keys_t *keys = ns_dyn_mem_alloc(sizeof(ticket_keys_t));
+    if (!keys) {
+        return NULL;
+    }
+    mbedtls_ssl_ticket_init(&keys->ctx);
+    if (mbedtls_ssl_ticket_setup(&keys->ctx, get_random, NULL, MBEDTLS_CIPHER_AES_128_CCM,
+                                 COAP_SECURITY_SESSION_TICKET_LIFETIME) != 0) {
+        mbedtls_ssl_ticket_free(&keys->ctx);
+        ns_dyn_mem_free(keys);
+        return NULL;
+    }
+    memcpy(keys->key_id, sec->_key_id, KEY_ID_LEN);
+    keys->socket_id = sec->_socket_id;
+    keys->retired = false;
+    keys->users = 1;
+    ns_list_add_to_end(&ticket_keys_list, keys);
+    return keys;
+}
+
+static void ticket_keys_release(ticket_keys_t *keys)
+{
+    if (--keys->users == 0 && keys->retired) {
+        ticket_keys_free(keys);
+    }
+}
+#endif
+
 /**** Key export function ****/
 #if defined(MBEDTLS_KEY_EXCHANGE_ECJPAKE_ENABLED)
 static int export_key_block(void *ctx,
@@ -416,6 +653,7 @@ int coap_security_handler_connect_non_blocking(coap_security_t *sec, bool is_ser
         return -1;
     }
     sec->_is_blocking = false;
+    sec->_is_server = is_server;
 
     int endpoint = MBEDTLS_SSL_IS_CLIENT;
     if( is_server ){
@@ -443,11 +681,31 @@ int coap_security_handler_connect_non_blocking(coap_security_t *sec, bool is_ser
 
     mbedtls_ssl_conf_rng( &sec->_conf, mbedtls_ctr_drbg_random, &sec->_ctr_drbg );
 
+#ifdef KEY_ID_LEN
+    key_id_compute(sec, &keys);
+#endif
+
+#ifdef COAP_SECURITY_SESSION_TICKETS
+    if( is_server && !sec->_ticket_keys ){
+        sec->_ticket_keys = ticket_keys_get(sec);
+    }
+    if( sec->_ticket_keys ){
+        mbedtls_ssl_conf_session_tickets_cb( &sec->_conf, mbedtls_ssl_ticket_write,
+                                             mbedtls_ssl_ticket_parse, &sec->_ticket_keys->ctx );
+    }
+#endif
+
     if( ( mbedtls_ssl_setup( &sec->_ssl, &sec->_conf ) ) != 0 )
     {
        return -1;
     }
 
+#ifdef COAP_SECURITY_SESSION_CACHE
+    if( !is_server && sec->_has_peer ){
+        session_cache_resume(sec);
+    }
+#endif
+
     mbedtls_ssl_set_bio( &sec->_ssl, sec,
                         f_send, f_recv, NULL );
 
@@ -510,10 +768,21 @@ int coap_security_handler_continue_connecting(coap_security_t *sec){
             return 1;
         }
         else if(ret && (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)){
+#ifdef COAP_SECURITY_SESSION_CACHE
+            // Do not retry resuming a session the peer failed on, but keep it over timeouts
+            if( !sec->_is_server && sec->_has_peer && ret != MBEDTLS_ERR_SSL_TIMEOUT ){
+                session_cache_forget(sec);
+            }
+#endif
             return ret;
         }
 
         if( sec->_ssl.state == MBEDTLS_SSL_HANDSHAKE_OVER ){
+#ifdef COAP_SECURITY_SESSION_CACHE
+            if( !sec->_is_server && sec->_has_peer ){
+                session_cache_save(sec);
+            }
+#endif
             return 0;
         }
     }
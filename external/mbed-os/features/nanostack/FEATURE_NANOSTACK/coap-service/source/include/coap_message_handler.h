@@ -25,6 +25,26 @@
 
 #define TRANSACTION_LIFETIME 180
 
+/* Initial number of buckets in each transaction index, must be a power of two */
+#ifndef TRANSACTION_HASH_SIZE
+#define TRANSACTION_HASH_SIZE 16
+#endif
+
+/* Number of buckets the indices may grow to as transactions are added, must
+ * be a power of two. The grown table is one allocation of
+ * TRANSACTION_INDEX_COUNT pointers per bucket. */
+#ifndef TRANSACTION_HASH_SIZE_MAX
+#define TRANSACTION_HASH_SIZE_MAX 1024
+#endif
+
+/* Hashed indices of the transaction list */
+typedef enum {
+    TRANSACTION_INDEX_TOKEN,    /* Client transactions by token, for matching responses */
+    TRANSACTION_INDEX_MSG_ID,   /* Server transactions by message ID, for sending responses */
+    TRANSACTION_INDEX_PTR,      /* By transaction address, for validating stored pointers */
+    TRANSACTION_INDEX_COUNT
+} transaction_index_e;
+
 /**
  * \brief Service message response receive callback.
  *
@@ -61,6 +81,8 @@ typedef struct coap_transaction {
 
     coap_message_handler_response_recv *resp_cb;
     ns_list_link_t link;
+    struct coap_transaction *hash_next[TRANSACTION_INDEX_COUNT];
+    struct coap_transaction **hash_pprev[TRANSACTION_INDEX_COUNT];
 } coap_transaction_t;
 
 
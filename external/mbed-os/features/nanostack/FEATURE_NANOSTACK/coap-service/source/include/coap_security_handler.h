@@ -46,6 +46,19 @@ typedef int timer_status_cb(int8_t timer_id);
 #define DTLS_HANDSHAKE_TIMEOUT_MIN 25000
 #define DTLS_HANDSHAKE_TIMEOUT_MAX 201000
 
+/* Number of client sessions kept for resuming handshakes with the same peer, 0 disables */
+#ifndef COAP_SECURITY_SESSION_CACHE_SIZE
+#define COAP_SECURITY_SESSION_CACHE_SIZE 4
+#endif
+
+/* Lifetime in seconds of session tickets issued by servers, 0 disables.
+ * A day by default, as in the mbedtls example server. Can be overridden
+ * from the "macros" of mbed_app.json. Only enforced when MBEDTLS_HAVE_TIME
+ * is defined */
+#ifndef COAP_SECURITY_SESSION_TICKET_LIFETIME
+#define COAP_SECURITY_SESSION_TICKET_LIFETIME 86400
+#endif
+
 typedef enum {
     DTLS = 0,
     TLS = 1
@@ -79,6 +92,8 @@ coap_security_t *coap_security_create(int8_t socket_id, int8_t timer_id, void *h
 
 void coap_security_destroy(coap_security_t *sec);
 
+void coap_security_handler_set_peer(coap_security_t *sec, const uint8_t address[static 16], uint16_t port);
+
 int coap_security_handler_connect(coap_security_t *sec, bool is_server, SecureSocketMode sock_mode, coap_security_keys_t keys);
 
 int coap_security_handler_connect_non_blocking(coap_security_t *sec, bool is_server, SecureSocketMode sock_mode, coap_security_keys_t keys, uint32_t timeout_min, uint32_t timeout_max);
@@ -108,6 +123,7 @@ NS_DUMMY_DEFINITIONS_OK
 #define coap_security_create(socket_id, timer_id, handle, \
                              mode, send_cb, receive_cb, start_timer_cb, timer_status_cb) ((coap_security_t *) 0)
 #define coap_security_destroy(sec) ((void) 0)
+#define coap_security_handler_set_peer(sec, address, port) ((void) 0)
 #define coap_security_handler_connect(sec, is_server, sock_mode, keys) (-1)
 #define coap_security_handler_connect_non_blocking(sec, is_server, sock_mode, keys, timeout_min, timeout_max) (-1)
 #define coap_security_handler_continue_connecting(sec) (-1)
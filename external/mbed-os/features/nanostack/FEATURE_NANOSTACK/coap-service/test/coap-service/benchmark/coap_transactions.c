@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2017 ARM Limited. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Puts 1000 client and 1000 server transactions in flight in the message
+ * handler, then answers every server request, matches a response to every
+ * client request by token and expires what is left. Each step is timed per
+ * transaction and compared with the same steps for 16 transactions, where
+ * the indices have one transaction per bucket or less.
+ *
+ * The CoAP protocol, builder and parser are replaced by stand-ins that
+ * assign message IDs and hand back prepared headers, so only the handler's
+ * own bookkeeping is measured.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ns_types.h"
+#include "nsdynmemLIB.h"
+#include "randLIB.h"
+#include "socket_api.h"
+#include "mbed-coap/sn_coap_protocol.h"
+#include "coap_service_api_internal.h"
+#include "coap_message_handler.h"
+#include "host_test.h"
+
+#define TRANSACTIONS    1000
+#define SMALL           16
+#define OPERATIONS      2000000
+
+
+
+// Stand-ins for the rest of the service and the CoAP library
+coap_msg_handler_t *coap_service_handle;
+const uint8_t ns_in6addr_any[16];
+static unsigned index_allocs;
+
+void *ns_dyn_mem_alloc(ns_mem_block_size_t alloc_size)
+{
+    // Everything bigger than a transaction is a grown index table
+    if (alloc_size > sizeof(coap_transaction_t)) {
+        index_allocs++;
+    }
+    return malloc(alloc_size);
+}
+
+void *ns_dyn_mem_temporary_alloc(ns_mem_block_size_t alloc_size)
+{
+    return malloc(alloc_size);
+}
+
+void ns_dyn_mem_free(void *block)
+{
+    free(block);
+}
+
+void *randLIB_get_n_bytes_random(void *data_ptr, uint8_t count)
+{
+    static uint32_t state = 2463534242u;
+    uint8_t *ptr = data_ptr;
+    while (count--) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        *ptr++ = state >> 24;
+    }
+    return data_ptr;
+}
+
+uint32_t coap_service_get_internal_timer_ticks(void)
+{
+    return 1;
+}
+
+uint16_t coap_service_id_find_by_socket(int8_t socket_id)
+{
+    return 1;
+}
+
+static char coap_stand_in;
+static uint16_t next_msg_id;
+static sn_coap_hdr_s parsed;
+static sn_coap_hdr_s response;
+
+struct coap_s *sn_coap_protocol_init(void *(*used_malloc_func_ptr)(uint16_t), void (*used_free_func_ptr)(void *),
+                                     uint8_t (*used_tx_callback_ptr)(uint8_t *, uint16_t, sn_nsdl_addr_s *, void *),
+                                     int8_t (*used_rx_callback_ptr)(sn_coap_hdr_s *, sn_nsdl_addr_s *, void *param))
+{
+    return (struct coap_s *)&coap_stand_in;
+}
+
+int8_t sn_coap_protocol_destroy(struct coap_s *handle)
+{
+    return 0;
+}
+
+int16_t sn_coap_protocol_build(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, void *param)
+{
+    src_coap_msg_ptr->msg_id = ++next_msg_id;
+    return 0;
+}
+
+sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t packet_data_len, uint8_t *packet_data_ptr, void *param)
+{
+    return &parsed;
+}
+
+int8_t sn_coap_protocol_exec(struct coap_s *handle, uint32_t current_time)
+{
+    return 0;
+}
+
+int8_t sn_coap_protocol_delete_retransmission(struct coap_s *handle, uint16_t msg_id)
+{
+    return 0;
+}
+
+uint16_t sn_coap_builder_calc_needed_packet_data_size(sn_coap_hdr_s *src_coap_msg_ptr)
+{
+    return 16;
+}
+
+sn_coap_hdr_s *sn_coap_build_response(struct coap_s *handle, sn_coap_hdr_s *coap_packet_ptr, uint8_t msg_code)
+{
+    return &response;
+}
+
+void sn_coap_parser_release_allocated_coap_msg_mem(struct coap_s *handle, sn_coap_hdr_s *freed_coap_msg_ptr)
+{
+}
+
+
+// Test
+static void *own_alloc(uint16_t size)
+{
+    return malloc(size);
+}
+
+static void own_free(void *ptr)
+{
+    free(ptr);
+}
+
+static coap_transaction_t *sent;
+
+static uint8_t tx_function(uint8_t *data_ptr, uint16_t data_len, sn_nsdl_addr_s *address_ptr, void *param)
+{
+    sent = param;
+    return 0;
+}
+
+static unsigned responses;
+
+static int response_cb(int8_t service_id, uint8_t source_address[static 16], uint16_t source_port, sn_coap_hdr_s *response_ptr)
+{
+    responses++;
+    return 0;
+}
+
+static int16_t request_cb(int8_t socket_id, sn_coap_hdr_s *request_ptr, coap_transaction_t *transaction_ptr)
+{
+    return 0;
+}
+
+enum { SEND, VALID, REQUEST, RESPOND, MATCH, EXPIRE, STEPS };
+
+static const char *const step_names[STEPS] = {
+    "request_send", "transaction_valid", "request received", "response_send", "response matched", "expired",
+};
+
+static coap_transaction_t *clients[TRANSACTIONS];
+static uint8_t tokens[TRANSACTIONS][4];
+
+// Runs count client and count server transactions through every step,
+// adding the time of each step to times
+static void run(coap_msg_handler_t *handle, int count, uint64_t times[STEPS])
+{
+    uint8_t address[16] = {0xfd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+    uint8_t packet[16] = {0};
+    sn_coap_hdr_s request;
+    bool ok = true;
+    uint64_t start;
+
+    responses = 0;
+
+    start = now_ns();
+    for (int i = 0; i < count; i++) {
+        coap_message_handler_request_send(handle, 1, 0, address, 5683, COAP_MSG_TYPE_CONFIRMABLE,
+                COAP_MSG_CODE_REQUEST_GET, "rs", COAP_CT_NONE, NULL, 0, response_cb);
+        clients[i] = sent;
+    }
+    times[SEND] += now_ns() - start;
+
+    for (int i = 0; i < count; i++) {
+        memcpy(tokens[i], clients[i]->token, 4);
+    }
+
+    memset(&parsed, 0, sizeof(parsed));
+    parsed.coap_status = COAP_STATUS_OK;
+    parsed.msg_code = COAP_MSG_CODE_REQUEST_GET;
+    start = now_ns();
+    for (int i = 0; i < count; i++) {
+        parsed.msg_id = 0x8000 + i;
+        ok &= coap_message_handler_coap_msg_process(handle, 0, address, 5683, address, packet, sizeof(packet), request_cb) == 0;
+    }
+    times[REQUEST] += now_ns() - start;
+
+    start = now_ns();
+    for (int i = 0; i < count; i++) {
+        ok &= coap_message_handler_transaction_valid(clients[i]) == clients[i];
+    }
+    times[VALID] += now_ns() - start;
+
+    memset(&request, 0, sizeof(request));
+    start = now_ns();
+    for (int i = 0; i < count; i++) {
+        request.msg_id = 0x8000 + i;
+        ok &= coap_message_handler_response_send(handle, 1, 0, &request, COAP_MSG_CODE_RESPONSE_CONTENT, COAP_CT_NONE, NULL, 0) == 0;
+    }
+    times[RESPOND] += now_ns() - start;
+
+    memset(&parsed, 0, sizeof(parsed));
+    parsed.coap_status = COAP_STATUS_OK;
+    parsed.msg_code = COAP_MSG_CODE_RESPONSE_CONTENT;
+    parsed.token_len = 4;
+    start = now_ns();
+    for (int i = 0; i < count; i++) {
+        parsed.token_ptr = tokens[i];
+        ok &= coap_message_handler_coap_msg_process(handle, 0, address, 5683, address, packet, sizeof(packet), request_cb) == 0;
+    }
+    times[MATCH] += now_ns() - start;
+
+    // The server transactions are left for expiry
+    start = now_ns();
+    coap_message_handler_exec(handle, 2 + TRANSACTION_LIFETIME);
+    times[EXPIRE] += now_ns() - start;
+
+    for (int i = 0; i < count; i++) {
+        ok &= coap_message_handler_transaction_valid(clients[i]) == NULL;
+    }
+    ok &= coap_message_handler_find_transaction(address, 5683) == NULL;
+    check(ok);
+    check(responses == count);
+}
+
+// Nanoseconds per transaction for each step with count transactions in flight
+static void measure(int count, double ns[STEPS])
+{
+    coap_msg_handler_t *handle = coap_message_handler_init(own_alloc, own_free, tx_function);
+    uint64_t times[STEPS] = {0};
+    int rounds = OPERATIONS / count;
+
+    // Once to grow the indices
+    run(handle, count, times);
+    memset(times, 0, sizeof(times));
+    for (int i = 0; i < rounds; i++) {
+        run(handle, count, times);
+    }
+    for (int i = 0; i < STEPS; i++) {
+        ns[i] = (double)times[i] / ((uint64_t)rounds * count);
+    }
+    coap_message_handler_destroy(handle);
+}
+
+int main(void)
+{
+    double small[STEPS];
+    double large[STEPS];
+
+    measure(SMALL, small);
+    index_allocs = 0;
+    measure(TRANSACTIONS, large);
+
+    printf("index size %d to %d, grown %u times for %d transactions\n",
+            TRANSACTION_HASH_SIZE, TRANSACTION_HASH_SIZE_MAX, index_allocs, TRANSACTIONS);
+    printf("%-20s %10s %10s\n", "ns per transaction", "16", "1000");
+    for (int i = 0; i < STEPS; i++) {
+        printf("%-20s %10.1f %10.1f\n", step_names[i], small[i], large[i]);
+    }
+
+#if TRANSACTION_HASH_SIZE_MAX > TRANSACTION_HASH_SIZE
+    // Lookups stay within a small factor of their cost with a handful of
+    // transactions, rather than growing with the number in flight
+    check(large[VALID] < 4 * small[VALID] + 20);
+    check(large[RESPOND] < 4 * small[RESPOND] + 20);
+    check(large[MATCH] < 4 * small[MATCH] + 20);
+#endif
+
+    return host_test_done();
+}
@@ -50,3 +50,13 @@ TEST(coap_message_handler, test_coap_message_handler_exec)
     CHECK(test_coap_message_handler_exec());
 }
 
+TEST(coap_message_handler, test_coap_message_handler_transaction_expiry)
+{
+    CHECK(test_coap_message_handler_transaction_expiry());
+}
+
+TEST(coap_message_handler, test_coap_message_handler_transaction_index)
+{
+    CHECK(test_coap_message_handler_transaction_index());
+}
+
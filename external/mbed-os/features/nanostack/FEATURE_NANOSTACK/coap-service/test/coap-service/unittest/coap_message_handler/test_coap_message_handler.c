@@ -255,12 +255,22 @@ bool test_coap_message_handler_response_send()
     if( 2 != coap_message_handler_request_send(handle, 3, 0, buf, 24, 1, 2, &uri, 4, NULL, 0, &resp_recv))
         return false;
 
+    // Client transactions are not found by message ID
     header->msg_id = 2;
+    if( -2 != coap_message_handler_response_send(handle, 2, 0, header, 1,3,NULL, 0))
+        return false;
+
+    sn_coap_protocol_stub.expectedHeader = (sn_coap_hdr_s *)malloc(sizeof(sn_coap_hdr_s));
+    memset(sn_coap_protocol_stub.expectedHeader, 0, sizeof(sn_coap_hdr_s));
+    sn_coap_protocol_stub.expectedHeader->coap_status = COAP_STATUS_OK;
+    sn_coap_protocol_stub.expectedHeader->msg_code = 1;
+    sn_coap_protocol_stub.expectedHeader->msg_id = 2;
+    nsdynmemlib_stub.returnCounter = 1;
+    retValue = 0;
+    if( 0 != coap_message_handler_coap_msg_process(handle, 0, buf, 22, ns_in6addr_any, NULL, 0, process_cb))
+        return false;
+
     sn_coap_builder_stub.expectedUint16 = 2;
-    coap_transaction_t * tx = coap_message_handler_find_transaction(&buf, 24);
-    if( tx ){
-        tx->client_request = false;
-    }
     sn_coap_builder_stub.expectedHeader = NULL;
     if( -1 != coap_message_handler_response_send(handle, 2, 0, header, 1,3,NULL, 0))
         return false;
@@ -300,3 +310,135 @@ bool test_coap_message_handler_exec()
     coap_message_handler_destroy(handle);
     return true;
 }
+
+bool test_coap_message_handler_transaction_expiry()
+{
+    retCounter = 1;
+    sn_coap_protocol_stub.expectedCoap = (struct coap_s*)malloc(sizeof(struct coap_s));
+    memset(sn_coap_protocol_stub.expectedCoap, 0, sizeof(struct coap_s));
+    coap_msg_handler_t *handle = coap_message_handler_init(&own_alloc, &own_free, &coap_tx_function);
+
+    uint8_t buf[16];
+    memset(&buf, 1, 16);
+    char uri[3] = "rs";
+    coap_transaction_t *tx[20];
+    for (int i = 0; i < 20; i++) {
+        buf[15] = i;
+        sn_coap_builder_stub.expectedUint16 = 1;
+        nsdynmemlib_stub.returnCounter = 3;
+        if( 2 != coap_message_handler_request_send(handle, 3, 0, buf, 24, 1, 2, &uri, 4, NULL, 0, &resp_recv))
+            return false;
+        tx[i] = coap_message_handler_find_transaction(&buf, 24);
+        if( !tx[i] || tx[i] != coap_message_handler_transaction_valid(tx[i]))
+            return false;
+    }
+
+    // Created at tick 1, not yet past the lifetime
+    if( 0 != coap_message_handler_exec(handle, 1 + TRANSACTION_LIFETIME))
+        return false;
+    for (int i = 0; i < 20; i++) {
+        if( tx[i] != coap_message_handler_transaction_valid(tx[i]))
+            return false;
+    }
+
+    if( 0 != coap_message_handler_exec(handle, 2 + TRANSACTION_LIFETIME))
+        return false;
+    for (int i = 0; i < 20; i++) {
+        buf[15] = i;
+        if( coap_message_handler_find_transaction(&buf, 24))
+            return false;
+        if( coap_message_handler_transaction_valid(tx[i]))
+            return false;
+    }
+
+    free(sn_coap_protocol_stub.expectedCoap);
+    sn_coap_protocol_stub.expectedCoap = NULL;
+    coap_message_handler_destroy(handle);
+    return true;
+}
+
+bool test_coap_message_handler_transaction_index()
+{
+    retCounter = 1;
+    sn_coap_protocol_stub.expectedCoap = (struct coap_s*)malloc(sizeof(struct coap_s));
+    memset(sn_coap_protocol_stub.expectedCoap, 0, sizeof(struct coap_s));
+    coap_msg_handler_t *handle = coap_message_handler_init(&own_alloc, &own_free, &coap_tx_function);
+
+    // Enough transactions to grow the indices a few times
+    enum { COUNT = 8 * TRANSACTION_HASH_SIZE };
+    uint8_t buf[16];
+    memset(&buf, 1, 16);
+    char uri[3] = "rs";
+    coap_transaction_t *tx[COUNT];
+    uint8_t token[COUNT][4];
+    for (int i = 0; i < COUNT; i++) {
+        buf[14] = 0;
+        buf[15] = i;
+        sn_coap_builder_stub.expectedUint16 = 1;
+        nsdynmemlib_stub.returnCounter = 4;
+        if( 2 != coap_message_handler_request_send(handle, 3, 0, buf, 24, 1, 2, &uri, 4, NULL, 0, &resp_recv))
+            return false;
+        tx[i] = coap_message_handler_find_transaction(&buf, 24);
+        if( !tx[i] )
+            return false;
+        memcpy(token[i], tx[i]->token, 4);
+    }
+
+    for (int i = 0; i < COUNT; i++) {
+        buf[14] = 1;
+        buf[15] = i;
+        sn_coap_protocol_stub.expectedHeader = (sn_coap_hdr_s *)malloc(sizeof(sn_coap_hdr_s));
+        memset(sn_coap_protocol_stub.expectedHeader, 0, sizeof(sn_coap_hdr_s));
+        sn_coap_protocol_stub.expectedHeader->coap_status = COAP_STATUS_OK;
+        sn_coap_protocol_stub.expectedHeader->msg_code = 1;
+        sn_coap_protocol_stub.expectedHeader->msg_id = 1000 + i;
+        nsdynmemlib_stub.returnCounter = 2;
+        retValue = 0;
+        if( 0 != coap_message_handler_coap_msg_process(handle, 0, buf, 22, ns_in6addr_any, NULL, 0, process_cb))
+            return false;
+    }
+
+    for (int i = 0; i < COUNT; i++) {
+        if( tx[i] != coap_message_handler_transaction_valid(tx[i]))
+            return false;
+    }
+
+    // Every server transaction is found by its message ID, the clients
+    // all share message ID 2 and are not found by it
+    sn_coap_hdr_s *header = (sn_coap_hdr_s *)malloc(sizeof(sn_coap_hdr_s));
+    memset(header, 0, sizeof(sn_coap_hdr_s));
+    header->msg_id = 2;
+    if( -2 != coap_message_handler_response_send(handle, 2, 0, header, 1,3,NULL, 0))
+        return false;
+    free(header);
+    for (int i = 0; i < COUNT; i++) {
+        header = (sn_coap_hdr_s *)malloc(sizeof(sn_coap_hdr_s));
+        memset(header, 0, sizeof(sn_coap_hdr_s));
+        header->msg_id = 1000 + i;
+        sn_coap_builder_stub.expectedHeader = (sn_coap_hdr_s *)malloc(sizeof(sn_coap_hdr_s));
+        memset(sn_coap_builder_stub.expectedHeader, 0, sizeof(sn_coap_hdr_s));
+        nsdynmemlib_stub.returnCounter = 1;
+        if( 0 != coap_message_handler_response_send(handle, 2, 0, header, 1,3,NULL, 0))
+            return false;
+    }
+
+    // Every client transaction is matched by the token of its response
+    for (int i = 0; i < COUNT; i++) {
+        sn_coap_protocol_stub.expectedHeader = (sn_coap_hdr_s *)malloc(sizeof(sn_coap_hdr_s));
+        memset(sn_coap_protocol_stub.expectedHeader, 0, sizeof(sn_coap_hdr_s));
+        sn_coap_protocol_stub.expectedHeader->coap_status = COAP_STATUS_OK;
+        sn_coap_protocol_stub.expectedHeader->msg_code = COAP_MSG_CODE_RESPONSE_CONTENT;
+        sn_coap_protocol_stub.expectedHeader->token_ptr = (uint8_t *)malloc(4);
+        memcpy(sn_coap_protocol_stub.expectedHeader->token_ptr, token[i], 4);
+        sn_coap_protocol_stub.expectedHeader->token_len = 4;
+        if( 0 != coap_message_handler_coap_msg_process(handle, 0, buf, 22, ns_in6addr_any, NULL, 0, process_cb))
+            return false;
+        if( coap_message_handler_transaction_valid(tx[i]))
+            return false;
+    }
+
+    free(sn_coap_protocol_stub.expectedCoap);
+    sn_coap_protocol_stub.expectedCoap = NULL;
+    coap_message_handler_destroy(handle);
+    return true;
+}
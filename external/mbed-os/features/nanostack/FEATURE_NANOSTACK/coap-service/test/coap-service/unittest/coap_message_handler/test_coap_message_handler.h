@@ -31,6 +31,8 @@ bool test_coap_message_handler_coap_msg_process();
 bool test_coap_message_handler_request_send();
 bool test_coap_message_handler_response_send();
 bool test_coap_message_handler_exec();
+bool test_coap_message_handler_transaction_expiry();
+bool test_coap_message_handler_transaction_index();
 
 #ifdef __cplusplus
 }
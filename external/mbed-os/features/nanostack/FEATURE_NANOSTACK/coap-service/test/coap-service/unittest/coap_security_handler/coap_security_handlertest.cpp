@@ -53,3 +53,8 @@ TEST(coap_security_handler, test_coap_security_handler_read)
 {
     CHECK(test_coap_security_handler_read());
 }
+
+TEST(coap_security_handler, test_coap_security_handler_session_resumption)
+{
+    CHECK(test_coap_security_handler_session_resumption());
+}
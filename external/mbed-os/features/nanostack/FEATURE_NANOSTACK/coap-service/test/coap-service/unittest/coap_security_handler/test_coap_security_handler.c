@@ -277,3 +277,58 @@ bool test_coap_security_handler_read()
     return true;
 }
 
+
+bool test_coap_security_handler_session_resumption()
+{
+    nsdynmemlib_stub.returnCounter = 2;
+    mbedtls_stub.crt_expected_int = 0;
+    mbedtls_stub.useCounter = false;
+    mbedtls_stub.expected_int = 0;
+    coap_security_t *handle = coap_security_create(1,2,NULL,ECJPAKE,&send_to_socket, &receive_from_socket, &start_timer_callback, &timer_status_callback);
+    if( NULL == handle )
+        return false;
+
+    uint8_t address[16];
+    memset(address, 1, 16);
+    coap_security_handler_set_peer(handle, address, 5684);
+
+    unsigned char pw[] = "pwd";
+    coap_security_keys_t keys;
+    keys._priv = pw;
+    keys._priv_len = 3;
+    if( 1 != coap_security_handler_connect_non_blocking(handle, false, DTLS, keys, 0, 1) )
+        return false;
+
+    // Session can not be read, nothing cached
+    nsdynmemlib_stub.returnCounter = 1;
+    mbedtls_stub.useCounter = true;
+    mbedtls_stub.counter = 0;
+    mbedtls_stub.retArray[0] = HANDSHAKE_FINISHED_VALUE_RETURN_ZERO;
+    if( 0 != coap_security_handler_continue_connecting(handle) )
+        return false;
+
+    nsdynmemlib_stub.returnCounter = 1;
+    mbedtls_stub.useCounter = false;
+    if( 0 != coap_security_handler_continue_connecting(handle) )
+        return false;
+
+    // Next connection to the same peer resumes the cached session
+    nsdynmemlib_stub.returnCounter = 2;
+    coap_security_t *handle2 = coap_security_create(1,3,NULL,ECJPAKE,&send_to_socket, &receive_from_socket, &start_timer_callback, &timer_status_callback);
+    if( NULL == handle2 )
+        return false;
+    coap_security_handler_set_peer(handle2, address, 5684);
+    if( 1 != coap_security_handler_connect_non_blocking(handle2, false, DTLS, keys, 0, 1) )
+        return false;
+
+    // Failed handshake drops the session
+    mbedtls_stub.useCounter = true;
+    mbedtls_stub.counter = 0;
+    mbedtls_stub.retArray[0] = MBEDTLS_ERR_SSL_BAD_HS_FINISHED;
+    if( MBEDTLS_ERR_SSL_BAD_HS_FINISHED != coap_security_handler_continue_connecting(handle2) )
+        return false;
+
+    coap_security_destroy(handle2);
+    coap_security_destroy(handle);
+    return true;
+}
@@ -38,6 +38,7 @@ bool test_coap_security_handler_send_message();
 bool test_thread_security_send_close_alert();
 
 bool test_coap_security_handler_read();
+bool test_coap_security_handler_session_resumption();
 
 #ifdef __cplusplus
 }
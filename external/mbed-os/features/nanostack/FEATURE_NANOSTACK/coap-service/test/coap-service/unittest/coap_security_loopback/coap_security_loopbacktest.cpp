@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2017 ARM. All rights reserved.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_coap_security_loopback.h"
+
+TEST_GROUP(coap_security_loopback)
+{
+    void setup()
+    {
+    }
+
+    void teardown()
+    {
+    }
+};
+
+TEST(coap_security_loopback, test_full_handshake)
+{
+    CHECK(test_full_handshake());
+}
+
+TEST(coap_security_loopback, test_resumed_handshake)
+{
+    CHECK(test_resumed_handshake());
+}
+
+TEST(coap_security_loopback, test_ticket_bound_to_socket)
+{
+    CHECK(test_ticket_bound_to_socket());
+}
+
+TEST(coap_security_loopback, test_server_password_change)
+{
+    CHECK(test_server_password_change());
+}
+
+TEST(coap_security_loopback, test_client_password_change)
+{
+    CHECK(test_client_password_change());
+}
+
+TEST(coap_security_loopback, test_handshake_time)
+{
+    CHECK(test_handshake_time());
+}
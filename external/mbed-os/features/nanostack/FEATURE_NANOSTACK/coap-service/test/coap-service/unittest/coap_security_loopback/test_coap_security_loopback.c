@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2017 ARM Limited. All Rights Reserved.
+ */
+/* Handshakes between a client and a server coap_security_handler over an
+ * in-memory datagram link, using the real mbedtls library */
+#include "test_coap_security_loopback.h"
+#include "coap_security_handler.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "nsdynmemLIB.h"
+#include "randLIB.h"
+
+#define CLIENT_SOCKET 1
+#define QUEUE_SIZE 32
+
+typedef struct {
+    unsigned char data[QUEUE_SIZE][1500];
+    size_t len[QUEUE_SIZE];
+    unsigned head;
+    unsigned tail;
+} datagram_queue_t;
+
+static datagram_queue_t to_client;
+static datagram_queue_t to_server;
+static unsigned datagrams;
+static uint64_t handshake_ns;
+
+static const uint8_t client_address[16] = {0xfe, 0x80, [15] = 1};
+static const uint8_t server_address[16] = {0xfe, 0x80, [15] = 2};
+
+/* Heap and random numbers of the platform */
+void *ns_dyn_mem_alloc(ns_mem_block_size_t alloc_size)
+{
+    return malloc(alloc_size);
+}
+
+void *ns_dyn_mem_temporary_alloc(ns_mem_block_size_t alloc_size)
+{
+    return malloc(alloc_size);
+}
+
+void ns_dyn_mem_free(void *block)
+{
+    free(block);
+}
+
+static uint32_t random_state = 12345;
+
+void randLIB_seed_random(void)
+{
+}
+
+uint8_t randLIB_get_8bit(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+/* Link */
+static int send_to_socket(int8_t socket_id, void *handle, const void *buf, size_t len)
+{
+    datagram_queue_t *queue = socket_id == CLIENT_SOCKET ? &to_server : &to_client;
+    memcpy(queue->data[queue->tail % QUEUE_SIZE], buf, len);
+    queue->len[queue->tail++ % QUEUE_SIZE] = len;
+    datagrams++;
+    return len;
+}
+
+static int receive_from_socket(int8_t socket_id, unsigned char *buf, size_t len)
+{
+    datagram_queue_t *queue = socket_id == CLIENT_SOCKET ? &to_client : &to_server;
+    if (queue->head == queue->tail) {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+    size_t datagram_len = queue->len[queue->head % QUEUE_SIZE];
+    memcpy(buf, queue->data[queue->head++ % QUEUE_SIZE], datagram_len);
+    return datagram_len;
+}
+
+static void start_timer_callback(int8_t timer_id, uint32_t int_ms, uint32_t fin_ms)
+{
+}
+
+static int timer_status_callback(int8_t timer_id)
+{
+    return 0;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Runs a handshake of the client with the server socket, on the given server
+ * port. Returns the number of datagrams exchanged, or 0 if the handshake
+ * failed or the ends did not derive the same keys. The time taken by both
+ * ends is left in handshake_ns */
+static unsigned handshake(int8_t server_socket, uint16_t port, const char *client_pw, const char *server_pw)
+{
+    coap_security_keys_t client_keys = {0};
+    coap_security_keys_t server_keys = {0};
+    client_keys._priv = (unsigned char *)client_pw;
+    client_keys._priv_len = strlen(client_pw);
+    server_keys._priv = (unsigned char *)server_pw;
+    server_keys._priv_len = strlen(server_pw);
+
+    coap_security_t *client = coap_security_create(CLIENT_SOCKET, 1, NULL, ECJPAKE, &send_to_socket,
+            &receive_from_socket, &start_timer_callback, &timer_status_callback);
+    coap_security_t *server = coap_security_create(server_socket, 2, NULL, ECJPAKE, &send_to_socket,
+            &receive_from_socket, &start_timer_callback, &timer_status_callback);
+    coap_security_handler_set_peer(client, server_address, port);
+    coap_security_handler_set_peer(server, client_address, 49152);
+
+    memset(&to_client, 0, sizeof(to_client));
+    memset(&to_server, 0, sizeof(to_server));
+    datagrams = 0;
+
+    bool client_done = false;
+    bool server_started = false;
+    bool server_done = false;
+    uint64_t start = now_ns();
+    bool failed = coap_security_handler_connect_non_blocking(client, false, DTLS, client_keys, 0, 0) < 0;
+
+    for (int i = 0; i < 100 && !failed && !(client_done && server_done); i++) {
+        if (to_server.head != to_server.tail && !server_done) {
+            int ret;
+            if (!server_started) {
+                server_started = true;
+                ret = coap_security_handler_connect_non_blocking(server, true, DTLS, server_keys, 0, 0);
+            } else {
+                ret = coap_security_handler_continue_connecting(server);
+            }
+            server_done = ret == 0;
+            failed = ret < 0;
+        }
+        if (to_client.head != to_client.tail && !client_done && !failed) {
+            int ret = coap_security_handler_continue_connecting(client);
+            client_done = ret == 0;
+            failed = ret < 0;
+        }
+    }
+
+    handshake_ns = now_ns() - start;
+    unsigned exchanged = datagrams;
+    unsigned char message[] = "ping";
+    unsigned char buffer[16];
+    bool ok = client_done && server_done &&
+              coap_security_handler_send_message(client, message, 4) == 4 &&
+              coap_security_handler_read(server, buffer, sizeof(buffer)) == 4 &&
+              memcmp(buffer, message, 4) == 0 &&
+              memcmp(coap_security_handler_keyblock(client), coap_security_handler_keyblock(server), KEY_BLOCK_LEN) == 0;
+
+    coap_security_destroy(client);
+    coap_security_destroy(server);
+    return ok ? exchanged : 0;
+}
+
+bool test_full_handshake()
+{
+    if (handshake(2, 5000, "J01NME", "J01NME") == 0) {
+        return false;
+    }
+
+    // A different password on each end fails
+    if (handshake(2, 5001, "J01NME", "OTHER1") != 0) {
+        return false;
+    }
+    return true;
+}
+
+bool test_resumed_handshake()
+{
+    unsigned full = handshake(3, 5100, "J01NME", "J01NME");
+    unsigned resumed = handshake(3, 5100, "J01NME", "J01NME");
+
+    if (full == 0 || resumed == 0 || resumed >= full) {
+        return false;
+    }
+
+    // A new port is a new peer, and has no session to resume
+    if (handshake(3, 5101, "J01NME", "J01NME") != full) {
+        return false;
+    }
+    return true;
+}
+
+bool test_ticket_bound_to_socket()
+{
+    // A client that knows the password of one service gets a ticket from it
+    if (handshake(4, 5200, "J01NME", "J01NME") == 0) {
+        return false;
+    }
+
+    // and must not resume it with another service, whose password it does not know
+    if (handshake(5, 5200, "J01NME", "OTHER1") != 0) {
+        return false;
+    }
+    return true;
+}
+
+bool test_server_password_change()
+{
+    unsigned full = handshake(6, 5300, "J01NME", "J01NME");
+    if (full == 0) {
+        return false;
+    }
+
+    // Tickets issued under the old password are no longer accepted
+    if (handshake(6, 5300, "J01NME", "OTHER1") != 0) {
+        return false;
+    }
+
+    // and the new password needs a full handshake
+    if (handshake(6, 5300, "OTHER1", "OTHER1") != full) {
+        return false;
+    }
+    return true;
+}
+
+bool test_client_password_change()
+{
+    unsigned full = handshake(7, 5400, "J01NME", "J01NME");
+    if (full == 0) {
+        return false;
+    }
+
+    // A session of the old password is not offered
+    if (handshake(7, 5400, "OTHER1", "J01NME") != 0) {
+        return false;
+    }
+
+    if (handshake(7, 5400, "OTHER1", "OTHER1") != full) {
+        return false;
+    }
+    return true;
+}
+
+bool test_handshake_time()
+{
+    enum { HANDSHAKES = 5 };
+    uint64_t full_ns = 0;
+    uint64_t resumed_ns = 0;
+
+    // Each port is a new peer, first a full handshake and then a resumed one
+    for (int i = 0; i < HANDSHAKES; i++) {
+        unsigned full = handshake(8, 5500 + i, "J01NME", "J01NME");
+        full_ns += handshake_ns;
+        unsigned resumed = handshake(8, 5500 + i, "J01NME", "J01NME");
+        resumed_ns += handshake_ns;
+        if (full == 0 || resumed == 0 || resumed >= full) {
+            return false;
+        }
+    }
+
+    full_ns /= HANDSHAKES;
+    resumed_ns /= HANDSHAKES;
+    printf("ECJPAKE handshake %llu us, resumed %llu us\n",
+           (unsigned long long)full_ns / 1000, (unsigned long long)resumed_ns / 1000);
+
+    // Resuming skips the rest of the EC J-PAKE exchange, but
+    // the client hello still carries round one, which the server verifies
+    return resumed_ns * 3 < full_ns * 2;
+}
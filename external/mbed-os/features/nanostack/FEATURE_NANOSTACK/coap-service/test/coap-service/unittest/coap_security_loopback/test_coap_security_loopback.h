@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2017 ARM Limited. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_COAP_SECURITY_LOOPBACK_H
+#define TEST_COAP_SECURITY_LOOPBACK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+bool test_full_handshake();
+
+bool test_resumed_handshake();
+
+bool test_ticket_bound_to_socket();
+
+bool test_server_password_change();
+
+bool test_client_password_change();
+
+bool test_handshake_time();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_COAP_SECURITY_LOOPBACK_H
+
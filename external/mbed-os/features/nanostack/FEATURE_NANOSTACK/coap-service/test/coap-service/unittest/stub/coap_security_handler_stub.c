@@ -40,6 +40,11 @@ void coap_security_destroy(coap_security_t *sec)
 
 }
 
+void coap_security_handler_set_peer(coap_security_t *sec, const uint8_t address[static 16], uint16_t port)
+{
+
+}
+
 int coap_security_handler_connect_non_blocking(coap_security_t *sec, bool is_server, SecureSocketMode sock_mode, coap_security_keys_t keys, uint32_t timeout_min, uint32_t timeout_max)
 {
     sec->_is_started = true;
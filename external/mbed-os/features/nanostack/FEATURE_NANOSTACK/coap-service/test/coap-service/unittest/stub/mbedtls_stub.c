@@ -308,3 +308,101 @@ int mbedtls_ssl_session_reset( mbedtls_ssl_context *ssl )
     }
     return mbedtls_stub.expected_int;
 }
+
+void mbedtls_ssl_session_init( mbedtls_ssl_session *session )
+{
+
+}
+
+void mbedtls_ssl_session_free( mbedtls_ssl_session *session )
+{
+
+}
+
+int mbedtls_ssl_get_session( const mbedtls_ssl_context *ssl, mbedtls_ssl_session *session )
+{
+    if( mbedtls_stub.useCounter ){
+        return mbedtls_stub.retArray[mbedtls_stub.counter++];
+    }
+    return mbedtls_stub.expected_int;
+}
+
+int mbedtls_ssl_set_session( mbedtls_ssl_context *ssl, const mbedtls_ssl_session *session )
+{
+    if( mbedtls_stub.useCounter ){
+        return mbedtls_stub.retArray[mbedtls_stub.counter++];
+    }
+    return mbedtls_stub.expected_int;
+}
+
+void mbedtls_ssl_conf_session_tickets_cb( mbedtls_ssl_config *conf,
+        mbedtls_ssl_ticket_write_t *f_ticket_write,
+        mbedtls_ssl_ticket_parse_t *f_ticket_parse,
+        void *p_ticket )
+{
+
+}
+
+//From ssl_ticket.h
+void mbedtls_ssl_ticket_init( mbedtls_ssl_ticket_context *ctx )
+{
+
+}
+
+int mbedtls_ssl_ticket_setup( mbedtls_ssl_ticket_context *ctx,
+    int (*f_rng)(void *, unsigned char *, size_t), void *p_rng,
+    mbedtls_cipher_type_t cipher,
+    uint32_t lifetime )
+{
+    return mbedtls_stub.expected_int;
+}
+
+void mbedtls_ssl_ticket_free( mbedtls_ssl_ticket_context *ctx )
+{
+
+}
+
+int mbedtls_ssl_ticket_write( void *p_ticket,
+                              const mbedtls_ssl_session *session,
+                              unsigned char *start,
+                              const unsigned char *end,
+                              size_t *tlen,
+                              uint32_t *lifetime )
+{
+    return mbedtls_stub.expected_int;
+}
+
+int mbedtls_ssl_ticket_parse( void *p_ticket,
+                              mbedtls_ssl_session *session,
+                              unsigned char *buf,
+                              size_t len )
+{
+    return mbedtls_stub.expected_int;
+}
+
+//From sha256.h
+void mbedtls_sha256_init( mbedtls_sha256_context *ctx )
+{
+
+}
+
+void mbedtls_sha256_free( mbedtls_sha256_context *ctx )
+{
+
+}
+
+void mbedtls_sha256_starts( mbedtls_sha256_context *ctx, int is224 )
+{
+
+}
+
+void mbedtls_sha256_update( mbedtls_sha256_context *ctx, const unsigned char *input,
+                    size_t ilen )
+{
+
+}
+
+void mbedtls_sha256_finish( mbedtls_sha256_context *ctx, unsigned char output[32] )
+{
+
+}
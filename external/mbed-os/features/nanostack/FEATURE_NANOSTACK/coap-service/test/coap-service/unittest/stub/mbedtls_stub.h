@@ -24,6 +24,7 @@
 #include <stdbool.h>
 #include "mbedtls/platform.h"
 #include "mbedtls/ssl.h"
+#include "mbedtls/ssl_ticket.h"
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/x509_crt.h"
 #include "mbedtls/sha256.h"
@@ -23,6 +23,7 @@ extern "C" {
 #endif
 
 #include "stdint.h"
+#include "stddef.h"
 
 typedef struct {
     uint8_t returnCounter;
@@ -32,8 +33,8 @@ typedef struct {
 extern nsdynmemlib_stub_data_t nsdynmemlib_stub;
 
 
-void *ns_dyn_mem_alloc(int16_t alloc_size);
-void *ns_dyn_mem_temporary_alloc(int16_t alloc_size);
+void *ns_dyn_mem_alloc(size_t alloc_size);
+void *ns_dyn_mem_temporary_alloc(size_t alloc_size);
 void ns_dyn_mem_free(void *block);
 
 #ifdef __cplusplus
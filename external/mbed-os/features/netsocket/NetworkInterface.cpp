@@ -60,6 +60,12 @@ nsapi_error_t NetworkInterface::gethostbyname(const char *name, SocketAddress *a
     return get_stack()->gethostbyname(name, address, version);
 }
 
+nsapi_error_t NetworkInterface::gethostbyname_async(const char *name, hostbyname_cb_t callback,
+        events::EventQueue *queue, nsapi_version_t version)
+{
+    return get_stack()->gethostbyname_async(name, callback, queue, version);
+}
+
 nsapi_error_t NetworkInterface::add_dns_server(const SocketAddress &address)
 {
     return get_stack()->add_dns_server(address);
@@ -22,10 +22,15 @@
 
 #include "netsocket/nsapi_types.h"
 #include "netsocket/SocketAddress.h"
+#include "platform/Callback.h"
 
 // Predeclared class
 class NetworkStack;
 
+namespace events {
+    class EventQueue;
+}
+
 
 /** NetworkInterface class
  *
@@ -33,6 +38,13 @@ class NetworkStack;
  */
 class NetworkInterface {
 public:
+    /** Callback for the result of an asynchronous hostname translation
+     *
+     *  The address is only valid for the duration of the callback, and is
+     *  null if the translation failed
+     */
+    typedef mbed::Callback<void (nsapi_error_t result, SocketAddress *address)> hostbyname_cb_t;
+
     virtual ~NetworkInterface() {};
 
     /** Get the local MAC address
@@ -121,6 +133,24 @@ public:
     virtual nsapi_error_t gethostbyname(const char *host,
             SocketAddress *address, nsapi_version_t version = NSAPI_UNSPEC);
 
+    /** Translates a hostname to an IP address without blocking the caller
+     *
+     *  The translation is posted to the event queue and runs in its
+     *  context, after which the callback is called from the same context.
+     *  Translating a hostname may block for the DNS timeout, so the queue
+     *  should be dispatched from a thread that can wait on the network.
+     *
+     *  @param host     Hostname to resolve, copied before returning
+     *  @param callback Callback to call with the result
+     *  @param queue    Event queue to run the translation on
+     *  @param version  IP version of address to resolve, NSAPI_UNSPEC indicates
+     *                  version is chosen by the stack (defaults to NSAPI_UNSPEC)
+     *  @return         0 if the translation was queued, negative error code on failure
+     */
+    virtual nsapi_error_t gethostbyname_async(const char *host,
+            hostbyname_cb_t callback, events::EventQueue *queue,
+            nsapi_version_t version = NSAPI_UNSPEC);
+
     /** Add a domain name server to list of servers to query
      *
      *  @param addr     Destination for the host address
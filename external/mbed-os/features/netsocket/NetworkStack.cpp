@@ -17,6 +17,7 @@
 #include "NetworkStack.h"
 #include "nsapi_dns.h"
 #include "mbed.h"
+#include "events/EventQueue.h"
 #include "stddef.h"
 #include <new>
 
@@ -45,6 +46,47 @@ nsapi_error_t NetworkStack::gethostbyname(const char *name, SocketAddress *addre
     return nsapi_dns_query(this, name, address, version);
 }
 
+// Pending asynchronous hostname translation
+struct nsapi_hostbyname {
+    NetworkStack *stack;
+    char *host;
+    NetworkStack::hostbyname_cb_t callback;
+    nsapi_version_t version;
+};
+
+static void nsapi_hostbyname_dispatch(nsapi_hostbyname *query)
+{
+    SocketAddress address;
+    nsapi_error_t err = query->stack->gethostbyname(query->host, &address, query->version);
+    query->callback(err, err ? NULL : &address);
+
+    delete[] query->host;
+    delete query;
+}
+
+nsapi_error_t NetworkStack::gethostbyname_async(const char *name, hostbyname_cb_t callback,
+        events::EventQueue *queue, nsapi_version_t version)
+{
+    if (!name || !queue) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    nsapi_hostbyname *query = new nsapi_hostbyname;
+    query->stack = this;
+    query->host = new char[strlen(name) + 1];
+    strcpy(query->host, name);
+    query->callback = callback;
+    query->version = version;
+
+    if (!queue->call(nsapi_hostbyname_dispatch, query)) {
+        delete[] query->host;
+        delete query;
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
 nsapi_error_t NetworkStack::add_dns_server(const SocketAddress &address)
 {
     return nsapi_dns_add_server(address);
@@ -70,6 +112,70 @@ nsapi_error_t NetworkStack::getsockopt(void *handle, int level, int optname, voi
     return NSAPI_ERROR_UNSUPPORTED;
 }
 
+nsapi_size_or_error_t NetworkStack::socket_sendv(nsapi_socket_t handle,
+        const nsapi_iovec_t *iov, unsigned count, int flags)
+{
+    nsapi_size_t sent = 0;
+    for (unsigned i = 0; i < count; i++) {
+        if (iov[i].size == 0) {
+            continue;
+        }
+
+        nsapi_size_or_error_t ret = socket_send(handle, iov[i].data, iov[i].size);
+        if (ret < 0) {
+            // Only report the error if nothing has been sent yet
+            return sent ? sent : ret;
+        }
+
+        sent += ret;
+        if ((nsapi_size_t)ret < iov[i].size) {
+            break;
+        }
+    }
+
+    return sent;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recv_buffer(nsapi_socket_t handle,
+        nsapi_buffer_t *buffer)
+{
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_sendtov(nsapi_socket_t handle, const SocketAddress &address,
+        const nsapi_iovec_t *iov, unsigned count, int flags)
+{
+    nsapi_size_t size = 0;
+    for (unsigned i = 0; i < count; i++) {
+        size += iov[i].size;
+    }
+
+    uint8_t *data = new (std::nothrow) uint8_t[size ? size : 1];
+    if (!data) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    nsapi_size_t off = 0;
+    for (unsigned i = 0; i < count; i++) {
+        memcpy(&data[off], iov[i].data, iov[i].size);
+        off += iov[i].size;
+    }
+
+    nsapi_size_or_error_t ret = socket_sendto(handle, address, data, size);
+    delete[] data;
+    return ret;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recvfrom_buffer(nsapi_socket_t handle, SocketAddress *address,
+        nsapi_buffer_t *buffer)
+{
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+void NetworkStack::socket_free_buffer(nsapi_buffer_t *buffer)
+{
+}
+
 
 // NetworkStackWrapper class for encapsulating the raw nsapi_stack structure
 class NetworkStackWrapper : public NetworkStack
@@ -275,6 +381,61 @@ protected:
 
         return _stack_api()->getsockopt(_stack(), socket, level, optname, optval, optlen);
     }
+
+    virtual nsapi_size_or_error_t socket_sendv(nsapi_socket_t socket, const nsapi_iovec_t *iov, unsigned count, int flags)
+    {
+        if (!_stack_api()->socket_sendv) {
+            return NetworkStack::socket_sendv(socket, iov, count, flags);
+        }
+
+        return _stack_api()->socket_sendv(_stack(), socket, iov, count, flags);
+    }
+
+    virtual nsapi_size_or_error_t socket_recv_buffer(nsapi_socket_t socket, nsapi_buffer_t *buffer)
+    {
+        if (!_stack_api()->socket_recv_buffer) {
+            return NSAPI_ERROR_UNSUPPORTED;
+        }
+
+        return _stack_api()->socket_recv_buffer(_stack(), socket, buffer);
+    }
+
+    virtual nsapi_size_or_error_t socket_sendtov(nsapi_socket_t socket, const SocketAddress &address, const nsapi_iovec_t *iov, unsigned count, int flags)
+    {
+        if (!_stack_api()->socket_sendtov) {
+            return NetworkStack::socket_sendtov(socket, address, iov, count, flags);
+        }
+
+        return _stack_api()->socket_sendtov(_stack(), socket, address.get_addr(), address.get_port(), iov, count, flags);
+    }
+
+    virtual nsapi_size_or_error_t socket_recvfrom_buffer(nsapi_socket_t socket, SocketAddress *address, nsapi_buffer_t *buffer)
+    {
+        if (!_stack_api()->socket_recvfrom_buffer) {
+            return NSAPI_ERROR_UNSUPPORTED;
+        }
+
+        nsapi_addr_t addr = {NSAPI_IPv4, 0};
+        uint16_t port = 0;
+
+        nsapi_size_or_error_t err = _stack_api()->socket_recvfrom_buffer(_stack(), socket, &addr, &port, buffer);
+
+        if (address) {
+            address->set_addr(addr);
+            address->set_port(port);
+        }
+
+        return err;
+    }
+
+    virtual void socket_free_buffer(nsapi_buffer_t *buffer)
+    {
+        if (!_stack_api()->socket_free_buffer) {
+            return;
+        }
+
+        _stack_api()->socket_free_buffer(_stack(), buffer);
+    }
 };
 
 
@@ -35,6 +35,8 @@
 class NetworkStack
 {
 public:
+    typedef NetworkInterface::hostbyname_cb_t hostbyname_cb_t;
+
     virtual ~NetworkStack() {};
 
     /** Get the local IP address
@@ -61,6 +63,25 @@ public:
     virtual nsapi_error_t gethostbyname(const char *host,
             SocketAddress *address, nsapi_version_t version = NSAPI_UNSPEC);
 
+    /** Translates a hostname to an IP address without blocking the caller
+     *
+     *  The translation is posted to the event queue and runs gethostbyname
+     *  in its context, after which the callback is called from the same
+     *  context. Translating a hostname may block for the DNS timeout, so
+     *  the queue should be dispatched from a thread that can wait on the
+     *  network.
+     *
+     *  @param host     Hostname to resolve, copied before returning
+     *  @param callback Callback to call with the result
+     *  @param queue    Event queue to run the translation on
+     *  @param version  IP version of address to resolve, NSAPI_UNSPEC indicates
+     *                  version is chosen by the stack (defaults to NSAPI_UNSPEC)
+     *  @return         0 if the translation was queued, negative error code on failure
+     */
+    virtual nsapi_error_t gethostbyname_async(const char *host,
+            hostbyname_cb_t callback, events::EventQueue *queue,
+            nsapi_version_t version = NSAPI_UNSPEC);
+
     /** Add a domain name server to list of servers to query
      *
      *  @param addr     Destination for the host address
@@ -300,6 +321,95 @@ protected:
      */
     virtual nsapi_error_t getsockopt(nsapi_socket_t handle, int level,
             int optname, void *optval, unsigned *optlen);
+
+    /** Send data gathered from multiple buffers over a TCP socket
+     *
+     *  The socket must be connected to a remote host. Returns the number of
+     *  bytes sent from the buffers, in order.
+     *
+     *  This call is non-blocking. If send would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  By default, each buffer is passed to socket_send in turn. Stacks
+     *  that can queue buffers without copying should override this.
+     *
+     *  @param handle   Socket handle
+     *  @param iov      Array of buffers to send to the host
+     *  @param count    Number of buffers in the array
+     *  @param flags    Bitmask of nsapi_send_flags_t
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_sendv(nsapi_socket_t handle,
+            const nsapi_iovec_t *iov, unsigned count, int flags);
+
+    /** Receive data over a TCP socket without copying
+     *
+     *  The socket must be connected to a remote host. Loans out the next
+     *  contiguous chunk of received data, which must be released with
+     *  socket_free_buffer. Returns the number of bytes in the buffer.
+     *
+     *  This call is non-blocking. If recv would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  By default, NSAPI_ERROR_UNSUPPORTED is returned.
+     *
+     *  @param handle   Socket handle
+     *  @param buffer   Destination for the loaned buffer
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_recv_buffer(nsapi_socket_t handle,
+            nsapi_buffer_t *buffer);
+
+    /** Send a packet gathered from multiple buffers over a UDP socket
+     *
+     *  Sends the buffers as a single packet to the specified address.
+     *  Returns the number of bytes sent from the buffers.
+     *
+     *  This call is non-blocking. If sendto would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  By default, the buffers are gathered into a temporary buffer
+     *  and passed to socket_sendto.
+     *
+     *  @param handle   Socket handle
+     *  @param address  The SocketAddress of the remote host
+     *  @param iov      Array of buffers to send to the host
+     *  @param count    Number of buffers in the array
+     *  @param flags    Bitmask of nsapi_send_flags_t
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_sendtov(nsapi_socket_t handle, const SocketAddress &address,
+            const nsapi_iovec_t *iov, unsigned count, int flags);
+
+    /** Receive a packet over a UDP socket without copying
+     *
+     *  Loans out the next packet as a single contiguous buffer, which must
+     *  be released with socket_free_buffer. Stores the source address in
+     *  address if address is not NULL. Returns the number of bytes in the
+     *  buffer.
+     *
+     *  This call is non-blocking. If recvfrom would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  By default, NSAPI_ERROR_UNSUPPORTED is returned.
+     *
+     *  @param handle   Socket handle
+     *  @param address  Destination for the source address or NULL
+     *  @param buffer   Destination for the loaned buffer
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    virtual nsapi_size_or_error_t socket_recvfrom_buffer(nsapi_socket_t handle, SocketAddress *address,
+            nsapi_buffer_t *buffer);
+
+    /** Release a buffer loaned out by socket_recv_buffer or socket_recvfrom_buffer
+     *
+     *  @param buffer   Buffer to release
+     */
+    virtual void socket_free_buffer(nsapi_buffer_t *buffer);
 };
 
 
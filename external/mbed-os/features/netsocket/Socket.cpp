@@ -21,6 +21,9 @@ Socket::Socket()
     : _stack(0)
     , _socket(0)
     , _timeout(osWaitForever)
+    , _read_pending(true)
+    , _write_pending(true)
+    , _poller(0)
 {
 }
 
@@ -149,6 +152,21 @@ nsapi_error_t Socket::getsockopt(int level, int optname, void *optval, unsigned
 
 }
 
+void Socket::free_buffer(nsapi_buffer_t *buffer)
+{
+    // release through the stack that loaned the buffer, the
+    // socket may have been closed since
+    NetworkStack *stack = static_cast<NetworkStack *>(buffer->stack);
+    if (stack && buffer->handle) {
+        stack->socket_free_buffer(buffer);
+    }
+
+    buffer->data = 0;
+    buffer->size = 0;
+    buffer->handle = 0;
+    buffer->stack = 0;
+}
+
 void Socket::sigio(Callback<void()> callback)
 {
     _lock.lock();
@@ -22,6 +22,7 @@
 
 #include "netsocket/SocketAddress.h"
 #include "netsocket/NetworkStack.h"
+#include "netsocket/nsapi_poll.h"
 #include "rtos/Mutex.h"
 #include "Callback.h"
 #include "mbed_toolchain.h"
@@ -154,6 +155,18 @@ public:
      */    
     nsapi_error_t getsockopt(int level, int optname, void *optval, unsigned *optlen);
 
+    /** Release a buffer loaned out by a socket
+     *
+     *  Buffers from TCPSocket::recv_buffer and UDPSocket::recvfrom_buffer
+     *  hold on to the network stack's memory until they are released,
+     *  which may be after the socket is closed or destroyed. The buffer
+     *  is released through the stack that loaned it, so no socket is
+     *  needed. Releasing an empty buffer does nothing.
+     *
+     *  @param buffer   Buffer to release
+     */
+    static void free_buffer(nsapi_buffer_t *buffer);
+
     /** Register a callback on state change of the socket
      *
      *  The specified callback will be called on state changes such as when
@@ -200,6 +213,8 @@ public:
     }
 
 protected:
+    friend nsapi_size_or_error_t nsapi_poll(nsapi_pollsock_t *socks, unsigned count, int timeout);
+
     Socket();
     virtual nsapi_protocol_t get_proto() = 0;
     virtual void event() = 0;
@@ -207,6 +222,14 @@ protected:
     NetworkStack *_stack;
     nsapi_socket_t _socket;
     uint32_t _timeout;
+
+    // Set on a stack event and cleared once an operation in that direction
+    // would block, so nsapi_poll reports what may make progress. Operations
+    // clear the flag before calling the stack and set it again if they did
+    // not block, so an event racing with the call is not lost.
+    volatile bool _read_pending;
+    volatile bool _write_pending;
+    osThreadId volatile _poller;
     mbed::Callback<void()> _event;
     mbed::Callback<void()> _callback;
     rtos::Mutex _lock;
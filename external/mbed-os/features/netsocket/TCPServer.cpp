@@ -59,8 +59,12 @@ nsapi_error_t TCPServer::accept(TCPSocket *connection, SocketAddress *address)
         } 
 
         _pending = 0;
+        _read_pending = false;
         void *socket;
         ret = _stack->socket_accept(_socket, &socket, address);
+        if (ret != NSAPI_ERROR_WOULD_BLOCK) {
+            _read_pending = true;
+        }
 
         if (0 == ret) {
             connection->_lock.lock();
@@ -71,6 +75,8 @@ nsapi_error_t TCPServer::accept(TCPSocket *connection, SocketAddress *address)
 
             connection->_stack = _stack;
             connection->_socket = socket;
+            connection->_read_pending = true;
+            connection->_write_pending = true;
             connection->_event = Callback<void()>(connection, &TCPSocket::event);
             _stack->socket_attach(socket, &Callback<void()>::thunk, &connection->_event);
 
@@ -106,6 +112,12 @@ void TCPServer::event()
         _accept_sem.release();
     }
 
+    bool ready = _read_pending;
+    _read_pending = true;
+    if (_poller && !ready) {
+        osSignalSet(_poller, NSAPI_POLL_SIGNAL);
+    }
+
     _pending += 1;
     if (_callback && _pending == 1) {
         _callback();
@@ -54,7 +54,11 @@ nsapi_error_t TCPSocket::connect(const SocketAddress &address)
         }
 
         _pending = 0;
+        _write_pending = false;
         ret = _stack->socket_connect(_socket, address);
+        if (ret != NSAPI_ERROR_IN_PROGRESS && ret != NSAPI_ERROR_ALREADY) {
+            _write_pending = true;
+        }
         if ((_timeout == 0) || !(ret == NSAPI_ERROR_IN_PROGRESS || ret == NSAPI_ERROR_ALREADY)) {
             break;
         } else {
@@ -118,7 +122,11 @@ nsapi_size_or_error_t TCPSocket::send(const void *data, nsapi_size_t size)
         }
 
         _pending = 0;
+        _write_pending = false;
         ret = _stack->socket_send(_socket, data, size);
+        if (ret != NSAPI_ERROR_WOULD_BLOCK) {
+            _write_pending = true;
+        }
         if ((_timeout == 0) || (ret != NSAPI_ERROR_WOULD_BLOCK)) {
             break;
         } else {
@@ -161,7 +169,109 @@ nsapi_size_or_error_t TCPSocket::recv(void *data, nsapi_size_t size)
         }
 
         _pending = 0;
+        _read_pending = false;
         ret = _stack->socket_recv(_socket, data, size);
+        if (ret != NSAPI_ERROR_WOULD_BLOCK) {
+            _read_pending = true;
+        }
+        if ((_timeout == 0) || (ret != NSAPI_ERROR_WOULD_BLOCK)) {
+            break;
+        } else {
+            int32_t count;
+
+            // Release lock before blocking so other threads
+            // accessing this object aren't blocked
+            _lock.unlock();
+            count = _read_sem.wait(_timeout);
+            _lock.lock();
+
+            if (count < 1) {
+                // Semaphore wait timed out so break out and return
+                ret = NSAPI_ERROR_WOULD_BLOCK;
+                break;
+            }
+        }
+    }
+
+    _read_in_progress = false;
+    _lock.unlock();
+    return ret;
+}
+
+nsapi_size_or_error_t TCPSocket::send(const nsapi_iovec_t *iov, unsigned iovcnt, int flags)
+{
+    _lock.lock();
+    nsapi_size_or_error_t ret;
+
+    // If this assert is hit then there are two threads
+    // performing a send at the same time which is undefined
+    // behavior
+    MBED_ASSERT(!_write_in_progress);
+    _write_in_progress = true;
+
+    while (true) {
+        if (!_socket) {
+            ret = NSAPI_ERROR_NO_SOCKET;
+            break;
+        }
+
+        _pending = 0;
+        _write_pending = false;
+        ret = _stack->socket_sendv(_socket, iov, iovcnt, flags);
+        if (ret != NSAPI_ERROR_WOULD_BLOCK) {
+            _write_pending = true;
+        }
+        if ((_timeout == 0) || (ret != NSAPI_ERROR_WOULD_BLOCK)) {
+            break;
+        } else {
+            int32_t count;
+
+            // Release lock before blocking so other threads
+            // accessing this object aren't blocked
+            _lock.unlock();
+            count = _write_sem.wait(_timeout);
+            _lock.lock();
+
+            if (count < 1) {
+                // Semaphore wait timed out so break out and return
+                ret = NSAPI_ERROR_WOULD_BLOCK;
+                break;
+            }
+        }
+    }
+
+    _write_in_progress = false;
+    _lock.unlock();
+    return ret;
+}
+
+nsapi_size_or_error_t TCPSocket::recv_buffer(nsapi_buffer_t *buffer)
+{
+    _lock.lock();
+    nsapi_size_or_error_t ret;
+
+    // If this assert is hit then there are two threads
+    // performing a recv at the same time which is undefined
+    // behavior
+    MBED_ASSERT(!_read_in_progress);
+    _read_in_progress = true;
+
+    while (true) {
+        if (!_socket) {
+            ret = NSAPI_ERROR_NO_SOCKET;
+            break;
+        }
+
+        _pending = 0;
+        _read_pending = false;
+        ret = _stack->socket_recv_buffer(_socket, buffer);
+        if (ret != NSAPI_ERROR_WOULD_BLOCK) {
+            _read_pending = true;
+        }
+        if (ret >= 0) {
+            buffer->stack = _stack;
+        }
+
         if ((_timeout == 0) || (ret != NSAPI_ERROR_WOULD_BLOCK)) {
             break;
         } else {
@@ -197,6 +307,13 @@ void TCPSocket::event()
         _read_sem.release();
     }
 
+    bool ready = _read_pending && _write_pending;
+    _read_pending = true;
+    _write_pending = true;
+    if (_poller && !ready) {
+        osSignalSet(_poller, NSAPI_POLL_SIGNAL);
+    }
+
     _pending += 1;
     if (_callback && _pending == 1) {
         _callback();
@@ -110,6 +110,43 @@ public:
      */
     nsapi_size_or_error_t recv(void *data, nsapi_size_t size);
 
+    /** Send data gathered from multiple buffers over a TCP socket
+     *
+     *  The socket must be connected to a remote host. Returns the number of
+     *  bytes sent from the buffers, in order.
+     *
+     *  The data is copied by the network stack, so the buffers may be
+     *  reused as soon as send returns. NSAPI_SEND_NOCOPY is ignored.
+     *
+     *  By default, send blocks until data is sent. If socket is set to
+     *  non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is returned
+     *  immediately.
+     *
+     *  @param iov      Array of buffers to send to the host
+     *  @param iovcnt   Number of buffers in the array
+     *  @param flags    Bitmask of nsapi_send_flags_t
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t send(const nsapi_iovec_t *iov, unsigned iovcnt, int flags = 0);
+
+    /** Receive data over a TCP socket without copying
+     *
+     *  The socket must be connected to a remote host. Loans out the next
+     *  contiguous chunk of received data, which must be released with
+     *  free_buffer. Returns the number of bytes in the buffer.
+     *
+     *  By default, recv_buffer blocks until data is sent. If socket is set to
+     *  non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is returned
+     *  immediately. If the network stack does not support loaning buffers,
+     *  NSAPI_ERROR_UNSUPPORTED is returned.
+     *
+     *  @param buffer   Destination for the loaned buffer
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t recv_buffer(nsapi_buffer_t *buffer);
+
 protected:
     friend class TCPServer;
 
@@ -59,7 +59,11 @@ nsapi_size_or_error_t UDPSocket::sendto(const SocketAddress &address, const void
         }
 
         _pending = 0;
+        _write_pending = false;
         nsapi_size_or_error_t sent = _stack->socket_sendto(_socket, address, data, size);
+        if (sent != NSAPI_ERROR_WOULD_BLOCK) {
+            _write_pending = true;
+        }
         if ((0 == _timeout) || (NSAPI_ERROR_WOULD_BLOCK != sent)) {
             ret = sent;
             break;
@@ -96,7 +100,97 @@ nsapi_size_or_error_t UDPSocket::recvfrom(SocketAddress *address, void *buffer,
         }
 
         _pending = 0;
+        _read_pending = false;
         nsapi_size_or_error_t recv = _stack->socket_recvfrom(_socket, address, buffer, size);
+        if (recv != NSAPI_ERROR_WOULD_BLOCK) {
+            _read_pending = true;
+        }
+        if ((0 == _timeout) || (NSAPI_ERROR_WOULD_BLOCK != recv)) {
+            ret = recv;
+            break;
+        } else {
+            int32_t count;
+
+            // Release lock before blocking so other threads
+            // accessing this object aren't blocked
+            _lock.unlock();
+            count = _read_sem.wait(_timeout);
+            _lock.lock();
+
+            if (count < 1) {
+                // Semaphore wait timed out so break out and return
+                ret = NSAPI_ERROR_WOULD_BLOCK;
+                break;
+            }
+        }
+    }
+
+    _lock.unlock();
+    return ret;
+}
+
+nsapi_size_or_error_t UDPSocket::sendto(const SocketAddress &address, const nsapi_iovec_t *iov, unsigned iovcnt, int flags)
+{
+    _lock.lock();
+    nsapi_size_or_error_t ret;
+
+    while (true) {
+        if (!_socket) {
+            ret = NSAPI_ERROR_NO_SOCKET;
+            break;
+        }
+
+        _pending = 0;
+        _write_pending = false;
+        nsapi_size_or_error_t sent = _stack->socket_sendtov(_socket, address, iov, iovcnt, flags);
+        if (sent != NSAPI_ERROR_WOULD_BLOCK) {
+            _write_pending = true;
+        }
+        if ((0 == _timeout) || (NSAPI_ERROR_WOULD_BLOCK != sent)) {
+            ret = sent;
+            break;
+        } else {
+            int32_t count;
+
+            // Release lock before blocking so other threads
+            // accessing this object aren't blocked
+            _lock.unlock();
+            count = _write_sem.wait(_timeout);
+            _lock.lock();
+
+            if (count < 1) {
+                // Semaphore wait timed out so break out and return
+                ret = NSAPI_ERROR_WOULD_BLOCK;
+                break;
+            }
+        }
+    }
+
+    _lock.unlock();
+    return ret;
+}
+
+nsapi_size_or_error_t UDPSocket::recvfrom_buffer(SocketAddress *address, nsapi_buffer_t *buffer)
+{
+    _lock.lock();
+    nsapi_size_or_error_t ret;
+
+    while (true) {
+        if (!_socket) {
+            ret = NSAPI_ERROR_NO_SOCKET;
+            break;
+        }
+
+        _pending = 0;
+        _read_pending = false;
+        nsapi_size_or_error_t recv = _stack->socket_recvfrom_buffer(_socket, address, buffer);
+        if (recv != NSAPI_ERROR_WOULD_BLOCK) {
+            _read_pending = true;
+        }
+        if (recv >= 0) {
+            buffer->stack = _stack;
+        }
+
         if ((0 == _timeout) || (NSAPI_ERROR_WOULD_BLOCK != recv)) {
             ret = recv;
             break;
@@ -132,6 +226,13 @@ void UDPSocket::event()
         _read_sem.release();
     }
 
+    bool ready = _read_pending && _write_pending;
+    _read_pending = true;
+    _write_pending = true;
+    if (_poller && !ready) {
+        osSignalSet(_poller, NSAPI_POLL_SIGNAL);
+    }
+
     _pending += 1;
     if (_callback && _pending == 1) {
         _callback();
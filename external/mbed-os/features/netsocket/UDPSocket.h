@@ -112,6 +112,47 @@ public:
     nsapi_size_or_error_t recvfrom(SocketAddress *address,
             void *data, nsapi_size_t size);
 
+    /** Send a packet gathered from multiple buffers over a UDP socket
+     *
+     *  Sends the buffers as a single packet to the specified address.
+     *  Returns the number of bytes sent from the buffers.
+     *
+     *  With NSAPI_SEND_NOCOPY, the network stack may reference the data
+     *  instead of copying it while the packet is sent.
+     *
+     *  By default, sendto blocks until data is sent. If socket is set to
+     *  non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is returned
+     *  immediately.
+     *
+     *  @param address  The SocketAddress of the remote host
+     *  @param iov      Array of buffers to send to the host
+     *  @param iovcnt   Number of buffers in the array
+     *  @param flags    Bitmask of nsapi_send_flags_t
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t sendto(const SocketAddress &address,
+            const nsapi_iovec_t *iov, unsigned iovcnt, int flags = 0);
+
+    /** Receive a packet over a UDP socket without copying
+     *
+     *  Loans out the next packet as a single contiguous buffer, which must
+     *  be released with free_buffer. Stores the source address in address
+     *  if address is not NULL. Returns the number of bytes in the buffer.
+     *
+     *  By default, recvfrom_buffer blocks until data is sent. If socket is set
+     *  to non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK is returned
+     *  immediately. If the network stack does not support loaning buffers,
+     *  NSAPI_ERROR_UNSUPPORTED is returned.
+     *
+     *  @param address  Destination for the source address or NULL
+     *  @param buffer   Destination for the loaned buffer
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t recvfrom_buffer(SocketAddress *address,
+            nsapi_buffer_t *buffer);
+
 protected:
     virtual nsapi_protocol_t get_proto();
     virtual void event();
@@ -16,6 +16,11 @@
  */
 #include "nsapi_dns.h"
 #include "netsocket/UDPSocket.h"
+#include "platform/PlatformMutex.h"
+#include "platform/SingletonPtr.h"
+#include "hal/ticker_api.h"
+#include "hal/us_ticker_api.h"
+#include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -23,13 +28,32 @@
 #define CLASS_IN 1
 
 #define RR_A 1
+#define RR_SOA 6
 #define RR_AAAA 28
 
+#define RCODE_NXDOMAIN 3
+
 // DNS options
 #define DNS_BUFFER_SIZE 512
 #define DNS_TIMEOUT 5000
 #define DNS_SERVERS_SIZE 5
 
+// DNS cache options, ttls are capped to keep expiry well within the tick
+#ifndef MBED_CONF_NSAPI_DNS_CACHE_SIZE
+#define MBED_CONF_NSAPI_DNS_CACHE_SIZE 3
+#endif
+
+#define DNS_CACHE_SIZE MBED_CONF_NSAPI_DNS_CACHE_SIZE
+#define DNS_CACHE_ADDRS 4
+#define DNS_CACHE_TTL_MAX (24*60*60)
+
+// Milliseconds from the us ticker, callers only compare differences so
+// the 32-bit wrap is harmless
+static unsigned dns_tick()
+{
+    return ticker_read_us(get_us_ticker_data()) / 1000;
+}
+
 nsapi_addr_t dns_servers[DNS_SERVERS_SIZE] = {
     {NSAPI_IPv4, {8, 8, 8, 8}},                             // Google
     {NSAPI_IPv4, {209, 244, 0, 3}},                         // Level 3
@@ -83,11 +107,35 @@ static uint16_t dns_scan_word(const uint8_t **p)
     return (a << 8) | b;
 }
 
+static uint32_t dns_scan_dword(const uint8_t **p)
+{
+    uint32_t a = dns_scan_word(p);
+    uint32_t b = dns_scan_word(p);
+    return (a << 16) | b;
+}
+
+static bool dns_skip_name(const uint8_t **p, const uint8_t *end)
+{
+    while (*p < end) {
+        uint8_t len = dns_scan_byte(p);
+        if (len == 0) {
+            return true;
+        } else if ((len & 0xc0) == 0xc0) { // this is link
+            *p += 1;
+            return *p <= end;
+        }
+
+        *p += len;
+    }
+
+    return false;
+}
+
 
-static void dns_append_question(uint8_t **p, const char *host, nsapi_version_t version)
+static void dns_append_question(uint8_t **p, const char *host, nsapi_version_t version, uint16_t id)
 {
     // fill the header
-    dns_append_word(p, 1);      // id      = 1
+    dns_append_word(p, id);     // id
     dns_append_word(p, 0x0100); // flags   = recursion required
     dns_append_word(p, 1);      // qdcount = 1
     dns_append_word(p, 0);      // ancount = 0
@@ -112,86 +160,250 @@ static void dns_append_question(uint8_t **p, const char *host, nsapi_version_t v
     dns_append_word(p, CLASS_IN);
 }
 
-static int dns_scan_response(const uint8_t **p, nsapi_addr_t *addr, unsigned addr_count)
+// Summary of a response, ttl is in seconds and 0 if the
+// response should not be cached
+struct dns_response {
+    uint8_t rcode;
+    unsigned count;
+    unsigned total;
+    uint32_t ttl;
+};
+
+static bool dns_scan_response(const uint8_t *p, const uint8_t *end, uint16_t expected_id,
+        struct dns_response *res, nsapi_addr_t *addr, unsigned addr_count)
 {
+    if (end - p < 12) {
+        return false;
+    }
+
     // scan header
-    uint16_t id    = dns_scan_word(p);
-    uint16_t flags = dns_scan_word(p);
+    uint16_t id    = dns_scan_word(&p);
+    uint16_t flags = dns_scan_word(&p);
     bool    qr     = 0x1 & (flags >> 15);
     uint8_t opcode = 0xf & (flags >> 11);
     uint8_t rcode  = 0xf & (flags >>  0);
 
-    uint16_t qdcount = dns_scan_word(p); // qdcount
-    uint16_t ancount = dns_scan_word(p); // ancount
-    dns_scan_word(p);                    // nscount
-    dns_scan_word(p);                    // arcount
+    uint16_t qdcount = dns_scan_word(&p); // qdcount
+    uint16_t ancount = dns_scan_word(&p); // ancount
+    uint16_t nscount = dns_scan_word(&p); // nscount
+    dns_scan_word(&p);                    // arcount
 
     // verify header is response to query
-    if (!(id == 1 && qr && opcode == 0 && rcode == 0)) {
-        return 0;
+    if (!(id == expected_id && qr && opcode == 0)) {
+        return false;
     }
 
     // skip questions
     for (int i = 0; i < qdcount; i++) {
-        while (true) {
-            uint8_t len = dns_scan_byte(p);
-            if (len == 0) {
-                break;
-            }
-
-            *p += len;
+        if (!dns_skip_name(&p, end) || end - p < 4) {
+            return false;
         }
 
-        dns_scan_word(p); // qtype
-        dns_scan_word(p); // qclass
+        dns_scan_word(&p); // qtype
+        dns_scan_word(&p); // qclass
     }
 
-    // scan each response
-    unsigned count = 0;
-
-    for (int i = 0; i < ancount && count < addr_count; i++) {
-        while (true) {
-            uint8_t len = dns_scan_byte(p);
-            if (len == 0) {
-                break;
-            } else if (len & 0xc0) { // this is link
-                dns_scan_byte(p);
-                break;
-            }
+    // scan each response, followed by the authority records
+    // that hold the ttl of negative responses
+    res->rcode = rcode;
+    res->count = 0;
+    res->total = 0;
+    uint32_t answer_ttl = DNS_CACHE_TTL_MAX;
+    uint32_t negative_ttl = 0;
+
+    for (int i = 0; i < ancount + nscount; i++) {
+        if (!dns_skip_name(&p, end) || end - p < 10) {
+            return false;
+        }
 
-            *p += len;
+        uint16_t rtype    = dns_scan_word(&p);  // rtype
+        uint16_t rclass   = dns_scan_word(&p);  // rclass
+        uint32_t ttl      = dns_scan_dword(&p); // ttl
+        uint16_t rdlength = dns_scan_word(&p);  // rdlength
+
+        if (end - p < rdlength) {
+            return false;
+        }
+
+        const uint8_t *rdata = p;
+        p += rdlength;
+
+        if (i >= ancount) {
+            // the soa minimum is the last field of its rdata
+            if (rtype == RR_SOA && rdlength >= 20) {
+                const uint8_t *minimum = rdata + rdlength - 4;
+                negative_ttl = dns_scan_dword(&minimum);
+                if (ttl < negative_ttl) {
+                    negative_ttl = ttl;
+                }
+            }
+            continue;
         }
 
-        uint16_t rtype    = dns_scan_word(p); // rtype
-        uint16_t rclass   = dns_scan_word(p); // rclass
-        *p += 4;                              // ttl
-        uint16_t rdlength = dns_scan_word(p); // rdlength
+        if (ttl < answer_ttl) {
+            answer_ttl = ttl;
+        }
 
         if (rtype == RR_A && rclass == CLASS_IN && rdlength == NSAPI_IPv4_BYTES) {
             // accept A record
-            addr->version = NSAPI_IPv4;
-            for (int i = 0; i < NSAPI_IPv4_BYTES; i++) {
-                addr->bytes[i] = dns_scan_byte(p);
+            if (res->count < addr_count) {
+                addr->version = NSAPI_IPv4;
+                memcpy(addr->bytes, rdata, NSAPI_IPv4_BYTES);
+                addr += 1;
+                res->count += 1;
             }
 
-            addr += 1;
-            count += 1;
+            res->total += 1;
         } else if (rtype == RR_AAAA && rclass == CLASS_IN && rdlength == NSAPI_IPv6_BYTES) {
             // accept AAAA record
-            addr->version = NSAPI_IPv6;
-            for (int i = 0; i < NSAPI_IPv6_BYTES; i++) {
-                addr->bytes[i] = dns_scan_byte(p);
+            if (res->count < addr_count) {
+                addr->version = NSAPI_IPv6;
+                memcpy(addr->bytes, rdata, NSAPI_IPv6_BYTES);
+                addr += 1;
+                res->count += 1;
             }
 
-            addr += 1;
-            count += 1;
+            res->total += 1;
+        }
+    }
+
+    res->ttl = res->total > 0 ? answer_ttl : negative_ttl;
+    if (res->ttl > DNS_CACHE_TTL_MAX) {
+        res->ttl = DNS_CACHE_TTL_MAX;
+    }
+
+    return true;
+}
+
+static bool dns_is_server(const SocketAddress &address)
+{
+    nsapi_addr_t addr = address.get_addr();
+    if (address.get_port() != 53) {
+        return false;
+    }
+
+    unsigned len = addr.version == NSAPI_IPv6 ? NSAPI_IPv6_BYTES : NSAPI_IPv4_BYTES;
+    for (unsigned i = 0; i < DNS_SERVERS_SIZE; i++) {
+        if (dns_servers[i].version == addr.version &&
+            memcmp(dns_servers[i].bytes, addr.bytes, len) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+// DNS cache, entries with a count of zero cache a failed lookup
+struct dns_cache_entry {
+    char *host;
+    nsapi_version_t version;
+    unsigned stamp;
+    uint32_t ttl;
+    uint8_t count;
+    bool complete;
+    nsapi_addr_t addrs[DNS_CACHE_ADDRS];
+};
+
+static struct dns_cache_entry dns_cache[DNS_CACHE_SIZE > 0 ? DNS_CACHE_SIZE : 1];
+static SingletonPtr<PlatformMutex> dns_cache_mutex;
+
+static bool dns_host_equal(const char *a, const char *b)
+{
+    while (*a && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
+    }
+
+    return *a == *b;
+}
+
+static nsapi_version_t dns_cache_version(nsapi_version_t version)
+{
+    // only ipv6 queries ask for AAAA records
+    return version == NSAPI_IPv6 ? NSAPI_IPv6 : NSAPI_IPv4;
+}
+
+static bool dns_cache_expired(const struct dns_cache_entry *entry, unsigned now)
+{
+    return !entry->host || now - entry->stamp >= entry->ttl*1000;
+}
+
+// Returns the number of cached addresses, NSAPI_ERROR_DNS_FAILURE if a
+// failed lookup is cached, or 0 if the host is not in the cache
+static nsapi_size_or_error_t dns_cache_find(const char *host, nsapi_version_t version,
+        nsapi_addr_t *addr, unsigned addr_count)
+{
+    nsapi_size_or_error_t result = 0;
+    unsigned now = dns_tick();
+    version = dns_cache_version(version);
+
+    dns_cache_mutex->lock();
+    for (unsigned i = 0; i < DNS_CACHE_SIZE; i++) {
+        struct dns_cache_entry *entry = &dns_cache[i];
+        if (dns_cache_expired(entry, now) ||
+            entry->version != version || !dns_host_equal(entry->host, host)) {
+            continue;
+        }
+
+        if (entry->count == 0) {
+            result = NSAPI_ERROR_DNS_FAILURE;
+        } else if (entry->complete || addr_count <= entry->count) {
+            result = addr_count < entry->count ? addr_count : entry->count;
+            memcpy(addr, entry->addrs, result*sizeof(nsapi_addr_t));
+        }
+        break;
+    }
+    dns_cache_mutex->unlock();
+
+    return result;
+}
+
+static void dns_cache_add(const char *host, nsapi_version_t version,
+        const struct dns_response *res, const nsapi_addr_t *addr)
+{
+    if (DNS_CACHE_SIZE == 0 || res->ttl == 0) {
+        return;
+    }
+
+    unsigned now = dns_tick();
+    version = dns_cache_version(version);
+
+    // replace the same host, an expired entry, or the entry closest to expiring
+    dns_cache_mutex->lock();
+    struct dns_cache_entry *entry = &dns_cache[0];
+    uint32_t entry_left = -1;
+    for (unsigned i = 0; i < DNS_CACHE_SIZE; i++) {
+        if (dns_cache_expired(&dns_cache[i], now)) {
+            entry = &dns_cache[i];
+            entry_left = 0;
+        } else if (dns_cache[i].version == version &&
+                   dns_host_equal(dns_cache[i].host, host)) {
+            entry = &dns_cache[i];
+            break;
         } else {
-            // skip unrecognized records
-            *p += rdlength;
+            uint32_t left = dns_cache[i].ttl*1000 - (now - dns_cache[i].stamp);
+            if (left < entry_left) {
+                entry = &dns_cache[i];
+                entry_left = left;
+            }
         }
     }
 
-    return count;
+    char *entry_host = new char[strlen(host) + 1];
+    strcpy(entry_host, host);
+    delete[] entry->host;
+
+    entry->host = entry_host;
+    entry->version = version;
+    entry->stamp = now;
+    entry->ttl = res->ttl;
+    entry->count = res->count < DNS_CACHE_ADDRS ? res->count : DNS_CACHE_ADDRS;
+    entry->complete = entry->count == res->total;
+    if (entry->count > 0) {
+        memcpy(entry->addrs, addr, entry->count*sizeof(nsapi_addr_t));
+    }
+    dns_cache_mutex->unlock();
 }
 
 // core query function
@@ -204,6 +416,12 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
         return NSAPI_ERROR_PARAMETER;
     }
 
+    // check for recent answers
+    nsapi_size_or_error_t result = dns_cache_find(host, version, addr, addr_count);
+    if (result != 0) {
+        return result;
+    }
+
     // create a udp socket
     UDPSocket socket;
     int err = socket.open(stack);
@@ -211,44 +429,69 @@ static nsapi_size_or_error_t nsapi_dns_query_multiple(NetworkStack *stack, const
         return err;
     }
 
-    socket.set_timeout(DNS_TIMEOUT);
-
     // create network packet
     uint8_t *packet = (uint8_t *)malloc(DNS_BUFFER_SIZE);
     if (!packet) {
+        socket.close();
         return NSAPI_ERROR_NO_MEMORY;
     }
 
-    nsapi_size_or_error_t result = NSAPI_ERROR_DNS_FAILURE;
+    static uint16_t dns_id = 0;
+    uint16_t id = ++dns_id ^ dns_tick();
 
-    // check against each dns server
-    for (unsigned i = 0; i < DNS_SERVERS_SIZE; i++) {
-        // send the question
-        uint8_t *question = packet;
-        dns_append_question(&question, host, version);
+    uint8_t *question = packet;
+    dns_append_question(&question, host, version, id);
+    nsapi_size_t question_len = question - packet;
 
-        err = socket.sendto(SocketAddress(dns_servers[i], 53), packet, DNS_BUFFER_SIZE);
+    // send the question to every dns server at once
+    unsigned pending = 0;
+    for (unsigned i = 0; i < DNS_SERVERS_SIZE; i++) {
+        err = socket.sendto(SocketAddress(dns_servers[i], 53), packet, question_len);
         // send may fail for various reasons, including wrong address type - move on
         if (err < 0) {
             continue;
         }
 
+        pending += 1;
+    }
+
+    result = NSAPI_ERROR_DNS_FAILURE;
+    unsigned start = dns_tick();
+
+    // the first final answer wins, server failures wait for the other servers
+    while (pending > 0) {
+        unsigned elapsed = dns_tick() - start;
+        if (elapsed >= DNS_TIMEOUT) {
+            break;
+        }
+
         // recv the response
-        err = socket.recvfrom(NULL, packet, DNS_BUFFER_SIZE);
+        SocketAddress from;
+        socket.set_timeout(DNS_TIMEOUT - elapsed);
+        err = socket.recvfrom(&from, packet, DNS_BUFFER_SIZE);
         if (err == NSAPI_ERROR_WOULD_BLOCK) {
-            continue;
+            break;
         } else if (err < 0) {
             result = err;
             break;
         }
 
-        const uint8_t *response = packet;
-        if (dns_scan_response(&response, addr, addr_count) > 0) {
-            result = NSAPI_ERROR_OK;
+        struct dns_response res;
+        if (!dns_is_server(from) ||
+            !dns_scan_response(packet, packet + err, id, &res, addr, addr_count)) {
+            continue;
         }
 
-        /* The DNS response is final, no need to check other servers */
-        break;
+        pending -= 1;
+        if (res.rcode == 0 && res.count > 0) {
+            dns_cache_add(host, version, &res, addr);
+            result = res.count;
+            break;
+        } else if (res.rcode == 0 || res.rcode == RCODE_NXDOMAIN) {
+            /* The DNS response is final, no need to wait for other servers */
+            dns_cache_add(host, version, &res, addr);
+            break;
+        }
     }
 
     // clean up packet
@@ -0,0 +1,89 @@
+/* nsapi_poll.cpp
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "nsapi_poll.h"
+#include "netsocket/Socket.h"
+#include "Timer.h"
+#include "cmsis_os.h"
+
+
+nsapi_size_or_error_t nsapi_poll(nsapi_pollsock_t *socks, unsigned count, int timeout)
+{
+    osThreadId self = osThreadGetId();
+    osSignalClear(self, NSAPI_POLL_SIGNAL);
+
+    // Register with the sockets before checking them, so an event that
+    // races with the check still wakes us up
+    for (unsigned i = 0; i < count; i++) {
+        if (socks[i].socket) {
+            socks[i].socket->_poller = self;
+        }
+    }
+
+    mbed::Timer timer;
+    timer.start();
+
+    nsapi_size_or_error_t ready;
+    while (true) {
+        ready = 0;
+        for (unsigned i = 0; i < count; i++) {
+            Socket *socket = socks[i].socket;
+            socks[i].revents = 0;
+
+            if (!socket) {
+                continue;
+            } else if (!socket->_socket) {
+                socks[i].revents = NSAPI_POLLNVAL;
+            } else {
+                if (socket->_read_pending) {
+                    socks[i].revents |= socks[i].events & NSAPI_POLLIN;
+                }
+                if (socket->_write_pending) {
+                    socks[i].revents |= socks[i].events & NSAPI_POLLOUT;
+                }
+            }
+
+            if (socks[i].revents) {
+                ready += 1;
+            }
+        }
+
+        if (ready || timeout == 0) {
+            break;
+        }
+
+        uint32_t wait = osWaitForever;
+        if (timeout > 0) {
+            int elapsed = timer.read_ms();
+            if (elapsed >= timeout) {
+                break;
+            }
+
+            wait = timeout - elapsed;
+        }
+
+        // Woken up by a socket event or the timeout, either way
+        // the sockets are checked again
+        osSignalWait(NSAPI_POLL_SIGNAL, wait);
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        if (socks[i].socket && socks[i].socket->_poller == self) {
+            socks[i].socket->_poller = 0;
+        }
+    }
+
+    return ready;
+}
@@ -0,0 +1,105 @@
+/** \addtogroup netsocket */
+/** @{*/
+/* nsapi_poll.h
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NSAPI_POLL_H
+#define NSAPI_POLL_H
+
+#include "nsapi_types.h"
+
+class Socket;
+
+
+/** Signal used to wake a thread blocked in nsapi_poll
+ *
+ *  This signal flag is reserved in threads that call nsapi_poll.
+ */
+#define NSAPI_POLL_SIGNAL 0x8000
+
+/** Enum of events reported by nsapi_poll
+ *
+ *  @enum nsapi_poll_event_t
+ */
+typedef enum nsapi_poll_event {
+    NSAPI_POLLIN   = 0x01, /*!< Socket may be ready to recv or accept */
+    NSAPI_POLLOUT  = 0x04, /*!< Socket may be ready to send */
+    NSAPI_POLLNVAL = 0x20, /*!< Socket is not open */
+} nsapi_poll_event_t;
+
+/** nsapi_pollsock structure
+ *
+ *  Socket to wait on with nsapi_poll
+ */
+typedef struct nsapi_pollsock {
+    /** Socket to wait on, ignored if NULL
+     */
+    Socket *socket;
+
+    /** Bitmask of requested nsapi_poll_event_t
+     */
+    short events;
+
+    /** Bitmask of nsapi_poll_event_t that occured, set by nsapi_poll
+     */
+    short revents;
+} nsapi_pollsock_t;
+
+
+/** Wait for events on multiple sockets
+ *
+ *  Blocks until an event occurs on one of the sockets, letting a single
+ *  thread serve many non-blocking sockets. Events are built on the
+ *  sockets' state change callbacks, so readiness is edge-triggered:
+ *
+ *  - NSAPI_POLLIN is reported from a state change until recv, recvfrom
+ *    or accept returns NSAPI_ERROR_WOULD_BLOCK, and NSAPI_POLLOUT until
+ *    send, sendto or connect would block.
+ *  - The socket should be used until an operation would block, otherwise
+ *    buffered data may not cause another event. Newly opened and accepted
+ *    sockets are reported as ready for both.
+ *  - State changes do not say whether they are for reading or writing,
+ *    so events may be reported spuriously.
+ *
+ *  Only one thread may poll a socket at a time.
+ *
+ *  @code
+ *  nsapi_pollsock_t socks[] = {
+ *      {&server, NSAPI_POLLIN},
+ *      {&client, NSAPI_POLLIN},
+ *  };
+ *
+ *  while (nsapi_poll(socks, 2, -1) >= 0) {
+ *      if (socks[1].revents & NSAPI_POLLIN) {
+ *          while ((size = client.recv(buffer, sizeof buffer)) > 0) {
+ *              // ...
+ *          }
+ *      }
+ *  }
+ *  @endcode
+ *
+ *  @param socks    Array of sockets to wait on
+ *  @param count    Number of sockets in the array
+ *  @param timeout  Timeout in milliseconds, 0 to return immediately
+ *                  or negative to wait forever
+ *  @return         Number of sockets with events, 0 on timeout,
+ *                  negative error code on failure
+ */
+nsapi_size_or_error_t nsapi_poll(nsapi_pollsock_t *socks, unsigned count, int timeout);
+
+
+#endif
+
+/** @}*/
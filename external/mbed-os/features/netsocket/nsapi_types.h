@@ -151,6 +151,43 @@ typedef struct nsapi_addr {
 typedef void *nsapi_socket_t;
 
 
+/** nsapi_iovec structure
+ *
+ *  Describes one of the buffers gathered by a vectored send
+ */
+typedef struct nsapi_iovec {
+    const void *data;
+    nsapi_size_t size;
+} nsapi_iovec_t;
+
+/** Enum of flags for vectored sends
+ *
+ *  @enum nsapi_send_flags_t
+ */
+typedef enum nsapi_send_flags {
+    NSAPI_SEND_NOCOPY = 0x1, /*!< Data may be referenced by the stack while a UDP packet is sent */
+} nsapi_send_flags_t;
+
+/** nsapi_buffer structure
+ *
+ *  Received data loaned out by the stack, the data stays valid
+ *  until the buffer is released back to the stack
+ */
+typedef struct nsapi_buffer {
+    const void *data;
+    nsapi_size_t size;
+
+    /** Stack-specific handle of the loaned data
+     */
+    void *handle;
+
+    /** Stack that loaned the data, the buffer is released
+     *  through it even after the socket is closed
+     */
+    void *stack;
+} nsapi_buffer_t;
+
+
 /** Enum of socket protocols
  *
  *  The socket protocol specifies a particular protocol to
@@ -539,6 +576,92 @@ typedef struct nsapi_stack_api
      */    
     nsapi_error_t (*getsockopt)(nsapi_stack_t *stack, nsapi_socket_t socket, int level,
             int optname, void *optval, unsigned *optlen);
+
+    /** Send data gathered from multiple buffers over a TCP socket
+     *
+     *  The socket must be connected to a remote host. Returns the number of
+     *  bytes sent from the buffers, in order.
+     *
+     *  This call is non-blocking. If send would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param iov      Array of buffers to send to the host
+     *  @param count    Number of buffers in the array
+     *  @param flags    Bitmask of nsapi_send_flags_t
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t (*socket_sendv)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            const nsapi_iovec_t *iov, unsigned count, int flags);
+
+    /** Receive data over a TCP socket without copying
+     *
+     *  The socket must be connected to a remote host. Loans out the next
+     *  contiguous chunk of received data, which must be released with
+     *  socket_free_buffer. Returns the number of bytes in the buffer.
+     *
+     *  This call is non-blocking. If recv would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param buffer   Destination for the loaned buffer
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t (*socket_recv_buffer)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_buffer_t *buffer);
+
+    /** Send a packet gathered from multiple buffers over a UDP socket
+     *
+     *  Sends the buffers as a single packet to the specified address.
+     *  Returns the number of bytes sent from the buffers.
+     *
+     *  This call is non-blocking. If sendto would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param addr     The address of the remote host
+     *  @param port     The port of the remote host
+     *  @param iov      Array of buffers to send to the host
+     *  @param count    Number of buffers in the array
+     *  @param flags    Bitmask of nsapi_send_flags_t
+     *  @return         Number of sent bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t (*socket_sendtov)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_addr_t addr, uint16_t port, const nsapi_iovec_t *iov, unsigned count, int flags);
+
+    /** Receive a packet over a UDP socket without copying
+     *
+     *  Loans out the next packet as a single contiguous buffer, which must
+     *  be released with socket_free_buffer. Stores the source address in
+     *  address if address is not NULL. Returns the number of bytes in the
+     *  buffer.
+     *
+     *  This call is non-blocking. If recvfrom would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param addr     Destination for the address of the remote host
+     *  @param port     Destination for the port of the remote host
+     *  @param buffer   Destination for the loaned buffer
+     *  @return         Number of received bytes on success, negative error
+     *                  code on failure
+     */
+    nsapi_size_or_error_t (*socket_recvfrom_buffer)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_addr_t *addr, uint16_t *port, nsapi_buffer_t *buffer);
+
+    /** Release a buffer loaned out by socket_recv_buffer or socket_recvfrom_buffer
+     *
+     *  @param stack    Stack handle
+     *  @param buffer   Buffer to release
+     */
+    void (*socket_free_buffer)(nsapi_stack_t *stack, nsapi_buffer_t *buffer);
 } nsapi_stack_api_t;
 
 
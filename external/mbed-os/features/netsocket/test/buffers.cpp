@@ -0,0 +1,172 @@
+/*
+ * Host test of vectored sends and loaned receive buffers
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Sends gathered buffers with TCPSocket::send and UDPSocket::sendto over
+ * loopback, receives them with recv_buffer and recvfrom_buffer, and checks
+ * every loaned buffer is released by Socket::free_buffer, including after
+ * the socket that loaned it is gone.
+ */
+#include "host_stack.h"
+#include "netsocket/TCPServer.h"
+#include "netsocket/TCPSocket.h"
+#include "netsocket/UDPSocket.h"
+#include "host_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TCP_PORT 7001
+#define UDP_PORT 7002
+
+
+// Test
+// A message gathered from a header, an empty buffer and a body
+static uint8_t header[16];
+static uint8_t body[1000];
+static const nsapi_iovec_t message[] = {
+    {header, sizeof(header)},
+    {body, 0},
+    {body, sizeof(body)},
+};
+#define MESSAGE_SIZE (sizeof(header) + sizeof(body))
+
+static bool is_message(const uint8_t *data, nsapi_size_t offset, nsapi_size_t size)
+{
+    for (nsapi_size_t i = 0; i < size; i++, offset++) {
+        nsapi_size_t at = offset % MESSAGE_SIZE;
+        uint8_t expected = at < sizeof(header) ? header[at] : body[at - sizeof(header)];
+        if (data[i] != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_tcp(HostStack *host)
+{
+    NetworkStack *stack = host;
+    TCPServer server;
+    TCPSocket client, connection;
+    check(server.open(stack) == 0);
+    check(server.bind("127.0.0.1", TCP_PORT) == 0);
+    check(server.listen(1) == 0);
+    check(client.open(stack) == 0);
+    check(client.connect(SocketAddress("127.0.0.1", TCP_PORT)) == 0);
+    check(server.accept(&connection) == 0);
+
+    // Each buffer is sent in order and empty buffers are skipped
+    check(client.send(message, 3) == (nsapi_size_or_error_t)MESSAGE_SIZE);
+    check(client.send(message, 3, NSAPI_SEND_NOCOPY) == (nsapi_size_or_error_t)MESSAGE_SIZE);
+
+    // The loaned chunks hold the stream, and are all released
+    nsapi_size_t received = 0;
+    bool same = true;
+    connection.set_timeout(1000);
+    while (received < 2*MESSAGE_SIZE) {
+        nsapi_buffer_t buffer;
+        nsapi_size_or_error_t size = connection.recv_buffer(&buffer);
+        check(size > 0);
+        if (size <= 0) {
+            break;
+        }
+        check(buffer.stack == stack && buffer.size == (nsapi_size_t)size);
+        same = same && is_message((const uint8_t *)buffer.data, received, size);
+        received += size;
+        Socket::free_buffer(&buffer);
+        check(!buffer.data && !buffer.size && !buffer.handle && !buffer.stack);
+    }
+    check(same);
+    check(received == 2*MESSAGE_SIZE);
+    check(host->loans == 0);
+
+    // Nothing left to loan
+    nsapi_buffer_t buffer;
+    connection.set_blocking(false);
+    check(connection.recv_buffer(&buffer) == NSAPI_ERROR_WOULD_BLOCK);
+
+    // A buffer outlives the socket that loaned it
+    check(client.send(message, 3) == (nsapi_size_or_error_t)MESSAGE_SIZE);
+    connection.set_timeout(1000);
+    check(connection.recv_buffer(&buffer) > 0);
+    check(host->loans == 1);
+    check(connection.close() == 0);
+    Socket::free_buffer(&buffer);
+    check(host->loans == 0);
+
+    // Releasing again, or releasing an empty buffer, does nothing
+    Socket::free_buffer(&buffer);
+    nsapi_buffer_t empty = {0};
+    Socket::free_buffer(&empty);
+    check(host->loans == 0);
+
+    check(client.close() == 0);
+    check(server.close() == 0);
+}
+
+static void test_udp(HostStack *host)
+{
+    NetworkStack *stack = host;
+    UDPSocket sender, receiver;
+    check(sender.open(stack) == 0);
+    check(receiver.open(stack) == 0);
+    check(receiver.bind("127.0.0.1", UDP_PORT) == 0);
+    check(sender.bind("127.0.0.1", UDP_PORT + 1) == 0);
+
+    // The buffers are gathered into a single packet
+    SocketAddress to("127.0.0.1", UDP_PORT);
+    check(sender.sendto(to, message, 3) == (nsapi_size_or_error_t)MESSAGE_SIZE);
+    check(sender.sendto(to, message, 3, NSAPI_SEND_NOCOPY) == (nsapi_size_or_error_t)MESSAGE_SIZE);
+
+    // Each packet is loaned whole with its source address
+    receiver.set_timeout(1000);
+    for (int i = 0; i < 2; i++) {
+        nsapi_buffer_t buffer;
+        SocketAddress from;
+        check(receiver.recvfrom_buffer(&from, &buffer) == (nsapi_size_or_error_t)MESSAGE_SIZE);
+        check(buffer.stack == stack);
+        check(is_message((const uint8_t *)buffer.data, 0, buffer.size));
+        check(from == SocketAddress("127.0.0.1", UDP_PORT + 1));
+        Socket::free_buffer(&buffer);
+    }
+    check(host->loans == 0);
+
+    // The source address is optional, and the buffer outlives the socket
+    nsapi_buffer_t buffer;
+    check(sender.sendto(to, message, 3) == (nsapi_size_or_error_t)MESSAGE_SIZE);
+    check(receiver.recvfrom_buffer(NULL, &buffer) == (nsapi_size_or_error_t)MESSAGE_SIZE);
+    check(receiver.close() == 0);
+    check(host->loans == 1);
+    Socket::free_buffer(&buffer);
+    check(host->loans == 0);
+
+    check(sender.close() == 0);
+}
+
+int main()
+{
+    for (unsigned i = 0; i < sizeof(header); i++) {
+        header[i] = 0xa0 + i;
+    }
+    for (unsigned i = 0; i < sizeof(body); i++) {
+        body[i] = i * 7;
+    }
+
+    HostStack stack;
+    test_tcp(&stack);
+    test_udp(&stack);
+
+    return host_test_done();
+}
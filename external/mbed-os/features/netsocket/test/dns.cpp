@@ -0,0 +1,136 @@
+/*
+ * Host test of the nsapi DNS resolver against local DNS servers
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Five servers stand in for the configured DNS servers, on loopback
+ * addresses with port 53 redirected: dead, slow (1s), SERVFAIL, fast and
+ * dead again. The question goes to all of them at once and the fast
+ * answer wins, answers are cached for their ttl, and a lookup with no
+ * final answer is bounded by the single 5s DNS timeout.
+ */
+#include "host_stack.h"
+#include "dns_server.h"
+#include "nsapi_dns.h"
+#include "host_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DNS_PORT 5353
+
+
+// Test
+static const char *const server_ips[] = {
+    "127.0.0.2", "127.0.0.3", "127.0.0.4", "127.0.0.5", "127.0.0.6",
+};
+
+static DnsServer *servers[5];
+
+static unsigned now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Looks up host and reports the time and questions it took
+static nsapi_size_or_error_t lookup(HostStack *stack, const char *host,
+        SocketAddress *addrs, unsigned count, unsigned *ms, unsigned *asked)
+{
+    unsigned packets = stack->packets;
+    unsigned bytes = stack->bytes;
+    unsigned start = now_ms();
+    nsapi_size_or_error_t result = nsapi_dns_query_multiple(
+            static_cast<NetworkStack *>(stack), host, addrs, count);
+    *ms = now_ms() - start;
+    *asked = stack->packets - packets;
+
+    printf("%-22s %6d, %4u ms, %u x %uB questions\n", host, result, *ms,
+            *asked, *asked ? (stack->bytes - bytes) / *asked : 0);
+    return result;
+}
+
+int main()
+{
+    servers[0] = new DnsServer(server_ips[0], DNS_PORT, DNS_SERVER_DEAD);
+    servers[1] = new DnsServer(server_ips[1], DNS_PORT, DNS_SERVER_ANSWER, 1000);
+    servers[2] = new DnsServer(server_ips[2], DNS_PORT, DNS_SERVER_SERVFAIL);
+    servers[3] = new DnsServer(server_ips[3], DNS_PORT, DNS_SERVER_ANSWER);
+    servers[4] = new DnsServer(server_ips[4], DNS_PORT, DNS_SERVER_DEAD);
+
+    // Adding puts each server first, so add them in reverse
+    for (int i = 4; i >= 0; i--) {
+        nsapi_addr_t addr = SocketAddress(server_ips[i]).get_addr();
+        check(nsapi_dns_add_server(addr) == 0);
+    }
+
+    HostStack stack;
+    stack.redirect(53, DNS_PORT);
+
+    SocketAddress addrs[3];
+    unsigned ms, asked;
+
+    // The first lookup asks every server with a single short question
+    check(lookup(&stack, "host.example.com", addrs, 1, &ms, &asked) == 1);
+    check(strcmp(addrs[0].get_ip_address(), "10.0.0.1") == 0);
+    check(ms < 500);
+    check(asked == 5);
+    check(stack.bytes == 5 * (12 + strlen("host.example.com") + 2 + 4));
+
+    // Repeats come from the cache, whatever the case
+    check(lookup(&stack, "host.example.com", addrs, 1, &ms, &asked) == 1);
+    check(asked == 0 && ms < 10);
+    check(lookup(&stack, "HOST.Example.com", addrs, 1, &ms, &asked) == 1);
+    check(asked == 0 && ms < 10);
+
+    // Negative answers are cached too
+    check(lookup(&stack, "nx.example.com", addrs, 1, &ms, &asked) == NSAPI_ERROR_DNS_FAILURE);
+    check(asked == 5 && ms < 500);
+    check(lookup(&stack, "nx.example.com", addrs, 1, &ms, &asked) == NSAPI_ERROR_DNS_FAILURE);
+    check(asked == 0 && ms < 10);
+
+    // A cached answer missing records is fetched again for more addresses
+    check(lookup(&stack, "multi.example.com", addrs, 1, &ms, &asked) == 1);
+    check(asked == 5);
+    check(lookup(&stack, "multi.example.com", addrs, 1, &ms, &asked) == 1);
+    check(asked == 0);
+    check(lookup(&stack, "multi.example.com", addrs, 3, &ms, &asked) == 3);
+    check(asked == 5);
+    check(strcmp(addrs[2].get_ip_address(), "10.0.0.3") == 0);
+    check(lookup(&stack, "multi.example.com", addrs, 3, &ms, &asked) == 3);
+    check(asked == 0);
+
+    // Expired answers are asked for again
+    check(lookup(&stack, "short.example.com", addrs, 1, &ms, &asked) == 1);
+    check(asked == 5);
+    usleep(1100*1000);
+    check(lookup(&stack, "short.example.com", addrs, 1, &ms, &asked) == 1);
+    check(asked == 5);
+
+    // With no final answer the lookup waits out the timeout once
+    check(lookup(&stack, "servfail.example.com", addrs, 1, &ms, &asked) == NSAPI_ERROR_DNS_FAILURE);
+    check(asked == 5);
+    check(ms >= 4900 && ms < 5500);
+
+    // Every server heard every question
+    usleep(1100*1000);
+    for (int i = 0; i < 5; i++) {
+        check(servers[i]->questions == stack.packets / 5);
+        delete servers[i];
+    }
+
+    return host_test_done();
+}
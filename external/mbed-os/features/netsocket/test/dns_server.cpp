@@ -0,0 +1,167 @@
+/* Local DNS server stand-in
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "dns_server.h"
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define RCODE_SERVFAIL  2
+#define RCODE_NXDOMAIN  3
+
+#define RR_A    1
+#define RR_SOA  6
+
+static void put_word(uint8_t **p, uint16_t word)
+{
+    *(*p)++ = word >> 8;
+    *(*p)++ = word;
+}
+
+static void put_dword(uint8_t **p, uint32_t dword)
+{
+    put_word(p, dword >> 16);
+    put_word(p, dword);
+}
+
+// Resource record naming the question, by a pointer to offset 12
+static void put_record(uint8_t **p, uint16_t type, uint32_t ttl, uint16_t rdlength)
+{
+    put_word(p, 0xc00c);
+    put_word(p, type);
+    put_word(p, 1);
+    put_dword(p, ttl);
+    put_word(p, rdlength);
+}
+
+DnsServer::DnsServer(const char *ip, uint16_t port, dns_server_mode mode, unsigned delay_ms)
+    : questions(0), _mode(mode), _delay_ms(delay_ms)
+{
+    struct sockaddr_in sin;
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+    inet_pton(AF_INET, ip, &sin.sin_addr);
+
+    _fd = socket(AF_INET, SOCK_DGRAM, 0);
+    int one = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    bind(_fd, (struct sockaddr *)&sin, sizeof(sin));
+    pthread_create(&_thread, NULL, run, this);
+}
+
+DnsServer::~DnsServer()
+{
+    shutdown(_fd, SHUT_RDWR);
+    pthread_join(_thread, NULL);
+    close(_fd);
+}
+
+// Turns the question into its answer, returning the answer's size
+unsigned DnsServer::answer(uint8_t *packet, unsigned size)
+{
+    // The question name starts after the header, with its first label
+    const uint8_t *name = &packet[12];
+    const uint8_t *end = name;
+    while (end < packet + size && *end) {
+        end += *end + 1;
+    }
+    if (end + 5 > packet + size) {
+        return 0;
+    }
+    uint8_t *p = (uint8_t *)end + 5;
+
+#define LABEL(s) (name[0] == sizeof(s) - 1 && memcmp(&name[1], s, sizeof(s) - 1) == 0)
+    uint8_t rcode = 0;
+    unsigned records = 1;
+    uint32_t ttl = 300;
+    if (_mode == DNS_SERVER_SERVFAIL || LABEL("servfail")) {
+        rcode = RCODE_SERVFAIL;
+        records = 0;
+    } else if (LABEL("nx")) {
+        rcode = RCODE_NXDOMAIN;
+        records = 0;
+    } else if (LABEL("multi")) {
+        records = 3;
+    } else if (LABEL("short")) {
+        ttl = 1;
+    }
+#undef LABEL
+
+    packet[2] = 0x81;           // response, recursion desired
+    packet[3] = 0x80 | rcode;   // recursion available
+    packet[6] = 0;
+    packet[7] = records;        // ancount
+    packet[8] = 0;
+    packet[9] = rcode == RCODE_NXDOMAIN; // nscount
+    packet[10] = 0;
+    packet[11] = 0;
+
+    for (unsigned i = 0; i < records; i++) {
+        put_record(&p, RR_A, ttl, 4);
+        *p++ = 10;
+        *p++ = 0;
+        *p++ = 0;
+        *p++ = i + 1;
+    }
+
+    if (rcode == RCODE_NXDOMAIN) {
+        // Root mname and rname, then serial, refresh, retry, expire, minimum
+        put_record(&p, RR_SOA, 3600, 22);
+        *p++ = 0;
+        *p++ = 0;
+        put_dword(&p, 1);
+        put_dword(&p, 3600);
+        put_dword(&p, 600);
+        put_dword(&p, 86400);
+        put_dword(&p, 60);
+    }
+
+    return p - packet;
+}
+
+void *DnsServer::run(void *arg)
+{
+    DnsServer *server = static_cast<DnsServer *>(arg);
+    uint8_t packet[512];
+
+    while (true) {
+        struct sockaddr_in from;
+        socklen_t len = sizeof(from);
+        ssize_t size = recvfrom(server->_fd, packet, sizeof(packet) - 64, 0,
+                (struct sockaddr *)&from, &len);
+        if (size <= 0) {
+            break;
+        }
+
+        server->questions++;
+        if (server->_mode == DNS_SERVER_DEAD) {
+            continue;
+        }
+
+        if (server->_delay_ms) {
+            usleep(server->_delay_ms * 1000);
+        }
+
+        unsigned answer = server->answer(packet, size);
+        if (answer) {
+            sendto(server->_fd, packet, answer, 0, (struct sockaddr *)&from, len);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/* Local DNS server stand-in
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef DNS_SERVER_H
+#define DNS_SERVER_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+/** Behaviour of a DNS server stand-in */
+enum dns_server_mode {
+    DNS_SERVER_DEAD,        /*!< Receives questions but never answers */
+    DNS_SERVER_SERVFAIL,    /*!< Answers every question with SERVFAIL */
+    DNS_SERVER_ANSWER,      /*!< Answers after the configured delay */
+};
+
+/** DNS server on a loopback address, answering A questions
+ *
+ *  The answer depends on the first label of the question:
+ *  - "nx" gives NXDOMAIN, with an SOA minimum of 60s
+ *  - "servfail" gives SERVFAIL
+ *  - "multi" gives three A records, 10.0.0.1 to 10.0.0.3
+ *  - "short" gives one A record with a ttl of 1s
+ *  - anything else gives one A record, 10.0.0.1, with a ttl of 300s
+ */
+class DnsServer {
+public:
+    /** Start a server on ip:port
+     *
+     *  @param ip       Loopback address, such as "127.0.0.2"
+     *  @param port     UDP port
+     *  @param mode     How the server answers
+     *  @param delay_ms Delay before each answer
+     */
+    DnsServer(const char *ip, uint16_t port, dns_server_mode mode, unsigned delay_ms = 0);
+    ~DnsServer();
+
+    /** Number of questions received */
+    volatile unsigned questions;
+
+private:
+    static void *run(void *server);
+    unsigned answer(uint8_t *packet, unsigned size);
+
+    int _fd;
+    dns_server_mode _mode;
+    unsigned _delay_ms;
+    pthread_t _thread;
+};
+
+#endif
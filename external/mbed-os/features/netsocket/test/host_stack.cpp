@@ -0,0 +1,465 @@
+/* NetworkStack over the host's sockets
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "host_stack.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#define HOST_SOCKETS_MAX 64
+#define HOST_BUFFER_SIZE 2048
+
+struct HostStack::host_socket {
+    int fd;
+    nsapi_protocol_t proto;
+    bool read;
+    bool write;
+    void (*callback)(void *);
+    void *data;
+    host_socket *next;
+};
+
+static nsapi_error_t host_error(int err)
+{
+    switch (err) {
+        case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+        case EWOULDBLOCK:
+#endif
+            return NSAPI_ERROR_WOULD_BLOCK;
+        case EINPROGRESS:
+            return NSAPI_ERROR_IN_PROGRESS;
+        case EALREADY:
+            return NSAPI_ERROR_ALREADY;
+        case EISCONN:
+            return NSAPI_ERROR_IS_CONNECTED;
+        case ENOTCONN:
+            return NSAPI_ERROR_NO_CONNECTION;
+        case ENOMEM:
+        case ENOBUFS:
+            return NSAPI_ERROR_NO_MEMORY;
+        case EADDRINUSE:
+            return NSAPI_ERROR_PARAMETER;
+        default:
+            return NSAPI_ERROR_DEVICE_ERROR;
+    }
+}
+
+HostStack::HostStack()
+    : events(0), packets(0), bytes(0), loans(0), _sockets(0), _running(true), _port(0), _host_port(0)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_mutex_init(&_callback_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    pipe(_wake);
+    fcntl(_wake[0], F_SETFL, O_NONBLOCK);
+    pthread_create(&_thread, NULL, run, this);
+}
+
+HostStack::~HostStack()
+{
+    pthread_mutex_lock(&_mutex);
+    _running = false;
+    pthread_mutex_unlock(&_mutex);
+    write(_wake[1], "", 1);
+    pthread_join(_thread, NULL);
+
+    while (_sockets) {
+        socket_close(_sockets);
+    }
+
+    close(_wake[0]);
+    close(_wake[1]);
+    pthread_mutex_destroy(&_callback_mutex);
+    pthread_mutex_destroy(&_mutex);
+}
+
+void HostStack::redirect(uint16_t port, uint16_t host_port)
+{
+    _port = port;
+    _host_port = host_port;
+}
+
+const char *HostStack::get_ip_address()
+{
+    return "127.0.0.1";
+}
+
+nsapi_error_t HostStack::address(const SocketAddress &address, struct sockaddr_in *sin)
+{
+    if (address.get_ip_version() != NSAPI_IPv4) {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    uint16_t port = address.get_port();
+    if (_port && port == _port) {
+        port = _host_port;
+    }
+
+    memset(sin, 0, sizeof(*sin));
+    sin->sin_family = AF_INET;
+    sin->sin_port = htons(port);
+    memcpy(&sin->sin_addr, address.get_ip_bytes(), NSAPI_IPv4_BYTES);
+    return NSAPI_ERROR_OK;
+}
+
+void HostStack::address(const struct sockaddr_in *sin, SocketAddress *address)
+{
+    uint16_t port = ntohs(sin->sin_port);
+    if (_port && port == _host_port) {
+        port = _port;
+    }
+
+    address->set_ip_bytes(&sin->sin_addr, NSAPI_IPv4);
+    address->set_port(port);
+}
+
+HostStack::host_socket *HostStack::add(int fd, nsapi_protocol_t proto)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    if (proto == NSAPI_TCP) {
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    host_socket *s = new host_socket;
+    s->fd = fd;
+    s->proto = proto;
+    s->read = true;
+    s->write = false;
+    s->callback = 0;
+    s->data = 0;
+
+    pthread_mutex_lock(&_mutex);
+    s->next = _sockets;
+    _sockets = s;
+    pthread_mutex_unlock(&_mutex);
+    write(_wake[1], "", 1);
+    return s;
+}
+
+// Poll the socket again for the directions it has been used in
+void HostStack::arm(host_socket *s, bool read, bool write)
+{
+    pthread_mutex_lock(&_mutex);
+    bool changed = (read && !s->read) || (write && !s->write);
+    s->read = s->read || read;
+    s->write = s->write || write;
+    pthread_mutex_unlock(&_mutex);
+
+    if (changed) {
+        ::write(_wake[1], "", 1);
+    }
+}
+
+void *HostStack::run(void *arg)
+{
+    HostStack *stack = static_cast<HostStack *>(arg);
+    struct pollfd fds[HOST_SOCKETS_MAX + 1];
+    host_socket *sockets[HOST_SOCKETS_MAX + 1];
+
+    while (true) {
+        pthread_mutex_lock(&stack->_mutex);
+        if (!stack->_running) {
+            pthread_mutex_unlock(&stack->_mutex);
+            break;
+        }
+
+        fds[0].fd = stack->_wake[0];
+        fds[0].events = POLLIN;
+        unsigned count = 1;
+        for (host_socket *s = stack->_sockets; s && count < HOST_SOCKETS_MAX + 1; s = s->next) {
+            if (s->read || s->write) {
+                sockets[count] = s;
+                fds[count].fd = s->fd;
+                fds[count].events = (s->read ? POLLIN : 0) | (s->write ? POLLOUT : 0);
+                count++;
+            }
+        }
+        pthread_mutex_unlock(&stack->_mutex);
+
+        poll(fds, count, -1);
+
+        char drain[16];
+        while (read(stack->_wake[0], drain, sizeof(drain)) > 0);
+
+        // Signal each ready socket once per direction, sockets closed
+        // meanwhile are skipped under the callback lock
+        pthread_mutex_lock(&stack->_callback_mutex);
+        for (unsigned i = 1; i < count; i++) {
+            if (!fds[i].revents) {
+                continue;
+            }
+
+            pthread_mutex_lock(&stack->_mutex);
+            host_socket *s = stack->_sockets;
+            while (s && s != sockets[i]) {
+                s = s->next;
+            }
+            bool signal = false;
+            if (s && s->fd == fds[i].fd) {
+                if (fds[i].revents & (POLLIN | POLLERR | POLLHUP)) {
+                    signal = signal || s->read;
+                    s->read = false;
+                }
+                if (fds[i].revents & (POLLOUT | POLLERR | POLLHUP)) {
+                    signal = signal || s->write;
+                    s->write = false;
+                }
+            }
+            void (*callback)(void *) = s ? s->callback : 0;
+            void *data = s ? s->data : 0;
+            pthread_mutex_unlock(&stack->_mutex);
+
+            if (signal && callback) {
+                stack->events++;
+                callback(data);
+            }
+        }
+        pthread_mutex_unlock(&stack->_callback_mutex);
+    }
+
+    return 0;
+}
+
+nsapi_error_t HostStack::socket_open(nsapi_socket_t *handle, nsapi_protocol_t proto)
+{
+    int fd = socket(AF_INET, proto == NSAPI_TCP ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return NSAPI_ERROR_NO_SOCKET;
+    }
+
+    *handle = add(fd, proto);
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t HostStack::socket_close(nsapi_socket_t handle)
+{
+    host_socket *s = static_cast<host_socket *>(handle);
+
+    pthread_mutex_lock(&_mutex);
+    host_socket **p = &_sockets;
+    while (*p != s) {
+        p = &(*p)->next;
+    }
+    *p = s->next;
+    pthread_mutex_unlock(&_mutex);
+
+    // Wait out a callback in progress
+    pthread_mutex_lock(&_callback_mutex);
+    close(s->fd);
+    delete s;
+    pthread_mutex_unlock(&_callback_mutex);
+
+    write(_wake[1], "", 1);
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t HostStack::socket_bind(nsapi_socket_t handle, const SocketAddress &addr)
+{
+    host_socket *s = static_cast<host_socket *>(handle);
+    struct sockaddr_in sin;
+    nsapi_error_t err = address(addr, &sin);
+    if (err) {
+        return err;
+    }
+
+    int one = 1;
+    ::setsockopt(s->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::bind(s->fd, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
+        return host_error(errno);
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t HostStack::socket_listen(nsapi_socket_t handle, int backlog)
+{
+    host_socket *s = static_cast<host_socket *>(handle);
+    if (::listen(s->fd, backlog) < 0) {
+        return host_error(errno);
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t HostStack::socket_connect(nsapi_socket_t handle, const SocketAddress &addr)
+{
+    host_socket *s = static_cast<host_socket *>(handle);
+    struct sockaddr_in sin;
+    nsapi_error_t err = address(addr, &sin);
+    if (err) {
+        return err;
+    }
+
+    if (::connect(s->fd, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
+        err = host_error(errno);
+        if (err == NSAPI_ERROR_IN_PROGRESS || err == NSAPI_ERROR_ALREADY) {
+            arm(s, false, true);
+        }
+        return err;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_error_t HostStack::socket_accept(nsapi_socket_t server,
+        nsapi_socket_t *handle, SocketAddress *addr)
+{
+    host_socket *s = static_cast<host_socket *>(server);
+    struct sockaddr_in sin;
+    socklen_t len = sizeof(sin);
+    int fd = ::accept(s->fd, (struct sockaddr *)&sin, &len);
+    arm(s, true, false);
+    if (fd < 0) {
+        return host_error(errno);
+    }
+
+    *handle = add(fd, NSAPI_TCP);
+    if (addr) {
+        address(&sin, addr);
+    }
+    return NSAPI_ERROR_OK;
+}
+
+nsapi_size_or_error_t HostStack::socket_send(nsapi_socket_t handle,
+        const void *data, nsapi_size_t size)
+{
+    host_socket *s = static_cast<host_socket *>(handle);
+    ssize_t sent = ::send(s->fd, data, size, MSG_NOSIGNAL);
+    if (sent < 0) {
+        nsapi_error_t err = host_error(errno);
+        if (err == NSAPI_ERROR_WOULD_BLOCK) {
+            arm(s, false, true);
+        }
+        return err;
+    }
+
+    return sent;
+}
+
+nsapi_size_or_error_t HostStack::socket_recv(nsapi_socket_t handle,
+        void *data, nsapi_size_t size)
+{
+    host_socket *s = static_cast<host_socket *>(handle);
+    ssize_t recv = ::recv(s->fd, data, size, 0);
+    arm(s, true, false);
+    if (recv < 0) {
+        return host_error(errno);
+    }
+
+    return recv;
+}
+
+nsapi_size_or_error_t HostStack::socket_sendto(nsapi_socket_t handle, const SocketAddress &addr,
+        const void *data, nsapi_size_t size)
+{
+    host_socket *s = static_cast<host_socket *>(handle);
+    struct sockaddr_in sin;
+    nsapi_error_t err = address(addr, &sin);
+    if (err) {
+        return err;
+    }
+
+    ssize_t sent = ::sendto(s->fd, data, size, 0, (struct sockaddr *)&sin, sizeof(sin));
+    if (sent < 0) {
+        err = host_error(errno);
+        if (err == NSAPI_ERROR_WOULD_BLOCK) {
+            arm(s, false, true);
+        }
+        return err;
+    }
+
+    __sync_fetch_and_add(&packets, 1);
+    __sync_fetch_and_add(&bytes, sent);
+    return sent;
+}
+
+nsapi_size_or_error_t HostStack::socket_recvfrom(nsapi_socket_t handle, SocketAddress *addr,
+        void *buffer, nsapi_size_t size)
+{
+    host_socket *s = static_cast<host_socket *>(handle);
+    struct sockaddr_in sin;
+    socklen_t len = sizeof(sin);
+    ssize_t recv = ::recvfrom(s->fd, buffer, size, 0, (struct sockaddr *)&sin, &len);
+    arm(s, true, false);
+    if (recv < 0) {
+        return host_error(errno);
+    }
+
+    if (addr) {
+        address(&sin, addr);
+    }
+    return recv;
+}
+
+void HostStack::socket_attach(nsapi_socket_t handle, void (*callback)(void *), void *data)
+{
+    host_socket *s = static_cast<host_socket *>(handle);
+
+    // Taking the callback lock waits out a callback in progress
+    pthread_mutex_lock(&_callback_mutex);
+    pthread_mutex_lock(&_mutex);
+    s->callback = callback;
+    s->data = data;
+    pthread_mutex_unlock(&_mutex);
+    pthread_mutex_unlock(&_callback_mutex);
+}
+
+// Loaned buffers are received into the heap, the handle is the allocation
+static nsapi_size_or_error_t host_loan(nsapi_size_or_error_t recv, uint8_t *data,
+        nsapi_buffer_t *buffer, volatile unsigned *loans)
+{
+    if (recv < 0) {
+        delete[] data;
+        return recv;
+    }
+
+    buffer->data = data;
+    buffer->size = recv;
+    buffer->handle = data;
+    __sync_fetch_and_add(loans, 1);
+    return recv;
+}
+
+nsapi_size_or_error_t HostStack::socket_recv_buffer(nsapi_socket_t handle,
+        nsapi_buffer_t *buffer)
+{
+    uint8_t *data = new uint8_t[HOST_BUFFER_SIZE];
+    return host_loan(socket_recv(handle, data, HOST_BUFFER_SIZE), data, buffer, &loans);
+}
+
+nsapi_size_or_error_t HostStack::socket_recvfrom_buffer(nsapi_socket_t handle, SocketAddress *addr,
+        nsapi_buffer_t *buffer)
+{
+    uint8_t *data = new uint8_t[HOST_BUFFER_SIZE];
+    return host_loan(socket_recvfrom(handle, addr, data, HOST_BUFFER_SIZE), data, buffer, &loans);
+}
+
+void HostStack::socket_free_buffer(nsapi_buffer_t *buffer)
+{
+    delete[] static_cast<uint8_t *>(buffer->handle);
+    __sync_fetch_and_sub(&loans, 1);
+}
@@ -0,0 +1,103 @@
+/* NetworkStack over the host's sockets
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HOST_STACK_H
+#define HOST_STACK_H
+
+#include "netsocket/NetworkStack.h"
+#include <pthread.h>
+
+
+/** NetworkStack over the host's non-blocking IPv4 sockets
+ *
+ *  Lets the netsocket classes run on the host against servers on the
+ *  loopback interface. A thread polls the sockets and calls a socket's
+ *  callback when it becomes readable, or writable after a send would
+ *  have blocked, as a network stack signals on packet arrival and acks.
+ *  A signalled direction is not polled again until the socket is used.
+ *
+ *  Ports can be redirected, so servers on privileged ports such as DNS
+ *  can be stood in for by unprivileged ones.
+ *
+ *  Received data is loaned out in heap buffers, counted until released.
+ */
+class HostStack : public NetworkStack
+{
+public:
+    HostStack();
+    virtual ~HostStack();
+
+    /** Send to host_port instead of port
+     *
+     *  Packets from host_port appear to come from port.
+     */
+    void redirect(uint16_t port, uint16_t host_port);
+
+    /** Number of socket callbacks made */
+    volatile unsigned events;
+
+    /** Number of packets and bytes sent by sendto */
+    volatile unsigned packets;
+    volatile unsigned bytes;
+
+    /** Number of received buffers loaned out and not yet released */
+    volatile unsigned loans;
+
+    virtual const char *get_ip_address();
+
+protected:
+    virtual nsapi_error_t socket_open(nsapi_socket_t *handle, nsapi_protocol_t proto);
+    virtual nsapi_error_t socket_close(nsapi_socket_t handle);
+    virtual nsapi_error_t socket_bind(nsapi_socket_t handle, const SocketAddress &address);
+    virtual nsapi_error_t socket_listen(nsapi_socket_t handle, int backlog);
+    virtual nsapi_error_t socket_connect(nsapi_socket_t handle, const SocketAddress &address);
+    virtual nsapi_error_t socket_accept(nsapi_socket_t server,
+            nsapi_socket_t *handle, SocketAddress *address);
+    virtual nsapi_size_or_error_t socket_send(nsapi_socket_t handle,
+            const void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t socket_recv(nsapi_socket_t handle,
+            void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t socket_sendto(nsapi_socket_t handle, const SocketAddress &address,
+            const void *data, nsapi_size_t size);
+    virtual nsapi_size_or_error_t socket_recvfrom(nsapi_socket_t handle, SocketAddress *address,
+            void *buffer, nsapi_size_t size);
+    virtual void socket_attach(nsapi_socket_t handle, void (*callback)(void *), void *data);
+    virtual nsapi_size_or_error_t socket_recv_buffer(nsapi_socket_t handle,
+            nsapi_buffer_t *buffer);
+    virtual nsapi_size_or_error_t socket_recvfrom_buffer(nsapi_socket_t handle, SocketAddress *address,
+            nsapi_buffer_t *buffer);
+    virtual void socket_free_buffer(nsapi_buffer_t *buffer);
+
+private:
+    struct host_socket;
+
+    host_socket *add(int fd, nsapi_protocol_t proto);
+    void arm(host_socket *s, bool read, bool write);
+    nsapi_error_t address(const SocketAddress &address, struct sockaddr_in *sin);
+    void address(const struct sockaddr_in *sin, SocketAddress *address);
+    static void *run(void *stack);
+
+    host_socket *_sockets;
+    pthread_mutex_t _mutex;
+    pthread_mutex_t _callback_mutex;
+    pthread_t _thread;
+    int _wake[2];
+    bool _running;
+
+    uint16_t _port;
+    uint16_t _host_port;
+};
+
+#endif
@@ -0,0 +1,362 @@
+/*
+ * Host test of nsapi_poll readiness, memory and context switches
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Checks nsapi_poll reports NSAPI_POLLIN and NSAPI_POLLOUT separately,
+ * each until an operation in that direction would block.
+ *
+ * Then runs the tcp_echo_poll transactions against an echo server in a
+ * child process, once with a thread per socket and once from a single
+ * thread with nsapi_poll. The clients run on stacks filled with a pattern
+ * to measure their high-water mark, and their context switches are
+ * counted with getrusage.
+ */
+#include "host_stack.h"
+#include "netsocket/TCPServer.h"
+#include "netsocket/TCPSocket.h"
+#include "netsocket/nsapi_poll.h"
+#include "host_test.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define ECHO_PORT       7003
+#define SINK_PORT       7004
+#define SOCKETS         16
+#define REQUESTS        2000
+#define REQUEST_SIZE    64
+#define STACK_SIZE      (64*1024)
+
+
+// Test
+static HostStack *host;
+static NetworkStack *stack;
+
+static void drain(TCPSocket *socket)
+{
+    char buffer[4096];
+    while (socket->recv(buffer, sizeof(buffer)) > 0) {
+    }
+}
+
+static void test_readiness()
+{
+    TCPServer server;
+    TCPSocket client, sink;
+    check(server.open(stack) == 0);
+    check(server.bind("127.0.0.1", SINK_PORT) == 0);
+    check(server.listen(1) == 0);
+    check(client.open(stack) == 0);
+    check(client.connect(SocketAddress("127.0.0.1", SINK_PORT)) == 0);
+    check(server.accept(&sink) == 0);
+    client.set_blocking(false);
+    sink.set_blocking(false);
+
+    // A new connection may be used in both directions
+    nsapi_pollsock_t socks[] = {{&client, NSAPI_POLLIN | NSAPI_POLLOUT}};
+    check(nsapi_poll(socks, 1, 0) == 1);
+    check(socks[0].revents == (NSAPI_POLLIN | NSAPI_POLLOUT));
+
+    // Once a recv would block, only writing is reported
+    drain(&client);
+    check(nsapi_poll(socks, 1, 0) == 1);
+    check(socks[0].revents == NSAPI_POLLOUT);
+    socks[0].events = NSAPI_POLLIN;
+    check(nsapi_poll(socks, 1, 0) == 0);
+    check(socks[0].revents == 0);
+
+    // Data arriving reports reading
+    check(sink.send("ping", 4) == 4);
+    check(nsapi_poll(socks, 1, 1000) == 1);
+    check(socks[0].revents == NSAPI_POLLIN);
+    char buffer[4096];
+    check(client.recv(buffer, sizeof(buffer)) == 4);
+    check(nsapi_poll(socks, 1, 0) == 1);
+    check(client.recv(buffer, sizeof(buffer)) == NSAPI_ERROR_WOULD_BLOCK);
+    check(nsapi_poll(socks, 1, 0) == 0);
+
+    // Once a send would block, only reading may be reported
+    memset(buffer, 0x5a, sizeof(buffer));
+    nsapi_size_t sent = 0;
+    while (true) {
+        nsapi_size_or_error_t size = client.send(buffer, sizeof(buffer));
+        if (size < 0) {
+            check(size == NSAPI_ERROR_WOULD_BLOCK);
+            break;
+        }
+        sent += size;
+    }
+    check(sent > 0);
+    socks[0].events = NSAPI_POLLOUT;
+    check(nsapi_poll(socks, 1, 0) == 0);
+
+    // The peer reading makes room, which reports writing
+    nsapi_size_t received = 0;
+    while (received < sent) {
+        nsapi_size_or_error_t size = sink.recv(buffer, sizeof(buffer));
+        if (size == NSAPI_ERROR_WOULD_BLOCK) {
+            usleep(1000);
+            continue;
+        }
+        check(size > 0);
+        if (size <= 0) {
+            break;
+        }
+        received += size;
+    }
+    check(nsapi_poll(socks, 1, 1000) == 1);
+    check(socks[0].revents == NSAPI_POLLOUT);
+
+    // A closed socket is invalid
+    check(sink.close() == 0);
+    nsapi_pollsock_t closed[] = {{&sink, NSAPI_POLLIN}};
+    check(nsapi_poll(closed, 1, 0) == 1);
+    check(closed[0].revents == NSAPI_POLLNVAL);
+
+    check(client.close() == 0);
+    check(server.close() == 0);
+}
+
+
+// Echo server in its own process, so its context switches are not counted
+static pid_t echo_server()
+{
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in sin;
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(ECHO_PORT);
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    check(bind(listener, (struct sockaddr *)&sin, sizeof(sin)) == 0);
+    check(listen(listener, SOCKETS) == 0);
+
+    pid_t pid = fork();
+    if (pid) {
+        close(listener);
+        return pid;
+    }
+
+    struct pollfd fds[SOCKETS + 1] = {{listener, POLLIN}};
+    unsigned count = 1;
+    while (poll(fds, count, -1) >= 0) {
+        for (unsigned i = 1; i < count; i++) {
+            char buffer[4096];
+            if (fds[i].revents) {
+                ssize_t size = recv(fds[i].fd, buffer, sizeof(buffer), 0);
+                if (size <= 0) {
+                    close(fds[i].fd);
+                    fds[i--] = fds[--count];
+                } else {
+                    send(fds[i].fd, buffer, size, 0);
+                }
+            }
+        }
+        if ((fds[0].revents & POLLIN) && count < SOCKETS + 1) {
+            fds[count].fd = accept(listener, NULL, NULL);
+            setsockopt(fds[count].fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            fds[count].events = POLLIN;
+            count++;
+        }
+    }
+    _exit(0);
+}
+
+class Echo {
+public:
+    TCPSocket sock;
+    char tx[REQUEST_SIZE];
+    char rx[REQUEST_SIZE];
+    nsapi_size_t rx_size;
+    unsigned requests;
+    bool same;
+
+    void start(bool blocking) {
+        check(sock.open(stack) == 0);
+        check(sock.connect(SocketAddress("127.0.0.1", ECHO_PORT)) == 0);
+        sock.set_blocking(blocking);
+        requests = 0;
+        same = true;
+        send();
+    }
+
+    void send() {
+        memset(tx, requests, sizeof(tx));
+        check(sock.send(tx, sizeof(tx)) == sizeof(tx));
+        rx_size = 0;
+    }
+
+    // Returns true once the last echo has been received
+    bool event() {
+        while (true) {
+            nsapi_size_or_error_t ret = sock.recv(&rx[rx_size], sizeof(rx) - rx_size);
+            if (ret == NSAPI_ERROR_WOULD_BLOCK) {
+                return false;
+            }
+
+            check(ret > 0);
+            if (ret <= 0) {
+                return true;
+            }
+
+            rx_size += ret;
+            if (rx_size == sizeof(rx)) {
+                same = same && !memcmp(tx, rx, sizeof(tx));
+                requests += 1;
+                if (requests == REQUESTS) {
+                    return true;
+                }
+                send();
+            }
+        }
+    }
+};
+
+static Echo echoers[SOCKETS];
+
+// Context switches of the calling thread, the stack's own thread and
+// the server are the same in both cases so they are left out
+static void *switches()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return (void *)(usage.ru_nvcsw + usage.ru_nivcsw);
+}
+
+static void *echo_thread(void *arg)
+{
+    Echo *echo = static_cast<Echo *>(arg);
+    while (!echo->event()) {
+    }
+    return switches();
+}
+
+static void *poll_thread(void *arg)
+{
+    nsapi_pollsock_t socks[SOCKETS];
+    for (int i = 0; i < SOCKETS; i++) {
+        socks[i].socket = &echoers[i].sock;
+        socks[i].events = NSAPI_POLLIN;
+    }
+
+    int done = 0;
+    while (done < SOCKETS) {
+        int ready = nsapi_poll(socks, SOCKETS, 10000);
+        check(ready > 0);
+        if (ready <= 0) {
+            break;
+        }
+
+        for (int i = 0; i < SOCKETS; i++) {
+            if ((socks[i].revents & NSAPI_POLLIN) && echoers[i].event()) {
+                socks[i].socket = NULL;
+                done += 1;
+            }
+        }
+    }
+    return switches();
+}
+
+// Runs threads on pattern filled stacks, returns the total stack used
+static size_t run(void *(*entry)(void *), void **args, int count, long *switched)
+{
+    pthread_t threads[SOCKETS];
+    uint8_t *stacks[SOCKETS];
+    for (int i = 0; i < count; i++) {
+        stacks[i] = (uint8_t *)malloc(STACK_SIZE);
+        memset(stacks[i], 0xa5, STACK_SIZE);
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstack(&attr, stacks[i], STACK_SIZE);
+        pthread_create(&threads[i], &attr, entry, args[i]);
+        pthread_attr_destroy(&attr);
+    }
+
+    size_t used = 0;
+    *switched = 0;
+    for (int i = 0; i < count; i++) {
+        void *thread_switches;
+        pthread_join(threads[i], &thread_switches);
+        *switched += (long)thread_switches;
+        size_t unused = 0;
+        while (unused < STACK_SIZE && stacks[i][unused] == 0xa5) {
+            unused++;
+        }
+        used += STACK_SIZE - unused;
+        free(stacks[i]);
+    }
+    return used;
+}
+
+static void bench(bool poll, size_t *memory, long *switched)
+{
+    for (int i = 0; i < SOCKETS; i++) {
+        echoers[i].start(!poll);
+    }
+
+    void *args[SOCKETS];
+    if (poll) {
+        args[0] = NULL;
+        *memory = run(poll_thread, args, 1, switched) + SOCKETS*sizeof(nsapi_pollsock_t);
+    } else {
+        for (int i = 0; i < SOCKETS; i++) {
+            args[i] = &echoers[i];
+        }
+        *memory = run(echo_thread, args, SOCKETS, switched);
+    }
+
+    for (int i = 0; i < SOCKETS; i++) {
+        check(echoers[i].requests == REQUESTS);
+        check(echoers[i].same);
+        check(echoers[i].sock.close() == 0);
+    }
+
+    printf("%-18s %2d thread%s %6zu bytes of stack  %6ld context switches (%.1f/request)\n",
+            poll ? "nsapi_poll" : "thread-per-socket", poll ? 1 : SOCKETS, poll ? " " : "s", *memory,
+            *switched, (double)*switched / (SOCKETS*REQUESTS));
+}
+
+int main()
+{
+    pid_t server = echo_server();
+
+    host = new HostStack;
+    stack = host;
+    test_readiness();
+
+    printf("%d connections echoing %d %dB requests\n", SOCKETS, REQUESTS, REQUEST_SIZE);
+    size_t threads_memory, poll_memory;
+    long threads_switches, poll_switches;
+    bench(false, &threads_memory, &threads_switches);
+    bench(true, &poll_memory, &poll_switches);
+    check(poll_memory < threads_memory / 4);
+    check(poll_switches < threads_switches / 2);
+
+    delete host;
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+
+    return host_test_done();
+}
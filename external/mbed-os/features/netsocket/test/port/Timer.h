@@ -0,0 +1,55 @@
+/* Host stand-in for mbed::Timer over the us ticker */
+#ifndef MBED_TIMER_H
+#define MBED_TIMER_H
+
+#include "hal/us_ticker_api.h"
+
+namespace mbed {
+
+class Timer {
+public:
+    Timer() : _running(false), _start(0), _time(0) {
+    }
+
+    void start() {
+        if (!_running) {
+            _start = ticker_read_us(get_us_ticker_data());
+            _running = true;
+        }
+    }
+
+    void stop() {
+        _time += slicetime();
+        _running = false;
+    }
+
+    void reset() {
+        _start = ticker_read_us(get_us_ticker_data());
+        _time = 0;
+    }
+
+    int read_ms() {
+        return read_us() / 1000;
+    }
+
+    int read_us() {
+        return _time + slicetime();
+    }
+
+    float read() {
+        return read_us() / 1000000.0f;
+    }
+
+private:
+    us_timestamp_t slicetime() {
+        return _running ? ticker_read_us(get_us_ticker_data()) - _start : 0;
+    }
+
+    bool _running;
+    us_timestamp_t _start;
+    us_timestamp_t _time;
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,18 @@
+/* Host stand-in for events::EventQueue, calls are run immediately */
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+namespace events {
+
+class EventQueue {
+public:
+    template <typename F, typename A>
+    int call(F f, A a) {
+        f(a);
+        return 1;
+    }
+};
+
+} // namespace events
+
+#endif
@@ -0,0 +1,19 @@
+/* Host stand-in for mbed.h, with the parts the netsocket sources use */
+#ifndef MBED_H
+#define MBED_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform/mbed_toolchain.h"
+#include "platform/mbed_assert.h"
+#include "platform/Callback.h"
+#include "cmsis_os.h"
+#include "rtos/Mutex.h"
+#include "rtos/Semaphore.h"
+#include "Timer.h"
+
+using namespace mbed;
+using namespace std;
+
+#endif
@@ -509,6 +509,61 @@ control_t cfstore_find_test_07_end(const size_t call_count)
 }
 
 
+/**
+ * @brief   test case to check Find() with a "prefix*" query returns the matching
+ *          KVs in key name order, and that a query for a name which is only a
+ *          prefix of other key names is not found.
+ *
+ * @return on success returns CaseNext to continue to next test case, otherwise will assert on errors.
+ */
+control_t cfstore_find_test_08_end(const size_t call_count)
+{
+    const char* key_name_query = "0123456789abcdef0123456.yxxx.*";
+    const char* key_name_prefix = "0123456789abcdef0123456.yxxx";
+    char key_name[CFSTORE_KEY_NAME_MAX_LENGTH+1];
+    uint8_t len = CFSTORE_KEY_NAME_MAX_LENGTH+1;
+    int32_t ret = ARM_DRIVER_ERROR;
+    ARM_CFSTORE_DRIVER* drv = &cfstore_driver;
+    ARM_CFSTORE_HANDLE_INIT(next);
+    ARM_CFSTORE_HANDLE_INIT(prev);
+    cfstore_kv_data_t* node = cfstore_find_test_06_data_match_results;
+
+    (void) call_count;
+    ret = cfstore_test_create_table(cfstore_find_test_06_data);
+    CFSTORE_TEST_UTEST_MESSAGE(cfstore_find_utest_msg_g, CFSTORE_UTEST_MSG_BUF_SIZE, "%s:Failed to add cfstore_find_test_06_data table data (ret=%d).\n", __func__, (int) ret);
+    TEST_ASSERT_MESSAGE(ret >= ARM_DRIVER_OK, cfstore_find_utest_msg_g);
+
+    /* the match results table is in key name order */
+    while((ret = drv->Find(key_name_query, prev, next)) == ARM_DRIVER_OK)
+    {
+        len = CFSTORE_KEY_NAME_MAX_LENGTH+1;
+        ret = drv->GetKeyName(next, key_name, &len);
+        CFSTORE_TEST_UTEST_MESSAGE(cfstore_find_utest_msg_g, CFSTORE_UTEST_MSG_BUF_SIZE, "%s:Error: failed to get key name for next (ret=%d).\n", __func__, (int) ret);
+        TEST_ASSERT_MESSAGE(ret >= ARM_DRIVER_OK, cfstore_find_utest_msg_g);
+
+        CFSTORE_TEST_UTEST_MESSAGE(cfstore_find_utest_msg_g, CFSTORE_UTEST_MSG_BUF_SIZE, "%s:Error: found %s but expected %s.\n", __func__, key_name, node->key_name ? node->key_name : "no more entries");
+        TEST_ASSERT_MESSAGE(node->key_name != NULL && strncmp(node->key_name, key_name, CFSTORE_KEY_NAME_MAX_LENGTH) == 0, cfstore_find_utest_msg_g);
+        node++;
+
+        CFSTORE_HANDLE_SWAP(prev, next);
+    }
+    CFSTORE_TEST_UTEST_MESSAGE(cfstore_find_utest_msg_g, CFSTORE_UTEST_MSG_BUF_SIZE, "%s:Error: not all entries in the match table were found.\n", __func__);
+    TEST_ASSERT_MESSAGE(node->key_name == NULL, cfstore_find_utest_msg_g);
+
+    CFSTORE_TEST_UTEST_MESSAGE(cfstore_find_utest_msg_g, CFSTORE_UTEST_MSG_BUF_SIZE, "%s:Error: expected ret == ARM_CFSTORE_DRIVER_ERROR_KEY_NOT_FOUND, but ret = %d.\n", __func__, (int) ret);
+    TEST_ASSERT_MESSAGE(ret == ARM_CFSTORE_DRIVER_ERROR_KEY_NOT_FOUND, cfstore_find_utest_msg_g);
+
+    ret = drv->Find(key_name_prefix, NULL, next);
+    CFSTORE_TEST_UTEST_MESSAGE(cfstore_find_utest_msg_g, CFSTORE_UTEST_MSG_BUF_SIZE, "%s:Error: Find() of key name prefix (%s) should not find a KV (ret=%d).\n", __func__, key_name_prefix, (int) ret);
+    TEST_ASSERT_MESSAGE(ret == ARM_CFSTORE_DRIVER_ERROR_KEY_NOT_FOUND, cfstore_find_utest_msg_g);
+
+    ret = drv->Uninitialize();
+    CFSTORE_TEST_UTEST_MESSAGE(cfstore_find_utest_msg_g, CFSTORE_UTEST_MSG_BUF_SIZE, "%s:Error: Uninitialize() call failed.\n", __func__);
+    TEST_ASSERT_MESSAGE(ret >= ARM_DRIVER_OK, cfstore_find_utest_msg_g);
+    return CaseNext;
+}
+
+
 /// @cond CFSTORE_DOXYGEN_DISABLE
 utest::v1::status_t greentea_setup(const size_t number_of_cases)
 {
@@ -531,6 +586,8 @@ Case cases[] = {
         Case("FIND_test_06_end", cfstore_find_test_06_end),
         Case("FIND_test_07_start", cfstore_utest_default_start),
         Case("FIND_test_07_end", cfstore_find_test_07_end),
+        Case("FIND_test_08_start", cfstore_utest_default_start),
+        Case("FIND_test_08_end", cfstore_find_test_08_end),
 };
 
 
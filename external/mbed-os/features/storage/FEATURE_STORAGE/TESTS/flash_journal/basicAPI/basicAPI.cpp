@@ -1053,6 +1053,39 @@ void test_crc32()
     }
 }
 
+void test_crc32Incremental()
+{
+    /* the standard check value, and messages long enough for the sliced path */
+    TEST_ASSERT_EQUAL(0xcbf43926, flashJournalCrc32("123456789", 9));
+
+    uint8_t msg[100];
+    for (unsigned i = 0; i < sizeof(msg); i++) {
+        msg[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    /* reference: byte at a time */
+    flash_journal_crc_t crc;
+    flashJournalCrcStart(&crc);
+    for (unsigned i = 0; i < sizeof(msg); i++) {
+        flashJournalCrcUpdate(&crc, &msg[i], 1);
+    }
+    uint32_t expected = flashJournalCrcValue(&crc);
+    TEST_ASSERT_EQUAL(expected, flashJournalCrc32(msg, sizeof(msg)));
+
+    /* independent computations may be interleaved with arbitrary chunking */
+    for (unsigned chunk = 2; chunk < 20; chunk++) {
+        flash_journal_crc_t other;
+        flashJournalCrcStart(&crc);
+        flashJournalCrcStart(&other);
+        for (unsigned offset = 0; offset < sizeof(msg); offset += chunk) {
+            unsigned len = (sizeof(msg) - offset < chunk) ? (sizeof(msg) - offset) : chunk;
+            flashJournalCrcUpdate(&crc, msg + offset, len);
+            flashJournalCrcUpdate(&other, msg, 3);
+        }
+        TEST_ASSERT_EQUAL(expected, flashJournalCrcValue(&crc));
+    }
+}
+
 #ifndef AVOID_GREENTEA
 // Custom setup handler required for proper Greentea support
 utest::v1::status_t greentea_setup(const size_t number_of_cases)
@@ -1145,6 +1178,7 @@ Case cases[] = {
 
     Case("reset and initialize6",                       test_resetAndInitialize),
     Case("crc32",                                       test_crc32),
+    Case("crc32 incremental",                           test_crc32Incremental),
     // Case("uninitialize", test_uninitialize),
 };
 
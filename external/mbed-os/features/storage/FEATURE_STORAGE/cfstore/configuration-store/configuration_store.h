@@ -152,8 +152,10 @@ typedef struct _ARM_CFSTORE_STATUS {
 #define CFSTORE_KEY_NAME_MAX_LENGTH     220         //!< The maximum length of the null terminated character
                                                     //!< string used as a key name string.
 #define CFSTORE_VALUE_SIZE_MAX          (1<<26)     //!< Max size of the KV value blob (currently 64MB)
+#ifndef CFSTORE_HANDLE_BUFSIZE
 #define CFSTORE_HANDLE_BUFSIZE          24          //!< size of the buffer owned and supplied by client
                                                     //!< to CFSTORE to hold internal data structures, referenced by the key handle.
+#endif
 
 /** @brief   Helper macro to declare handle and client owned buffer supplied
  *           to CFSTORE for storing opaque handle state
@@ -505,7 +507,10 @@ typedef struct _ARM_DRIVER_CFSTORE
      *
      * @param   key_name_query
      *          IN: a search string to find. This can include the wildcard '*'
-     *          character
+     *          character. Matching KVs are returned in key name order.
+     *          Queries of the form "com.acme.*" (a literal prefix followed
+     *          by a wildcard) are the most efficient, as only the KVs with
+     *          names starting with the literal prefix are examined.
      * @param   previous
      *          IN: On the first call to (*Find) then previous is a pointer
      *          (the handle) to a buffer initialised to 0.
@@ -90,6 +90,7 @@ struct _ARM_DRIVER_STORAGE cfstore_journal_mtd;
 #define CFSTORE_SENTINEL                            0x7fffffff
 #define CFSTORE_CALLBACK_RET_CODE_DEFAULT           0x1
 #define ARM_DRIVER_OK_DONE                          1
+#define CFSTORE_KV_INDEX_GROW_SIZE                  8
 
 /*
  * Simple Types
@@ -347,6 +348,19 @@ static int32_t cfstore_get_key_name_ex(cfstore_area_hkvt_t *hkvt, char* key_name
  *          length of the area used for storing KVs, including padding to
  *          round to nearest program unit
  *
+ * @param   kv_index
+ *          array of the offsets from area_0_head of the KV headers in the
+ *          area, sorted by key name. Used to find KVs by name or key name
+ *          prefix without walking the whole area. Offsets rather than
+ *          pointers are stored so the index is unaffected by realloc()
+ *          moving the area.
+ *
+ * @param   kv_index_len
+ *          number of entries in kv_index, which is the number of KVs in the area.
+ *
+ * @param   kv_index_size
+ *          number of entries allocated for kv_index.
+ *
  * @param   rw_area0_lock
  *          lock used to make CS re-entrant e.g. only 1 flush operation can be
  *          performed at a time while no readers/writers have handles open
@@ -381,6 +395,9 @@ typedef struct cfstore_ctx_t
     uint8_t *area_0_head;
     uint8_t *area_0_tail;
     size_t area_0_len;
+    uint32_t *kv_index;
+    uint32_t kv_index_len;
+    uint32_t kv_index_size;
     cfstore_fsm_t fsm;
     int32_t status;
 
@@ -467,6 +484,9 @@ static cfstore_ctx_t cfstore_ctx_g = {
         .power_state = ARM_POWER_FULL,
         .area_0_head = NULL,
         .area_0_tail = NULL,
+        .kv_index = NULL,
+        .kv_index_len = 0,
+        .kv_index_size = 0,
         .client_callback = NULL,
         .client_context = NULL,
         .f_reserved0 = 0,
@@ -1305,6 +1325,180 @@ static int32_t cfstore_get_next_hkvt(cfstore_area_hkvt_t* prev, cfstore_area_hkv
 }
 
 
+/*
+ * KV name index
+ *
+ * ctx->kv_index holds the offset of every KV header in the area, sorted by
+ * key name. Exact names are found with a binary search, and the KVs whose
+ * names start with a given prefix (e.g. for the query "com.acme.*") form a
+ * contiguous range of the index. The index is kept up to date by Create(),
+ * Delete() and when KVs change size, and is rebuilt when the area is loaded
+ * from flash.
+ *
+ * The index is not part of the area persisted to flash, so it is allocated
+ * from the heap with realloc() rather than CFSTORE_REALLOC().
+ */
+
+/* @brief   compare the key name of the KV at offset in the area with name of length len,
+ *          in the manner of strcmp(). */
+static int32_t cfstore_kv_index_cmp(cfstore_ctx_t* ctx, uint32_t offset, const char* name, size_t len)
+{
+    cfstore_area_header_t* hdr = (cfstore_area_header_t*) (ctx->area_0_head + offset);
+    size_t klen = hdr->klength;
+    int32_t ret = 0;
+
+    ret = memcmp((uint8_t*) hdr + sizeof(cfstore_area_header_t), name, klen < len ? klen : len);
+    if(ret == 0 && klen != len){
+        ret = klen < len ? -1 : 1;
+    }
+    return ret;
+}
+
+
+/* @brief   return true if the key name of the KV at offset in the area starts with prefix */
+static bool cfstore_kv_index_has_prefix(cfstore_ctx_t* ctx, uint32_t offset, const char* prefix, size_t len)
+{
+    cfstore_area_header_t* hdr = (cfstore_area_header_t*) (ctx->area_0_head + offset);
+
+    if(hdr->klength < len){
+        return false;
+    }
+    return memcmp((uint8_t*) hdr + sizeof(cfstore_area_header_t), prefix, len) == 0;
+}
+
+
+/* @brief   return the position of the first index entry with a key name not less than name */
+static uint32_t cfstore_kv_index_lower_bound(cfstore_ctx_t* ctx, const char* name, size_t len)
+{
+    uint32_t lo = 0;
+    uint32_t hi = ctx->kv_index_len;
+    uint32_t mid = 0;
+
+    while(lo < hi){
+        mid = lo + (hi - lo) / 2;
+        if(cfstore_kv_index_cmp(ctx, ctx->kv_index[mid], name, len) < 0){
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+
+/* @brief   make sure the index has space for at least len entries.
+ *
+ * Called before the area is changed so a failure leaves the store unchanged.
+ */
+static int32_t cfstore_kv_index_reserve(cfstore_ctx_t* ctx, uint32_t len)
+{
+    uint32_t size = 0;
+    uint32_t* index = NULL;
+
+    if(len <= ctx->kv_index_size){
+        return ARM_DRIVER_OK;
+    }
+    size = len + CFSTORE_KV_INDEX_GROW_SIZE - (len % CFSTORE_KV_INDEX_GROW_SIZE);
+    index = (uint32_t*) realloc(ctx->kv_index, size * sizeof(uint32_t));
+    if(index == NULL){
+        CFSTORE_ERRLOG("%s:Error: unable to allocate memory for key index (size=%d)\n", __func__, (int) size);
+        return ARM_CFSTORE_DRIVER_ERROR_OUT_OF_MEMORY;
+    }
+    ctx->kv_index = index;
+    ctx->kv_index_size = size;
+    return ARM_DRIVER_OK;
+}
+
+
+/* @brief   add the KV starting at head to the index. Space must have been reserved. */
+static void cfstore_kv_index_insert(cfstore_ctx_t* ctx, uint8_t* head)
+{
+    uint32_t pos = 0;
+    cfstore_area_header_t* hdr = (cfstore_area_header_t*) head;
+
+    CFSTORE_ASSERT(ctx->kv_index_len < ctx->kv_index_size);
+    pos = cfstore_kv_index_lower_bound(ctx, (const char*) head + sizeof(cfstore_area_header_t), hdr->klength);
+    memmove(&ctx->kv_index[pos+1], &ctx->kv_index[pos], (ctx->kv_index_len - pos) * sizeof(uint32_t));
+    ctx->kv_index[pos] = (uint32_t) (head - ctx->area_0_head);
+    ctx->kv_index_len++;
+}
+
+
+/* @brief   remove the KV starting at head from the index. Must be called before the KV is overwritten. */
+static void cfstore_kv_index_remove(cfstore_ctx_t* ctx, uint8_t* head)
+{
+    uint32_t pos = 0;
+    uint32_t offset = (uint32_t) (head - ctx->area_0_head);
+    cfstore_area_header_t* hdr = (cfstore_area_header_t*) head;
+
+    /* a KV being deleted can share its name with a newer KV, so check the offset as well */
+    pos = cfstore_kv_index_lower_bound(ctx, (const char*) head + sizeof(cfstore_area_header_t), hdr->klength);
+    while(pos < ctx->kv_index_len && ctx->kv_index[pos] != offset){
+        pos++;
+    }
+    if(pos == ctx->kv_index_len){
+        CFSTORE_ERRLOG("%s:Error: KV not found in key index (offset=%d)\n", __func__, (int) offset);
+        return;
+    }
+    ctx->kv_index_len--;
+    memmove(&ctx->kv_index[pos], &ctx->kv_index[pos+1], (ctx->kv_index_len - pos) * sizeof(uint32_t));
+}
+
+
+/* @brief   update the index after the KVs following the KV at head have been moved by size_diff bytes.
+ *          See cfstore_file_update() for the meaning of size_diff. */
+static void cfstore_kv_index_update(cfstore_ctx_t* ctx, uint8_t* head, int32_t size_diff)
+{
+    uint32_t i = 0;
+    uint32_t offset = (uint32_t) (head - ctx->area_0_head);
+
+    for(i = 0; i < ctx->kv_index_len; i++){
+        if(ctx->kv_index[i] > offset){
+            ctx->kv_index[i] += size_diff;
+        }
+    }
+}
+
+
+#ifdef CFSTORE_CONFIG_BACKEND_FLASH_ENABLED
+/* @brief   build the index for the KVs in the area, after it has been loaded from flash */
+static int32_t cfstore_kv_index_build(cfstore_ctx_t* ctx)
+{
+    int32_t ret = ARM_DRIVER_ERROR;
+    uint32_t num_kvs = 0;
+    cfstore_area_hkvt_t hkvt;
+
+    CFSTORE_FENTRYLOG("%s:entered\n", __func__);
+    ctx->kv_index_len = 0;
+    ret = cfstore_get_head_hkvt(&hkvt);
+    while(ret == ARM_DRIVER_OK){
+        num_kvs++;
+        ret = cfstore_get_next_hkvt(&hkvt, &hkvt);
+    }
+    ret = cfstore_kv_index_reserve(ctx, num_kvs);
+    if(ret < ARM_DRIVER_OK){
+        return ret;
+    }
+    ret = cfstore_get_head_hkvt(&hkvt);
+    while(ret == ARM_DRIVER_OK){
+        cfstore_kv_index_insert(ctx, hkvt.head);
+        ret = cfstore_get_next_hkvt(&hkvt, &hkvt);
+    }
+    return ARM_DRIVER_OK;
+}
+#endif /* CFSTORE_CONFIG_BACKEND_FLASH_ENABLED */
+
+
+/* @brief   free the index memory */
+static void cfstore_kv_index_free(cfstore_ctx_t* ctx)
+{
+    free(ctx->kv_index);
+    ctx->kv_index = NULL;
+    ctx->kv_index_len = 0;
+    ctx->kv_index_size = 0;
+}
+
+
 /*
  * Flash support functions
  */
@@ -1778,6 +1972,14 @@ static int32_t cfstore_fsm_reading(void* context)
                     memset(&ctx->info, 0, sizeof(ctx->info));
                     goto out;
                 }
+                ret = cfstore_kv_index_build(ctx);
+                if(ret < ARM_DRIVER_OK){
+                    CFSTORE_ERRLOG("%s:Error: cfstore_kv_index_build() failed (ret=%d)\n", __func__, (int) ret);
+                    /* move to ready state. cfstore client is expected to Uninitialize() before further calls */
+                    cfstore_fsm_state_set(&ctx->fsm, cfstore_fsm_state_ready, ctx);
+                    memset(&ctx->info, 0, sizeof(ctx->info));
+                    goto out;
+                }
                 ret = cfstore_fsm_state_set(&ctx->fsm, cfstore_fsm_state_ready, ctx);
                 if(ret < ARM_DRIVER_OK){
                     CFSTORE_ERRLOG("%s:Error: cfstore_fsm_state_set() failed (ret=%d)\n", __func__, (int) ret);
@@ -2379,7 +2581,9 @@ static int32_t cfstore_delete_ex(cfstore_area_hkvt_t* hkvt)
      *     start of heap block to a new location, in which case all cfstore_file_t::head pointers
      *     need to be updated. cfstore_realloc() can only do this starting from a set of correct
      *     cfstore_file_t::head pointers i.e. after 1. has been completed.
+     *  3. The KV is removed from the key index before memmove() overwrites its key name.
      */
+    cfstore_kv_index_remove(ctx, hkvt->head);
     memmove(hkvt->head, hkvt->tail, ctx->area_0_tail - hkvt->tail);
     /* zero the deleted KV memory */
     memset(ctx->area_0_tail-kv_size, 0, kv_size);
@@ -2390,6 +2594,7 @@ static int32_t cfstore_delete_ex(cfstore_area_hkvt_t* hkvt)
         CFSTORE_ERRLOG("%s:Error:file update failed\n", __func__);
         goto out0;
     }
+    cfstore_kv_index_update(ctx, hkvt->head, -1 * kv_size);
 
     /* setup the reallocation memory size. */
     realloc_size = kv_total_size - kv_size;
@@ -3123,6 +3328,9 @@ out0:
  *    This function does not affect refcount for underlying KVs.
  *  - The function assumes the arguments have been validated before calling this function
  *  - No acl policy is enforced by the function.
+ *  - Matching KVs are returned in key name order. Only the KVs in the key index
+ *    range sharing the literal prefix of the query (the part before the first '*')
+ *    are examined, so exact names and "prefix*" queries do not walk the whole area.
  *
  * @return  return_value
  *          On success (finding a KV matching the query) ARM_DRIVER_OK is
@@ -3132,90 +3340,67 @@ out0:
 static int32_t cfstore_find_ex(const char* key_name_query, cfstore_area_hkvt_t *prev, cfstore_area_hkvt_t *next)
 {
     int32_t ret = ARM_DRIVER_ERROR;
+    uint32_t pos = 0;
+    size_t prefix_len = 0;
+    bool is_pattern = false;
     uint8_t next_key_len;
     char key_name[CFSTORE_KEY_NAME_MAX_LENGTH+1];
     cfstore_ctx_t* ctx = cfstore_ctx_get();
 
     CFSTORE_TP((CFSTORE_TP_FIND|CFSTORE_TP_FENTRY), "%s:entered: key_name_query=\"%s\", prev=%p, next=%p\n", __func__, key_name_query, prev, next);
+    /* the literal prefix of the query bounds the range of the index that can match */
+    prefix_len = strcspn(key_name_query, "*");
+    is_pattern = key_name_query[prefix_len] != '\0';
+    cfstore_hkvt_init(next);
     if(prev == NULL){
-        ret = cfstore_get_head_hkvt(next);
-        /* CFSTORE_TP(CFSTORE_TP_FIND, "%s:next->head=%p, next->key=%p, next->value=%p, next->tail=%p, \n", __func__, next->head, next->key, next->value, next->tail); */
-        if(ret == ARM_CFSTORE_DRIVER_ERROR_KEY_NOT_FOUND){
-            CFSTORE_TP(CFSTORE_TP_FIND, "%s:CFSTORE has no KVs\n", __func__);
-            return ret;
-        } else if(ret < ARM_DRIVER_OK) {
-            CFSTORE_TP(CFSTORE_TP_FIND, "%s:failed to find the first KV in area\n", __func__);
-            return ret;
-        }
-
-        /* check for no KVs in the store => hkvt is not valid */
-        if(!cfstore_hkvt_is_valid(next, ctx->area_0_tail)){
-            /* no KVs in store */
-            CFSTORE_TP(CFSTORE_TP_FIND, "%s:hkvt is not valid\n", __func__);
-            return ARM_DRIVER_OK;
-        }
-
+        pos = cfstore_kv_index_lower_bound(ctx, key_name_query, prefix_len);
     } else {
-        /* CFSTORE_TP(CFSTORE_TP_FIND, "%s:getting hkvt from prev\n", __func__);*/
-        ret = cfstore_get_next_hkvt(prev, next);
-        if(ret < ARM_DRIVER_OK){
-            /* no more matching entries or error.
-             * either way, return*/
-            return ret;
+        /* continue from the entry following prev in key name order */
+        pos = cfstore_kv_index_lower_bound(ctx, (const char*) prev->key, cfstore_hkvt_get_key_len(prev));
+        while(pos < ctx->kv_index_len && cfstore_kv_index_cmp(ctx, ctx->kv_index[pos], (const char*) prev->key, cfstore_hkvt_get_key_len(prev)) == 0){
+            pos++;
         }
     }
-    if(next->head == NULL){
-        /* no entry*/
-        CFSTORE_TP(CFSTORE_TP_FIND, "%s:No more entries found\n", __func__);
-        return ARM_CFSTORE_DRIVER_ERROR_KEY_NOT_FOUND;
-    }
-    /* CFSTORE_TP(CFSTORE_TP_FIND, "%s:cfstore_ctx_g.area_0_head=%p, cfstore_ctx_g.area_0_tail=%p\n", __func__, cfstore_ctx_g.area_0_head, cfstore_ctx_g.area_0_tail);*/
-    cfstore_hkvt_dump(next, __func__);
-    while(cfstore_hkvt_is_valid(next, ctx->area_0_tail))
+    for( ; pos < ctx->kv_index_len; pos++)
     {
-        /* CFSTORE_TP(CFSTORE_TP_FIND, "%s:next->head=%p, next->key=%p, next->value=%p, next->tail=%p, \n", __func__, next->head, next->key, next->value, next->tail); */
+        if(!cfstore_kv_index_has_prefix(ctx, ctx->kv_index[pos], key_name_query, prefix_len)){
+            /* past the end of the range of KVs starting with the prefix */
+            break;
+        }
+        *next = cfstore_get_hkvt_from_head_ptr(ctx->area_0_head + ctx->kv_index[pos]);
         cfstore_hkvt_dump(next, __func__);
-
+        if(!is_pattern && cfstore_hkvt_get_key_len(next) != prefix_len){
+            /* exact name query and the first KV in the range is not an exact match */
+            break;
+        }
         /* if this KV is deleting then proceed to the next item */
         if(cfstore_hkvt_get_flags_delete(next)){
-            ret = cfstore_get_next_hkvt(next, next);
-            if(ret == ARM_CFSTORE_DRIVER_ERROR_KEY_NOT_FOUND) {
-                CFSTORE_TP(CFSTORE_TP_FIND, "%s:No more KVs found\n", __func__);
-                return ret;
-            }
             continue;
         }
         /* if this KV is not readable by the client then proceed to the next item */
         if(!cfstore_is_kv_client_readable(next)){
-            ret = cfstore_get_next_hkvt(next, next);
-            if(ret == ARM_CFSTORE_DRIVER_ERROR_KEY_NOT_FOUND) {
-                CFSTORE_TP(CFSTORE_TP_FIND, "%s:No more KVs found\n", __func__);
-                return ret;
-            }
             continue;
         }
-        /* check if this key_name matches the query */
-        next_key_len = cfstore_hkvt_get_key_len(next);
-        next_key_len++;
-        cfstore_get_key_name_ex(next, key_name, &next_key_len);
-        ret = cfstore_fnmatch(key_name_query, key_name, 0);
-        if(ret == 0){
-            /* found the entry in the store. return handle */
-            CFSTORE_TP(CFSTORE_TP_FIND, "%s:Found matching key (key_name_query = \"%s\", next->key = \"%s\"),next_key_len=%d\n", __func__, key_name_query, key_name, (int) next_key_len);
-            cfstore_hkvt_dump(next, __func__);
-            return ARM_DRIVER_OK;
-        } else if(ret != CFSTORE_FNM_NOMATCH){
-            CFSTORE_ERRLOG("%s:Error: cfstore_fnmatch() error (ret=%d).\n", __func__, (int) ret);
-            return ARM_DRIVER_ERROR;
-        }
-        /* CFSTORE_FNM_NOMATCH => get the next hkvt if any */
-        ret = cfstore_get_next_hkvt(next, next);
-        if(ret == ARM_CFSTORE_DRIVER_ERROR_KEY_NOT_FOUND) {
-            CFSTORE_TP(CFSTORE_TP_FIND, "%s:No more KVs found\n", __func__);
-            return ret;
+        if(is_pattern){
+            /* check if this key_name matches the query */
+            next_key_len = cfstore_hkvt_get_key_len(next);
+            next_key_len++;
+            cfstore_get_key_name_ex(next, key_name, &next_key_len);
+            ret = cfstore_fnmatch(key_name_query, key_name, 0);
+            if(ret == CFSTORE_FNM_NOMATCH){
+                continue;
+            } else if(ret != 0){
+                CFSTORE_ERRLOG("%s:Error: cfstore_fnmatch() error (ret=%d).\n", __func__, (int) ret);
+                return ARM_DRIVER_ERROR;
+            }
         }
+        /* found the entry in the store. return handle */
+        CFSTORE_TP(CFSTORE_TP_FIND, "%s:Found matching key (key_name_query = \"%s\")\n", __func__, key_name_query);
+        return ARM_DRIVER_OK;
     }
-    return ARM_DRIVER_OK;
+    CFSTORE_TP(CFSTORE_TP_FIND, "%s:No more KVs found\n", __func__);
+    cfstore_hkvt_init(next);
+    return ARM_CFSTORE_DRIVER_ERROR_KEY_NOT_FOUND;
 }
 
 
@@ -3372,6 +3557,7 @@ static int32_t cfstore_recreate(const char* key_name, ARM_CFSTORE_SIZE value_len
             CFSTORE_ERRLOG("%s:Error:file update failed\n", __func__);
             goto out0;
         }
+        cfstore_kv_index_update(ctx, hkvt->head, kv_size_diff);
     }
 
     ret = cfstore_realloc_ex(area_size + kv_size_diff, NULL);
@@ -3395,6 +3581,7 @@ static int32_t cfstore_recreate(const char* key_name, ARM_CFSTORE_SIZE value_len
             CFSTORE_ERRLOG("%s:Error:file update failed\n", __func__);
             goto out0;
         }
+        cfstore_kv_index_update(ctx, hkvt->head, kv_size_diff);
     }
     /* hkvt->head, hkvt->key and hkvt->value remain unchanged but hkvt->tail has moved. Update it.*/
     hkvt->tail = hkvt->tail + kv_size_diff;
@@ -3508,6 +3695,11 @@ static int32_t cfstore_create(const char* key_name, ARM_CFSTORE_SIZE value_len,
      * aligned to a program_unit boundary to facilitate r/w to flash and so the memory realloc size
      * is calculated to align, as follows */
     area_size = cfstore_ctx_get_kv_total_len();
+    /* make space in the key index first so failing to do so leaves the area unchanged */
+    ret = cfstore_kv_index_reserve(ctx, ctx->kv_index_len + 1);
+    if(ret < ARM_DRIVER_OK){
+        goto out1;
+    }
     /* setup the reallocation memory size. */
     realloc_size = area_size + kv_size;
     ret = cfstore_realloc_ex(realloc_size, NULL);
@@ -3535,6 +3727,7 @@ static int32_t cfstore_create(const char* key_name, ARM_CFSTORE_SIZE value_len,
     hdr->perm_other_execute = kdesc->acl.perm_other_execute;
     strncpy((char*)hdr + sizeof(cfstore_area_header_t), key_name, strlen(key_name));
     hkvt = cfstore_get_hkvt_from_head_ptr((uint8_t*) hdr);
+    cfstore_kv_index_insert(ctx, hkvt.head);
     if(cfstore_flags_is_default(kdesc->flags)){
         /* set as read-only by default default */
         flags.read = true;
@@ -4054,6 +4247,7 @@ static int32_t cfstore_uninitialise(void)
             ctx->area_0_tail = NULL;
             ctx->area_0_len = 0;
         }
+        cfstore_kv_index_free(ctx);
     }
 out:
     /* notify client */
@@ -0,0 +1,117 @@
+/*
+ * Lookup benchmark for the cfstore key index
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Builds cfstore on the host with the SRAM backend, and measures the time
+ * of Open() and of a prefix Find() as the number of keys grows. With the
+ * index both grow with the log of the key count, rather than linearly.
+ */
+#include "configuration_store.h"
+#include "host_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+extern ARM_CFSTORE_DRIVER cfstore_driver;
+static ARM_CFSTORE_DRIVER *drv = &cfstore_driver;
+
+#define MAX_KEYS    1024
+#define OPS         20000
+
+static char names[MAX_KEYS][CFSTORE_KEY_NAME_MAX_LENGTH+1];
+
+// Keys are spread over a few roots and groups, like application settings
+static void key_name(char *name, int i)
+{
+    static const char *roots[] = {"com.acme.", "com.acme2.", "org.x.", "com."};
+    sprintf(name, "%sg%d.k%d", roots[i % 4], (i / 4) % 8, i);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+
+// Test
+// Creates the keys and returns the time in us of an Open() and a Close()
+static double bench_open(int keys)
+{
+    static const char value[16] = "value";
+    ARM_CFSTORE_KEYDESC kdesc;
+    ARM_CFSTORE_FMODE flags;
+    memset(&kdesc, 0, sizeof(kdesc));
+    memset(&flags, 0, sizeof(flags));
+    kdesc.drl = ARM_RETENTION_WHILE_DEVICE_ACTIVE;
+
+    for (int i = 0; i < keys; i++) {
+        ARM_CFSTORE_HANDLE_INIT(h);
+        ARM_CFSTORE_SIZE len = sizeof(value);
+        key_name(names[i], i);
+        check(drv->Create(names[i], len, &kdesc, h) == ARM_DRIVER_OK);
+        check(drv->Write(h, value, &len) >= 0);
+        check(drv->Close(h) == ARM_DRIVER_OK);
+    }
+
+    int reps = OPS / keys + 1;
+    double start = now();
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < keys; i++) {
+            ARM_CFSTORE_HANDLE_INIT(h);
+            check(drv->Open(names[i], flags, h) == ARM_DRIVER_OK);
+            drv->Close(h);
+        }
+    }
+
+    return (now() - start)*1e6 / (reps*keys);
+}
+
+// Returns the time in us of finding the first key of the group of the
+// last key
+static double bench_find(int keys)
+{
+    char query[CFSTORE_KEY_NAME_MAX_LENGTH+1];
+    const char *last = names[keys-1];
+    sprintf(query, "%.*s*", (int)(strrchr(last, '.') - last + 1), last);
+
+    double start = now();
+    for (int r = 0; r < OPS; r++) {
+        ARM_CFSTORE_HANDLE_INIT(next);
+        check(drv->Find(query, NULL, next) == ARM_DRIVER_OK);
+        drv->Close(next);
+    }
+
+    return (now() - start)*1e6 / OPS;
+}
+
+int main(void)
+{
+    static const int counts[] = {16, 64, 256, 1024};
+
+    printf("%6s %12s %12s\n", "keys", "open us", "find us");
+    for (unsigned i = 0; i < sizeof counts / sizeof counts[0]; i++) {
+        check(drv->Initialize(NULL, NULL) >= ARM_DRIVER_OK);
+        double open = bench_open(counts[i]);
+        double find = bench_find(counts[i]);
+        printf("%6d %12.3f %12.3f\n", counts[i], open, find);
+        check(drv->Uninitialize() >= ARM_DRIVER_OK);
+    }
+
+    return host_test_done();
+}
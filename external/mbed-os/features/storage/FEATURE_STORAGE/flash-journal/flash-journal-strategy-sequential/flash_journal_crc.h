@@ -17,13 +17,61 @@
 #define _flash_journal_crc_h
 
 #include <inttypes.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Number of 256-entry lookup tables used by the software CRC: 1, 4 or 8.
+ * Each table costs 1KB of flash; slicing by 4 or 8 processes that many
+ * bytes per step instead of one.
+ */
+#ifndef FLASH_JOURNAL_CRC_SLICES
+#define FLASH_JOURNAL_CRC_SLICES 4
+#endif
+
 typedef uint32_t  flash_journal_crc32_t;
 
+/**
+ * State of an incremental CRC-32 computation. Every operation which needs
+ * a CRC over data arriving in chunks keeps its own instance, so that
+ * independent computations may be interleaved.
+ */
+typedef struct {
+    flash_journal_crc32_t remainder;
+} flash_journal_crc_t;
+
+/** Start a new CRC-32 computation. */
+void flashJournalCrcStart(flash_journal_crc_t *crc);
+
+/** Append the next nBytes of the message to a CRC-32 computation. */
+void flashJournalCrcUpdate(flash_journal_crc_t *crc, const void *data, size_t nBytes);
+
+/** The CRC-32 of the message appended so far; the computation may continue. */
+flash_journal_crc32_t flashJournalCrcValue(const flash_journal_crc_t *crc);
+
+/** The CRC-32 of a complete message. */
+flash_journal_crc32_t flashJournalCrc32(const void *data, size_t nBytes);
+
+#if defined(FLASH_JOURNAL_CRC_HW)
+/**
+ * Provided by targets which define FLASH_JOURNAL_CRC_HW, to compute the CRC
+ * with a hardware unit instead of the lookup tables.
+ *
+ * Continue a reflected CRC-32 (polynomial 0x04C11DB7) over nBytes of data,
+ * starting from the given remainder, and return the new remainder. The
+ * remainder is the raw shift register: 0xFFFFFFFF at the start of a message
+ * and without the final XOR applied.
+ */
+flash_journal_crc32_t flashJournalCrcHwUpdate(flash_journal_crc32_t remainder, const uint8_t *data, size_t nBytes);
+#endif
+
+/**
+ * Single shared CRC-32 computation, kept for existing callers; new code
+ * should use its own flash_journal_crc_t.
+ */
 void flashJournalCrcReset(void);
 flash_journal_crc32_t flashJournalCrcCummulative(unsigned char const message[], int nBytes);
 
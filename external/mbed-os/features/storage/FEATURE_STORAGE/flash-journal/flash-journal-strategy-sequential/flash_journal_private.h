@@ -23,6 +23,7 @@ extern "C" {
 #endif // __cplusplus
 
 #include "flash-journal/flash_journal.h"
+#include "flash-journal-strategy-sequential/flash_journal_crc.h"
 
 static inline uint32_t roundUp_uint32(uint32_t N, uint32_t BOUNDARY) {
     return ((((N) + (BOUNDARY) - 1) / (BOUNDARY)) * (BOUNDARY));
@@ -130,6 +131,7 @@ typedef struct _SequentialFlashJournal_t {
         struct {
             const uint8_t *blob;           /**< the original buffer holding source data. */
             size_t         sizeofBlob;
+            flash_journal_crc_t crc;       /**< running CRC32 over the head, the body logged so far, and the tail. */
             union {
                 struct {
                     uint64_t mtdEraseOffset;
@@ -114,8 +114,7 @@ int32_t readAndVerifyJournalHeader(SequentialFlashJournal_t *journal, Sequential
 
     uint32_t expectedCRC = headerP->genericHeader.checksum;
     headerP->genericHeader.checksum = 0;
-    flashJournalCrcReset();
-    uint32_t computedCRC = flashJournalCrcCummulative((const unsigned char *)&headerP->genericHeader, sizeof(SequentialFlashJournalLogHead_t));
+    uint32_t computedCRC = flashJournalCrc32(&headerP->genericHeader, sizeof(SequentialFlashJournalLogHead_t));
     if (computedCRC != expectedCRC) {
         //printf("readAndVerifyJournalHeader: checksum mismatch during header verification: expected = %u, computed = %u\n", (unsigned int) expectedCRC, (unsigned int) computedCRC);
         return JOURNAL_STATUS_METADATA_ERROR;
@@ -324,8 +323,8 @@ int32_t flashJournalStrategySequential_commit(FlashJournal_t *_journal)
 
     if (journal->prevCommand == FLASH_JOURNAL_OPCODE_LOG_BLOB) {
         /* the tail has already been setup during previous calls to log(); we can now include it in the crc32. */
-        journal->log.tail.crc32 = flashJournalCrcCummulative((const unsigned char *)&journal->log.tail, sizeof(SequentialFlashJournalLogTail_t));
-        flashJournalCrcReset();
+        flashJournalCrcUpdate(&journal->log.crc, &journal->log.tail, sizeof(SequentialFlashJournalLogTail_t));
+        journal->log.tail.crc32 = flashJournalCrcValue(&journal->log.crc);
 
         journal->log.mtdOffset       = journal->log.mtdTailOffset;
         journal->log.dataBeingLogged = (const uint8_t *)&journal->log.tail;
@@ -67,8 +67,9 @@ int32_t slotIsSane(SequentialFlashJournal_t        *journal,
     }
 
     /* compute the CRC32 of the header */
-    flashJournalCrcReset();
-    flashJournalCrcCummulative((const unsigned char *)&head, sizeof(SequentialFlashJournalLogHead_t));
+    flash_journal_crc_t crc;
+    flashJournalCrcStart(&crc);
+    flashJournalCrcUpdate(&crc, &head, sizeof(SequentialFlashJournalLogHead_t));
 
     // printf("head->version: %lu\n", journal->initScan.head.version);
     // printf("head->magic: %lx\n", journal->initScan.head.magic);
@@ -114,7 +115,7 @@ int32_t slotIsSane(SequentialFlashJournal_t        *journal,
                 }
 
                 bodyIndex += sizeofReadOperation;
-                flashJournalCrcCummulative(crcBuffer, sizeofReadOperation);
+                flashJournalCrcUpdate(&crc, crcBuffer, sizeofReadOperation);
             }
 
             /* compute CRC32 over the tail */
@@ -122,8 +123,8 @@ int32_t slotIsSane(SequentialFlashJournal_t        *journal,
             uint32_t expectedCRC32 = tailP->crc32;
             tailP->crc32 = 0;
 
-            uint32_t crc32 = flashJournalCrcCummulative((const unsigned char *)tailP, sizeof(SequentialFlashJournalLogTail_t));
-            flashJournalCrcReset();
+            flashJournalCrcUpdate(&crc, tailP, sizeof(SequentialFlashJournalLogTail_t));
+            uint32_t crc32 = flashJournalCrcValue(&crc);
             // printf("expectedCRC32: 0x%x, computedCRC32: 0x%x\n", expectedCRC32, crc32);
             if (crc32 == expectedCRC32) {
                 return 1;
@@ -174,8 +175,7 @@ int32_t setupSequentialJournalHeader(SequentialFlashJournalHeader_t *headerP, AR
 
     /* compute checksum over the entire header */
     headerP->genericHeader.checksum = 0;
-    flashJournalCrcReset();
-    headerP->genericHeader.checksum = flashJournalCrcCummulative((const unsigned char *)&headerP->genericHeader, sizeof(SequentialFlashJournalLogHead_t));
+    headerP->genericHeader.checksum = flashJournalCrc32(&headerP->genericHeader, sizeof(SequentialFlashJournalLogHead_t));
 
     return JOURNAL_STATUS_OK;
 }
@@ -504,8 +504,8 @@ int32_t flashJournalStrategySequential_log_progress(void)
 
             case SEQUENTIAL_JOURNAL_STATE_LOGGING_HEAD: /* we've finished writing the head */
                 /* compute CRC32 on the header */
-                flashJournalCrcReset();
-                flashJournalCrcCummulative((const unsigned char *)&journal->log.head, sizeof(SequentialFlashJournalLogHead_t));
+                flashJournalCrcStart(&journal->log.crc);
+                flashJournalCrcUpdate(&journal->log.crc, &journal->log.head, sizeof(SequentialFlashJournalLogHead_t));
 
                 /* switch to writing the body */
 
@@ -520,8 +520,8 @@ int32_t flashJournalStrategySequential_log_progress(void)
 
                 if (journal->prevCommand == FLASH_JOURNAL_OPCODE_COMMIT) {
                     /* This branch is taken only when commit() is called without any preceding log() operations. */
-                    journal->log.tail.crc32      = flashJournalCrcCummulative((const unsigned char *)&journal->log.tail, sizeof(SequentialFlashJournalLogTail_t));
-                    flashJournalCrcReset();
+                    flashJournalCrcUpdate(&journal->log.crc, &journal->log.tail, sizeof(SequentialFlashJournalLogTail_t));
+                    journal->log.tail.crc32      = flashJournalCrcValue(&journal->log.crc);
 
                     journal->state               = SEQUENTIAL_JOURNAL_STATE_LOGGING_TAIL;
                     journal->log.dataBeingLogged = (const uint8_t *)&journal->log.tail;
@@ -542,7 +542,7 @@ int32_t flashJournalStrategySequential_log_progress(void)
                     return JOURNAL_STATUS_SMALL_LOG_REQUEST;
                 } else {
                     uint32_t amountOfDataLogged = (journal->log.dataBeingLogged - journal->log.blob);
-                    flashJournalCrcCummulative(journal->log.blob, amountOfDataLogged); /* compute CRC32 on logged data */
+                    flashJournalCrcUpdate(&journal->log.crc, journal->log.blob, amountOfDataLogged); /* compute CRC32 on logged data */
                     return amountOfDataLogged;
                 }
 
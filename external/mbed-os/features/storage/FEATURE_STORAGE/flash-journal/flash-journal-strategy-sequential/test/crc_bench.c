@@ -0,0 +1,164 @@
+/*
+ * Host test and benchmark of the flash-journal CRC-32
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Checks the CRC against the previous implementation, which ran the
+ * unreflected table over reflected bytes, for every alignment, length and
+ * split of the message, through each of the APIs. Then measures MB/s of
+ * both over 4KB buffers, the size of a journal program unit on most parts.
+ *
+ * With FLASH_JOURNAL_CRC_HW a bitwise stand-in plays the hardware unit.
+ */
+#include "flash-journal-strategy-sequential/flash_journal_crc.h"
+#include "host_test.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+
+#define MAX_LENGTH      600
+#define BUFFER_SIZE     4096
+#define BENCH_BYTES     (256*1024*1024)
+
+// Test
+
+
+// The previous implementation, a byte-wise table of the unreflected
+// polynomial with the data and the result reflected bit by bit
+static uint32_t reflect(uint32_t data, unsigned char nBits)
+{
+    uint32_t reflection = 0;
+    for (unsigned char bit = 0; bit < nBits; ++bit) {
+        if (data & 0x01) {
+            reflection |= (1U << ((nBits - 1) - bit));
+        }
+        data = (data >> 1);
+    }
+    return reflection;
+}
+
+static uint32_t reference_table[256];
+
+static void reference_init(void)
+{
+    for (int dividend = 0; dividend < 256; ++dividend) {
+        uint32_t remainder = (uint32_t)dividend << 24;
+        for (int bit = 8; bit > 0; --bit) {
+            if (remainder & 0x80000000U) {
+                remainder = (remainder << 1) ^ 0x04C11DB7;
+            } else {
+                remainder = (remainder << 1);
+            }
+        }
+        reference_table[dividend] = remainder;
+    }
+}
+
+static uint32_t reference_crc(const uint8_t *message, size_t nBytes)
+{
+    uint32_t remainder = 0xFFFFFFFF;
+    for (size_t byte = 0; byte < nBytes; ++byte) {
+        uint8_t data = (uint8_t)reflect(message[byte], 8) ^ (remainder >> 24);
+        remainder = reference_table[data] ^ (remainder << 8);
+    }
+    return reflect(remainder, 32) ^ 0xFFFFFFFF;
+}
+
+#if defined(FLASH_JOURNAL_CRC_HW)
+// Bitwise reflected CRC-32, standing in for a CRC unit
+flash_journal_crc32_t flashJournalCrcHwUpdate(flash_journal_crc32_t remainder, const uint8_t *data, size_t nBytes)
+{
+    while (nBytes--) {
+        remainder ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            remainder = (remainder >> 1) ^ (0xEDB88320 & -(remainder & 1));
+        }
+    }
+    return remainder;
+}
+#define CRC_NAME    "hardware hook"
+#else
+#define CRC_NAME    "tables"
+#endif
+
+
+static uint8_t buffer[BUFFER_SIZE + 8];
+
+int main(void)
+{
+    reference_init();
+
+    uint32_t seed = 1;
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        seed = seed * 1103515245 + 12345;
+        buffer[i] = seed >> 16;
+    }
+
+    // The CRC-32 check value
+    check(flashJournalCrc32("123456789", 9) == 0xCBF43926);
+    check(reference_crc((const uint8_t *)"123456789", 9) == 0xCBF43926);
+
+    bool same = true;
+    for (int offset = 0; offset < 8; offset++) {
+        for (int length = 0; length < MAX_LENGTH; length++) {
+            const uint8_t *message = &buffer[offset];
+            uint32_t expected = reference_crc(message, length);
+            same = same && flashJournalCrc32(message, length) == expected;
+
+            // Split in two, and continued after taking the value
+            for (int split = 0; split <= length; split += 1 + split / 8) {
+                flash_journal_crc_t crc;
+                flashJournalCrcStart(&crc);
+                flashJournalCrcUpdate(&crc, message, split);
+                same = same && flashJournalCrcValue(&crc) == reference_crc(message, split);
+                flashJournalCrcUpdate(&crc, message + split, length - split);
+                same = same && flashJournalCrcValue(&crc) == expected;
+            }
+
+            // Byte by byte through the shared API
+            uint32_t cumulative = 0;
+            flashJournalCrcReset();
+            for (int i = 0; i < length; i++) {
+                cumulative = flashJournalCrcCummulative(message + i, 1);
+            }
+            same = same && (length == 0 || cumulative == expected);
+        }
+    }
+    check(same);
+
+    // Throughput over 4KB buffers
+    volatile uint32_t sink = 0;
+    uint64_t start = now_ns();
+    for (int i = 0; i < BENCH_BYTES / 64 / BUFFER_SIZE; i++) {
+        sink += reference_crc(buffer, BUFFER_SIZE);
+    }
+    double reference_mbs = (BENCH_BYTES / 64) / ((now_ns() - start) / 1e9) / (1024 * 1024);
+
+    start = now_ns();
+    for (int i = 0; i < BENCH_BYTES / BUFFER_SIZE; i++) {
+        sink += flashJournalCrc32(buffer, BUFFER_SIZE);
+    }
+    double mbs = BENCH_BYTES / ((now_ns() - start) / 1e9) / (1024 * 1024);
+
+#if defined(FLASH_JOURNAL_CRC_HW)
+    printf("%s: %.1f MB/s, previous %.1f MB/s\n", CRC_NAME, mbs, reference_mbs);
+#else
+    printf("%s x%d: %.1f MB/s, previous %.1f MB/s\n", CRC_NAME, FLASH_JOURNAL_CRC_SLICES, mbs, reference_mbs);
+    check(mbs > reference_mbs);
+#endif
+
+    return host_test_done();
+}
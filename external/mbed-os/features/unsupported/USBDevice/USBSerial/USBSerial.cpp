@@ -26,6 +26,23 @@ int USBSerial::_putc(int c) {
     return 1;
 }
 
+ssize_t USBSerial::_write(const void* buffer, size_t length) {
+    uint8_t *data = (uint8_t *)buffer;
+    size_t sent = 0;
+
+    if (!terminal_connected)
+        return length;
+    while (sent < length) {
+        uint32_t size = length - sent;
+        if (size > MAX_PACKET_SIZE_EPBULK)
+            size = MAX_PACKET_SIZE_EPBULK;
+        if (!send(data + sent, size))
+            break;
+        sent += size;
+    }
+    return sent;
+}
+
 int USBSerial::_getc() {
     uint8_t c = 0;
     while (buf.isEmpty());
@@ -69,6 +69,15 @@ public:
     */
     virtual int _putc(int c);
 
+    /**
+    * Send a buffer, in as few packets as the endpoint allows
+    *
+    * @param buffer data to be sent
+    * @param length number of bytes to send
+    * @returns the number of bytes sent
+    */
+    virtual ssize_t _write(const void* buffer, size_t length);
+
     /**
     * Read a character: blocking
     *
@@ -17,73 +17,283 @@
 #include "hal/ticker_api.h"
 #include "platform/mbed_critical.h"
 
+/* Longest time the interrupt is set ahead, so that the ticker is read well
+   within each wrap of its 32-bit counter and present_time stays correct */
+#define TICKER_MAX_DELTA 0x70000000UL
+
+#if defined(TICKER_COUNT_HEAP_STEPS)
+/* Levels walked and swaps made in the heap, read by the host test in
+   hal/test to bound the work done with interrupts disabled */
+uint32_t ticker_heap_steps;
+#define TICKER_HEAP_STEP() (ticker_heap_steps++)
+#else
+#define TICKER_HEAP_STEP()
+#endif
+
+/* Extend the ticker value to 64 bits. Called with interrupts disabled. */
+static void update_present_time(const ticker_data_t *const data)
+{
+    ticker_event_queue_t *queue = data->queue;
+    uint32_t ticker_time = data->interface->read();
+
+    queue->present_time += (uint32_t)(ticker_time - queue->tick_last_read);
+    queue->tick_last_read = ticker_time;
+}
+
+static void initialize(const ticker_data_t *const data)
+{
+    ticker_event_queue_t *queue = data->queue;
+
+    /* start at the ticker value, so that the lower 32 bits of present_time
+       always match the value returned by the ticker */
+    queue->tick_last_read = data->interface->read();
+    queue->present_time = queue->tick_last_read;
+    queue->initialized = 1;
+}
+
+/* Set the interrupt for the next event, or for the longest allowed time
+   if it is further away. Called with interrupts disabled. */
+static void schedule_interrupt(const ticker_data_t *const data)
+{
+    ticker_event_queue_t *queue = data->queue;
+    us_timestamp_t next = queue->present_time + TICKER_MAX_DELTA;
+
+    if (queue->head != NULL && queue->head->timestamp < next) {
+        next = queue->head->timestamp;
+    }
+    data->interface->set_interrupt((timestamp_t)next);
+}
+
+/* Find the node at 1-based position pos in the heap, walking down from the
+   root by the bits of pos below its most significant bit */
+static ticker_event_t *heap_node_at(ticker_event_queue_t *queue, uint32_t pos)
+{
+    ticker_event_t *p = queue->head;
+    uint32_t bit = 1UL << 31;
+
+    while (!(pos & bit)) {
+        bit >>= 1;
+    }
+    for (bit >>= 1; bit != 0; bit >>= 1) {
+        TICKER_HEAP_STEP();
+        p = (pos & bit) ? p->right : p->left;
+    }
+    return p;
+}
+
+/* Exchange a node with its parent, relinking both in the tree */
+static void heap_swap_with_parent(ticker_event_queue_t *queue, ticker_event_t *obj)
+{
+    ticker_event_t *parent = obj->parent;
+    ticker_event_t *grandparent = parent->parent;
+    ticker_event_t *left = obj->left;
+    ticker_event_t *right = obj->right;
+
+    TICKER_HEAP_STEP();
+    if (parent->left == obj) {
+        obj->left = parent;
+        obj->right = parent->right;
+        if (obj->right != NULL) {
+            obj->right->parent = obj;
+        }
+    } else {
+        obj->right = parent;
+        obj->left = parent->left;
+        obj->left->parent = obj;
+    }
+
+    parent->left = left;
+    parent->right = right;
+    if (left != NULL) {
+        left->parent = parent;
+    }
+    if (right != NULL) {
+        right->parent = parent;
+    }
+
+    obj->parent = grandparent;
+    parent->parent = obj;
+    if (grandparent == NULL) {
+        queue->head = obj;
+    } else if (grandparent->left == parent) {
+        grandparent->left = obj;
+    } else {
+        grandparent->right = obj;
+    }
+}
+
+/* Whether a is due before b. Events due at the same time are taken in the
+   order they were inserted, comparing sequence numbers modulo 2^32. */
+static int heap_before(const ticker_event_t *a, const ticker_event_t *b)
+{
+    if (a->timestamp != b->timestamp) {
+        return a->timestamp < b->timestamp;
+    }
+    return (int32_t)(a->sequence - b->sequence) < 0;
+}
+
+static void heap_sift_up(ticker_event_queue_t *queue, ticker_event_t *obj)
+{
+    while (obj->parent != NULL && heap_before(obj, obj->parent)) {
+        heap_swap_with_parent(queue, obj);
+    }
+}
+
+static void heap_sift_down(ticker_event_queue_t *queue, ticker_event_t *obj)
+{
+    while (obj->left != NULL) {
+        ticker_event_t *child = obj->left;
+        if (obj->right != NULL && heap_before(obj->right, child)) {
+            child = obj->right;
+        }
+        if (!heap_before(child, obj)) {
+            break;
+        }
+        heap_swap_with_parent(queue, child);
+    }
+}
+
+static void heap_insert(ticker_event_queue_t *queue, ticker_event_t *obj)
+{
+    obj->left = NULL;
+    obj->right = NULL;
+    obj->sequence = queue->sequence++;
+    queue->count++;
+
+    if (queue->count == 1) {
+        obj->parent = NULL;
+        queue->head = obj;
+        return;
+    }
+
+    /* append at the next free position of the complete tree */
+    obj->parent = heap_node_at(queue, queue->count >> 1);
+    if (queue->count & 1) {
+        obj->parent->right = obj;
+    } else {
+        obj->parent->left = obj;
+    }
+    heap_sift_up(queue, obj);
+}
+
+static void heap_remove(ticker_event_queue_t *queue, ticker_event_t *obj)
+{
+    /* detach the node at the last position and move it into obj's place */
+    ticker_event_t *last = heap_node_at(queue, queue->count);
+
+    if (last == queue->head) {
+        queue->head = NULL;
+    } else if (last->parent->left == last) {
+        last->parent->left = NULL;
+    } else {
+        last->parent->right = NULL;
+    }
+    queue->count--;
+
+    if (last != obj) {
+        last->parent = obj->parent;
+        last->left = obj->left;
+        last->right = obj->right;
+        if (last->left != NULL) {
+            last->left->parent = last;
+        }
+        if (last->right != NULL) {
+            last->right->parent = last;
+        }
+        if (last->parent == NULL) {
+            queue->head = last;
+        } else if (last->parent->left == obj) {
+            last->parent->left = last;
+        } else {
+            last->parent->right = last;
+        }
+        heap_sift_up(queue, last);
+        heap_sift_down(queue, last);
+    }
+
+    obj->parent = NULL;
+    obj->left = NULL;
+    obj->right = NULL;
+}
+
 void ticker_set_handler(const ticker_data_t *const data, ticker_event_handler handler) {
     data->interface->init();
 
+    core_util_critical_section_enter();
     data->queue->event_handler = handler;
+    if (!data->queue->initialized) {
+        initialize(data);
+        schedule_interrupt(data);
+    }
+    core_util_critical_section_exit();
 }
 
 void ticker_irq_handler(const ticker_data_t *const data) {
     data->interface->clear_interrupt();
 
     /* Go through all the pending TimerEvents */
+    core_util_critical_section_enter();
     while (1) {
-        if (data->queue->head == NULL) {
-            // There are no more TimerEvents left, so disable matches.
-            data->interface->disable_interrupt();
-            return;
+        update_present_time(data);
+        if (data->queue->head == NULL || data->queue->head->timestamp > data->queue->present_time) {
+            // There are no more events due: set the interrupt for the next one
+            schedule_interrupt(data);
+            break;
         }
 
-        if ((int)(data->queue->head->timestamp - data->interface->read()) <= 0) {
-            // This event was in the past:
-            //      point to the following one and execute its handler
-            ticker_event_t *p = data->queue->head;
-            data->queue->head = data->queue->head->next;
-            if (data->queue->event_handler != NULL) {
-                (*data->queue->event_handler)(p->id); // NOTE: the handler can set new events
-            }
-            /* Note: We continue back to examining the head because calling the
-             * event handler may have altered the chain of pending events. */
-        } else {
-            // This event and the following ones in the list are in the future:
-            //      set it as next interrupt and return
-            data->interface->set_interrupt(data->queue->head->timestamp);
-            return;
+        // This event was in the past: take it off the queue and execute its handler
+        ticker_event_t *p = data->queue->head;
+        heap_remove(data->queue, p);
+        core_util_critical_section_exit();
+        if (data->queue->event_handler != NULL) {
+            (*data->queue->event_handler)(p->id); // NOTE: the handler can set new events
         }
+        /* Note: We continue back to examining the head because calling the
+         * event handler may have altered the pending events. */
+        core_util_critical_section_enter();
     }
+    core_util_critical_section_exit();
 }
 
 void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, timestamp_t timestamp, uint32_t id) {
     /* disable interrupts for the duration of the function */
     core_util_critical_section_enter();
 
+    if (!data->queue->initialized) {
+        initialize(data);
+    }
+    update_present_time(data);
+
+    /* the 32-bit timestamp is taken to be the nearest one to the present
+       time, as before, so that a timestamp up to 2^31 us ago is overdue */
+    us_timestamp_t present = data->queue->present_time;
+    int32_t delta = (int32_t)(timestamp - (timestamp_t)present);
+    if (delta < 0 && (us_timestamp_t)(-(int64_t)delta) > present) {
+        present = 0;
+        delta = 0;
+    }
+    ticker_insert_event_us(data, obj, present + delta, id);
+
+    core_util_critical_section_exit();
+}
+
+void ticker_insert_event_us(const ticker_data_t *const data, ticker_event_t *obj, us_timestamp_t timestamp, uint32_t id) {
+    core_util_critical_section_enter();
+
+    if (!data->queue->initialized) {
+        initialize(data);
+    }
+
     // initialise our data
     obj->timestamp = timestamp;
     obj->id = id;
 
-    /* Go through the list until we either reach the end, or find
-       an element this should come before (which is possibly the
-       head). */
-    ticker_event_t *prev = NULL, *p = data->queue->head;
-    while (p != NULL) {
-        /* check if we come before p */
-        if ((int)(timestamp - p->timestamp) < 0) {
-            break;
-        }
-        /* go to the next element */
-        prev = p;
-        p = p->next;
-    }
-    
-    /* if we're at the end p will be NULL, which is correct */
-    obj->next = p;
-
-    /* if prev is NULL we're at the head */
-    if (prev == NULL) {
-        data->queue->head = obj;
-        data->interface->set_interrupt(timestamp);
-    } else {
-        prev->next = obj;
+    heap_insert(data->queue, obj);
+
+    /* set the interrupt if this is now the first event */
+    if (data->queue->head == obj) {
+        update_present_time(data);
+        schedule_interrupt(data);
     }
 
     core_util_critical_section_exit();
@@ -92,25 +302,13 @@ void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, t
 void ticker_remove_event(const ticker_data_t *const data, ticker_event_t *obj) {
     core_util_critical_section_enter();
 
-    // remove this object from the list
+    // remove this object from the queue, if it is in it
     if (data->queue->head == obj) {
-        // first in the list, so just drop me
-        data->queue->head = obj->next;
-        if (data->queue->head == NULL) {
-            data->interface->disable_interrupt();
-        } else {
-            data->interface->set_interrupt(data->queue->head->timestamp);
-        }
-    } else {
-        // find the object before me, then drop me
-        ticker_event_t* p = data->queue->head;
-        while (p != NULL) {
-            if (p->next == obj) {
-                p->next = obj->next;
-                break;
-            }
-            p = p->next;
-        }
+        heap_remove(data->queue, obj);
+        update_present_time(data);
+        schedule_interrupt(data);
+    } else if (obj->parent != NULL) {
+        heap_remove(data->queue, obj);
     }
 
     core_util_critical_section_exit();
@@ -121,6 +319,21 @@ timestamp_t ticker_read(const ticker_data_t *const data)
     return data->interface->read();
 }
 
+us_timestamp_t ticker_read_us(const ticker_data_t *const data)
+{
+    us_timestamp_t ret;
+
+    core_util_critical_section_enter();
+    if (!data->queue->initialized) {
+        initialize(data);
+    }
+    update_present_time(data);
+    ret = data->queue->present_time;
+    core_util_critical_section_exit();
+
+    return ret;
+}
+
 int ticker_get_next_timestamp(const ticker_data_t *const data, timestamp_t *timestamp)
 {
     int ret = 0;
@@ -128,7 +341,7 @@ int ticker_get_next_timestamp(const ticker_data_t *const data, timestamp_t *time
     /* if head is NULL, there are no pending events */
     core_util_critical_section_enter();
     if (data->queue->head != NULL) {
-        *timestamp = data->queue->head->timestamp;
+        *timestamp = (timestamp_t)data->queue->head->timestamp;
         ret = 1;
     }
     core_util_critical_section_exit();
@@ -0,0 +1,13 @@
+/* Host stand-in for the unity assertions, which count failures and carry on */
+#ifndef UNITY_H
+#define UNITY_H
+
+#include <stdint.h>
+#include "host_test.h"
+
+#define TEST_ASSERT_TRUE(condition) check(condition)
+#define TEST_ASSERT_FALSE(condition) check(!(condition))
+#define TEST_ASSERT_EQUAL_UINT32(expected, actual) \
+    check((uint32_t)(expected) == (uint32_t)(actual))
+
+#endif
@@ -0,0 +1,76 @@
+/* Host stand-in for utest, running each case in turn and exiting with
+ * the result of host_test_done() */
+#ifndef UTEST_H
+#define UTEST_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "unity/unity.h"
+
+namespace utest {
+namespace v1 {
+
+enum status_t {
+    STATUS_CONTINUE = 0,
+    STATUS_ABORT = -1,
+};
+
+struct failure_t {
+};
+
+struct Case;
+
+typedef status_t (*failure_handler_t)(const Case *const source, const failure_t reason);
+typedef status_t (*test_setup_handler_t)(const size_t number_of_cases);
+typedef void (*test_teardown_handler_t)(const size_t passed, const size_t failed, const failure_t failure);
+
+struct Case {
+    Case(const char *description, void (*handler)(void), failure_handler_t failure_handler)
+        : description(description), handler(handler) {}
+
+    const char *description;
+    void (*handler)(void);
+};
+
+struct Specification {
+    template <size_t N>
+    Specification(test_setup_handler_t setup, Case (&cases)[N], test_teardown_handler_t teardown)
+        : setup(setup), cases(cases), length(N) {}
+
+    test_setup_handler_t setup;
+    Case *cases;
+    size_t length;
+};
+
+static inline status_t greentea_test_setup_handler(const size_t number_of_cases)
+{
+    return STATUS_CONTINUE;
+}
+
+static inline void greentea_test_teardown_handler(const size_t passed, const size_t failed, const failure_t failure)
+{
+}
+
+static inline status_t greentea_case_failure_abort_handler(const Case *const source, const failure_t reason)
+{
+    return STATUS_ABORT;
+}
+
+struct Harness {
+    static void run(Specification &specification)
+    {
+        specification.setup(specification.length);
+        for (size_t i = 0; i < specification.length; i++) {
+            printf("%s\n", specification.cases[i].description);
+            specification.cases[i].handler();
+        }
+
+        exit(host_test_done());
+    }
+};
+
+}
+}
+
+#endif
@@ -24,12 +24,25 @@
 
 typedef uint32_t timestamp_t;
 
+/** 64-bit timestamp in microseconds, which does not wrap in practice
+ */
+typedef uint64_t us_timestamp_t;
+
 /** Ticker's event structure
+ *
+ * Events are kept in a binary min-heap linked through the parent, left and
+ * right pointers, so that inserting and removing an event takes O(log n)
+ * time with interrupts disabled. An event which is not queued has a NULL
+ * parent, so a zero initialised event may safely be removed. Events with
+ * the same timestamp fire in the order they were inserted.
  */
 typedef struct ticker_event_s {
-    timestamp_t            timestamp; /**< Event's timestamp */
+    us_timestamp_t         timestamp; /**< Event's timestamp */
     uint32_t               id;        /**< TimerEvent object */
-    struct ticker_event_s *next;      /**< Next event in the queue */
+    uint32_t               sequence;  /**< Insertion order, breaks timestamp ties */
+    struct ticker_event_s *parent;    /**< Parent event in the heap */
+    struct ticker_event_s *left;      /**< Left child event in the heap */
+    struct ticker_event_s *right;     /**< Right child event in the heap */
 } ticker_event_t;
 
 typedef void (*ticker_event_handler)(uint32_t id);
@@ -48,7 +61,12 @@ typedef struct {
  */
 typedef struct {
     ticker_event_handler event_handler; /**< Event handler */
-    ticker_event_t *head;               /**< A pointer to head */
+    ticker_event_t *head;               /**< Root of the heap, the next event due */
+    uint32_t count;                     /**< Number of queued events */
+    uint32_t sequence;                  /**< Sequence number of the next inserted event */
+    uint32_t tick_last_read;            /**< Ticker value when present_time was last updated */
+    us_timestamp_t present_time;        /**< 64-bit extension of the ticker value */
+    uint8_t initialized;                /**< Set once present_time has been started */
 } ticker_event_queue_t;
 
 /** Ticker's data structure
@@ -91,11 +109,23 @@ void ticker_remove_event(const ticker_data_t *const data, ticker_event_t *obj);
  *
  * @param data      The ticker's data
  * @param obj       The event object to be inserted to the queue
- * @param timestamp The event's timestamp
+ * @param timestamp The event's timestamp, less than 2^31 us from now
  * @param id        The event object
  */
 void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, timestamp_t timestamp, uint32_t id);
 
+/** Insert an event to the queue at an absolute 64-bit time
+ *
+ * Unlike ticker_insert_event(), the timestamp may be any distance in the
+ * future.
+ *
+ * @param data      The ticker's data
+ * @param obj       The event object to be inserted to the queue
+ * @param timestamp The event's 64-bit timestamp, as returned by ticker_read_us()
+ * @param id        The event object
+ */
+void ticker_insert_event_us(const ticker_data_t *const data, ticker_event_t *obj, us_timestamp_t timestamp, uint32_t id);
+
 /** Read the current ticker's timestamp
  *
  * @param data The ticker's data
@@ -103,6 +133,15 @@ void ticker_insert_event(const ticker_data_t *const data, ticker_event_t *obj, t
  */
 timestamp_t ticker_read(const ticker_data_t *const data);
 
+/** Read the current ticker's timestamp extended to 64 bits
+ *
+ * The lower 32 bits are the same as those returned by ticker_read().
+ *
+ * @param data The ticker's data
+ * @return The current 64-bit timestamp
+ */
+us_timestamp_t ticker_read_us(const ticker_data_t *const data);
+
 /** Read the next event's timestamp
  *
  * @param data The ticker's data
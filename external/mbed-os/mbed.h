@@ -85,6 +85,7 @@
 #include "drivers/Ethernet.h"
 #include "drivers/CAN.h"
 #include "drivers/RawSerial.h"
+#include "drivers/BufferedSerial.h"
 #include "drivers/FlashIAP.h"
 
 // mbed Internal components
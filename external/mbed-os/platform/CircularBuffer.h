@@ -23,6 +23,9 @@ namespace mbed {
 /** @{*/
 
 /** Templated Circular buffer class
+ *
+ *  Every operation runs in a critical section. When there is only one
+ *  producer and one consumer, SPSCCircularBuffer avoids that cost.
  *
  *  @Note Synchronization level: Interrupt safe
  */
@@ -0,0 +1,209 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SPSCCIRCULARBUFFER_H
+#define MBED_SPSCCIRCULARBUFFER_H
+
+#include <stdint.h>
+#include "cmsis.h"
+#include "platform/mbed_assert.h"
+
+namespace mbed {
+/** \addtogroup platform */
+/** @{*/
+
+/** Templated circular buffer for one producer and one consumer
+ *
+ *  Unlike CircularBuffer, no operation disables interrupts. The producer
+ *  only writes the head index and the consumer only writes the tail index,
+ *  and memory barriers order the element accesses around them. This makes
+ *  it suitable for passing data from an interrupt handler to a thread, or
+ *  from one thread to another, at high rates.
+ *
+ *  A power of two BufferSize lets the index arithmetic use masks.
+ *
+ *  @Note Synchronization level: Interrupt safe for one producer (push)
+ *  and one consumer (pop) context
+ */
+template<typename T, uint32_t BufferSize, typename CounterType = uint32_t>
+class SPSCCircularBuffer {
+public:
+    MBED_STATIC_ASSERT(BufferSize > 0, "SPSCCircularBuffer must not be empty");
+    MBED_STATIC_ASSERT((CounterType)(2 * BufferSize - 1) == 2 * BufferSize - 1,
+        "CounterType must be able to hold twice the BufferSize");
+
+    SPSCCircularBuffer() : _head(0), _tail(0) {
+    }
+
+    ~SPSCCircularBuffer() {
+    }
+
+    /** Push an element to the buffer. Called by the producer only.
+     *
+     * @param data Data to be pushed to the buffer
+     * @return True if the data was pushed, false if the buffer was full
+     */
+    bool push(const T& data) {
+        CounterType head = _head;
+        CounterType tail = _tail;
+        __DMB();
+        if (count(head, tail) == BufferSize) {
+            return false;
+        }
+        _pool[slot(head)] = data;
+        __DMB();
+        _head = advance(head, 1);
+        return true;
+    }
+
+    /** Push as many elements as fit in the buffer. Called by the producer only.
+     *
+     * @param data Elements to be pushed to the buffer
+     * @param n    Number of elements in data
+     * @return The number of elements pushed
+     */
+    uint32_t push(const T *data, uint32_t n) {
+        CounterType head = _head;
+        CounterType tail = _tail;
+        __DMB();
+        uint32_t space = BufferSize - count(head, tail);
+        if (n > space) {
+            n = space;
+        }
+        uint32_t index = slot(head);
+        for (uint32_t i = 0; i < n; i++) {
+            _pool[index] = data[i];
+            if (++index == BufferSize) {
+                index = 0;
+            }
+        }
+        __DMB();
+        _head = advance(head, n);
+        return n;
+    }
+
+    /** Pop an element from the buffer. Called by the consumer only.
+     *
+     * @param data Where to store the popped element
+     * @return True if an element was popped, false if the buffer was empty
+     */
+    bool pop(T& data) {
+        CounterType tail = _tail;
+        CounterType head = _head;
+        __DMB();
+        if (head == tail) {
+            return false;
+        }
+        data = _pool[slot(tail)];
+        __DMB();
+        _tail = advance(tail, 1);
+        return true;
+    }
+
+    /** Pop up to n elements from the buffer. Called by the consumer only.
+     *
+     * @param data Where to store the popped elements
+     * @param n    Maximum number of elements to pop
+     * @return The number of elements popped
+     */
+    uint32_t pop(T *data, uint32_t n) {
+        CounterType tail = _tail;
+        CounterType head = _head;
+        __DMB();
+        uint32_t available = count(head, tail);
+        if (n > available) {
+            n = available;
+        }
+        uint32_t index = slot(tail);
+        for (uint32_t i = 0; i < n; i++) {
+            data[i] = _pool[index];
+            if (++index == BufferSize) {
+                index = 0;
+            }
+        }
+        __DMB();
+        _tail = advance(tail, n);
+        return n;
+    }
+
+    /** Check if the buffer is empty
+     *
+     * @return True if the buffer is empty, false if not
+     */
+    bool empty() const {
+        return _head == _tail;
+    }
+
+    /** Check if the buffer is full
+     *
+     * @return True if the buffer is full, false if not
+     */
+    bool full() const {
+        return count(_head, _tail) == BufferSize;
+    }
+
+    /** Get the number of elements in the buffer
+     *
+     * @return The number of elements in the buffer
+     */
+    uint32_t size() const {
+        return count(_head, _tail);
+    }
+
+    /** Reset the buffer. Neither the producer nor the consumer may be using
+     *  the buffer at the same time.
+     */
+    void reset() {
+        _head = 0;
+        _tail = 0;
+    }
+
+private:
+    /* The head and tail run from 0 to 2 * BufferSize - 1, so that a full
+     * buffer can be told from an empty one without a separate flag. */
+    static const bool is_pow2 = (BufferSize & (BufferSize - 1)) == 0;
+
+    static uint32_t slot(uint32_t index) {
+        if (is_pow2) {
+            return index & (BufferSize - 1);
+        }
+        return index >= BufferSize ? index - BufferSize : index;
+    }
+
+    static CounterType advance(uint32_t index, uint32_t n) {
+        if (is_pow2) {
+            return (index + n) & (2 * BufferSize - 1);
+        }
+        index += n;
+        return index >= 2 * BufferSize ? index - 2 * BufferSize : index;
+    }
+
+    static uint32_t count(uint32_t head, uint32_t tail) {
+        if (is_pow2) {
+            return (head - tail) & (2 * BufferSize - 1);
+        }
+        return head >= tail ? head - tail : head + 2 * BufferSize - tail;
+    }
+
+    T _pool[BufferSize];
+    volatile CounterType _head;
+    volatile CounterType _tail;
+};
+
+}
+
+#endif
+
+/** @}*/
@@ -0,0 +1,161 @@
+/*
+ * Host stand-ins for the target code the host tests link against
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * A recursive mutex shared by all threads plays the part of masking
+ * interrupts, and every exit from the critical section is checked against
+ * an enter. The atomic operations are the compiler's builtins. The us
+ * ticker reads the monotonic clock and never interrupts, which is all the
+ * tests that read the time through it need.
+ */
+#include "host_test.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_critical.h"
+#include "hal/us_ticker_api.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+
+int host_test_failures;
+volatile unsigned host_mutex_contended;
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assert %s %s:%d\n", expr, file, line);
+    abort();
+}
+
+
+// Critical section
+static pthread_once_t critical_section_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t critical_section_mutex;
+static __thread uint32_t critical_section_depth;
+
+static void critical_section_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical_section_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+bool core_util_are_interrupts_enabled(void)
+{
+    return critical_section_depth == 0;
+}
+
+void core_util_critical_section_enter(void)
+{
+    pthread_once(&critical_section_once, critical_section_init);
+    pthread_mutex_lock(&critical_section_mutex);
+    critical_section_depth++;
+}
+
+void core_util_critical_section_exit(void)
+{
+    assert(critical_section_depth > 0);
+    critical_section_depth--;
+    pthread_mutex_unlock(&critical_section_mutex);
+}
+
+
+// Atomic operations
+#define ATOMIC_CAS(ptr, expected, desired) \
+    __atomic_compare_exchange_n(ptr, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+bool core_util_atomic_cas_u8(uint8_t *ptr, uint8_t *expectedCurrentValue, uint8_t desiredValue)
+{
+    return ATOMIC_CAS(ptr, expectedCurrentValue, desiredValue);
+}
+
+bool core_util_atomic_cas_u16(uint16_t *ptr, uint16_t *expectedCurrentValue, uint16_t desiredValue)
+{
+    return ATOMIC_CAS(ptr, expectedCurrentValue, desiredValue);
+}
+
+bool core_util_atomic_cas_u32(uint32_t *ptr, uint32_t *expectedCurrentValue, uint32_t desiredValue)
+{
+    return ATOMIC_CAS(ptr, expectedCurrentValue, desiredValue);
+}
+
+bool core_util_atomic_cas_ptr(void **ptr, void **expectedCurrentValue, void *desiredValue)
+{
+    return ATOMIC_CAS(ptr, expectedCurrentValue, desiredValue);
+}
+
+uint8_t core_util_atomic_incr_u8(uint8_t *valuePtr, uint8_t delta)
+{
+    return __atomic_add_fetch(valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+uint16_t core_util_atomic_incr_u16(uint16_t *valuePtr, uint16_t delta)
+{
+    return __atomic_add_fetch(valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+uint32_t core_util_atomic_incr_u32(uint32_t *valuePtr, uint32_t delta)
+{
+    return __atomic_add_fetch(valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+void *core_util_atomic_incr_ptr(void **valuePtr, ptrdiff_t delta)
+{
+    return (void *)__atomic_add_fetch((uintptr_t *)valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+uint8_t core_util_atomic_decr_u8(uint8_t *valuePtr, uint8_t delta)
+{
+    return __atomic_sub_fetch(valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+uint16_t core_util_atomic_decr_u16(uint16_t *valuePtr, uint16_t delta)
+{
+    return __atomic_sub_fetch(valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+uint32_t core_util_atomic_decr_u32(uint32_t *valuePtr, uint32_t delta)
+{
+    return __atomic_sub_fetch(valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+void *core_util_atomic_decr_ptr(void **valuePtr, ptrdiff_t delta)
+{
+    return (void *)__atomic_sub_fetch((uintptr_t *)valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+
+// us ticker
+void us_ticker_init(void)
+{
+}
+
+uint32_t us_ticker_read(void)
+{
+    return (uint32_t)(now_ns() / 1000);
+}
+
+void us_ticker_set_interrupt(timestamp_t timestamp)
+{
+}
+
+void us_ticker_disable_interrupt(void)
+{
+}
+
+void us_ticker_clear_interrupt(void)
+{
+}
@@ -0,0 +1,65 @@
+/*
+ * Harness shared by the host tests
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * check() reports a condition that does not hold with its file and line,
+ * and counts it from any thread. The count lives in host_stubs.c, so a test
+ * built from several sources reports all of them, and host_test_done()
+ * prints the result and gives the exit status.
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int host_test_failures;
+
+#define check(test) do { \
+        if (!(test)) { \
+            printf("\e[1m\e[31mfail\e[0m %s:%d: %s\n", __FILE__, __LINE__, #test); \
+            __sync_fetch_and_add(&host_test_failures, 1); \
+        } \
+    } while (0)
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Prints the result, returns the exit status
+static inline int host_test_done(void)
+{
+    if (host_test_failures) {
+        printf("\e[1m\e[31m%d failures\e[0m\n", host_test_failures);
+    } else {
+        printf("\e[1m\e[32mdone\e[0m\n");
+    }
+
+    return host_test_failures != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,15 @@
+# Part shared by the host test Makefiles: host_test.h, the stand-ins in
+# port/ for the RTOS and target headers, and host_stubs.c
+#
+# Set MBED to the root of mbed-os before including this, put $(HOST_FLAGS)
+# after the test's own port directory and before $(MBED) on the include
+# path, and link $(HOST_OBJ) into each test. HOST_BUILD is the test's
+# build directory.
+
+HOST = $(MBED)/platform/test/host
+HOST_BUILD ?= build
+HOST_OBJ = $(HOST_BUILD)/host_stubs.o
+HOST_FLAGS = -I$(HOST) -I$(HOST)/port
+
+$(HOST_BUILD)/%.o: $(HOST)/%.c | $(HOST_BUILD)
+	$(CC) -c -O2 -std=gnu99 -pthread $(HOST_FLAGS) -I$(MBED) $< -o $@
@@ -0,0 +1,102 @@
+/* Host stand-in for the CMSIS-RTOS status codes and thread signals, with
+ * the values of the RTX cmsis_os.h. Each thread gets its signal flags on
+ * first use. */
+#ifndef CMSIS_OS_H
+#define CMSIS_OS_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#define osWaitForever 0xFFFFFFFF
+
+typedef enum {
+    osOK = 0,
+    osEventSignal = 0x08,
+    osEventMessage = 0x10,
+    osEventTimeout = 0x40,
+    osErrorResource = 0x81,
+    osErrorValue = 0x86,
+} osStatus;
+
+typedef struct {
+    osStatus status;
+    union {
+        int32_t signals;
+    } value;
+} osEvent;
+
+typedef struct os_thread {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int32_t signals;
+} *osThreadId;
+
+// Deadline for a timed pthread wait
+static inline struct timespec os_deadline(uint32_t millisec)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += millisec / 1000;
+    ts.tv_nsec += (millisec % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec += 1;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+inline osThreadId osThreadGetId(void)
+{
+    static __thread struct os_thread self = {
+        PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0
+    };
+    return &self;
+}
+
+inline int32_t osSignalSet(osThreadId thread, int32_t signals)
+{
+    pthread_mutex_lock(&thread->mutex);
+    int32_t old = thread->signals;
+    thread->signals |= signals;
+    pthread_cond_broadcast(&thread->cond);
+    pthread_mutex_unlock(&thread->mutex);
+    return old;
+}
+
+inline int32_t osSignalClear(osThreadId thread, int32_t signals)
+{
+    pthread_mutex_lock(&thread->mutex);
+    int32_t old = thread->signals;
+    thread->signals &= ~signals;
+    pthread_mutex_unlock(&thread->mutex);
+    return old;
+}
+
+inline osEvent osSignalWait(int32_t signals, uint32_t millisec)
+{
+    osThreadId self = osThreadGetId();
+    struct timespec deadline = os_deadline(millisec);
+    osEvent event = {osEventTimeout, {0}};
+
+    pthread_mutex_lock(&self->mutex);
+    while ((self->signals & signals) != signals) {
+        if (millisec == 0) {
+            break;
+        } else if (millisec == osWaitForever) {
+            pthread_cond_wait(&self->cond, &self->mutex);
+        } else if (pthread_cond_timedwait(&self->cond, &self->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if ((self->signals & signals) == signals) {
+        event.status = osEventSignal;
+        event.value.signals = self->signals;
+        self->signals &= ~signals;
+    }
+    pthread_mutex_unlock(&self->mutex);
+    return event;
+}
+
+#endif
@@ -0,0 +1,5 @@
+/* Host stand-in for the target's device.h, which the ticker API needs nothing from */
+#ifndef MBED_DEVICE_H
+#define MBED_DEVICE_H
+
+#endif
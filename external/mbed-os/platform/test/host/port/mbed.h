@@ -0,0 +1,17 @@
+/* Host stand-in for mbed.h, with the C library parts. Tests that need more
+ * of it keep their own. */
+#ifndef MBED_H
+#define MBED_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+namespace mbed {
+}
+
+using namespace mbed;
+#endif
+
+#endif
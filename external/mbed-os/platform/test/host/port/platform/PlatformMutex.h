@@ -0,0 +1,8 @@
+/* Host stand-in for PlatformMutex, as with the RTOS present */
+#ifndef PLATFORM_MUTEX_H
+#define PLATFORM_MUTEX_H
+
+#include "rtos/Mutex.h"
+typedef rtos::Mutex PlatformMutex;
+
+#endif
@@ -0,0 +1,49 @@
+/* Host stand-in for rtos::Mutex, a recursive pthread mutex. Counts the
+ * times a thread had to wait for another to unlock. */
+#ifndef MUTEX_H
+#define MUTEX_H
+
+#include "cmsis_os.h"
+
+extern "C" volatile unsigned host_mutex_contended;
+
+namespace rtos {
+
+class Mutex {
+public:
+    Mutex() {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&_mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+    }
+
+    ~Mutex() {
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    osStatus lock(uint32_t millisec = osWaitForever) {
+        if (pthread_mutex_trylock(&_mutex) != 0) {
+            __sync_fetch_and_add(&host_mutex_contended, 1);
+            pthread_mutex_lock(&_mutex);
+        }
+        return osOK;
+    }
+
+    bool trylock() {
+        return pthread_mutex_trylock(&_mutex) == 0;
+    }
+
+    osStatus unlock() {
+        pthread_mutex_unlock(&_mutex);
+        return osOK;
+    }
+
+private:
+    pthread_mutex_t _mutex;
+};
+
+} // namespace rtos
+
+#endif
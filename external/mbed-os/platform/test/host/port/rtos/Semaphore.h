@@ -0,0 +1,59 @@
+/* Host stand-in for rtos::Semaphore over a pthread condition */
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include "cmsis_os.h"
+
+namespace rtos {
+
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0) : _count(count) {
+        pthread_mutex_init(&_mutex, NULL);
+        pthread_cond_init(&_cond, NULL);
+    }
+
+    ~Semaphore() {
+        pthread_cond_destroy(&_cond);
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    // Returns the tokens available before taking one, or 0 on timeout
+    int32_t wait(uint32_t millisec = osWaitForever) {
+        struct timespec deadline = os_deadline(millisec);
+
+        pthread_mutex_lock(&_mutex);
+        while (_count == 0) {
+            if (millisec == 0) {
+                break;
+            } else if (millisec == osWaitForever) {
+                pthread_cond_wait(&_cond, &_mutex);
+            } else if (pthread_cond_timedwait(&_cond, &_mutex, &deadline) == ETIMEDOUT) {
+                break;
+            }
+        }
+        int32_t count = _count;
+        if (_count > 0) {
+            _count--;
+        }
+        pthread_mutex_unlock(&_mutex);
+        return count;
+    }
+
+    osStatus release() {
+        pthread_mutex_lock(&_mutex);
+        _count++;
+        pthread_cond_signal(&_cond);
+        pthread_mutex_unlock(&_mutex);
+        return osOK;
+    }
+
+private:
+    pthread_mutex_t _mutex;
+    pthread_cond_t _cond;
+    int32_t _count;
+};
+
+} // namespace rtos
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * Host test of SPSCCircularBuffer with a producer and a consumer thread
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Checks full, empty, size and wrapping from one thread, for power of two
+ * and other sizes and a narrow counter. Then a producer thread pushes a
+ * running count, singly and in bulk runs of varying length, and a consumer
+ * thread pops it the same ways and checks that nothing is lost, repeated or
+ * reordered. Either side yields when the buffer is full or empty.
+ *
+ * The same transfer through CircularBuffer, with a mutex standing in for
+ * the critical section, gives the throughput to compare against.
+ */
+#include "platform/SPSCCircularBuffer.h"
+#include "platform/CircularBuffer.h"
+#include "host_test.h"
+#include <pthread.h>
+#include <sched.h>
+
+using namespace mbed;
+
+
+#define ITEMS           10000000
+#define MAX_RUN         40
+
+
+// Run lengths from 1 to MAX_RUN, the same sequence for any seed
+static uint32_t next_run(uint32_t *state)
+{
+    *state = *state * 1103515245 + 12345;
+    return 1 + (*state >> 16) % MAX_RUN;
+}
+
+
+// One thread
+template <typename Buffer, uint32_t Size>
+static void test_single(void)
+{
+    Buffer buffer;
+    uint32_t data[3 * Size];
+    uint32_t value;
+
+    check(buffer.empty() && !buffer.full() && buffer.size() == 0);
+    check(!buffer.pop(value));
+
+    for (uint32_t i = 0; i < Size; i++) {
+        check(buffer.push(i));
+    }
+    check(buffer.full() && !buffer.empty() && buffer.size() == Size);
+    check(!buffer.push(Size));
+    for (uint32_t i = 0; i < Size; i++) {
+        check(buffer.pop(value) && value == i);
+    }
+    check(buffer.empty() && !buffer.pop(value));
+
+    // Bulk operations are cut to the space and the data there is, and
+    // wrap around the end of the pool and of the counters
+    uint32_t next_push = 0;
+    uint32_t next_pop = 0;
+    uint32_t state = 1;
+    bool same = true;
+    for (uint32_t round = 0; round < 8 * Size; round++) {
+        uint32_t n = next_run(&state) % (Size + 2);
+        for (uint32_t i = 0; i < n; i++) {
+            data[i] = next_push + i;
+        }
+        uint32_t space = Size - buffer.size();
+        uint32_t pushed = buffer.push(data, n);
+        same = same && pushed == (n < space ? n : space);
+        next_push += pushed;
+
+        n = next_run(&state) % (Size + 2);
+        uint32_t available = buffer.size();
+        uint32_t popped = buffer.pop(data, n);
+        same = same && popped == (n < available ? n : available);
+        for (uint32_t i = 0; i < popped; i++) {
+            same = same && data[i] == next_pop++;
+        }
+        same = same && buffer.size() == next_push - next_pop;
+    }
+    check(same);
+
+    buffer.reset();
+    check(buffer.empty() && buffer.size() == 0);
+}
+
+
+// Two threads
+template <typename Buffer>
+struct Transfer {
+    Buffer buffer;
+    bool bulk;
+    uint32_t items;
+    uint32_t errors;
+};
+
+template <typename Buffer>
+static void *spsc_producer(void *arg)
+{
+    Transfer<Buffer> *t = (Transfer<Buffer> *)arg;
+    uint32_t data[MAX_RUN];
+    uint32_t state = 1;
+    uint32_t next = 0;
+
+    while (next < t->items) {
+        uint32_t n = t->bulk ? next_run(&state) : 1;
+        if (n > t->items - next) {
+            n = t->items - next;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            data[i] = next + i;
+        }
+        uint32_t pushed = n == 1 ? t->buffer.push(data[0]) : t->buffer.push(data, n);
+        if (pushed == 0) {
+            sched_yield();
+        }
+        next += pushed;
+    }
+    return NULL;
+}
+
+template <typename Buffer>
+static void *spsc_consumer(void *arg)
+{
+    Transfer<Buffer> *t = (Transfer<Buffer> *)arg;
+    uint32_t data[MAX_RUN];
+    uint32_t state = 2;
+    uint32_t next = 0;
+
+    while (next < t->items) {
+        uint32_t n = t->bulk ? next_run(&state) : 1;
+        uint32_t popped = n == 1 ? t->buffer.pop(data[0]) : t->buffer.pop(data, n);
+        if (popped == 0) {
+            sched_yield();
+        }
+        for (uint32_t i = 0; i < popped; i++) {
+            if (data[i] != next++) {
+                t->errors++;
+            }
+        }
+    }
+    return NULL;
+}
+
+// CircularBuffer overwrites when full, so the only producer waits for space
+template <typename Buffer>
+static void *locked_producer(void *arg)
+{
+    Transfer<Buffer> *t = (Transfer<Buffer> *)arg;
+
+    for (uint32_t next = 0; next < t->items; next++) {
+        while (t->buffer.full()) {
+            sched_yield();
+        }
+        t->buffer.push(next);
+    }
+    return NULL;
+}
+
+template <typename Buffer>
+static void *locked_consumer(void *arg)
+{
+    Transfer<Buffer> *t = (Transfer<Buffer> *)arg;
+    uint32_t value;
+
+    for (uint32_t next = 0; next < t->items; next++) {
+        while (!t->buffer.pop(value)) {
+            sched_yield();
+        }
+        if (value != next) {
+            t->errors++;
+        }
+    }
+    return NULL;
+}
+
+// Moves items from a producer to a consumer thread, returning millions of
+// items per second
+template <typename Buffer>
+static double run(const char *name, void *(*producer)(void *), void *(*consumer)(void *), bool bulk)
+{
+    static Transfer<Buffer> t;
+    pthread_t threads[2];
+
+    t.buffer.reset();
+    t.bulk = bulk;
+    t.items = ITEMS;
+    t.errors = 0;
+
+    uint64_t start = now_ns();
+    pthread_create(&threads[0], NULL, consumer, &t);
+    pthread_create(&threads[1], NULL, producer, &t);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    double rate = ITEMS / ((now_ns() - start) / 1e3);
+
+    printf("%-36s %6.1f M items/s\n", name, rate);
+    check(t.errors == 0);
+    check(t.buffer.empty());
+    return rate;
+}
+
+int main(void)
+{
+    test_single<SPSCCircularBuffer<uint32_t, 16>, 16>();
+    test_single<SPSCCircularBuffer<uint32_t, 12>, 12>();
+    test_single<SPSCCircularBuffer<uint32_t, 1>, 1>();
+    test_single<SPSCCircularBuffer<uint32_t, 64, uint8_t>, 64>();
+    test_single<SPSCCircularBuffer<uint32_t, 100, uint8_t>, 100>();
+
+    typedef SPSCCircularBuffer<uint32_t, 256> Pow2;
+    typedef SPSCCircularBuffer<uint32_t, 250> NotPow2;
+    typedef SPSCCircularBuffer<uint32_t, 64, uint8_t> Narrow;
+    typedef CircularBuffer<uint32_t, 256> Locked;
+
+    printf("%u items from a producer to a consumer thread\n", ITEMS);
+    double single = run<Pow2>("SPSCCircularBuffer<256>",
+            spsc_producer<Pow2>, spsc_consumer<Pow2>, false);
+    double bulk = run<Pow2>("SPSCCircularBuffer<256>, bulk",
+            spsc_producer<Pow2>, spsc_consumer<Pow2>, true);
+    run<NotPow2>("SPSCCircularBuffer<250>",
+            spsc_producer<NotPow2>, spsc_consumer<NotPow2>, false);
+    run<NotPow2>("SPSCCircularBuffer<250>, bulk",
+            spsc_producer<NotPow2>, spsc_consumer<NotPow2>, true);
+    run<Narrow>("SPSCCircularBuffer<64, uint8_t>, bulk",
+            spsc_producer<Narrow>, spsc_consumer<Narrow>, true);
+    double locked = run<Locked>("CircularBuffer<256>, locked",
+            locked_producer<Locked>, locked_consumer<Locked>, false);
+
+    check(single > locked);
+    check(bulk > single);
+
+    return host_test_done();
+}
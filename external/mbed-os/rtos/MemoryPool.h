@@ -25,43 +25,66 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "cmsis.h"
 #include "cmsis_os.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_critical.h"
 
 namespace rtos {
 /** \addtogroup rtos */
 /** @{*/
 
 /** Define and manage fixed-size memory pools of objects of a given type.
+
+  Blocks are kept on a free list which is updated with an atomic compare
+  and exchange, so alloc and free never enter the kernel or disable
+  interrupts, and may be called from threads and interrupt handlers.
+
   @tparam  T         data type of a single object (element).
   @tparam  queue_sz  maximum number of objects (elements) in the memory pool.
 */
 template<typename T, uint32_t pool_sz>
 class MemoryPool {
+    MBED_STATIC_ASSERT(pool_sz > 0 && pool_sz < 0xFFFF, "MemoryPool must hold between 1 and 65534 blocks");
+
 public:
     /** Create and Initialize a memory pool. */
     MemoryPool() {
-    #ifdef CMSIS_OS_RTX
         memset(_pool_m, 0, sizeof(_pool_m));
-        _pool_def.pool = _pool_m;
-
-        _pool_def.pool_sz = pool_sz;
-        _pool_def.item_sz =  sizeof(T);
-    #endif
-        _pool_id = osPoolCreate(&_pool_def);
+        for (uint32_t i = 0; i < pool_sz; i++) {
+            _pool_m[i][0] = i + 2;
+        }
+        _pool_m[pool_sz - 1][0] = 0;
+        _free = 1;
     }
 
     /** Allocate a memory block of type T from a memory pool.
       @return  address of the allocated memory block or NULL in case of no memory available.
     */
     T* alloc(void) {
-        return (T*)osPoolAlloc(_pool_id);
+        uint32_t head = _free;
+        uint32_t next;
+        do {
+            if ((head & 0xFFFF) == 0) {
+                return NULL;
+            }
+            /* The block may be taken and written by another context before
+               the exchange below; the tag then makes the exchange fail. */
+            next = ((head + 0x10000) & 0xFFFF0000) | _pool_m[(head & 0xFFFF) - 1][0];
+        } while (!core_util_atomic_cas_u32((uint32_t *)&_free, &head, next));
+
+        return (T*)_pool_m[(head & 0xFFFF) - 1];
     }
 
     /** Allocate a memory block of type T from a memory pool and set memory block to zero.
       @return  address of the allocated memory block or NULL in case of no memory available.
     */
     T* calloc(void) {
-        return (T*)osPoolCAlloc(_pool_id);
+        T *block = alloc();
+        if (block != NULL) {
+            memset(block, 0, sizeof(_pool_m[0]));
+        }
+        return block;
     }
 
     /** Return an allocated memory block back to a specific memory pool.
@@ -69,15 +92,32 @@ public:
       @return  status code that indicates the execution status of the function.
     */
     osStatus free(T *block) {
-        return osPoolFree(_pool_id, (void*)block);
+        uint32_t *mem = (uint32_t *)block;
+        if (mem < _pool_m[0] || mem > _pool_m[pool_sz - 1] ||
+                (uint32_t)((char *)mem - (char *)_pool_m) % sizeof(_pool_m[0]) != 0) {
+            return osErrorValue;
+        }
+        uint32_t index = (uint32_t)((char *)mem - (char *)_pool_m) / sizeof(_pool_m[0]) + 1;
+
+        uint32_t head = _free;
+        uint32_t next;
+        do {
+            mem[0] = head & 0xFFFF;
+            __DMB();
+            next = ((head + 0x10000) & 0xFFFF0000) | index;
+        } while (!core_util_atomic_cas_u32((uint32_t *)&_free, &head, next));
+
+        return osOK;
     }
 
 private:
-    osPoolId    _pool_id;
-    osPoolDef_t _pool_def;
-#ifdef CMSIS_OS_RTX
-    uint32_t    _pool_m[3+((sizeof(T)+3)/4)*(pool_sz)];
-#endif
+    /* Index + 1 of the first free block in the lower 16 bits, 0 if none.
+       The upper 16 bits change on every update, so that an exchange based
+       on a stale read of the list fails even if the same block is back at
+       its head. Free blocks hold the index + 1 of the next free block in
+       their first word. */
+    volatile uint32_t _free;
+    uint32_t _pool_m[pool_sz][(sizeof(T) + 3) / 4 > 0 ? (sizeof(T) + 3) / 4 : 1];
 };
 
 }
@@ -0,0 +1,261 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2017 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef OBJECTQUEUE_H
+#define OBJECTQUEUE_H
+
+#include <stdint.h>
+#include <new>
+#if __cplusplus >= 201103L
+#include <utility>
+#endif
+
+#include "cmsis.h"
+#include "cmsis_os.h"
+#include "rtos/Semaphore.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_critical.h"
+
+namespace rtos {
+/** \addtogroup rtos */
+/** @{*/
+
+/** The ObjectQueue class passes objects of type T to a thread or interrupt
+ service routine by value.
+
+ Unlike Queue, which carries a pointer through the kernel and usually needs a
+ MemoryPool or Mail to hold the data, the objects are copied (or moved) into
+ the queue's own storage. Slots are claimed with an atomic compare and
+ exchange, so put and try_get never enter the kernel or disable interrupts.
+ The kernel is only used by get() when it has to wait, and by put() when a
+ thread is waiting in get().
+
+ A put or get which is interrupted between claiming a slot and finishing
+ with it makes that slot look empty or full to the interrupt handler until
+ the interrupted context resumes.
+
+  @tparam  T         data type of a single message element.
+  @tparam  queue_sz  maximum number of messages in queue, rounded up to a power of two.
+
+ @Note Synchronization level: Thread and interrupt safe, get() with a timeout
+ other than 0 may only be called from threads.
+*/
+template<typename T, uint32_t queue_sz>
+class ObjectQueue {
+    MBED_STATIC_ASSERT(queue_sz > 0 && queue_sz <= 0x80000000, "ObjectQueue size out of range");
+
+public:
+    /** Create and initialise an object queue. */
+    ObjectQueue() : _enqueue_pos(0), _dequeue_pos(0), _waiters(0) {
+        for (uint32_t i = 0; i <= mask; i++) {
+            _cells[i].sequence = i;
+        }
+    }
+
+    /** Destroy the objects which are left in the queue. */
+    ~ObjectQueue() {
+        uint32_t pos;
+        T *obj;
+        while ((obj = claim_full(pos)) != NULL) {
+            obj->~T();
+            release(pos);
+        }
+    }
+
+    /** Copy an object into the queue.
+      @param   data      object to copy.
+      @return  osOK, or osErrorResource if the queue is full.
+    */
+    osStatus put(const T &data) {
+        uint32_t pos;
+        void *cell = claim_empty(pos);
+        if (cell == NULL) {
+            return osErrorResource;
+        }
+        new (cell) T(data);
+        publish(pos);
+        return osOK;
+    }
+
+#if __cplusplus >= 201103L
+    /** Move an object into the queue.
+      @param   data      object to move from.
+      @return  osOK, or osErrorResource if the queue is full.
+    */
+    osStatus put(T &&data) {
+        uint32_t pos;
+        void *cell = claim_empty(pos);
+        if (cell == NULL) {
+            return osErrorResource;
+        }
+        new (cell) T(std::move(data));
+        publish(pos);
+        return osOK;
+    }
+#endif
+
+    /** Take the oldest object from the queue without waiting.
+      @param   data      assigned the object taken from the queue.
+      @return  true if an object was taken, false if the queue was empty.
+    */
+    bool try_get(T &data) {
+        uint32_t pos;
+        T *obj = claim_full(pos);
+        if (obj == NULL) {
+            return false;
+        }
+#if __cplusplus >= 201103L
+        data = std::move(*obj);
+#else
+        data = *obj;
+#endif
+        obj->~T();
+        release(pos);
+        return true;
+    }
+
+    /** Take the oldest object from the queue, waiting for one if it is empty.
+      @param   data      assigned the object taken from the queue.
+      @param   millisec  timeout value or 0 in case of no time-out. (default: osWaitForever).
+      @return  osEventMessage if an object was taken, osOK if the queue was
+               empty and millisec is 0, osEventTimeout if the time ran out.
+
+      @note A wake-up which finds the queue empty again restarts the timeout,
+            so the total wait may be longer than millisec.
+    */
+    osStatus get(T &data, uint32_t millisec=osWaitForever) {
+        while (!try_get(data)) {
+            if (millisec == 0) {
+                return osOK;
+            }
+
+            /* Announce the waiter before looking again, so that a put()
+               which the second look misses is sure to see it */
+            core_util_atomic_incr_u32((uint32_t *)&_waiters, 1);
+            __DMB();
+            bool found = try_get(data);
+            int32_t tokens = found ? 1 : _wake.wait(millisec);
+            core_util_atomic_decr_u32((uint32_t *)&_waiters, 1);
+
+            if (found) {
+                return osEventMessage;
+            }
+            if (tokens <= 0) {
+                return osEventTimeout;
+            }
+        }
+        return osEventMessage;
+    }
+
+    /** Check if the queue is empty
+      @return  true if there was no object in the queue when checked.
+    */
+    bool empty() const {
+        return _enqueue_pos == _dequeue_pos;
+    }
+
+private:
+    /* Capacity - 1, queue_sz - 1 with all lower bits set */
+    static const uint32_t _m0 = queue_sz - 1;
+    static const uint32_t _m1 = _m0 | (_m0 >> 1);
+    static const uint32_t _m2 = _m1 | (_m1 >> 2);
+    static const uint32_t _m3 = _m2 | (_m2 >> 4);
+    static const uint32_t _m4 = _m3 | (_m3 >> 8);
+    static const uint32_t mask = _m4 | (_m4 >> 16);
+
+    /* A cell at index pos & mask is free for the put() at position pos when
+       its sequence equals pos, and holds an object for the get() at position
+       pos when its sequence equals pos + 1. Taking the object hands the cell
+       on to the put() at position pos + mask + 1. */
+    struct Cell {
+        volatile uint32_t sequence;
+        union {
+            uint64_t align_u64;
+            void *align_ptr;
+            char data[sizeof(T)];
+        } storage;
+    };
+
+    void *claim_empty(uint32_t &pos) {
+        pos = _enqueue_pos;
+        while (true) {
+            Cell &cell = _cells[pos & mask];
+            int32_t diff = (int32_t)(cell.sequence - pos);
+            __DMB();
+            if (diff == 0) {
+                if (core_util_atomic_cas_u32((uint32_t *)&_enqueue_pos, &pos, pos + 1)) {
+                    return cell.storage.data;
+                }
+            } else if (diff < 0) {
+                return NULL;
+            } else {
+                pos = _enqueue_pos;
+            }
+        }
+    }
+
+    void publish(uint32_t pos) {
+        __DMB();
+        _cells[pos & mask].sequence = pos + 1;
+        __DMB();
+        if (_waiters != 0) {
+            _wake.release();
+        }
+    }
+
+    T *claim_full(uint32_t &pos) {
+        pos = _dequeue_pos;
+        while (true) {
+            Cell &cell = _cells[pos & mask];
+            int32_t diff = (int32_t)(cell.sequence - (pos + 1));
+            __DMB();
+            if (diff == 0) {
+                if (core_util_atomic_cas_u32((uint32_t *)&_dequeue_pos, &pos, pos + 1)) {
+                    return (T *)cell.storage.data;
+                }
+            } else if (diff < 0) {
+                return NULL;
+            } else {
+                pos = _dequeue_pos;
+            }
+        }
+    }
+
+    void release(uint32_t pos) {
+        __DMB();
+        _cells[pos & mask].sequence = pos + mask + 1;
+    }
+
+    /* not copyable */
+    ObjectQueue(const ObjectQueue &);
+    ObjectQueue &operator=(const ObjectQueue &);
+
+    Cell _cells[mask + 1];
+    volatile uint32_t _enqueue_pos;
+    volatile uint32_t _dequeue_pos;
+    volatile uint32_t _waiters;
+    Semaphore _wake;
+};
+
+}
+#endif
+
+/** @}*/
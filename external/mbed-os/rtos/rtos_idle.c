@@ -23,6 +23,12 @@
 #include "rtos/rtos_idle.h"
 #include "platform/mbed_sleep.h"
 
+#if defined(MBED_TICKLESS) && DEVICE_LOWPOWERTIMER
+/* Stops the RTX tick and deep sleeps until the next delay or timer is due,
+   waking on the lp_ticker. See rtos_tickless.cpp */
+extern void rtos_tickless_idle_hook(void);
+#define default_idle_hook rtos_tickless_idle_hook
+#else
 static void default_idle_hook(void)
 {
     /* Sleep: ideally, we should put the chip to sleep.
@@ -31,6 +37,8 @@ static void default_idle_hook(void)
     */
     sleep();
 }
+#endif
+
 static void (*idle_hook_fptr)(void) = &default_idle_hook;
 
 void rtos_attach_idle_hook(void (*fptr)(void))
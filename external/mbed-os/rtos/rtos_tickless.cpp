@@ -0,0 +1,112 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2006-2017 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "rtos/rtos_idle.h"
+#include "platform/platform.h"
+
+#if defined(MBED_TICKLESS) && DEVICE_LOWPOWERTIMER
+
+#include "cmsis.h"
+#include "cmsis_os.h"
+#include "drivers/TimerEvent.h"
+#include "hal/lp_ticker_api.h"
+#include "platform/mbed_sleep.h"
+
+/* RTX tick period in microseconds (OS_TICK) */
+extern "C" uint32_t const os_clockrate;
+
+/* Set by RTX when an interrupt made a request, such as setting a signal,
+ * while the scheduler was suspended. The request is only handled on resume. */
+extern "C" volatile uint8_t os_psh_flag;
+
+namespace {
+
+/* lp_ticker event used to bring the core out of deep sleep when the next
+ * RTX delay or timer is due. Taking the interrupt is all that is needed. */
+class TicklessWakeup : public mbed::TimerEvent {
+public:
+    TicklessWakeup() : TimerEvent(get_lp_ticker_data()) {
+    }
+
+    timestamp_t read() {
+        return ticker_read(_ticker_data);
+    }
+
+    void schedule(timestamp_t timestamp) {
+        insert(timestamp);
+    }
+
+    void cancel() {
+        remove();
+    }
+
+protected:
+    virtual void handler() {
+    }
+};
+
+TicklessWakeup tickless_wakeup;
+
+/* Time spent asleep which did not make up a whole tick. It is carried over
+ * to the next idle period so the RTX time does not fall behind. */
+uint32_t tickless_remainder_us;
+
+} // namespace
+
+extern "C" void rtos_tickless_idle_hook(void)
+{
+    uint32_t ticks;
+    uint32_t slept = 0;
+    uint32_t start;
+    uint32_t elapsed_us;
+
+    /* Stop the RTX tick and get the number of ticks until the next thread
+     * delay or timer expires (capped by RTX at 0xFFFF) */
+    ticks = os_suspend();
+    if (ticks > 0x7FFFFFFFU / os_clockrate) {
+        ticks = 0x7FFFFFFFU / os_clockrate;
+    }
+    if (ticks > 1) {
+        start = tickless_wakeup.read();
+        tickless_wakeup.schedule(start + ticks * os_clockrate);
+        /* An interrupt taken since os_suspend() may have readied a thread,
+         * so only sleep if there was none. With interrupts masked, one
+         * arriving after the check still wakes the core. */
+        __disable_irq();
+        if (!os_psh_flag) {
+            deepsleep();
+        }
+        __enable_irq();
+        /* woken by the lp_ticker or by another interrupt */
+        tickless_wakeup.cancel();
+        elapsed_us = tickless_wakeup.read() - start + tickless_remainder_us;
+        slept = elapsed_us / os_clockrate;
+        tickless_remainder_us = elapsed_us % os_clockrate;
+    }
+    os_resume(slept);
+
+    if (ticks <= 1) {
+        /* next tick is due anyway, so wait for it with the tick running */
+        sleep();
+    }
+}
+
+#endif
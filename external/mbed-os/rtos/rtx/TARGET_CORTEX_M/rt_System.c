@@ -50,13 +50,13 @@
  *---------------------------------------------------------------------------*/
 
 S32 os_tick_irqn;
+volatile BIT os_psh_flag;
 
 /*----------------------------------------------------------------------------
  *      Local Variables
  *---------------------------------------------------------------------------*/
 
 static volatile BIT os_lock;
-static volatile BIT os_psh_flag;
 static          U8  pend_flags;
 
 /*----------------------------------------------------------------------------
@@ -38,6 +38,7 @@
 /* Variables */
 #define os_psq  ((P_PSQ)&os_fifo)
 extern S32 os_tick_irqn;
+extern volatile BIT os_psh_flag;
 
 /* Functions */
 extern U32  rt_suspend    (void);
@@ -0,0 +1,457 @@
+/*
+ * Host benchmark and stress test of MemoryPool and ObjectQueue
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Compares the lock-free pool and queue with a model of the CMSIS path
+ * they replace. From a thread, osPoolAlloc, osPoolFree, osMessagePut and
+ * osMessageGet each enter the kernel through an SVC, and the service runs
+ * with no other service alongside it. The model takes a real system call
+ * for the exception entry and a mutex shared by all its calls for the
+ * serialisation, around the same free list and mailbox ring as rt_MemBox
+ * and rt_Mailbox. The host cannot time an SVC exactly, so the same model is
+ * also timed without the system call.
+ *
+ * Then two producer and two consumer threads pass records through an
+ * ObjectQueue, and four threads share a MemoryPool, checking that every
+ * record arrives once and in order from each producer, and that no block
+ * is handed out twice.
+ */
+#include "rtos/MemoryPool.h"
+#include "rtos/ObjectQueue.h"
+#include "host_test.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace rtos;
+
+
+#define OPERATIONS      2000000
+#define RECORDS         1000000
+#define PRODUCERS       2
+#define CONSUMERS       2
+#define POOL_THREADS    4
+#define POOL_SIZE       8
+
+// Test
+struct Record {
+    uint32_t producer;
+    uint32_t seq;
+    uint32_t payload[2];
+};
+
+static Record make_record(uint32_t producer, uint32_t seq)
+{
+    Record r = { producer, seq, { seq * 2654435761u, producer ^ ~seq } };
+    return r;
+}
+
+static bool valid_record(const Record &r)
+{
+    return r.payload[0] == r.seq * 2654435761u && r.payload[1] == (r.producer ^ ~r.seq);
+}
+
+
+// Model of the CMSIS path
+static bool model_trap = true;
+static pthread_mutex_t kernel = PTHREAD_MUTEX_INITIALIZER;
+
+static void svc_enter(void)
+{
+    if (model_trap) {
+        syscall(SYS_getppid);
+    }
+    pthread_mutex_lock(&kernel);
+}
+
+static void svc_exit(void)
+{
+    pthread_mutex_unlock(&kernel);
+}
+
+// osPoolAlloc/osPoolFree, a linked list of free blocks as in rt_MemBox
+template <typename T, uint32_t pool_sz>
+class ModelPool {
+public:
+    ModelPool() {
+        _free = NULL;
+        for (uint32_t i = pool_sz; i > 0; i--) {
+            *(void **)&_blocks[i - 1] = _free;
+            _free = &_blocks[i - 1];
+        }
+    }
+
+    T *alloc(void) {
+        svc_enter();
+        void *block = _free;
+        if (block != NULL) {
+            _free = *(void **)block;
+        }
+        svc_exit();
+        return (T *)block;
+    }
+
+    osStatus free(T *block) {
+        svc_enter();
+        *(void **)block = _free;
+        _free = block;
+        svc_exit();
+        return osOK;
+    }
+
+private:
+    union Block {
+        void *next;
+        T data;
+    };
+    void *_free;
+    Block _blocks[pool_sz];
+};
+
+// osMessagePut/osMessageGet with a 0 timeout, a ring of 32-bit messages as
+// in rt_Mailbox
+template <uint32_t queue_sz>
+class ModelMessageQueue {
+public:
+    ModelMessageQueue() : _first(0), _last(0), _count(0) {
+    }
+
+    osStatus put(uint32_t info) {
+        osStatus ret = osErrorResource;
+        svc_enter();
+        if (_count < queue_sz) {
+            _msg[_first] = info;
+            _first = (_first + 1) % queue_sz;
+            _count++;
+            ret = osOK;
+        }
+        svc_exit();
+        return ret;
+    }
+
+    bool get(uint32_t &info) {
+        bool ret = false;
+        svc_enter();
+        if (_count > 0) {
+            info = _msg[_last];
+            _last = (_last + 1) % queue_sz;
+            _count--;
+            ret = true;
+        }
+        svc_exit();
+        return ret;
+    }
+
+private:
+    uint32_t _msg[queue_sz];
+    uint32_t _first;
+    uint32_t _last;
+    uint32_t _count;
+};
+
+
+// Single thread
+struct Counted {
+    static int live;
+    Counted() { live++; }
+    Counted(const Counted &) { live++; }
+    ~Counted() { live--; }
+};
+
+int Counted::live;
+
+static void test_pool(void)
+{
+    MemoryPool<Record, POOL_SIZE> pool;
+    Record *blocks[POOL_SIZE];
+    Record other;
+
+    for (int i = 0; i < POOL_SIZE; i++) {
+        blocks[i] = pool.alloc();
+        check(blocks[i] != NULL);
+        for (int j = 0; j < i; j++) {
+            check(blocks[i] != blocks[j]);
+        }
+    }
+    check(pool.alloc() == NULL);
+    check(pool.free(&other) == osErrorValue);
+    check(pool.free((Record *)((char *)blocks[1] + 4)) == osErrorValue);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        check(pool.free(blocks[i]) == osOK);
+    }
+
+    Record *block = pool.calloc();
+    check(block != NULL && block->seq == 0 && block->payload[1] == 0);
+    check(pool.free(block) == osOK);
+}
+
+static void test_queue(void)
+{
+    ObjectQueue<Record, 6> queue;
+    Record r;
+
+    // Rounded up to 8
+    check(queue.empty());
+    for (uint32_t i = 0; i < 8; i++) {
+        check(queue.put(make_record(0, i)) == osOK);
+    }
+    check(queue.put(make_record(0, 8)) == osErrorResource);
+    for (uint32_t i = 0; i < 8; i++) {
+        check(queue.get(r, 0) == osEventMessage && r.seq == i && valid_record(r));
+    }
+    check(queue.empty());
+    check(!queue.try_get(r));
+    check(queue.get(r, 0) == osOK);
+    check(queue.get(r, 20) == osEventTimeout);
+
+    // Objects left in the queue are destroyed with it
+    {
+        ObjectQueue<Counted, 4> counted;
+        Counted c;
+        check(counted.put(c) == osOK);
+        check(counted.put(c) == osOK);
+        check(counted.try_get(c));
+        check(Counted::live == 2);
+    }
+    check(Counted::live == 0);
+}
+
+
+// Ops per second
+static double bench_pool(void)
+{
+    static MemoryPool<Record, POOL_SIZE> pool;
+    uint64_t start = now_ns();
+    for (int i = 0; i < OPERATIONS; i++) {
+        Record *r = pool.alloc();
+        r->seq = i;
+        pool.free(r);
+    }
+    return OPERATIONS / ((now_ns() - start) / 1e9);
+}
+
+static double bench_model_pool(void)
+{
+    static ModelPool<Record, POOL_SIZE> pool;
+    uint64_t start = now_ns();
+    for (int i = 0; i < OPERATIONS; i++) {
+        Record *r = pool.alloc();
+        r->seq = i;
+        pool.free(r);
+    }
+    return OPERATIONS / ((now_ns() - start) / 1e9);
+}
+
+static double bench_queue(void)
+{
+    static ObjectQueue<Record, 16> queue;
+    Record r;
+    bool ok = true;
+    uint64_t start = now_ns();
+    for (int i = 0; i < OPERATIONS; i++) {
+        queue.put(make_record(0, i));
+        ok &= queue.try_get(r) && r.seq == (uint32_t)i;
+    }
+    double rate = OPERATIONS / ((now_ns() - start) / 1e9);
+    check(ok);
+    return rate;
+}
+
+// A record through the pool and a pointer through the message queue, as
+// Mail or a MemoryPool with a Queue did
+static double bench_model_queue(void)
+{
+    static ModelPool<Record, 16> pool;
+    static ModelMessageQueue<16> queue;
+    uint32_t info;
+    bool ok = true;
+    uint64_t start = now_ns();
+    for (int i = 0; i < OPERATIONS; i++) {
+        Record *r = pool.alloc();
+        *r = make_record(0, i);
+        queue.put((uint32_t)(uintptr_t)r - (uint32_t)(uintptr_t)&pool);
+        ok &= queue.get(info);
+        r = (Record *)((char *)&pool + info);
+        ok &= r->seq == (uint32_t)i;
+        pool.free(r);
+    }
+    double rate = OPERATIONS / ((now_ns() - start) / 1e9);
+    check(ok);
+    return rate;
+}
+
+
+// Producers and consumers
+static ObjectQueue<Record, 32> stress_queue;
+static uint8_t seen[PRODUCERS][RECORDS];
+static uint32_t consumed;
+static uint32_t stress_errors;
+
+static void *producer(void *arg)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    for (uint32_t seq = 0; seq < RECORDS; seq++) {
+        Record r = make_record(id, seq);
+        while (stress_queue.put(r) != osOK) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    uint32_t last[PRODUCERS];
+    uint32_t errors = 0;
+    memset(last, 0xff, sizeof(last));
+
+    while (__atomic_load_n(&consumed, __ATOMIC_SEQ_CST) < PRODUCERS * RECORDS) {
+        Record r;
+        // One consumer waits on the semaphore, the other polls
+        if (id == 0) {
+            if (stress_queue.get(r, 10) != osEventMessage) {
+                continue;
+            }
+        } else if (!stress_queue.try_get(r)) {
+            sched_yield();
+            continue;
+        }
+
+        // Each producer's records reach each consumer in order, once
+        if (r.producer >= PRODUCERS || r.seq >= RECORDS || !valid_record(r) ||
+                (last[r.producer] != 0xffffffff && r.seq <= last[r.producer]) ||
+                seen[r.producer][r.seq]++ != 0) {
+            errors++;
+        } else {
+            last[r.producer] = r.seq;
+        }
+        __atomic_add_fetch(&consumed, 1, __ATOMIC_SEQ_CST);
+    }
+    __atomic_add_fetch(&stress_errors, errors, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+static MemoryPool<uint32_t, POOL_SIZE> stress_pool;
+static uint32_t pool_errors;
+
+static void *pool_user(void *arg)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    uint32_t errors = 0;
+    uint32_t *held[POOL_SIZE / POOL_THREADS];
+
+    for (uint32_t i = 0; i < RECORDS; i++) {
+        // Hold a few blocks at once, and check that nobody else wrote them
+        uint32_t n = 1 + i % (POOL_SIZE / POOL_THREADS);
+        for (uint32_t j = 0; j < n; j++) {
+            while ((held[j] = stress_pool.alloc()) == NULL) {
+                sched_yield();
+            }
+            *held[j] = id << 24 | j;
+        }
+        if (i % 64 == 0) {
+            sched_yield();
+        }
+        for (uint32_t j = 0; j < n; j++) {
+            if (*held[j] != (id << 24 | j)) {
+                errors++;
+            }
+            if (stress_pool.free(held[j]) != osOK) {
+                errors++;
+            }
+        }
+    }
+    __atomic_add_fetch(&pool_errors, errors, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+static void test_stress(void)
+{
+    pthread_t threads[PRODUCERS + CONSUMERS];
+
+    uint64_t start = now_ns();
+    for (uintptr_t i = 0; i < CONSUMERS; i++) {
+        pthread_create(&threads[i], NULL, consumer, (void *)i);
+    }
+    for (uintptr_t i = 0; i < PRODUCERS; i++) {
+        pthread_create(&threads[CONSUMERS + i], NULL, producer, (void *)i);
+    }
+    for (int i = 0; i < PRODUCERS + CONSUMERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    printf("%d producers, %d consumers: %u records in %.0f ms\n", PRODUCERS, CONSUMERS,
+            consumed, (now_ns() - start) / 1e6);
+
+    check(consumed == PRODUCERS * RECORDS);
+    check(stress_errors == 0);
+    bool all = true;
+    for (int p = 0; p < PRODUCERS; p++) {
+        for (int i = 0; i < RECORDS; i++) {
+            all = all && seen[p][i] == 1;
+        }
+    }
+    check(all);
+    check(stress_queue.empty());
+
+    pthread_t pool_threads[POOL_THREADS];
+    start = now_ns();
+    for (uintptr_t i = 0; i < POOL_THREADS; i++) {
+        pthread_create(&pool_threads[i], NULL, pool_user, (void *)i);
+    }
+    for (int i = 0; i < POOL_THREADS; i++) {
+        pthread_join(pool_threads[i], NULL);
+    }
+    printf("%d threads sharing a pool of %d: %d rounds each in %.0f ms\n", POOL_THREADS, POOL_SIZE,
+            RECORDS, (now_ns() - start) / 1e6);
+    check(pool_errors == 0);
+
+    // Every block is back
+    uint32_t *blocks[POOL_SIZE];
+    for (int i = 0; i < POOL_SIZE; i++) {
+        blocks[i] = stress_pool.alloc();
+        check(blocks[i] != NULL);
+    }
+    check(stress_pool.alloc() == NULL);
+}
+
+int main(void)
+{
+    test_pool();
+    test_queue();
+
+    double pool = bench_pool();
+    double queue = bench_queue();
+    double model_pool = bench_model_pool();
+    double model_queue = bench_model_queue();
+    model_trap = false;
+    double lock_pool = bench_model_pool();
+    double lock_queue = bench_model_queue();
+
+    printf("%-44s %12s %12s %12s\n", "M ops/s", "lock-free", "CMSIS model", "no trap");
+    printf("%-44s %12.1f %12.1f %12.1f\n", "alloc+free", pool / 1e6, model_pool / 1e6, lock_pool / 1e6);
+    printf("%-44s %12.1f %12.1f %12.1f\n", "16-byte record put+get", queue / 1e6, model_queue / 1e6, lock_queue / 1e6);
+
+    check(pool > model_pool);
+    check(queue > model_queue);
+
+    test_stress();
+
+    return host_test_done();
+}
@@ -0,0 +1,19 @@
+/* Host stand-in: interrupt masking is simulated by tickless_sim.cpp, and
+ * the rest is the shared stand-in */
+#ifndef SIM_CMSIS_H
+#define SIM_CMSIS_H
+
+#include_next "cmsis.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void __disable_irq(void);
+void __enable_irq(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,19 @@
+/* Host stand-in: the RTX scheduler is simulated by tickless_sim.cpp, and
+ * the rest is the shared stand-in */
+#ifndef SIM_CMSIS_OS_H
+#define SIM_CMSIS_OS_H
+
+#include_next "cmsis_os.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t os_suspend(void);
+void os_resume(uint32_t sleep_time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,33 @@
+/* Host stand-in: events go to the simulated lp_ticker */
+#ifndef MBED_TIMEREVENT_H
+#define MBED_TIMEREVENT_H
+
+#include "hal/lp_ticker_api.h"
+
+namespace mbed {
+
+class TimerEvent {
+public:
+    TimerEvent(const ticker_data_t *data) : _ticker_data(data) {
+    }
+
+    virtual ~TimerEvent() {
+    }
+
+protected:
+    virtual void handler() = 0;
+
+    void insert(timestamp_t timestamp) {
+        sim_lp_ticker_insert(timestamp);
+    }
+
+    void remove() {
+        sim_lp_ticker_remove();
+    }
+
+    const ticker_data_t *_ticker_data;
+};
+
+} // namespace mbed
+
+#endif
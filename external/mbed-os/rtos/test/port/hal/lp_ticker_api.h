@@ -0,0 +1,25 @@
+/* Host stand-in: the lp_ticker is simulated by tickless_sim.cpp */
+#ifndef MBED_LPTICKER_API_H
+#define MBED_LPTICKER_API_H
+
+#include <stdint.h>
+
+typedef uint32_t timestamp_t;
+typedef struct ticker_data_s ticker_data_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const ticker_data_t *get_lp_ticker_data(void);
+timestamp_t ticker_read(const ticker_data_t *const data);
+
+/* Sets and clears the single lp_ticker event */
+void sim_lp_ticker_insert(timestamp_t timestamp);
+void sim_lp_ticker_remove(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,18 @@
+/* Host stand-in: sleeping is simulated by tickless_sim.cpp */
+#ifndef MBED_SLEEP_H
+#define MBED_SLEEP_H
+
+#include "platform/platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void sleep(void);
+void deepsleep(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,10 @@
+/* Host stand-in for a target with a low power ticker */
+#ifndef MBED_PLATFORM_H
+#define MBED_PLATFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DEVICE_LOWPOWERTIMER 1
+
+#endif
@@ -0,0 +1,276 @@
+/*
+ * Host simulation of the tickless idle hook
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Runs rtos_idle_loop() with the tickless idle hook against a simulated
+ * RTX tick, lp_ticker and interrupt source, and counts the wakeups per idle
+ * second. Two threads wait 1 s and 3.7 s in a loop. Time is simulated, and
+ * the run starts near the wrap of the 32-bit lp_ticker.
+ *
+ *   tickless_sim tick      tick running, the plain sleep() idle hook
+ *   tickless_sim           tickless idle hook
+ *   tickless_sim irq       tickless, with interrupts that signal a thread,
+ *                          some of them between os_suspend() and the sleep
+ */
+#include "cmsis.h"
+#include "cmsis_os.h"
+#include "hal/lp_ticker_api.h"
+#include "platform/mbed_sleep.h"
+#include "rtos/rtos_idle.h"
+#include "host_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" void rtos_idle_loop(void);
+
+
+// RTX tick period in us
+extern "C" uint32_t const os_clockrate = 1000;
+extern "C" {
+volatile uint8_t os_psh_flag;
+}
+
+#define SIM_START       0xFFFF0000ULL   // us, just before the lp_ticker wraps
+#define SIM_DURATION    600000000ULL    // us
+#define IRQ_PERIOD      150000          // us, mean time between interrupts
+#define IRQ_IN_WINDOW   4               // one in n idle periods
+
+static uint64_t now = SIM_START;
+static uint64_t next_tick;
+static bool suspended;
+static bool irq_masked;
+static bool irq_mode;
+
+// RTX time and the threads waiting on it
+static uint64_t os_time;
+static const uint32_t periods[] = {1000, 3700};   // ticks
+static uint64_t due[2];
+
+// lp_ticker event
+static bool wakeup_set;
+static timestamp_t wakeup_at;
+
+// Interrupt source, each interrupt signals a thread
+static uint64_t next_irq = ~0ULL;
+static uint64_t signalled_at;
+
+// Results
+static uint64_t wakeups;
+static uint64_t signals;
+static uint64_t max_latency;
+static uint64_t max_drift;
+static unsigned masked_svcs;
+
+
+static void schedule_irq()
+{
+    next_irq = irq_mode ? now + 1 + rand() % (2*IRQ_PERIOD) : ~0ULL;
+}
+
+static void run_threads()
+{
+    for (int i = 0; i < 2; i++) {
+        while (due[i] <= os_time) {
+            due[i] += periods[i];
+        }
+    }
+}
+
+static void check_drift()
+{
+    uint64_t real = now - SIM_START;
+    uint64_t rtx = os_time * os_clockrate;
+    uint64_t drift = real > rtx ? real - rtx : rtx - real;
+    if (drift > max_drift) {
+        max_drift = drift;
+    }
+}
+
+// The signalled thread runs once the scheduler handles the request
+static void signal_handled()
+{
+    if (now - signalled_at > max_latency) {
+        max_latency = now - signalled_at;
+    }
+    signals++;
+}
+
+// An interrupt sets a signal. RTX defers the request while suspended.
+static void irq()
+{
+    signalled_at = now;
+    if (suspended) {
+        os_psh_flag = 1;
+    } else {
+        signal_handled();
+    }
+    schedule_irq();
+}
+
+
+// Test
+static void wakeup()
+{
+    wakeups++;
+    if (now - SIM_START < SIM_DURATION) {
+        return;
+    }
+
+    double seconds = (now - SIM_START) / 1e6;
+    printf("wakeups per idle second: %.1f, max os_time drift: %llu us\n",
+            wakeups / seconds, (unsigned long long)max_drift);
+    if (irq_mode) {
+        printf("%llu signals, max latency: %llu us\n",
+                (unsigned long long)signals, (unsigned long long)max_latency);
+        check(signals > 0);
+        check(max_latency < os_clockrate);
+    }
+    check(max_drift < os_clockrate);
+    check(masked_svcs == 0);
+
+    exit(host_test_done());
+}
+
+
+// Simulated RTX, SVC calls fault with interrupts masked
+extern "C" uint32_t os_suspend(void)
+{
+    masked_svcs += irq_masked;
+    suspended = true;
+
+    uint64_t delta = due[0] - os_time;
+    if (due[1] - os_time < delta) {
+        delta = due[1] - os_time;
+    }
+
+    // an interrupt right after the tick was stopped
+    if (irq_mode && rand() % IRQ_IN_WINDOW == 0) {
+        irq();
+    }
+
+    return delta > 0xFFFF ? 0xFFFF : (uint32_t)delta;
+}
+
+extern "C" void os_resume(uint32_t sleep_time)
+{
+    masked_svcs += irq_masked;
+    suspended = false;
+    os_time += sleep_time;
+    check_drift();
+
+    if (os_psh_flag) {
+        os_psh_flag = 0;
+        signal_handled();
+    }
+
+    run_threads();
+    next_tick = SIM_START + (os_time + 1) * os_clockrate;
+}
+
+extern "C" void __disable_irq(void)
+{
+    irq_masked = true;
+}
+
+extern "C" void __enable_irq(void)
+{
+    irq_masked = false;
+}
+
+
+// Simulated lp_ticker
+extern "C" const ticker_data_t *get_lp_ticker_data(void)
+{
+    return NULL;
+}
+
+extern "C" timestamp_t ticker_read(const ticker_data_t *const data)
+{
+    return (timestamp_t)now;
+}
+
+extern "C" void sim_lp_ticker_insert(timestamp_t timestamp)
+{
+    wakeup_set = true;
+    wakeup_at = timestamp;
+}
+
+extern "C" void sim_lp_ticker_remove(void)
+{
+    wakeup_set = false;
+}
+
+
+// Simulated sleep, until the next tick or interrupt
+extern "C" void sleep(void)
+{
+    if (next_irq < next_tick) {
+        now = next_irq;
+        irq();
+    } else {
+        now = next_tick;
+        next_tick += os_clockrate;
+        os_time++;
+        check_drift();
+        run_threads();
+    }
+
+    wakeup();
+}
+
+// Simulated deep sleep, until the lp_ticker event or an interrupt. The tick
+// is stopped, unless RTX was not suspended.
+extern "C" void deepsleep(void)
+{
+    if (!suspended) {
+        sleep();
+        return;
+    }
+
+    uint64_t until = wakeup_set ? now + (timestamp_t)(wakeup_at - (timestamp_t)now) : ~0ULL;
+    if (next_irq < until) {
+        now = next_irq;
+        irq();
+    } else {
+        now = until;
+    }
+
+    wakeup();
+}
+
+
+static void tick_idle_hook(void)
+{
+    sleep();
+}
+
+int main(int argc, char **argv)
+{
+    bool tick = argc > 1 && strcmp(argv[1], "tick") == 0;
+    irq_mode = argc > 1 && strcmp(argv[1], "irq") == 0;
+
+    srand(1);
+    due[0] = periods[0];
+    due[1] = periods[1];
+    next_tick = SIM_START + os_clockrate;
+    schedule_irq();
+
+    if (tick) {
+        rtos_attach_idle_hook(tick_idle_hook);
+    }
+
+    rtos_idle_loop();
+}
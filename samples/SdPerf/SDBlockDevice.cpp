@@ -60,10 +60,12 @@
  * just always use the Standard Capacity cards with a block size of 512 bytes.
  * This is set with CMD16.
  *
- * You can read and write single blocks (CMD17, CMD25) or multiple blocks
- * (CMD18, CMD25). For simplicity, I'll just use single block accesses. When
- * the card gets a read command, it responds with a response token, and then
- * a data token or an error.
+ * You can read and write single blocks (CMD17, CMD24) or multiple blocks
+ * (CMD18, CMD25). Single block accesses are used when only one block is
+ * transferred, otherwise the multiple block commands are used so that the
+ * command overhead is paid once per transfer rather than once per block.
+ * When the card gets a read command, it responds with a response token, and
+ * then a data token or an error.
  *
  * SPI Command Format
  * ------------------
@@ -111,6 +113,23 @@
  * +------+---------+---------+- -  - -+---------+-----------+----------+
  * | 0xFE | data[0] | data[1] |        | data[n] | crc[15:8] | crc[7:0] |
  * +------+---------+---------+- -  - -+---------+-----------+----------+
+ *
+ * Multiple Block Read and Write
+ * -----------------------------
+ *
+ * A multiple block read (CMD18) streams data blocks, each with the same
+ * 0xFE header, until the host sends STOP_TRANSMISSION (CMD12). The byte
+ * following CMD12 is a stuff byte and must be discarded before the R1b
+ * response.
+ *
+ * A multiple block write (CMD25) uses a 0xFC header for each data block,
+ * and is terminated with a 0xFD stop token followed by a busy signal. The
+ * number of blocks is announced beforehand with SET_WR_BLK_ERASE_COUNT
+ * (ACMD23) so the card can pre-erase them.
+ *
+ * Data blocks are clocked with the buffer version of SPI::write, or with
+ * SPI::transfer when SD_SPI_DMA is enabled on targets with asynchronous
+ * SPI, instead of one SPI::write call per byte.
  */
 
 /* If the target has no SPI support then SDCard is not supported */
@@ -123,6 +142,13 @@
 
 #define SD_DBG             0
 
+#define SD_BLOCK_SIZE      512
+#define SD_BULK_TIMEOUT    500  // ms, for an asynchronous block transfer
+
+#define SD_TOKEN_START     0xFE
+#define SD_TOKEN_MULTI     0xFC
+#define SD_TOKEN_STOP      0xFD
+
 #define SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK        -5001	/*!< operation would block */
 #define SD_BLOCK_DEVICE_ERROR_UNSUPPORTED        -5002	/*!< unsupported operation */
 #define SD_BLOCK_DEVICE_ERROR_PARAMETER          -5003	/*!< invalid parameter */
@@ -250,6 +276,9 @@ int SDBlockDevice::init()
 
     // Set SCK for data transfer
     _spi.frequency(_transfer_sck);
+#if SD_SPI_DMA && DEVICE_SPI_ASYNCH
+    _spi.set_dma_usage(DMA_USAGE_ALWAYS);
+#endif
     _lock.unlock();
     return BD_ERROR_OK;
 }
@@ -272,8 +301,10 @@ int SDBlockDevice::program(const void *b, bd_addr_t addr, bd_size_t size)
     }
 
     const uint8_t *buffer = static_cast<const uint8_t*>(b);
-    while (size > 0) {
-        bd_addr_t block = addr / 512;
+    bd_addr_t block = addr / SD_BLOCK_SIZE;
+    uint32_t count = size / SD_BLOCK_SIZE;
+    int err;
+    if (count == 1) {
         // set write address for single block (CMD24)
         if (_cmd(24, block * _block_size) != 0) {
             _lock.unlock();
@@ -281,13 +312,23 @@ int SDBlockDevice::program(const void *b, bd_addr_t addr, bd_size_t size)
         }
 
         // send the data block
-        _write(buffer, 512);
-        buffer += 512;
-        addr += 512;
-        size -= 512;
+        err = _write(buffer, SD_BLOCK_SIZE);
+    } else {
+        // let the card pre-erase the blocks (ACMD23), failure is harmless
+        _cmd(55, 0);
+        _cmd(23, count);
+
+        // set write address for multiple blocks (CMD25)
+        if (_cmd(25, block * _block_size) != 0) {
+            _lock.unlock();
+            return BD_ERROR_DEVICE_ERROR;
+        }
+
+        // send the data blocks and the stop token
+        err = _write_blocks(buffer, count);
     }
     _lock.unlock();
-    return 0;
+    return err ? BD_ERROR_DEVICE_ERROR : 0;
 }
 
 int SDBlockDevice::read(void *b, bd_addr_t addr, bd_size_t size)
@@ -303,19 +344,32 @@ int SDBlockDevice::read(void *b, bd_addr_t addr, bd_size_t size)
     }
     
     uint8_t *buffer = static_cast<uint8_t *>(b);
-    while (size > 0) {
-        bd_addr_t block = addr / 512;
+    bd_addr_t block = addr / SD_BLOCK_SIZE;
+    uint32_t count = size / SD_BLOCK_SIZE;
+    if (count == 1) {
         // set read address for single block (CMD17)
         if (_cmd(17, block * _block_size) != 0) {
             _lock.unlock();
             return BD_ERROR_DEVICE_ERROR;
         }
-        
+
         // receive the data
-        _read(buffer, 512);
-        buffer += 512;
-        addr += 512;
-        size -= 512;
+        if (_read(buffer, SD_BLOCK_SIZE) != 0) {
+            _lock.unlock();
+            return BD_ERROR_DEVICE_ERROR;
+        }
+    } else {
+        // set read address for multiple blocks (CMD18)
+        if (_cmd(18, block * _block_size) != 0) {
+            _lock.unlock();
+            return BD_ERROR_DEVICE_ERROR;
+        }
+
+        // receive the data blocks and stop the transmission (CMD12)
+        if (_read_blocks(buffer, count) != 0) {
+            _lock.unlock();
+            return BD_ERROR_DEVICE_ERROR;
+        }
     }
     _lock.unlock();
     return 0;
@@ -350,6 +404,11 @@ bd_size_t SDBlockDevice::size() const
     return 512*sectors;
 }
 
+bool SDBlockDevice::requires_erase() const
+{
+    return false;
+}
+
 void SDBlockDevice::debug(bool dbg)
 {
     _dbg = dbg;
@@ -463,7 +522,7 @@ int SDBlockDevice::_cmd8() {
         response[0] = _spi.write(0xFF);
         if (!(response[0] & 0x80)) {
             for (int j = 1; j < 5; j++) {
-                response[i] = _spi.write(0xFF);
+                response[j] = _spi.write(0xFF);
             }
             _cs = 1;
             _spi.write(0xFF);
@@ -485,16 +544,14 @@ int SDBlockDevice::_read(uint8_t *buffer, uint32_t length) {
     while (_spi.write(0xFF) != 0xFE);
 
     // read data
-    for (uint32_t i = 0; i < length; i++) {
-        buffer[i] = _spi.write(0xFF);
-    }
+    int err = _bulk(NULL, buffer, length);
     _spi.write(0xFF); // checksum
     _spi.write(0xFF);
 
     _cs = 1;
     _spi.write(0xFF);
     _spi.unlock();
-    return 0;
+    return err;
 }
 
 int SDBlockDevice::_write(const uint8_t*buffer, uint32_t length) {
@@ -505,16 +562,14 @@ int SDBlockDevice::_write(const uint8_t*buffer, uint32_t length) {
     _spi.write(0xFE);
 
     // write the data
-    for (uint32_t i = 0; i < length; i++) {
-        _spi.write(buffer[i]);
-    }
+    int err = _bulk(buffer, NULL, length);
 
     // write the checksum
     _spi.write(0xFF);
     _spi.write(0xFF);
 
     // check the response token
-    if ((_spi.write(0xFF) & 0x1F) != 0x05) {
+    if ((_spi.write(0xFF) & 0x1F) != 0x05 || err) {
         _cs = 1;
         _spi.write(0xFF);
         _spi.unlock();
@@ -530,6 +585,131 @@ int SDBlockDevice::_write(const uint8_t*buffer, uint32_t length) {
     return 0;
 }
 
+int SDBlockDevice::_read_blocks(uint8_t *buffer, uint32_t count) {
+    _spi.lock();
+    _cs = 0;
+
+    int err = 0;
+    while (count > 0) {
+        // read until start byte (0xFE)
+        while (_spi.write(0xFF) != SD_TOKEN_START);
+
+        // read data
+        err = _bulk(NULL, buffer, SD_BLOCK_SIZE);
+        _spi.write(0xFF); // checksum
+        _spi.write(0xFF);
+        if (err) {
+            break;
+        }
+
+        buffer += SD_BLOCK_SIZE;
+        count -= 1;
+    }
+
+    // stop transmission (CMD12)
+    _spi.write(0x40 | 12);
+    _spi.write(0x00);
+    _spi.write(0x00);
+    _spi.write(0x00);
+    _spi.write(0x00);
+    _spi.write(0x95);
+
+    // skip the stuff byte, then wait for the response (response[7] == 0)
+    _spi.write(0xFF);
+    int response = -1;
+    for (int i = 0; i < SD_COMMAND_TIMEOUT; i++) {
+        response = _spi.write(0xFF);
+        if (!(response & 0x80)) {
+            break;
+        }
+    }
+
+    // wait for the card to leave busy state (R1b)
+    while (_spi.write(0xFF) == 0);
+
+    _cs = 1;
+    _spi.write(0xFF);
+    _spi.unlock();
+    return (response == 0 && !err) ? 0 : 1;
+}
+
+int SDBlockDevice::_write_blocks(const uint8_t *buffer, uint32_t count) {
+    _spi.lock();
+    _cs = 0;
+
+    int err = 0;
+    while (count > 0) {
+        // indicate start of block in a multiple block write
+        _spi.write(SD_TOKEN_MULTI);
+
+        // write the data
+        err = _bulk(buffer, NULL, SD_BLOCK_SIZE);
+
+        // write the checksum
+        _spi.write(0xFF);
+        _spi.write(0xFF);
+
+        // check the response token
+        if ((_spi.write(0xFF) & 0x1F) != 0x05 || err) {
+            err = 1;
+            break;
+        }
+
+        // wait for write to finish
+        while (_spi.write(0xFF) == 0);
+
+        buffer += SD_BLOCK_SIZE;
+        count -= 1;
+    }
+
+    // indicate end of transmission, even on error so the card leaves
+    // receive-data state, and wait for the card to finish programming
+    _spi.write(SD_TOKEN_STOP);
+    _spi.write(0xFF);
+    while (_spi.write(0xFF) == 0);
+
+    _cs = 1;
+    _spi.write(0xFF);
+    _spi.unlock();
+    return err;
+}
+
+int SDBlockDevice::_bulk(const uint8_t *tx, uint8_t *rx, uint32_t length) {
+#if SD_SPI_DMA && DEVICE_SPI_ASYNCH
+    // the card needs MOSI held high while it sends data, so reads clock out
+    // 0xFF from the receive buffer itself; each byte is sent before the
+    // byte received in its place is stored
+    if (!tx) {
+        memset(rx, 0xFF, length);
+        tx = rx;
+    }
+
+    // drop a completion that arrived after an earlier transfer timed out
+    while (_bulk_sem.wait(0) > 0);
+
+    if (_spi.transfer<uint8_t>(tx, length, rx, rx ? length : 0,
+            callback(this, &SDBlockDevice::_bulk_done), SPI_EVENT_COMPLETE) == 0) {
+        if (_bulk_sem.wait(SD_BULK_TIMEOUT) > 0) {
+            return 0;
+        }
+
+        debug_if(_dbg, "Bulk transfer timed out\n");
+        _spi.abort_transfer();
+        return 1;
+    }
+
+    // the peripheral is busy or cannot queue, clock the data out directly
+#endif
+    _spi.write((const char *)tx, tx ? length : 0, (char *)rx, rx ? length : 0);
+    return 0;
+}
+
+#if SD_SPI_DMA && DEVICE_SPI_ASYNCH
+void SDBlockDevice::_bulk_done(int event) {
+    _bulk_sem.release();
+}
+#endif
+
 static uint32_t ext_bits(unsigned char *data, int msb, int lsb) {
     uint32_t bits = 0;
     uint32_t size = 1 + msb - lsb;
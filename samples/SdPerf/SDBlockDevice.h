@@ -28,6 +28,11 @@
 #include "BlockDevice.h"
 #include "mbed.h"
 
+// Use asynchronous (and possibly DMA backed) SPI transfers for data blocks
+#ifndef SD_SPI_DMA
+#define SD_SPI_DMA 0
+#endif
+
 
 /** Access an SD Card using SPI
  *
@@ -121,6 +126,14 @@ public:
      */
     virtual bd_size_t size() const;
 
+    /** Check if blocks must be erased before they are programmed
+     *
+     *  The card erases internally on write, so this is always false
+     *
+     *  @return         True if program must be preceded by erase
+     */
+    virtual bool requires_erase() const;
+
     /** Enable or disable debugging
      *
      *  @param          State of debugging
@@ -138,6 +151,9 @@ private:
 
     int _read(uint8_t * buffer, uint32_t length);
     int _write(const uint8_t *buffer, uint32_t length);
+    int _read_blocks(uint8_t *buffer, uint32_t count);
+    int _write_blocks(const uint8_t *buffer, uint32_t count);
+    int _bulk(const uint8_t *tx, uint8_t *rx, uint32_t length);
     uint32_t _sd_sectors();
     uint32_t _sectors;
 
@@ -150,6 +166,10 @@ private:
     bool _is_initialized;
     bool _dbg;
     Mutex _lock;
+#if SD_SPI_DMA && DEVICE_SPI_ASYNCH
+    void _bulk_done(int event);
+    Semaphore _bulk_sem;
+#endif
 };
 
 
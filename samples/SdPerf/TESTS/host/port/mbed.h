@@ -0,0 +1,110 @@
+/* Host stand-in for mbed.h, with the SPI, DigitalOut and RTOS classes that
+ * SDBlockDevice uses. SPI and chip select go to the emulated card. */
+#ifndef MBED_H
+#define MBED_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "platform/Callback.h"
+
+typedef int PinName;
+#define NC (-1)
+
+namespace mbed {
+
+typedef Callback<void(int)> event_callback_t;
+
+#define SPI_EVENT_COMPLETE (1 << 3)
+
+enum DMAUsage {
+    DMA_USAGE_NEVER,
+    DMA_USAGE_OPPORTUNISTIC,
+    DMA_USAGE_ALWAYS,
+    DMA_USAGE_TEMPORARY_ALLOCATED,
+    DMA_USAGE_ALLOCATED
+};
+
+class SPI {
+public:
+    SPI(PinName mosi, PinName miso, PinName sclk) {
+    }
+
+    void frequency(int hz);
+    int write(int value);
+    int write(const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length);
+
+    void lock() {
+    }
+
+    void unlock() {
+    }
+
+#if DEVICE_SPI_ASYNCH
+    template<typename Type>
+    int transfer(const Type *tx_buffer, int tx_length, Type *rx_buffer, int rx_length,
+            const event_callback_t& callback, int event = SPI_EVENT_COMPLETE) {
+        return transfer(tx_buffer, tx_length, rx_buffer, rx_length, sizeof(Type)*8, callback, event);
+    }
+
+    int transfer(const void *tx_buffer, int tx_length, void *rx_buffer, int rx_length,
+            unsigned char bit_width, const event_callback_t& callback, int event);
+    void abort_transfer();
+
+    int set_dma_usage(DMAUsage usage) {
+        return 0;
+    }
+#endif
+};
+
+void sd_card_select(int value);
+
+class DigitalOut {
+public:
+    DigitalOut(PinName pin) {
+    }
+
+    DigitalOut &operator=(int value) {
+        sd_card_select(value);
+        return *this;
+    }
+};
+
+void wait_ms(int ms);
+
+} // namespace mbed
+
+namespace rtos {
+
+class Mutex {
+public:
+    void lock() {
+    }
+
+    void unlock() {
+    }
+};
+
+/* wait() completes an outstanding bulk transfer, or lets the timeout pass
+ * if the emulated DMA does not finish */
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0) : _count(count) {
+    }
+
+    int32_t wait(uint32_t millisec);
+
+    void release() {
+        _count++;
+    }
+
+private:
+    int32_t _count;
+};
+
+} // namespace rtos
+
+using namespace mbed;
+using namespace rtos;
+
+#endif
@@ -0,0 +1,18 @@
+/* Host stand-in for mbed_debug.h */
+#ifndef MBED_DEBUG_H
+#define MBED_DEBUG_H
+
+#include <stdarg.h>
+#include <stdio.h>
+
+static inline void debug_if(int condition, const char *format, ...)
+{
+    if (condition) {
+        va_list args;
+        va_start(args, format);
+        vfprintf(stderr, format, args);
+        va_end(args);
+    }
+}
+
+#endif
@@ -0,0 +1,599 @@
+/*
+ * Host test of SDBlockDevice against an emulated SD card on SPI
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * The card answers the SPI mode protocol byte by byte, as a real card sees
+ * it: commands, R1/R3/R7 responses, read latency, data tokens, data
+ * response tokens and busy signalling. Time is simulated. Every byte on
+ * the bus costs 8 SCK periods, and every SPI call costs a fixed overhead,
+ * which is what multi-block commands and bulk transfers save.
+ *
+ * With SD_SPI_DMA, SPI::transfer() moves the bytes when the caller waits
+ * on the completion semaphore. The transfer can be made to fail to start,
+ * to never complete, or to complete only when it is aborted.
+ */
+#include "SDBlockDevice.h"
+#include <stdlib.h>
+#include <deque>
+
+
+#define SD_SECTORS      65536           // 32MB SDHC card
+#define NAC             8               // bytes from read command to data token
+#define BUSY            16              // busy bytes after a block is written
+#define CALL_NS         1000            // cost of one SPI call
+
+// Emulated SD card
+enum CardState {
+    CARD_IDLE,
+    CARD_READ_SINGLE,                   // sending one block when clocked
+    CARD_READ_MULTI,                    // streaming blocks until CMD12
+    CARD_WRITE_TOKEN,                   // waiting for a data token
+    CARD_WRITE_DATA,                    // receiving a data block and its CRC
+};
+
+static uint8_t storage[SD_SECTORS][512];
+static std::deque<uint8_t> miso;
+static bool selected;
+static bool initialized;
+static bool app_cmd;
+static int acmd41_polls;
+
+static CardState state;
+static bool multi;
+static uint32_t block;
+static const uint8_t *read_data;
+static unsigned read_length;
+static uint8_t data[512 + 2];
+static unsigned data_len;
+
+static int ncr = 1;                     // bytes from command to response
+static uint8_t cmd[6];
+static unsigned cmd_len;
+
+static unsigned cmds[64];
+static unsigned acmd23s;
+static uint32_t acmd23_count;
+
+static uint64_t now;
+static uint64_t byte_ns = 8000;
+static unsigned spi_calls;
+
+static void respond(uint8_t r1)
+{
+    for (int i = 0; i < ncr; i++) {
+        miso.push_back(0xFF);
+    }
+    miso.push_back(r1);
+}
+
+static void send_block(const uint8_t *buffer, unsigned length)
+{
+    for (int i = 0; i < NAC; i++) {
+        miso.push_back(0xFF);
+    }
+    miso.push_back(0xFE);
+    miso.insert(miso.end(), buffer, buffer + length);
+    miso.push_back(0x12);
+    miso.push_back(0x34);
+}
+
+static void send_busy()
+{
+    for (int i = 0; i < BUSY; i++) {
+        miso.push_back(0x00);
+    }
+}
+
+static void command()
+{
+    int index = cmd[0] & 0x3F;
+    uint32_t arg = cmd[1] << 24 | cmd[2] << 16 | cmd[3] << 8 | cmd[4];
+    uint8_t idle = initialized ? 0 : 0x01;
+    bool acmd = app_cmd;
+    app_cmd = false;
+
+    if (acmd && index == 41) {
+        initialized = ++acmd41_polls >= 2;
+        respond(initialized ? 0x00 : 0x01);
+        return;
+    }
+    if (acmd && index == 23) {
+        acmd23s++;
+        acmd23_count = arg;
+        respond(idle);
+        return;
+    }
+
+    cmds[index]++;
+    switch (index) {
+        case 0:
+            initialized = false;
+            acmd41_polls = 0;
+            respond(0x01);
+            break;
+
+        case 8: {
+            static const uint8_t r7[] = {0x00, 0x00, 0x01, 0xAA};
+            respond(idle);
+            miso.insert(miso.end(), r7, r7 + sizeof(r7));
+            break;
+        }
+
+        case 9: {
+            // CSD v2.0, with C_SIZE where _sd_sectors() reads it
+            static uint8_t csd[16] = {0x40};
+            csd[8] = (SD_SECTORS / 1024 - 1) >> 8;
+            csd[9] = (SD_SECTORS / 1024 - 1) & 0xFF;
+            respond(idle);
+            read_data = csd;
+            read_length = sizeof(csd);
+            state = CARD_READ_SINGLE;
+            break;
+        }
+
+        case 12:
+            // the stuff byte, R1, then busy
+            miso.clear();
+            miso.push_back(0xFF);
+            miso.push_back(0x00);
+            send_busy();
+            state = CARD_IDLE;
+            break;
+
+        case 16:
+            respond(arg == 512 ? idle : 0x40);
+            break;
+
+        case 17:
+        case 18:
+            if (arg >= SD_SECTORS) {
+                respond(0x20);
+                break;
+            }
+            respond(idle);
+            block = arg;
+            if (index == 17) {
+                read_data = storage[block];
+                read_length = 512;
+                state = CARD_READ_SINGLE;
+            } else {
+                state = CARD_READ_MULTI;
+            }
+            break;
+
+        case 24:
+        case 25:
+            if (arg >= SD_SECTORS) {
+                respond(0x20);
+                break;
+            }
+            respond(idle);
+            block = arg;
+            multi = (index == 25);
+            state = CARD_WRITE_TOKEN;
+            break;
+
+        case 55:
+            app_cmd = true;
+            respond(idle);
+            break;
+
+        case 58: {
+            static const uint8_t ocr[] = {0xC0, 0xFF, 0x80, 0x00};
+            respond(idle);
+            miso.insert(miso.end(), ocr, ocr + sizeof(ocr));
+            break;
+        }
+
+        default:
+            respond(idle | 0x04);
+            break;
+    }
+}
+
+static void receive(uint8_t mosi)
+{
+    if (state == CARD_WRITE_TOKEN) {
+        if (mosi == (multi ? 0xFC : 0xFE)) {
+            state = CARD_WRITE_DATA;
+            data_len = 0;
+        } else if (multi && mosi == 0xFD) {
+            // one byte before busy
+            miso.push_back(0xFF);
+            send_busy();
+            state = CARD_IDLE;
+        }
+        return;
+    }
+
+    if (state == CARD_WRITE_DATA) {
+        data[data_len++] = mosi;
+        if (data_len == sizeof(data)) {
+            memcpy(storage[block++], data, 512);
+            miso.push_back(0xE5);
+            send_busy();
+            state = multi ? CARD_WRITE_TOKEN : CARD_IDLE;
+        }
+        return;
+    }
+
+    if (cmd_len == 0 && (mosi & 0xC0) != 0x40) {
+        return;
+    }
+    cmd[cmd_len++] = mosi;
+    if (cmd_len == sizeof(cmd)) {
+        cmd_len = 0;
+        command();
+    }
+}
+
+static uint8_t exchange(uint8_t mosi)
+{
+    now += byte_ns;
+    if (!selected) {
+        return 0xFF;
+    }
+
+    if (miso.empty() && state == CARD_READ_SINGLE) {
+        send_block(read_data, read_length);
+        state = CARD_IDLE;
+    }
+    if (miso.empty() && state == CARD_READ_MULTI) {
+        send_block(storage[block++ % SD_SECTORS], 512);
+    }
+
+    uint8_t out = 0xFF;
+    if (!miso.empty()) {
+        out = miso.front();
+        miso.pop_front();
+    }
+    receive(mosi);
+    return out;
+}
+
+void mbed::sd_card_select(int value)
+{
+    if (value && selected) {
+        // deselecting stops the card driving MISO, and abandons a data
+        // block that is being received
+        miso.clear();
+        cmd_len = 0;
+        if (state == CARD_WRITE_DATA) {
+            state = CARD_IDLE;
+        }
+    }
+    selected = !value;
+}
+
+void mbed::SPI::frequency(int hz)
+{
+    byte_ns = 8000000000ULL / hz;
+}
+
+int mbed::SPI::write(int value)
+{
+    spi_calls++;
+    now += CALL_NS;
+    return exchange(value);
+}
+
+int mbed::SPI::write(const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length)
+{
+    spi_calls++;
+    now += CALL_NS;
+    int total = (tx_length > rx_length) ? tx_length : rx_length;
+    for (int i = 0; i < total; i++) {
+        char in = exchange((i < tx_length) ? tx_buffer[i] : 0xFF);
+        if (i < rx_length) {
+            rx_buffer[i] = in;
+        }
+    }
+    return total;
+}
+
+void mbed::wait_ms(int ms)
+{
+    now += ms * 1000000ULL;
+}
+
+
+// Emulated DMA
+#if SD_SPI_DMA
+enum DmaMode {
+    DMA_COMPLETE,
+    DMA_BUSY,                           // transfer() cannot start
+    DMA_HANG,                           // the transfer never completes
+    DMA_LATE,                           // the transfer completes when aborted
+};
+
+static DmaMode dma_mode;
+static bool dma_active;
+static const uint8_t *dma_tx;
+static uint8_t *dma_rx;
+static int dma_tx_length;
+static int dma_rx_length;
+static event_callback_t dma_callback;
+static unsigned dma_timeouts;
+static unsigned dma_aborts;
+
+static void dma_complete()
+{
+    int total = (dma_tx_length > dma_rx_length) ? dma_tx_length : dma_rx_length;
+    for (int i = 0; i < total; i++) {
+        uint8_t in = exchange(dma_tx && i < dma_tx_length ? dma_tx[i] : 0xFF);
+        if (i < dma_rx_length) {
+            dma_rx[i] = in;
+        }
+    }
+    dma_active = false;
+    dma_callback(SPI_EVENT_COMPLETE);
+}
+
+int mbed::SPI::transfer(const void *tx_buffer, int tx_length, void *rx_buffer, int rx_length,
+        unsigned char bit_width, const event_callback_t& callback, int event)
+{
+    spi_calls++;
+    now += CALL_NS;
+    if (dma_mode == DMA_BUSY || dma_active) {
+        return -1;
+    }
+
+    dma_active = true;
+    dma_tx = (const uint8_t *)tx_buffer;
+    dma_rx = (uint8_t *)rx_buffer;
+    dma_tx_length = tx_length;
+    dma_rx_length = rx_length;
+    dma_callback = callback;
+    return 0;
+}
+
+void mbed::SPI::abort_transfer()
+{
+    dma_aborts++;
+    if (dma_active && dma_mode == DMA_LATE) {
+        dma_complete();
+    }
+    dma_active = false;
+}
+
+int32_t rtos::Semaphore::wait(uint32_t millisec)
+{
+    if (_count == 0 && dma_active && dma_mode == DMA_COMPLETE) {
+        dma_complete();
+    }
+    if (_count > 0) {
+        return _count--;
+    }
+    if (millisec > 0) {
+        now += millisec * 1000000ULL;
+        dma_timeouts++;
+    }
+    return 0;
+}
+#endif
+
+extern "C" void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assert %s %s:%d\n", expr, file, line);
+    abort();
+}
+
+
+// Test
+static int failures;
+
+#define check(test) do { \
+        if (!(test)) { \
+            printf("\e[1m\e[31mfail\e[0m sd_card.cpp:%d: %s\n", __LINE__, #test); \
+            failures++; \
+        } \
+    } while (0)
+
+static uint8_t pattern(uint32_t addr, uint32_t i)
+{
+    return (uint8_t)((addr >> 9) * 7 + i * 13 + (i >> 8));
+}
+
+static void fill(uint8_t *buffer, bd_addr_t addr, bd_size_t size)
+{
+    for (bd_size_t i = 0; i < size; i++) {
+        buffer[i] = pattern(addr + i, i);
+    }
+}
+
+static void reset_counts()
+{
+    memset(cmds, 0, sizeof(cmds));
+    acmd23s = 0;
+    spi_calls = 0;
+}
+
+static void test_init(SDBlockDevice &sd)
+{
+    // the longest command response time allowed
+    ncr = 8;
+    SDBlockDevice slow(NC, NC, NC, NC);
+    check(slow.init() == 0);
+    check(slow.size() == (bd_size_t)SD_SECTORS * 512);
+    ncr = 1;
+
+    check(sd.init() == 0);
+    check(sd.size() == (bd_size_t)SD_SECTORS * 512);
+    check(initialized);
+}
+
+static void test_single_block(SDBlockDevice &sd)
+{
+    static uint8_t buffer[512];
+    static uint8_t readback[512];
+    fill(buffer, 512 * 100, sizeof(buffer));
+
+    reset_counts();
+    check(sd.program(buffer, 512 * 100, 512) == 0);
+    check(cmds[24] == 1 && cmds[25] == 0 && acmd23s == 0);
+    check(memcmp(storage[100], buffer, 512) == 0);
+
+    reset_counts();
+    check(sd.read(readback, 512 * 100, 512) == 0);
+    check(cmds[17] == 1 && cmds[18] == 0 && cmds[12] == 0);
+    check(memcmp(readback, buffer, 512) == 0);
+}
+
+static void test_multi_block(SDBlockDevice &sd)
+{
+    static uint8_t buffer[16 * 1024];
+    static uint8_t readback[16 * 1024];
+    const bd_addr_t addr = 512 * 1000;
+    fill(buffer, addr, sizeof(buffer));
+
+    // one CMD25, announced with ACMD23 and ended with the stop token
+    reset_counts();
+    check(sd.program(buffer, addr, sizeof(buffer)) == 0);
+    check(cmds[25] == 1 && cmds[24] == 0);
+    check(acmd23s == 1 && acmd23_count == sizeof(buffer) / 512);
+    check(state == CARD_IDLE);
+    check(memcmp(storage[1000], buffer, sizeof(buffer)) == 0);
+    check(spi_calls < sizeof(buffer) / 16);
+
+    // one CMD18, ended with CMD12
+    reset_counts();
+    check(sd.read(readback, addr, sizeof(readback)) == 0);
+    check(cmds[18] == 1 && cmds[12] == 1 && cmds[17] == 0);
+    check(state == CARD_IDLE);
+    check(memcmp(readback, buffer, sizeof(buffer)) == 0);
+    check(spi_calls < sizeof(buffer) / 16);
+
+    // the neighbouring blocks are untouched
+    static const uint8_t zero[512] = {0};
+    check(memcmp(storage[999], zero, 512) == 0);
+    check(memcmp(storage[1000 + sizeof(buffer) / 512], zero, 512) == 0);
+}
+
+// Bytes per simulated second, moving 1MB in requests of the given size
+static double throughput(SDBlockDevice &sd, bd_size_t request, bool write)
+{
+    static uint8_t buffer[16 * 1024];
+    const bd_size_t total = 1024 * 1024;
+    bool ok = true;
+
+    uint64_t start = now;
+    for (bd_addr_t addr = 0; addr < total; addr += request) {
+        if (write) {
+            fill(buffer, addr, request);
+            ok = ok && sd.program(buffer, addr, request) == 0;
+        } else {
+            ok = ok && sd.read(buffer, addr, request) == 0;
+            for (bd_size_t i = 0; i < request; i++) {
+                ok = ok && buffer[i] == pattern(addr + i, i);
+            }
+        }
+    }
+    check(ok);
+    return total / ((now - start) / 1e9);
+}
+
+static void test_throughput(SDBlockDevice &sd)
+{
+    double wire = 1e9 / byte_ns;
+    double write_single = throughput(sd, 512, true);
+    double read_single = throughput(sd, 512, false);
+    double write_multi = throughput(sd, 16 * 1024, true);
+    double read_multi = throughput(sd, 16 * 1024, false);
+
+    printf("wire limit %.0f B/s\n", wire);
+    printf("write: %.0f B/s in 512B requests, %.0f B/s in 16KB requests\n",
+            write_single, write_multi);
+    printf("read:  %.0f B/s in 512B requests, %.0f B/s in 16KB requests\n",
+            read_single, read_multi);
+
+    // Clocked one SPI::write() per byte, a block would reach 8/9 of the wire
+    check(write_multi > 0.95 * wire);
+    check(read_multi > 0.95 * wire);
+    check(write_multi > write_single);
+    check(read_multi > read_single);
+}
+
+#if SD_SPI_DMA
+static void test_dma_timeout(SDBlockDevice &sd)
+{
+    static uint8_t buffer[4 * 512];
+    static uint8_t readback[4 * 512];
+    fill(buffer, 512 * 200, sizeof(buffer));
+    check(sd.program(buffer, 512 * 200, sizeof(buffer)) == 0);
+
+    // a transfer that never completes fails the request after the timeout
+    dma_mode = DMA_HANG;
+    dma_timeouts = dma_aborts = 0;
+    uint64_t start = now;
+    check(sd.read(readback, 512 * 200, 512) != 0);
+    check(sd.read(readback, 512 * 200, sizeof(readback)) != 0);
+    check(sd.program(buffer, 512 * 200, sizeof(buffer)) != 0);
+    check(dma_timeouts == 3 && dma_aborts == 3);
+    check(now - start >= 3 * 500 * 1000000ULL);
+    check(!dma_active);
+
+    // the card recovers, and the data written before is intact
+    dma_mode = DMA_COMPLETE;
+    memset(readback, 0, sizeof(readback));
+    check(sd.read(readback, 512 * 200, sizeof(readback)) == 0);
+    check(memcmp(readback, buffer, sizeof(buffer)) == 0);
+
+    // a completion that arrives after the timeout does not end the next
+    // transfer early
+    dma_mode = DMA_LATE;
+    check(sd.read(readback, 512 * 200, 512) != 0);
+    dma_mode = DMA_COMPLETE;
+    memset(readback, 0, sizeof(readback));
+    check(sd.read(readback, 512 * 200, sizeof(readback)) == 0);
+    check(memcmp(readback, buffer, sizeof(buffer)) == 0);
+
+    // a peripheral that cannot start the transfer falls back to SPI::write()
+    dma_mode = DMA_BUSY;
+    dma_timeouts = 0;
+    memset(readback, 0, sizeof(readback));
+    check(sd.read(readback, 512 * 200, sizeof(readback)) == 0);
+    check(memcmp(readback, buffer, sizeof(buffer)) == 0);
+    check(sd.program(buffer, 512 * 200, sizeof(buffer)) == 0);
+    check(dma_timeouts == 0);
+    dma_mode = DMA_COMPLETE;
+}
+#endif
+
+int main()
+{
+#if SD_SPI_DMA
+    printf("data blocks through SPI::transfer()\n");
+#else
+    printf("data blocks through SPI::write()\n");
+#endif
+
+    SDBlockDevice sd(NC, NC, NC, NC);
+    test_init(sd);
+    test_single_block(sd);
+    test_multi_block(sd);
+    test_throughput(sd);
+#if SD_SPI_DMA
+    test_dma_timeout(sd);
+#endif
+    check(sd.deinit() == 0);
+
+    if (failures) {
+        printf("\e[1m\e[31m%d failures\e[0m\n", failures);
+    } else {
+        printf("\e[1m\e[32mdone\e[0m\n");
+    }
+
+    return failures != 0;
+}
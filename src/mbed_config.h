@@ -8,17 +8,24 @@
 #define MBED_CONF_LWIP_TCP_SERVER_MAX               4    // set by library:lwip
 #define MBED_CONF_LWIP_ADDR_TIMEOUT                 5    // set by library:lwip
 #define MBED_CONF_PLATFORM_DEFAULT_SERIAL_BAUD_RATE 9600 // set by library:platform
+#define MBED_CONF_PLATFORM_BUFFERED_SERIAL_TXBUF_SIZE 256 // set by library:platform
+#define MBED_CONF_PLATFORM_BUFFERED_SERIAL_RXBUF_SIZE 256 // set by library:platform
 #define MBED_CONF_LWIP_IPV4_ENABLED                 1    // set by library:lwip
 #define MBED_CONF_LWIP_TCP_SOCKET_MAX               4    // set by library:lwip
 #define MBED_CONF_EVENTS_PRESENT                    1    // set by library:events
+#define MBED_CONF_NSAPI_DNS_CACHE_SIZE              3    // set by library:nsapi
 #define MBED_CONF_PLATFORM_STDIO_FLUSH_AT_EXIT      1    // set by library:platform
 #define MBED_CONF_LWIP_UDP_SOCKET_MAX               4    // set by library:lwip
 #define MBED_CONF_FILESYSTEM_PRESENT                1    // set by library:filesystem
+#define MBED_CONF_FILESYSTEM_FAT_FLUSH_INTERVAL     0    // set by library:filesystem
+#define MBED_CONF_FILESYSTEM_FAT_VOLUMES            4    // set by library:filesystem
 #define MBED_CONF_LWIP_IP_VER_PREF                  4    // set by library:lwip
 #define MBED_CONF_PLATFORM_STDIO_CONVERT_NEWLINES   0    // set by library:platform
 #define MBED_CONF_PLATFORM_STDIO_BAUD_RATE          9600 // set by library:platform
 #define MBED_CONF_LWIP_SOCKET_MAX                   4    // set by library:lwip
 #define MBED_CONF_LWIP_IPV6_ENABLED                 0    // set by library:lwip
+#define MBED_CONF_LWIP_THROUGHPUT_PROFILE           0    // set by library:lwip
+#define MBED_CONF_LWIP_TCP_OOSEQ_MAX_PBUFS          4    // set by library:lwip
 // Macros
 #define UNITY_INCLUDE_CONFIG_H                           // defined by library:utest
 
@@ -31,4 +38,9 @@
 // reduce the task and timer counts accordingly to save RAM.
 //#define MBED_RTOS_SINGLE_THREAD                     1
 
+// Set MBED_TICKLESS macro to stop the RTOS tick while all threads are idle. The idle thread then deep sleeps
+// until the next delay or timer is due, woken by the low power ticker. Only used on targets with
+// DEVICE_LOWPOWERTIMER. Ticker and Timeout callbacks on the us_ticker can be held off while in deep sleep.
+//#define MBED_TICKLESS                               1
+
 #endif